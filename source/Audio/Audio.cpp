@@ -2,6 +2,7 @@
 
 #include "AudioDataMgr.h"
 #include "AudioOutputDevice.h"
+#include "AudioStream.h"
 #include "AudioSystem.h"
 #include "Sounds.h"
 
@@ -9,15 +10,16 @@ BEGIN_NAMESPACE(Audio)
 
 static constexpr uint32_t MAX_SOUND_VOICES = 32;
 
-// Audio device, audio data manager & sound systems
+// Audio device, audio data manager, sound system, music stream and movie audio stream.
+// Note: music and movie audio are streamed rather than loaded fully, since they are very large once decoded.
 static AudioOutputDevice    gAudioOutputDevice;
 static AudioDataMgr         gAudioDataMgr;
 static AudioSystem          gSoundAudioSystem;
-static AudioSystem          gMusicAudioSystem;
+static AudioStream          gMusicAudioStream;
+static AudioStream          gMovieAudioStream;
 
-// Loaded sound and music
+// Loaded sounds
 static AudioDataMgr::Handle gSoundAudioDataHandles[NUMSFX];
-static AudioDataMgr::Handle gMusicAudioDataHandle = AudioDataMgr::INVALID_HANDLE;
 
 // Other audio state
 static uint32_t gMusicVolume = MAX_VOLUME;
@@ -29,8 +31,11 @@ void init() noexcept {
         FATAL_ERROR("Unable to initialize an audio output device!");
     }
 
+    gAudioDataMgr.setAudioOutputDevice(&gAudioOutputDevice);
+
     gSoundAudioSystem.init(gAudioOutputDevice, gAudioDataMgr, MAX_SOUND_VOICES);
-    gMusicAudioSystem.init(gAudioOutputDevice, gAudioDataMgr, 1);
+    gMusicAudioStream.init(gAudioOutputDevice);
+    gMovieAudioStream.init(gAudioOutputDevice);
 
     // Insure initial volume is set with the audio system
     setMusicVolume(gMusicVolume);
@@ -44,33 +49,37 @@ void loadAllSounds() noexcept {
         // N.B: File extension *must* be UPPERCASE - this is what is on the 3DO Disc!
         char fileName[128];          
         std::snprintf(fileName, sizeof(fileName), "Sounds/Sound%02d.AIFF", int(soundNum));
-        gSoundAudioDataHandles[soundNum] = gAudioDataMgr.loadFile(fileName);
+        gSoundAudioDataHandles[soundNum] = gAudioDataMgr.loadFile(fileName, true);      // Note: only sounds use the asset cache, not music
     }
 }
 
 void shutdown() noexcept {
-    gMusicAudioSystem.shutdown();
+    gMovieAudioStream.shutdown();
+    gMusicAudioStream.shutdown();
     gSoundAudioSystem.shutdown();
 
     gAudioDataMgr.unloadAll();
+    gAudioDataMgr.setAudioOutputDevice(nullptr);
     gAudioOutputDevice.shutdown();
 
     for (AudioDataMgr::Handle& handle : gSoundAudioDataHandles) {
         handle = AudioDataMgr::INVALID_HANDLE;
     }
 
-    gMusicAudioDataHandle = AudioDataMgr::INVALID_HANDLE;
+    gPlayingMusicTrackNum = UINT32_MAX;
 }
 
 uint32_t playSound(
     const uint32_t num,
     const float lVolume,
     const float rVolume,
-    const bool bStopOtherInstances
+    const bool bStopOtherInstances,
+    const uint8_t priority,
+    const uint32_t maxInstances
 ) noexcept {
     ASSERT(num < NUMSFX);
     const AudioDataMgr::Handle soundHandle = gSoundAudioDataHandles[num];
-    return gSoundAudioSystem.play(soundHandle, false, lVolume, rVolume, bStopOtherInstances);
+    return gSoundAudioSystem.play(soundHandle, false, lVolume, rVolume, bStopOtherInstances, priority, maxInstances);
 }
 
 bool isSoundPlaying(const uint32_t num) noexcept {
@@ -108,40 +117,26 @@ void playMusic(const uint32_t trackNum) noexcept {
     if (gPlayingMusicTrackNum == trackNum)
         return;
 
-    // Load the song
+    // Start streaming the song, looped
     char fileName[128];
     std::snprintf(fileName, sizeof(fileName), "Music/Song%d", int(trackNum));
-
-    const AudioDataMgr::Handle oldMusicHandle = gMusicAudioDataHandle;
-    const AudioDataMgr::Handle newMusicHandle = gAudioDataMgr.loadFile(fileName);
-
-    // Stop the old one and play the new one
-    gMusicAudioSystem.stopAllVoices();
-    gMusicAudioSystem.play(newMusicHandle, true);   // N.B: assuming it will play successfully always!
-
-    // Unload the old song (if it's still loaded)
-    if (oldMusicHandle != AudioDataMgr::INVALID_HANDLE) {
-        if (oldMusicHandle != newMusicHandle) {
-            gAudioDataMgr.unloadHandle(oldMusicHandle);
-        }
-    }
+    gMusicAudioStream.play(fileName, true);     // N.B: assuming it will play successfully always!
 
     // Remember what is playing
-    gMusicAudioDataHandle = newMusicHandle;
     gPlayingMusicTrackNum = trackNum;
 }
 
 void stopMusic() noexcept {
-    gMusicAudioSystem.stopAllVoices();
+    gMusicAudioStream.stop();
     gPlayingMusicTrackNum = UINT32_MAX;
 }
 
 void pauseMusic() noexcept {
-    gMusicAudioSystem.pause(true);
+    gMusicAudioStream.pause(true);
 }
 
 void resumeMusic() noexcept {
-    gMusicAudioSystem.pause(false);
+    gMusicAudioStream.pause(false);
 }
 
 uint32_t getMusicVolume() noexcept {
@@ -151,8 +146,8 @@ uint32_t getMusicVolume() noexcept {
 void setMusicVolume(const uint32_t volume) noexcept {
     gMusicVolume = (volume > MAX_VOLUME) ? MAX_VOLUME : volume;
 
-    if (gMusicAudioSystem.isInitialized()) {
-        gMusicAudioSystem.setMasterVolume((float) gMusicVolume / (float) MAX_VOLUME);
+    if (gMusicAudioStream.isInitialized()) {
+        gMusicAudioStream.setVolume((float) gMusicVolume / (float) MAX_VOLUME);
     }
 }
 
@@ -166,6 +161,11 @@ void setSoundVolume(const uint32_t volume) noexcept {
     if (gSoundAudioSystem.isInitialized()) {
         gSoundAudioSystem.setMasterVolume((float) gSoundVolume / (float) MAX_VOLUME);
     }
+
+    // Note: movie audio is treated as a sound for the purposes of volume
+    if (gMovieAudioStream.isInitialized()) {
+        gMovieAudioStream.setVolume((float) gSoundVolume / (float) MAX_VOLUME);
+    }
 }
 
 AudioDataMgr& getAudioDataMgr() noexcept {
@@ -176,8 +176,12 @@ AudioSystem& getSoundAudioSystem() noexcept {
     return gSoundAudioSystem;
 }
 
-AudioSystem& getMusicAudioSystem() noexcept {
-    return gMusicAudioSystem;
+AudioStream& getMusicAudioStream() noexcept {
+    return gMusicAudioStream;
+}
+
+AudioStream& getMovieAudioStream() noexcept {
+    return gMovieAudioStream;
 }
 
 END_NAMESPACE(Audio)
@@ -4,6 +4,7 @@
 #include <cstdint>
 
 class AudioDataMgr;
+class AudioStream;
 class AudioSystem;
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -21,7 +22,9 @@ uint32_t playSound(
     const uint32_t num,
     const float lVolume,
     const float rVolume,
-    const bool bStopOtherInstances = false
+    const bool bStopOtherInstances = false,
+    const uint8_t priority = 0,
+    const uint32_t maxInstances = 0
 ) noexcept;
 
 bool isSoundPlaying(const uint32_t num) noexcept;
@@ -48,6 +51,7 @@ void setSoundVolume(const uint32_t volume) noexcept;
 // Low level access
 AudioDataMgr& getAudioDataMgr() noexcept;
 AudioSystem& getSoundAudioSystem() noexcept;
-AudioSystem& getMusicAudioSystem() noexcept;
+AudioStream& getMusicAudioStream() noexcept;
+AudioStream& getMovieAudioStream() noexcept;
 
 END_NAMESPACE(Audio)
@@ -13,7 +13,7 @@ struct AudioData {
     uint32_t    numSamples;     // Number of samples in the audio data (per channel)
     uint32_t    sampleRate;     // 44,100 etc.
     uint16_t    numChannels;    // Should be: '1' or '2', note that the data for each channel is interleaved for each sample.
-    uint16_t    bitDepth;       // Should be: '8' or '16' only.
+    uint16_t    bitDepth;       // Should be: '8' or '16' for integer samples, or '32' for float samples.
 
     inline AudioData() noexcept
         : pBuffer(nullptr)
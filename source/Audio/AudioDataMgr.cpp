@@ -1,9 +1,75 @@
 #include "AudioDataMgr.h"
 
 #include "AudioLoader.h"
+#include "AudioOutputDevice.h"
+#include <algorithm>
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Reads a single sample from audio data in any of the supported formats and returns it as a float
+//------------------------------------------------------------------------------------------------------------------------------------------
+static float readSampleAsFloat(const AudioData& audioData, const uint32_t sampleIdx, const uint32_t channel) noexcept {
+    const uint32_t valueIdx = sampleIdx * audioData.numChannels + channel;
+
+    if (audioData.bitDepth == 8) {
+        return float(((const int8_t*) audioData.pBuffer)[valueIdx]) / float(INT8_MAX);
+    } else if (audioData.bitDepth == 16) {
+        return float(((const int16_t*) audioData.pBuffer)[valueIdx]) / float(INT16_MAX);
+    } else {
+        ASSERT(audioData.bitDepth == 32);
+        return ((const float*) audioData.pBuffer)[valueIdx];
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Converts audio data to 32-bit float samples at the given sample rate, so the mixer does not need to resample or convert it.
+// Resampling is done using linear interpolation between samples, the same as the mixer does.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void convertToFloatSamples(AudioData& audioData, const uint32_t outSampleRate) noexcept {
+    ASSERT(outSampleRate > 0);
+
+    if ((audioData.bitDepth == 32) && (audioData.sampleRate == outSampleRate))
+        return;
+
+    // Figure out how many output samples there will be and how many input samples to step per output sample in 32.16 format
+    const uint32_t numChannels = audioData.numChannels;
+    const uint32_t inSampleRate = audioData.sampleRate;
+    const uint32_t numInSamples = audioData.numSamples;
+    const uint64_t numOutSamples64 = ((uint64_t) numInSamples * outSampleRate + inSampleRate - 1) / inSampleRate;
+    const uint32_t numOutSamples = (uint32_t) std::max<uint64_t>(numOutSamples64, 1);
+    const uint64_t sampleStepFrac = ((uint64_t) inSampleRate << 16) / outSampleRate;
+
+    AudioData converted;
+    converted.allocBuffer(numOutSamples * numChannels * (uint32_t) sizeof(float));
+    converted.numSamples = numOutSamples;
+    converted.sampleRate = outSampleRate;
+    converted.numChannels = audioData.numChannels;
+    converted.bitDepth = 32;
+
+    float* pOutSample = (float*) converted.pBuffer;
+    uint64_t curSampleFrac = 0;
+
+    for (uint32_t outSampleIdx = 0; outSampleIdx < numOutSamples; ++outSampleIdx) {
+        const uint32_t curSample = std::min((uint32_t)(curSampleFrac >> 16), numInSamples - 1);
+        const uint32_t nextSample = std::min(curSample + 1, numInSamples - 1);
+        const float sampleLerp = float(uint16_t(curSampleFrac)) / 65536.0f;
+
+        for (uint32_t channel = 0; channel < numChannels; ++channel) {
+            const float sample1 = readSampleAsFloat(audioData, curSample, channel);
+            const float sample2 = readSampleAsFloat(audioData, nextSample, channel);
+            *pOutSample = (1.0f - sampleLerp) * sample1 + sampleLerp * sample2;
+            ++pOutSample;
+        }
+
+        curSampleFrac += sampleStepFrac;
+    }
+
+    audioData.clear();
+    audioData = converted;
+}
 
 AudioDataMgr::AudioDataMgr() noexcept
-    : mAudioEntries()
+    : mpAudioOutputDevice(nullptr)
+    , mAudioEntries()
     , mFreeHandles()
     , mPathToHandle()
 {
@@ -28,7 +94,7 @@ const AudioData* AudioDataMgr::getHandleData(const Handle handle) const noexcept
     return nullptr;
 }
 
-AudioDataMgr::Handle AudioDataMgr::loadFile(const char* const file) noexcept {
+AudioDataMgr::Handle AudioDataMgr::loadFile(const char* const file, const bool bUseAssetCache) noexcept {
     // If the file is already loaded we can just early out
     ASSERT(file);
     const Handle fileHandle = getFileHandle(file);
@@ -39,10 +105,16 @@ AudioDataMgr::Handle AudioDataMgr::loadFile(const char* const file) noexcept {
     // Try to load the audio data
     AudioData audioData;
 
-    if (!AudioLoader::loadFromFile(file, audioData))
+    if (!AudioLoader::loadFromFile(file, audioData, bUseAssetCache))
         return INVALID_HANDLE;
+
+    // Convert to the format the mixer for the output device wants
+    if (mpAudioOutputDevice) {
+        convertToFloatSamples(audioData, mpAudioOutputDevice->getSampleRate());
+    }
     
     // Alloc a new handle and add a path to handle lut entry
+    lockAudioOutputDevice();
     const Handle handle = allocHandle();
     HandleLut::iterator pathToHandleIter = mPathToHandle.insert({ file, handle }).first;
 
@@ -50,6 +122,7 @@ AudioDataMgr::Handle AudioDataMgr::loadFile(const char* const file) noexcept {
     AudioEntry& audioEntry = mAudioEntries[handle];
     audioEntry.data = audioData;
     audioEntry.pathToHandleIter = pathToHandleIter;
+    unlockAudioOutputDevice();
 
     return handle;
 }
@@ -62,7 +135,7 @@ AudioDataMgr::Handle AudioDataMgr::addAudioDataWithOwnership(AudioData& data) no
         (data.numSamples > 0) &&
         (data.sampleRate > 0) &&
         (data.numChannels == 1 || data.numChannels == 2) &&
-        (data.bitDepth == 8 || data.bitDepth == 16)
+        (data.bitDepth == 8 || data.bitDepth == 16 || data.bitDepth == 32)
     );
 
     if (!bDataIsValid) {
@@ -70,12 +143,19 @@ AudioDataMgr::Handle AudioDataMgr::addAudioDataWithOwnership(AudioData& data) no
         return INVALID_HANDLE;
     }
 
+    // Convert to the format the mixer for the output device wants
+    if (mpAudioOutputDevice) {
+        convertToFloatSamples(data, mpAudioOutputDevice->getSampleRate());
+    }
+
     // Assign the audio data a handle and save the audio entry
+    lockAudioOutputDevice();
     const Handle handle = allocHandle();
 
     AudioEntry& audioEntry = mAudioEntries[handle];
     audioEntry.data = data;
     audioEntry.pathToHandleIter = mPathToHandle.end();
+    unlockAudioOutputDevice();
 
     return handle;
 }
@@ -85,6 +165,7 @@ void AudioDataMgr::unloadHandle(const Handle handle) noexcept {
         AudioEntry& entry = mAudioEntries[handle];
 
         if (entry.isLoaded()) {
+            lockAudioOutputDevice();
             entry.data.clear();
 
             if (entry.pathToHandleIter != mPathToHandle.end()) {
@@ -93,11 +174,14 @@ void AudioDataMgr::unloadHandle(const Handle handle) noexcept {
 
             entry.pathToHandleIter = {};
             mFreeHandles.emplace_back(handle);
+            unlockAudioOutputDevice();
         }
     }
 }
 
 void AudioDataMgr::unloadAll() noexcept {
+    lockAudioOutputDevice();
+
     for (AudioEntry& entry : mAudioEntries) {
         if (entry.isLoaded()) {
             entry.data.clear();
@@ -107,6 +191,7 @@ void AudioDataMgr::unloadAll() noexcept {
     mAudioEntries.clear();
     mFreeHandles.clear();
     mPathToHandle.clear();
+    unlockAudioOutputDevice();
 }
 
 AudioDataMgr::Handle AudioDataMgr::allocHandle() noexcept {
@@ -123,3 +208,15 @@ AudioDataMgr::Handle AudioDataMgr::allocHandle() noexcept {
 
     return handle;
 }
+
+void AudioDataMgr::lockAudioOutputDevice() noexcept {
+    if (mpAudioOutputDevice) {
+        mpAudioOutputDevice->lockAudioDevice();
+    }
+}
+
+void AudioDataMgr::unlockAudioOutputDevice() noexcept {
+    if (mpAudioOutputDevice) {
+        mpAudioOutputDevice->unlockAudioDevice();
+    }
+}
@@ -6,9 +6,15 @@
 #include <string>
 #include <vector>
 
+class AudioOutputDevice;
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Holds audio pieces loaded from files and allocates each audio piece handles.
 // Simple resource manager for all kinds of audio.
+//
+// If an audio output device is set then the device is locked whenever audio data is added or removed, so that the audio thread
+// never reads audio data while it is being modified. Audio data is also converted on load to float samples at the sample rate
+// of the device, so the mixer does not need to resample or convert formats.
 //------------------------------------------------------------------------------------------------------------------------------------------
 class AudioDataMgr {
 public:
@@ -19,6 +25,9 @@ public:
     AudioDataMgr() noexcept;
     ~AudioDataMgr() noexcept;
 
+    // Set the output device which plays the audio data in this manager, or null if none
+    inline void setAudioOutputDevice(AudioOutputDevice* const pDevice) noexcept { mpAudioOutputDevice = pDevice; }
+
     //------------------------------------------------------------------------------------------------------------------
     // Lookup a specified handle for a file.
     // Returns 'INVALID_HANDLE' if the file is not loaded.
@@ -36,8 +45,9 @@ public:
     // Load the specified audio file and return its handle.
     // If it fails then 'INVALID_HANDLE' will be returned.
     // If the audio file is already loaded then the existing handle will be returned.
+    // If 'bUseAssetCache' is set then the decoded audio may be read from or saved to the on disk asset cache.
     //------------------------------------------------------------------------------------------------------------------
-    Handle loadFile(const char* const file) noexcept;
+    Handle loadFile(const char* const file, const bool bUseAssetCache = false) noexcept;
 
     //------------------------------------------------------------------------------------------------------------------
     // Adds audio data that has been generated or loaded externally to the manager.
@@ -48,6 +58,8 @@ public:
     //  (2) Even in failure cases the manager maintains ownership over any data pointer.
     //      It may free the data as a result of the failure.
     //  (3) It is undefined behavior to add audio data that is already owned by the manager.
+    //  (4) If an audio output device is set then the data is converted to float samples at the device sample rate,
+    //      and the given data object is updated to reflect this.
     //------------------------------------------------------------------------------------------------------------------
     Handle addAudioDataWithOwnership(AudioData& data) noexcept;
 
@@ -73,6 +85,11 @@ private:
     // Alloc a new audio data handle or re-use a previous one
     Handle allocHandle() noexcept;
 
+    // Lock or unlock the audio output device (if any) while modifying audio data
+    void lockAudioOutputDevice() noexcept;
+    void unlockAudioOutputDevice() noexcept;
+
+    AudioOutputDevice*          mpAudioOutputDevice;
     std::vector<AudioEntry>     mAudioEntries;
     std::vector<Handle>         mFreeHandles;
     HandleLut                   mPathToHandle;
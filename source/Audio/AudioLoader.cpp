@@ -5,6 +5,7 @@
 #include "Base/Endian.h"
 #include "Base/Finally.h"
 #include "Base/Mem.h"
+#include "Game/AssetCache.h"
 #include "Game/GameDataFS.h"
 #include <vector>
 #include <limits>
@@ -194,66 +195,59 @@ static bool readSdx2CompressedSoundData(ByteInputStream& stream, AudioData& audi
     const uint32_t bufferSize = audioData.numSamples * audioData.numChannels * sizeof(uint16_t);
     audioData.allocBuffer(bufferSize);
 
-    // Setup before we decode each sample
-    const uint32_t numSamples = audioData.numSamples;
-    const uint16_t numChannels = audioData.numChannels;
-    const uint32_t numChannelSamples = numSamples * numChannels;
-
-    int16_t* pOutput = reinterpret_cast<int16_t*>(audioData.pBuffer);
-    int16_t* const pEndOutput = pOutput + numChannelSamples;
-
-    const int8_t* pInput = reinterpret_cast<const int8_t*>(stream.getCurData());
+    // Decode all the samples in one go
+    const uint32_t numChannelSamples = audioData.numSamples * audioData.numChannels;
+    const std::byte* const pInput = stream.getCurData();
     stream.consume(numChannelSamples);
 
-    // Hardcode the loop for both 1 and 2 channel cases to help speed up decoding.
-    // Removing loops, conditionals and allowing for more pipelining helps...
-    if (numChannels == 2) {
-        int16_t prevSampleL = 0;
-        int16_t prevSampleR = 0;
-
-        while (pOutput < pEndOutput) {
-            // Get both the left and right compressed samples (read both at the same time, then separate)
-            const int8_t sampleL8 = pInput[0];
-            const int8_t sampleR8 = pInput[1];
-
-            // Compute this sample's actual value via the SDX2 encoding mechanism
-            int16_t sampleL16 = (int16_t)((sampleL8 * (int16_t) std::abs(sampleL8)) * 2);
-            int16_t sampleR16 = (int16_t)((sampleR8 * (int16_t) std::abs(sampleR8)) * 2);
-            sampleL16 += prevSampleL * int16_t(sampleL8 & int8_t(0x01));
-            sampleR16 += prevSampleR * int16_t(sampleR8 & int8_t(0x01));
+    AudioLoader::Sdx2DecoderState decoderState = {};
+    AudioLoader::decodeSdx2Samples(
+        pInput,
+        reinterpret_cast<int16_t*>(audioData.pBuffer),
+        audioData.numSamples,
+        audioData.numChannels,
+        decoderState
+    );
 
-            // Save output and move on.
-            // Note: looks strange but increment input before output as it will be needed again sooner... (pipelining considerations)
-            pOutput[0] = sampleL16;
-            pOutput[1] = sampleR16;
-            pInput += 2;
+    return true;
+}
 
-            prevSampleL = sampleL16;
-            prevSampleR = sampleR16;
-            pOutput += 2;
-        }
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Reads the format details in the common chunk.
+// Returns 'false' if the format is not one that is supported.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool readCommonChunk(
+    ByteInputStream& commonStream,
+    const bool bIsAifc,
+    uint16_t& numChannels,
+    uint32_t& numSamples,
+    uint16_t& bitDepth,
+    uint32_t& sampleRate,
+    IffId& compressionType
+) THROWS {
+    numChannels = Endian::bigToHost(commonStream.read<uint16_t>());
+    numSamples = Endian::bigToHost(commonStream.read<uint32_t>());
+    bitDepth = Endian::bigToHost(commonStream.read<uint16_t>());
+    sampleRate = (uint32_t) readBigEndianExtendedFloat(commonStream);
+
+    // Note: if the format is AIFF-C then the common chunk is extended to include compression info.
+    // If the format is AIFF then there is no compression.
+    if (bIsAifc) {
+        compressionType = commonStream.read<uint32_t>();
     }
     else {
-        ASSERT(numChannels == 1);
-        int16_t prevSample = 0;
-
-        while (pOutput < pEndOutput) {
-            // Get the compressed sample
-            const int8_t sample8 = pInput[0];
+        compressionType = ID_NONE;
+    }
 
-            // Compute this sample's actual value via the SDX2 encoding mechanism
-            int16_t sample16 = (sample8 * (int16_t) std::abs(sample8)) << (int16_t) 1;
-            sample16 += prevSample * int16_t(sample8 & int8_t(0x01));
+    // Sanity check some of the data - only supporting certain formats
+    if (numChannels != 1 && numChannels != 2)
+        return false;
 
-            // Save output and move on.
-            // Note: looks strange but increment input before output as it will be needed again sooner... (pipelining considerations)
-            pOutput[0] = sample16;
-            ++pInput;
+    if (bitDepth != 8 && bitDepth != 16)
+        return false;
 
-            prevSample = sample16;
-            ++pOutput;
-        }
-    }
+    if (sampleRate <= 0)
+        return false;
 
     return true;
 }
@@ -296,31 +290,10 @@ static bool readFormChunk(const IffChunk& formChunk, AudioData& audioData) THROW
     {
         ByteInputStream commonStream = pCommonChunk->toStream();
 
-        numChannels = Endian::bigToHost(commonStream.read<uint16_t>());
-        numSamples = Endian::bigToHost(commonStream.read<uint32_t>());
-        bitDepth = Endian::bigToHost(commonStream.read<uint16_t>());
-        sampleRate = (uint32_t) readBigEndianExtendedFloat(commonStream);
-
-        // Note: if the format is AIFF-C then the common chunk is extended to include compression info.
-        // If the format is AIFF then there is no compression.
-        if (bIsAifc) {
-            compressionType = commonStream.read<uint32_t>();
-        }
-        else {
-            compressionType = ID_NONE;
-        }
+        if (!readCommonChunk(commonStream, bIsAifc, numChannels, numSamples, bitDepth, sampleRate, compressionType))
+            return false;
     }
 
-    // Sanity check some of the data - only supporting certain formats
-    if (numChannels != 1 && numChannels != 2)
-        return false;
-
-    if (bitDepth != 8 && bitDepth != 16)
-        return false;
-
-    if (sampleRate <= 0)
-        return false;
-
     // Save sound properties
     audioData.numSamples = numSamples;
     audioData.sampleRate = sampleRate;
@@ -341,7 +314,55 @@ static bool readFormChunk(const IffChunk& formChunk, AudioData& audioData) THROW
     }
 }
 
-bool AudioLoader::loadFromFile(const char* const filePath, AudioData& audioData) noexcept {
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Try to read decoded audio data from the asset cache, returning 'false' on failure.
+// The cache payload is the audio format details followed by the sample buffer.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool readCachedAudioData(const AssetCache::Key& cacheKey, AudioData& audioData) noexcept {
+    AssetCache::Entry cacheEntry;
+
+    if (!AssetCache::read(cacheKey, cacheEntry))
+        return false;
+
+    try {
+        ByteInputStream stream = cacheEntry.getPayloadStream();
+        audioData.numSamples = stream.read<uint32_t>();
+        audioData.sampleRate = stream.read<uint32_t>();
+        audioData.numChannels = stream.read<uint16_t>();
+        audioData.bitDepth = stream.read<uint16_t>();
+
+        const uint32_t bufferSize = stream.read<uint32_t>();
+
+        if ((bufferSize == 0) || (bufferSize != stream.getNumBytesLeft())) {
+            audioData.clear();
+            return false;
+        }
+
+        audioData.allocBuffer(bufferSize);
+        stream.readBytes(audioData.pBuffer, bufferSize);
+        return true;
+    }
+    catch (...) {
+        audioData.clear();
+        return false;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Save decoded audio data to the asset cache
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void writeCachedAudioData(const AssetCache::Key& cacheKey, const AudioData& audioData) noexcept {
+    AssetCache::PayloadWriter payload;
+    payload.write(audioData.numSamples);
+    payload.write(audioData.sampleRate);
+    payload.write(audioData.numChannels);
+    payload.write(audioData.bitDepth);
+    payload.write(audioData.bufferSize);
+    payload.writeBytes(audioData.pBuffer, audioData.bufferSize);
+    AssetCache::write(cacheKey, payload);
+}
+
+bool AudioLoader::loadFromFile(const char* const filePath, AudioData& audioData, const bool bUseAssetCache) noexcept {
     // Read the file and abort on failure
     std::byte* pAudioFileData = nullptr;
     size_t audioFileSize = 0;
@@ -352,7 +373,21 @@ bool AudioLoader::loadFromFile(const char* const filePath, AudioData& audioData)
 
     if (!GameDataFS::getContentsOfFile(filePath, pAudioFileData, audioFileSize))
         return false;
-    
+
+    // If we are allowed to then use the already decoded audio in the asset cache, if it is there
+    if (bUseAssetCache && AssetCache::isEnabled()) {
+        const AssetCache::Key cacheKey = AssetCache::makeKey(AssetCache::AssetType::SOUND, pAudioFileData, (uint32_t) audioFileSize);
+
+        if (readCachedAudioData(cacheKey, audioData))
+            return true;
+
+        if (!loadFromBuffer(pAudioFileData, (uint32_t) audioFileSize, audioData))
+            return false;
+
+        writeCachedAudioData(cacheKey, audioData);
+        return true;
+    }
+
     // Now load the audio from the file's buffer
     return loadFromBuffer(pAudioFileData, (uint32_t) audioFileSize, audioData);
 }
@@ -389,3 +424,179 @@ bool AudioLoader::loadFromBuffer(const std::byte* const pBuffer, const uint32_t
 
     return bLoadedSuccessfully;
 }
+
+bool AudioLoader::readStreamInfo(GameDataFS::InputStream& stream, StreamInfo& info) noexcept {
+    info = {};
+
+    // Helper: skips the padding byte after an odd sized chunk (IFF chunk data is always padded to 2 bytes)
+    const auto skipChunkPadding = [&]() THROWS {
+        if ((stream.tell() & 1) && (stream.tell() < stream.size())) {
+            stream.skip(1);
+        }
+    };
+
+    try {
+        // Look through the root chunks in the file for the 'FORM' chunk that contains audio data.
+        // Only the chunk headers and the small common chunk are read, the sound data itself is skipped over.
+        stream.seek(0);
+
+        while (stream.size() - stream.tell() >= sizeof(IffChunkHeader)) {
+            IffChunkHeader rootHeader;
+            stream.read(rootHeader);
+            rootHeader.convertBigToHostEndian();
+
+            const uint32_t rootChunkEnd = stream.tell() + rootHeader.dataSize;
+            bool bIsAudioForm = false;
+            bool bIsAifc = false;
+
+            if ((rootHeader.id == ID_FORM) && (rootHeader.dataSize >= sizeof(IffId))) {
+                const IffId formType = stream.read<IffId>();
+                bIsAudioForm = ((formType == ID_AIFF) || (formType == ID_AIFC));
+                bIsAifc = (formType == ID_AIFC);
+            }
+
+            if (!bIsAudioForm) {
+                stream.seek(rootChunkEnd);
+                skipChunkPadding();
+                continue;
+            }
+
+            // Read the sub-chunks of the form: need the common chunk and to know where the sound data chunk is
+            bool bFoundCommonChunk = false;
+            bool bFoundSoundChunk = false;
+            uint16_t numChannels = 0;
+            uint32_t numSamples = 0;
+            uint16_t bitDepth = 0;
+            uint32_t sampleRate = 0;
+            IffId compressionType = ID_NONE;
+
+            while ((stream.tell() < rootChunkEnd) && (rootChunkEnd - stream.tell() >= sizeof(IffChunkHeader))) {
+                IffChunkHeader header;
+                stream.read(header);
+                header.convertBigToHostEndian();
+
+                const uint32_t chunkStart = stream.tell();
+
+                if (header.id == ID_COMM) {
+                    std::vector<std::byte> commonChunkData(header.dataSize);
+                    stream.readBytes(commonChunkData.data(), header.dataSize);
+                    ByteInputStream commonStream(commonChunkData.data(), header.dataSize);
+
+                    if (!readCommonChunk(commonStream, bIsAifc, numChannels, numSamples, bitDepth, sampleRate, compressionType))
+                        return false;
+
+                    bFoundCommonChunk = true;
+                }
+                else if (header.id == ID_SSND) {
+                    info.soundDataOffset = chunkStart;
+                    info.soundDataSize = header.dataSize;
+                    bFoundSoundChunk = true;
+                }
+
+                stream.seek(chunkStart + header.dataSize);
+                skipChunkPadding();
+            }
+
+            if ((!bFoundCommonChunk) || (!bFoundSoundChunk))
+                return false;
+
+            // Only support uncompressed or 16-bit SDX2 compressed data, same as when loading the audio fully
+            if (compressionType == ID_SDX2) {
+                if (bitDepth != 16)
+                    return false;
+            }
+            else if (compressionType != ID_NONE) {
+                return false;
+            }
+
+            // Make sure the sound data chunk is big enough for all the samples
+            const bool bSdx2Compressed = (compressionType == ID_SDX2);
+            const uint32_t bytesPerSample = (bSdx2Compressed || (bitDepth == 8)) ? 1 : 2;
+            const uint64_t soundDataSize = (uint64_t) numSamples * numChannels * bytesPerSample;
+
+            if ((numSamples == 0) || (soundDataSize > info.soundDataSize))
+                return false;
+
+            info.numSamples = numSamples;
+            info.sampleRate = sampleRate;
+            info.numChannels = numChannels;
+            info.bitDepth = bitDepth;
+            info.bSdx2Compressed = bSdx2Compressed;
+            info.soundDataSize = (uint32_t) soundDataSize;
+            return true;
+        }
+    }
+    catch (...) {
+        // Ignore...
+    }
+
+    return false;
+}
+
+void AudioLoader::decodeSdx2Samples(
+    const std::byte* const pInputBytes,
+    int16_t* const pOutputSamples,
+    const uint32_t numSamples,
+    const uint16_t numChannels,
+    Sdx2DecoderState& state
+) noexcept {
+    ASSERT(numChannels == 1 || numChannels == 2);
+
+    int16_t* pOutput = pOutputSamples;
+    int16_t* const pEndOutput = pOutput + numSamples * numChannels;
+    const int8_t* pInput = reinterpret_cast<const int8_t*>(pInputBytes);
+
+    // Hardcode the loop for both 1 and 2 channel cases to help speed up decoding.
+    // Removing loops, conditionals and allowing for more pipelining helps...
+    if (numChannels == 2) {
+        int16_t prevSampleL = state.prevSamples[0];
+        int16_t prevSampleR = state.prevSamples[1];
+
+        while (pOutput < pEndOutput) {
+            // Get both the left and right compressed samples (read both at the same time, then separate)
+            const int8_t sampleL8 = pInput[0];
+            const int8_t sampleR8 = pInput[1];
+
+            // Compute this sample's actual value via the SDX2 encoding mechanism
+            int16_t sampleL16 = (int16_t)((sampleL8 * (int16_t) std::abs(sampleL8)) * 2);
+            int16_t sampleR16 = (int16_t)((sampleR8 * (int16_t) std::abs(sampleR8)) * 2);
+            sampleL16 += prevSampleL * int16_t(sampleL8 & int8_t(0x01));
+            sampleR16 += prevSampleR * int16_t(sampleR8 & int8_t(0x01));
+
+            // Save output and move on.
+            // Note: looks strange but increment input before output as it will be needed again sooner... (pipelining considerations)
+            pOutput[0] = sampleL16;
+            pOutput[1] = sampleR16;
+            pInput += 2;
+
+            prevSampleL = sampleL16;
+            prevSampleR = sampleR16;
+            pOutput += 2;
+        }
+
+        state.prevSamples[0] = prevSampleL;
+        state.prevSamples[1] = prevSampleR;
+    }
+    else {
+        int16_t prevSample = state.prevSamples[0];
+
+        while (pOutput < pEndOutput) {
+            // Get the compressed sample
+            const int8_t sample8 = pInput[0];
+
+            // Compute this sample's actual value via the SDX2 encoding mechanism
+            int16_t sample16 = (sample8 * (int16_t) std::abs(sample8)) << (int16_t) 1;
+            sample16 += prevSample * int16_t(sample8 & int8_t(0x01));
+
+            // Save output and move on.
+            // Note: looks strange but increment input before output as it will be needed again sooner... (pipelining considerations)
+            pOutput[0] = sample16;
+            ++pInput;
+
+            prevSample = sample16;
+            ++pOutput;
+        }
+
+        state.prevSamples[0] = prevSample;
+    }
+}
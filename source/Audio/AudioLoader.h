@@ -5,17 +5,59 @@
 
 struct AudioData;
 
+namespace GameDataFS {
+    class InputStream;
+}
+
 namespace AudioLoader {
     //------------------------------------------------------------------------------------------------------------------
     // Loads an audio file from the specified file path and saves the loaded data to the given object.
     // Supported sound file formats are:
     //      (1) AIFF
     //      (2) AIFF-C (Uncompressed, and SDX2 compressed)
+    //
+    // If 'bUseAssetCache' is set then the decoded audio is read from (or saved to) the on disk asset cache.
     //------------------------------------------------------------------------------------------------------------------
-    bool loadFromFile(const char* const filePath, AudioData& audioData) noexcept;
+    bool loadFromFile(const char* const filePath, AudioData& audioData, const bool bUseAssetCache = false) noexcept;
 
     //------------------------------------------------------------------------------------------------------------------
     // Same as 'loadFromFile' but loads the audio from a buffer instead
     //------------------------------------------------------------------------------------------------------------------
     bool loadFromBuffer(const std::byte* const pBuffer, const uint32_t bufferSize, AudioData& audioData) noexcept;
+
+    //------------------------------------------------------------------------------------------------------------------
+    // Details about the sound data in an audio file, for streaming the sound data from the file in pieces
+    //------------------------------------------------------------------------------------------------------------------
+    struct StreamInfo {
+        uint32_t    numSamples;         // Number of samples in the audio data (per channel)
+        uint32_t    sampleRate;         // 44,100 etc.
+        uint16_t    numChannels;        // '1' or '2', the data for each channel is interleaved for each sample
+        uint16_t    bitDepth;           // '8' or '16': the bit depth of the samples once decoded
+        bool        bSdx2Compressed;    // If set then the sound data is SDX2 compressed, with 1 byte per channel sample
+        uint32_t    soundDataOffset;    // Offset in the file to the start of the sound data
+        uint32_t    soundDataSize;      // Size of the sound data in bytes
+    };
+
+    //------------------------------------------------------------------------------------------------------------------
+    // Reads the format of the sound data in the given audio file without reading the sound data itself.
+    // The same file formats as 'loadFromFile' are supported. Returns 'false' on failure.
+    //------------------------------------------------------------------------------------------------------------------
+    bool readStreamInfo(GameDataFS::InputStream& stream, StreamInfo& info) noexcept;
+
+    //------------------------------------------------------------------------------------------------------------------
+    // Decodes SDX2 compressed sound data to 16-bit samples.
+    // The decoder state carries over between calls so a stream of sound data can be decoded in pieces; it should be zero
+    // initialized at the start of the sound data.
+    //------------------------------------------------------------------------------------------------------------------
+    struct Sdx2DecoderState {
+        int16_t prevSamples[2];
+    };
+
+    void decodeSdx2Samples(
+        const std::byte* const pInputBytes,
+        int16_t* const pOutputSamples,
+        const uint32_t numSamples,
+        const uint16_t numChannels,
+        Sdx2DecoderState& state
+    ) noexcept;
 }
@@ -1,5 +1,6 @@
 #include "AudioOutputDevice.h"
 
+#include "AudioStream.h"
 #include "AudioSystem.h"
 #include "Base/Macros.h"
 #include <algorithm>
@@ -12,6 +13,7 @@ AudioOutputDevice::AudioOutputDevice() noexcept
     , mAudioDeviceId(0)
     , mSampleRate(0)
     , mAudioSystems()
+    , mAudioStreams()
 {
 }
 
@@ -62,6 +64,7 @@ bool AudioOutputDevice::init() noexcept {
 
 void AudioOutputDevice::shutdown() noexcept {
     ASSERT_LOG(mAudioSystems.empty(), "All audio systems should be deregistered by the time the output device is shut down!");
+    ASSERT_LOG(mAudioStreams.empty(), "All audio streams should be deregistered by the time the output device is shut down!");
 
     if (!mbIsInitialized)
         return;
@@ -104,6 +107,29 @@ void AudioOutputDevice::unregisterAudioSystem(AudioSystem& system) noexcept {
     }
 }
 
+void AudioOutputDevice::registerAudioStream(AudioStream& stream) noexcept {
+    ASSERT(mbIsInitialized);
+    ASSERT_LOG(
+        std::find(mAudioStreams.begin(), mAudioStreams.end(), &stream) == mAudioStreams.end(),
+        "Stream must not already be registered!"
+    );
+
+    AudioDeviceLock lockAudioDev(*this);
+    mAudioStreams.push_back(&stream);
+}
+
+void AudioOutputDevice::unregisterAudioStream(AudioStream& stream) noexcept {
+    ASSERT(mbIsInitialized);
+
+    // N.B: Safe to do searching outside of the lock so long as we don't unregister from the audio thread
+    const auto iter = std::find(mAudioStreams.begin(), mAudioStreams.end(), &stream);
+
+    if (iter != mAudioStreams.end()) {
+        AudioDeviceLock lockAudioDev(*this);
+        mAudioStreams.erase(iter);
+    }
+}
+
 void AudioOutputDevice::lockAudioDevice() noexcept {
     ASSERT(mbIsInitialized);
     SDL_LockAudioDevice(mAudioDeviceId);
@@ -130,13 +156,16 @@ void AudioOutputDevice::audioCallback(
     // Zero all sample data initially
     std::memset(pBuffer, 0, (uint32_t) bufferSize);
 
-    // Add the contribution of all non paused systems to the output
+    // Add the contribution of all systems and streams to the output.
+    // Note: paused systems are still called so they can process commands, they just won't mix anything.
     float* const pOutput = reinterpret_cast<float*>(pBuffer);
     AudioOutputDevice& device = *reinterpret_cast<AudioOutputDevice*>(pUserData);
 
     for (AudioSystem* pSystem : device.mAudioSystems) {
-        if (!pSystem->isPaused()) {
-            pSystem->mixAudio(pOutput, numSamples);
-        }
+        pSystem->mixAudio(pOutput, numSamples);
+    }
+
+    for (AudioStream* pStream : device.mAudioStreams) {
+        pStream->mixAudio(pOutput, numSamples);
     }
 }
@@ -3,11 +3,12 @@
 #include <cstdint>
 #include <vector>
 
+class AudioStream;
 class AudioSystem;
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Manages a single audio output device.
-// Mixes together streams from multiple audio systems.
+// Mixes together streams from multiple audio systems and audio streams.
 //------------------------------------------------------------------------------------------------------------------------------------------
 class AudioOutputDevice {
 public:
@@ -25,13 +26,18 @@ public:
     void registerAudioSystem(AudioSystem& system) noexcept;
     void unregisterAudioSystem(AudioSystem& system) noexcept;
 
+    // Register and unregister an audio stream
+    void registerAudioStream(AudioStream& stream) noexcept;
+    void unregisterAudioStream(AudioStream& stream) noexcept;
+
     //------------------------------------------------------------------------------------------------------------------
     // Locks and unlocks the audio device.
     // When the lock is held it is guaranteed that no audio callback will be in progress.
     //
-    // Lock should be done whenever we are doing anything that might affect playing audio, such as
-    // modifying a voice or setting the volume or pausing a music system. Otherwise we might run
-    // into data race issues with the audio callback thread...
+    // Lock should be done whenever we are doing anything that might affect playing audio which is not
+    // otherwise synchronized with the audio callback thread, such as registering an audio system or
+    // loading and unloading audio data. Voice and volume changes do NOT need the lock since audio
+    // systems send these to the audio thread through a lock-free queue.
     //
     // Use the RAII lock helper to assist with using these.
     //------------------------------------------------------------------------------------------------------------------
@@ -50,6 +56,7 @@ private:
     uint32_t                    mAudioDeviceId;
     uint32_t                    mSampleRate;
     std::vector<AudioSystem*>   mAudioSystems;
+    std::vector<AudioStream*>   mAudioStreams;
 };
 
 //------------------------------------------------------------------------------------------------------------------------------------------
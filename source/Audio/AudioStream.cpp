@@ -0,0 +1,416 @@
+#include "AudioStream.h"
+
+#include "AudioOutputDevice.h"
+#include "Game/GameDataFS.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+AudioStream::AudioStream() noexcept
+    : mbIsInitialized(false)
+    , mpAudioOutputDevice(nullptr)
+    , mbIsPlaying(false)
+    , mbIsPaused(false)
+    , mbDecodeFinished(false)
+    , mVolume(DEFAULT_VOLUME)
+    , mDecodeThread()
+    , mDecodeMutex()
+    , mDecodeCondVar()
+    , mbStopDecoding(false)
+    , mpInput()
+    , mStreamInfo()
+    , mSdx2State()
+    , mbLooped(false)
+    , mChunkNumSamples(0)
+    , mNumSrcSamplesLeft(0)
+    , mResampleStep(0)
+    , mResamplePos(0)
+    , mSrcBytes()
+    , mSrcDecoded()
+    , mSrcSamples()
+    , mpRingSamples()
+    , mRingWritePos(0)
+    , mRingReadPos(0)
+{
+}
+
+AudioStream::~AudioStream() noexcept {
+    shutdown();
+}
+
+void AudioStream::init(AudioOutputDevice& device) noexcept {
+    ASSERT(!mbIsInitialized);
+
+    mpAudioOutputDevice = &device;
+    mpRingSamples = std::make_unique<float[]>(RING_NUM_SAMPLES * 2);
+    mRingWritePos = 0;
+    mRingReadPos = 0;
+    mbIsInitialized = true;
+
+    device.registerAudioStream(*this);
+}
+
+void AudioStream::shutdown() noexcept {
+    if (!mbIsInitialized)
+        return;
+
+    stop();
+    mpAudioOutputDevice->unregisterAudioStream(*this);
+
+    mpRingSamples.reset();
+    mpAudioOutputDevice = nullptr;
+    mbIsPaused = false;
+    mVolume = DEFAULT_VOLUME;
+    mbIsInitialized = false;
+}
+
+bool AudioStream::play(const char* const filePath, const bool bLooped) noexcept {
+    ASSERT(mbIsInitialized);
+    ASSERT(filePath);
+
+    // Stop whatever was playing, then open the file and figure out the format of the sound data
+    stop();
+
+    std::unique_ptr<GameDataFS::InputStream> pInput = GameDataFS::openFile(filePath);
+
+    if (!pInput)
+        return false;
+
+    AudioLoader::StreamInfo streamInfo;
+
+    if (!AudioLoader::readStreamInfo(*pInput, streamInfo))
+        return false;
+
+    try {
+        pInput->seek(streamInfo.soundDataOffset);
+    }
+    catch (...) {
+        return false;
+    }
+
+    // Setup the decoding state
+    mpInput = std::move(pInput);
+    mbLooped = bLooped;
+    mNumSrcSamplesLeft = streamInfo.numSamples;
+    setupDecoding(streamInfo);
+
+    // Decode the first chunk straight away so the audio thread has something to play immediately, then start the decode
+    // thread to keep the ring buffer topped up.
+    decodeChunk();
+
+    mbIsPlaying.store(true, std::memory_order_release);
+    startDecodeThread();
+    return true;
+}
+
+bool AudioStream::playQueued(const uint32_t sampleRate, const uint16_t numChannels, const uint16_t bitDepth) noexcept {
+    ASSERT(mbIsInitialized);
+
+    // Stop whatever was playing and validate the format of the audio that will be queued
+    stop();
+
+    if ((sampleRate == 0) || (numChannels != 1 && numChannels != 2) || (bitDepth != 8 && bitDepth != 16))
+        return false;
+
+    AudioLoader::StreamInfo streamInfo = {};
+    streamInfo.sampleRate = sampleRate;
+    streamInfo.numChannels = numChannels;
+    streamInfo.bitDepth = bitDepth;
+    streamInfo.bSdx2Compressed = false;
+
+    mbLooped = false;
+    mNumSrcSamplesLeft = 0;
+    setupDecoding(streamInfo);
+
+    // Start playing: the audio thread outputs silence until samples are queued
+    mbIsPlaying.store(true, std::memory_order_release);
+    return true;
+}
+
+uint32_t AudioStream::queueSamples(const std::byte* const pSamples, const uint32_t numSamples) noexcept {
+    ASSERT(pSamples || (numSamples == 0));
+    ASSERT(!mDecodeThread.joinable());
+
+    // Queue a chunk at a time for as long as there is room in the ring buffer
+    const uint32_t bytesPerSample = mStreamInfo.numChannels * (mStreamInfo.bitDepth / 8u);
+    const uint32_t maxOutputSamplesPerChunk = getMaxOutputSamplesPerChunk();
+    uint32_t numSamplesQueued = 0;
+
+    while (numSamplesQueued < numSamples) {
+        const uint32_t writePos = mRingWritePos.load(std::memory_order_relaxed);
+        const uint32_t readPos = mRingReadPos.load(std::memory_order_acquire);
+        const uint32_t numFreeSamples = RING_NUM_SAMPLES - (writePos - readPos);
+
+        if (numFreeSamples < maxOutputSamplesPerChunk)
+            break;
+
+        const uint32_t numSrcSamples = std::min(mChunkNumSamples, numSamples - numSamplesQueued);
+        appendSrcSamples(pSamples + (size_t) numSamplesQueued * bytesPerSample, numSrcSamples);
+        resampleToRing();
+        numSamplesQueued += numSrcSamples;
+    }
+
+    return numSamplesQueued;
+}
+
+void AudioStream::endQueue() noexcept {
+    mbDecodeFinished.store(true, std::memory_order_release);
+}
+
+double AudioStream::getPlaybackTime() const noexcept {
+    ASSERT(mbIsInitialized);
+    const uint32_t numSamplesPlayed = mRingReadPos.load(std::memory_order_relaxed);
+    return (double) numSamplesPlayed / (double) mpAudioOutputDevice->getSampleRate();
+}
+
+void AudioStream::stop() noexcept {
+    stopDecodeThread();
+
+    // Make sure the audio thread is not reading the ring buffer before it is reset
+    if (mbIsPlaying.load(std::memory_order_relaxed)) {
+        AudioDeviceLock lockAudioDevice(*mpAudioOutputDevice);
+        mbIsPlaying.store(false, std::memory_order_relaxed);
+    }
+
+    mRingWritePos = 0;
+    mRingReadPos = 0;
+    mpInput.reset();
+    mSrcSamples.clear();
+    mbDecodeFinished = false;
+}
+
+bool AudioStream::isPlaying() const noexcept {
+    if (!mbIsPlaying.load(std::memory_order_relaxed))
+        return false;
+
+    // A non looped stream is finished once everything has been decoded and the audio thread has consumed it all
+    const bool bRingEmpty = (mRingReadPos.load(std::memory_order_relaxed) == mRingWritePos.load(std::memory_order_relaxed));
+    return (!(mbDecodeFinished.load(std::memory_order_acquire) && bRingEmpty));
+}
+
+void AudioStream::setVolume(const float volume) noexcept {
+    mVolume.store(volume, std::memory_order_relaxed);
+}
+
+void AudioStream::pause(const bool pause) noexcept {
+    mbIsPaused.store(pause, std::memory_order_relaxed);
+}
+
+void AudioStream::mixAudio(float* const pSamples, const uint32_t numSamples) noexcept {
+    ASSERT(pSamples);
+
+    if ((!mbIsPlaying.load(std::memory_order_acquire)) || mbIsPaused.load(std::memory_order_relaxed))
+        return;
+
+    // Mix in as much as is available. If the decode thread has fallen behind then the rest is just silence.
+    const uint32_t readPos = mRingReadPos.load(std::memory_order_relaxed);
+    const uint32_t writePos = mRingWritePos.load(std::memory_order_acquire);
+    const uint32_t numSamplesToMix = std::min(writePos - readPos, numSamples);
+    const float volume = mVolume.load(std::memory_order_relaxed);
+    const float* const pRingSamples = mpRingSamples.get();
+
+    for (uint32_t i = 0; i < numSamplesToMix; ++i) {
+        const uint32_t ringIdx = (readPos + i) & (RING_NUM_SAMPLES - 1);
+        pSamples[i * 2 + 0] += pRingSamples[ringIdx * 2 + 0] * volume;
+        pSamples[i * 2 + 1] += pRingSamples[ringIdx * 2 + 1] * volume;
+    }
+
+    mRingReadPos.store(readPos + numSamplesToMix, std::memory_order_release);
+}
+
+void AudioStream::startDecodeThread() noexcept {
+    ASSERT(!mDecodeThread.joinable());
+    mbStopDecoding = false;
+    mDecodeThread = std::thread([this]() noexcept { decodeThreadMain(); });
+}
+
+void AudioStream::stopDecodeThread() noexcept {
+    if (!mDecodeThread.joinable())
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(mDecodeMutex);
+        mbStopDecoding = true;
+    }
+
+    mDecodeCondVar.notify_one();
+    mDecodeThread.join();
+    mbStopDecoding = false;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Keeps the ring buffer topped up until told to stop or the end of a non looped stream is reached.
+// When the ring buffer is too full to take another chunk the thread just sleeps for a little while: the ring holds enough audio
+// that waking up every few milliseconds is plenty, and it means the audio thread never has to signal this thread.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void AudioStream::decodeThreadMain() noexcept {
+    const uint32_t maxOutputSamplesPerChunk = getMaxOutputSamplesPerChunk();
+    std::unique_lock<std::mutex> lock(mDecodeMutex);
+
+    while (!mbStopDecoding) {
+        const uint32_t writePos = mRingWritePos.load(std::memory_order_relaxed);
+        const uint32_t readPos = mRingReadPos.load(std::memory_order_acquire);
+        const uint32_t numFreeSamples = RING_NUM_SAMPLES - (writePos - readPos);
+
+        if (numFreeSamples >= maxOutputSamplesPerChunk) {
+            lock.unlock();
+            const bool bMoreToDecode = decodeChunk();
+            lock.lock();
+
+            if (!bMoreToDecode)
+                break;
+        } else {
+            mDecodeCondVar.wait_for(lock, std::chrono::milliseconds(5));
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Resets the decoding and resampling state and the ring buffer for playing audio in the given format
+//------------------------------------------------------------------------------------------------------------------------------------------
+void AudioStream::setupDecoding(const AudioLoader::StreamInfo& streamInfo) noexcept {
+    mStreamInfo = streamInfo;
+    mSdx2State = {};
+    mResampleStep = std::max<uint64_t>(((uint64_t) streamInfo.sampleRate << 16) / mpAudioOutputDevice->getSampleRate(), 1);
+    mResamplePos = 0;
+    mSrcSamples.clear();
+    mbDecodeFinished = false;
+    mRingWritePos = 0;
+    mRingReadPos = 0;
+
+    // Decode in chunks small enough that the resampled output of one chunk fits in half of the ring buffer, so the producer
+    // can top the ring up well before the audio thread runs it dry.
+    mChunkNumSamples = MAX_CHUNK_NUM_SAMPLES;
+
+    while ((getMaxOutputSamplesPerChunk() > RING_NUM_SAMPLES / 2) && (mChunkNumSamples > 1)) {
+        mChunkNumSamples /= 2;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Gives the most output samples that decoding a single chunk of source samples could produce.
+// Allows for the one source sample that is carried over between chunks for interpolation.
+//------------------------------------------------------------------------------------------------------------------------------------------
+uint32_t AudioStream::getMaxOutputSamplesPerChunk() const noexcept {
+    ASSERT(mResampleStep > 0);
+    return (uint32_t)((((uint64_t) mChunkNumSamples + 1) << 16) / mResampleStep + 1);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Reads and decodes the next chunk of source samples and resamples them into the ring buffer.
+// Returns 'false' if there is nothing more to decode, either because the end of a non looped stream was reached or an error.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool AudioStream::decodeChunk() noexcept {
+    const AudioLoader::StreamInfo& info = mStreamInfo;
+
+    try {
+        // Loop back to the start of the sound data if we've reached the end.
+        // The resampler carries on from the last sample of the previous loop, so there is no gap or click at the loop point.
+        if (mNumSrcSamplesLeft == 0) {
+            if (!mbLooped) {
+                mbDecodeFinished.store(true, std::memory_order_release);
+                return false;
+            }
+
+            mpInput->seek(info.soundDataOffset);
+            mNumSrcSamplesLeft = info.numSamples;
+            mSdx2State = {};
+        }
+
+        // Read the raw source data
+        const uint32_t numChannels = info.numChannels;
+        const uint32_t numSrcSamples = std::min(mChunkNumSamples, mNumSrcSamplesLeft);
+        const uint32_t numChannelSamples = numSrcSamples * numChannels;
+        const uint32_t bytesPerChannelSample = (info.bSdx2Compressed || (info.bitDepth == 8)) ? 1 : 2;
+
+        mSrcBytes.resize(numChannelSamples * bytesPerChannelSample);
+        mpInput->readBytes(mSrcBytes.data(), (uint32_t) mSrcBytes.size());
+        mNumSrcSamplesLeft -= numSrcSamples;
+
+        // Decode to stereo float samples
+        appendSrcSamples(mSrcBytes.data(), numSrcSamples);
+    }
+    catch (...) {
+        // Treat a failure to read the file as the end of the stream
+        mbDecodeFinished.store(true, std::memory_order_release);
+        return false;
+    }
+
+    resampleToRing();
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Decodes the given source data in the format of the stream to stereo float samples, and adds them to the source samples waiting
+// to be resampled. Mono samples are duplicated to both channels.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void AudioStream::appendSrcSamples(const std::byte* const pSrcBytes, const uint32_t numSrcSamples) noexcept {
+    const AudioLoader::StreamInfo& info = mStreamInfo;
+    const uint32_t numChannels = info.numChannels;
+    const uint32_t numChannelSamples = numSrcSamples * numChannels;
+
+    const size_t srcSamplesStartIdx = mSrcSamples.size();
+    mSrcSamples.resize(srcSamplesStartIdx + (size_t) numSrcSamples * 2);
+    float* const pOutput = mSrcSamples.data() + srcSamplesStartIdx;
+
+    if ((info.bitDepth == 8) && (!info.bSdx2Compressed)) {
+        const int8_t* const pInput = reinterpret_cast<const int8_t*>(pSrcBytes);
+
+        for (uint32_t i = 0; i < numSrcSamples; ++i) {
+            const int8_t* const pSample = pInput + i * numChannels;
+            pOutput[i * 2 + 0] = float(pSample[0]) / float(INT8_MAX);
+            pOutput[i * 2 + 1] = float(pSample[numChannels - 1]) / float(INT8_MAX);
+        }
+    } else {
+        mSrcDecoded.resize(numChannelSamples);
+
+        if (info.bSdx2Compressed) {
+            AudioLoader::decodeSdx2Samples(pSrcBytes, mSrcDecoded.data(), numSrcSamples, info.numChannels, mSdx2State);
+        } else {
+            std::memcpy(mSrcDecoded.data(), pSrcBytes, numChannelSamples * sizeof(int16_t));
+        }
+
+        const int16_t* const pInput = mSrcDecoded.data();
+
+        for (uint32_t i = 0; i < numSrcSamples; ++i) {
+            const int16_t* const pSample = pInput + i * numChannels;
+            pOutput[i * 2 + 0] = float(pSample[0]) / float(INT16_MAX);
+            pOutput[i * 2 + 1] = float(pSample[numChannels - 1]) / float(INT16_MAX);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Resamples as many of the decoded source samples as possible into the ring buffer, using linear interpolation the same as the
+// rest of the audio code does. The last source sample is kept back for interpolating with the start of the next chunk.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void AudioStream::resampleToRing() noexcept {
+    const uint32_t numSrcSamples = (uint32_t)(mSrcSamples.size() / 2);
+
+    if (numSrcSamples == 0)
+        return;
+
+    const float* const pSrcSamples = mSrcSamples.data();
+    float* const pRingSamples = mpRingSamples.get();
+    uint32_t writePos = mRingWritePos.load(std::memory_order_relaxed);
+    uint64_t srcPos = mResamplePos;
+
+    while ((srcPos >> 16) + 1 < numSrcSamples) {
+        const uint32_t srcIdx = (uint32_t)(srcPos >> 16);
+        const float lerp = float(uint16_t(srcPos)) / 65536.0f;
+        const uint32_t ringIdx = writePos & (RING_NUM_SAMPLES - 1);
+
+        pRingSamples[ringIdx * 2 + 0] = (1.0f - lerp) * pSrcSamples[srcIdx * 2 + 0] + lerp * pSrcSamples[srcIdx * 2 + 2];
+        pRingSamples[ringIdx * 2 + 1] = (1.0f - lerp) * pSrcSamples[srcIdx * 2 + 1] + lerp * pSrcSamples[srcIdx * 2 + 3];
+
+        ++writePos;
+        srcPos += mResampleStep;
+    }
+
+    mRingWritePos.store(writePos, std::memory_order_release);
+
+    // Discard the source samples which are no longer needed
+    const uint32_t numConsumedSamples = (uint32_t)(srcPos >> 16);
+    mSrcSamples.erase(mSrcSamples.begin(), mSrcSamples.begin() + (size_t) numConsumedSamples * 2);
+    mResamplePos = srcPos - ((uint64_t) numConsumedSamples << 16);
+}
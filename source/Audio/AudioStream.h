@@ -0,0 +1,139 @@
+#pragma once
+
+#include "AudioLoader.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class AudioOutputDevice;
+
+namespace GameDataFS {
+    class InputStream;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Plays a single piece of audio which is streamed from a file rather than loaded fully into memory, used for music.
+// Alternatively the audio can be supplied incrementally by the caller, which is used for movie audio.
+// A background thread reads and decodes the file in small chunks and resamples it to the output device's rate, filling a ring
+// buffer which the audio thread then mixes from. Only the ring buffer and one chunk of source data are ever held in memory.
+//
+// Threading notes:
+//  (1) All functions except 'mixAudio' must be called from the same thread (the game thread).
+//  (2) The decode thread is the only writer of the ring buffer and the audio thread is the only reader. Neither thread blocks
+//      the other: if the decode thread falls behind then the audio thread simply outputs silence until data is available.
+//  (3) Starting and stopping playback briefly locks the audio device, since that resets the ring buffer.
+//------------------------------------------------------------------------------------------------------------------------------------------
+class AudioStream {
+public:
+    // Default volume
+    static constexpr float DEFAULT_VOLUME = 1.0f;
+
+    AudioStream() noexcept;
+    ~AudioStream() noexcept;
+
+    //------------------------------------------------------------------------------------------------------------------
+    // Note: the given device MUST remain valid for the lifetime of the stream.
+    //------------------------------------------------------------------------------------------------------------------
+    void init(AudioOutputDevice& device) noexcept;
+    void shutdown() noexcept;
+    inline bool isInitialized() const noexcept { return mbIsInitialized; }
+
+    //------------------------------------------------------------------------------------------------------------------
+    // Start playing the given file, stopping whatever was playing before.
+    // If looped then the audio restarts seamlessly from the beginning when it ends. Returns 'false' on failure.
+    //------------------------------------------------------------------------------------------------------------------
+    bool play(const char* const filePath, const bool bLooped) noexcept;
+    void stop() noexcept;
+    bool isPlaying() const noexcept;
+
+    //------------------------------------------------------------------------------------------------------------------
+    // Start playing audio which is supplied incrementally with 'queueSamples' instead of read from a file, stopping whatever
+    // was playing before. The samples are raw 8 or 16-bit integer samples, interleaved if stereo. Returns 'false' on failure.
+    //
+    // 'queueSamples' returns how many of the given samples were queued, which may be less than all of them if the ring buffer
+    // is full; the caller should try again with the rest later. Call 'endQueue' once all samples have been queued so the
+    // stream knows when playback is finished. Both of these may be called from one other thread (the producer) instead of
+    // the game thread, so long as that thread is done before the stream is stopped.
+    //------------------------------------------------------------------------------------------------------------------
+    bool playQueued(const uint32_t sampleRate, const uint16_t numChannels, const uint16_t bitDepth) noexcept;
+    uint32_t queueSamples(const std::byte* const pSamples, const uint32_t numSamples) noexcept;
+    void endQueue() noexcept;
+
+    //------------------------------------------------------------------------------------------------------------------
+    // How many seconds of audio the audio thread has output since playback started, for syncing other things to the audio
+    //------------------------------------------------------------------------------------------------------------------
+    double getPlaybackTime() const noexcept;
+
+    //------------------------------------------------------------------------------------------------------------------
+    // Get or set the volume of the stream
+    //------------------------------------------------------------------------------------------------------------------
+    inline float getVolume() const noexcept { return mVolume.load(std::memory_order_relaxed); }
+    void setVolume(const float volume) noexcept;
+
+    //------------------------------------------------------------------------------------------------------------------
+    // Pause or unpause the stream and query if paused
+    //------------------------------------------------------------------------------------------------------------------
+    inline bool isPaused() const noexcept { return mbIsPaused.load(std::memory_order_relaxed); }
+    void pause(const bool pause) noexcept;
+
+    //------------------------------------------------------------------------------------------------------------------
+    // Called by the audio output device on the audio thread.
+    // Should *NEVER* be called on any other thread as it already assumes the audio device is locked!
+    //
+    // Mixes in (adds) the requested number of interleaved stereo samples at the sample rate of the audio device.
+    //------------------------------------------------------------------------------------------------------------------
+    void mixAudio(float* const pSamples, const uint32_t numSamples) noexcept;
+
+private:
+    // Size of the ring buffer of decoded stereo samples: about 1/3 of a second at 48 KHz
+    static constexpr uint32_t RING_NUM_SAMPLES = 16384;
+    static_assert((RING_NUM_SAMPLES & (RING_NUM_SAMPLES - 1)) == 0, "Ring size must be a power of two!");
+
+    // Max number of source samples to read and decode at a time
+    static constexpr uint32_t MAX_CHUNK_NUM_SAMPLES = 2048;
+
+    void startDecodeThread() noexcept;
+    void stopDecodeThread() noexcept;
+    void decodeThreadMain() noexcept;
+    void setupDecoding(const AudioLoader::StreamInfo& streamInfo) noexcept;
+    uint32_t getMaxOutputSamplesPerChunk() const noexcept;
+    bool decodeChunk() noexcept;
+    void appendSrcSamples(const std::byte* const pSrcBytes, const uint32_t numSrcSamples) noexcept;
+    void resampleToRing() noexcept;
+
+    bool                                            mbIsInitialized;
+    AudioOutputDevice*                              mpAudioOutputDevice;
+    std::atomic<bool>                               mbIsPlaying;
+    std::atomic<bool>                               mbIsPaused;
+    std::atomic<bool>                               mbDecodeFinished;       // Set by the decode thread once the end of a non looped stream is decoded
+    std::atomic<float>                              mVolume;
+
+    // Decode thread and its stop signal
+    std::thread                                     mDecodeThread;
+    std::mutex                                      mDecodeMutex;
+    std::condition_variable                         mDecodeCondVar;
+    bool                                            mbStopDecoding;         // Protected by 'mDecodeMutex'
+
+    // Source file and decoding state: only touched by the decode thread (or queued audio producer) while it is running
+    std::unique_ptr<GameDataFS::InputStream>        mpInput;
+    AudioLoader::StreamInfo                         mStreamInfo;
+    AudioLoader::Sdx2DecoderState                   mSdx2State;
+    bool                                            mbLooped;
+    uint32_t                                        mChunkNumSamples;       // How many source samples to decode per chunk
+    uint32_t                                        mNumSrcSamplesLeft;     // Number of source samples left before the end of the sound data
+    uint64_t                                        mResampleStep;          // How much to step through the source per output sample (16.16 format)
+    uint64_t                                        mResamplePos;           // Position within the decoded source samples (16.16 format)
+    std::vector<std::byte>                          mSrcBytes;              // Raw source data for the current chunk
+    std::vector<int16_t>                            mSrcDecoded;            // SDX2 decoded source data for the current chunk
+    std::vector<float>                              mSrcSamples;            // Stereo float source samples waiting to be resampled
+
+    // The ring buffer of interleaved stereo samples at the output device rate.
+    // Note: the read and write positions are kept on separate cache lines to avoid false sharing between the two threads.
+    std::unique_ptr<float[]>                        mpRingSamples;
+    alignas(64) std::atomic<uint32_t>               mRingWritePos;          // Written only by the decode thread
+    alignas(64) std::atomic<uint32_t>               mRingReadPos;           // Written only by the audio thread
+};
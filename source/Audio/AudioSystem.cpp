@@ -2,9 +2,125 @@
 
 #include "AudioDataMgr.h"
 #include "AudioOutputDevice.h"
+#include <algorithm>
 
+// Use SSE to mix blocks of float samples where available
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+    #define AUDIO_MIX_USE_SSE 1
+    #include <xmmintrin.h>
+#else
+    #define AUDIO_MIX_USE_SSE 0
+#endif
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Mixes (adds) a block of float input samples into the interleaved stereo output, scaled by the given left/right volumes.
+// The input must be at the output sample rate and have the given number of channels (interleaved if stereo).
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Does the work of mixing an audio voice, specialized to a certain bit depth and channel count
+template <uint16_t NumChannels>
+static void mixFloatSamples(
+    const float* const pInput,
+    float* const pOutput,
+    const uint32_t numSamples,
+    const float lVolume,
+    const float rVolume
+) noexcept {
+    static_assert(NumChannels == 1 || NumChannels == 2);
+    uint32_t sampleIdx = 0;
+
+    #if AUDIO_MIX_USE_SSE
+        if constexpr (NumChannels == 1) {
+            // Mono: 4 input samples at a time, which become 8 output values when split into left and right
+            const __m128 lVolumeVec = _mm_set1_ps(lVolume);
+            const __m128 rVolumeVec = _mm_set1_ps(rVolume);
+
+            for (; sampleIdx + 4 <= numSamples; sampleIdx += 4) {
+                const __m128 input = _mm_loadu_ps(pInput + sampleIdx);
+                const __m128 left = _mm_mul_ps(input, lVolumeVec);
+                const __m128 right = _mm_mul_ps(input, rVolumeVec);
+
+                float* const pOut = pOutput + sampleIdx * 2;
+                _mm_storeu_ps(pOut + 0, _mm_add_ps(_mm_loadu_ps(pOut + 0), _mm_unpacklo_ps(left, right)));
+                _mm_storeu_ps(pOut + 4, _mm_add_ps(_mm_loadu_ps(pOut + 4), _mm_unpackhi_ps(left, right)));
+            }
+        } else {
+            // Stereo: input is already interleaved the same as the output, do 2 samples (4 values) at a time
+            const __m128 volumeVec = _mm_setr_ps(lVolume, rVolume, lVolume, rVolume);
+
+            for (; sampleIdx + 2 <= numSamples; sampleIdx += 2) {
+                const __m128 input = _mm_loadu_ps(pInput + sampleIdx * 2);
+                float* const pOut = pOutput + sampleIdx * 2;
+                _mm_storeu_ps(pOut, _mm_add_ps(_mm_loadu_ps(pOut), _mm_mul_ps(input, volumeVec)));
+            }
+        }
+    #endif
+
+    // Do any remaining samples one at a time
+    for (; sampleIdx < numSamples; ++sampleIdx) {
+        if constexpr (NumChannels == 1) {
+            const float sample = pInput[sampleIdx];
+            pOutput[sampleIdx * 2 + 0] += sample * lVolume;
+            pOutput[sampleIdx * 2 + 1] += sample * rVolume;
+        } else {
+            pOutput[sampleIdx * 2 + 0] += pInput[sampleIdx * 2 + 0] * lVolume;
+            pOutput[sampleIdx * 2 + 1] += pInput[sampleIdx * 2 + 1] * rVolume;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Mixes an audio voice whose data is float samples already at the output sample rate.
+// This is the normal case since the audio data manager converts audio to this format on load. Handling of the end of the sound
+// and looping is done per block of samples rather than per sample.
+//------------------------------------------------------------------------------------------------------------------------------------------
+template <uint16_t NumChannels>
+static void mixFloatVoiceAudioImpl(
+    const float masterVolume,
+    AudioVoice& voice,
+    const AudioData& audioData,
+    float* const pSamples,
+    const uint32_t numSamples
+) noexcept {
+    const float* const pInput = (const float*) audioData.pBuffer;
+    const uint32_t totalInSamples = audioData.numSamples;
+    const float lVolume = voice.lVolume * masterVolume;
+    const float rVolume = voice.rVolume * masterVolume;
+
+    uint32_t curSample = voice.curSample;
+    uint32_t numOutSamplesLeft = numSamples;
+    float* pCurOutSample = pSamples;
+
+    while (numOutSamplesLeft > 0) {
+        // If we are at the end of the input then playback is done unless looped, in which case wraparound
+        if (curSample >= totalInSamples) {
+            if (!voice.bIsLooped)
+                break;
+
+            curSample = 0;
+        }
+
+        // Mix in as much as we can before the end of the input
+        const uint32_t numToMix = std::min(numOutSamplesLeft, totalInSamples - curSample);
+        mixFloatSamples<NumChannels>(pInput + (uintptr_t) curSample * NumChannels, pCurOutSample, numToMix, lVolume, rVolume);
+
+        curSample += numToMix;
+        numOutSamplesLeft -= numToMix;
+        pCurOutSample += (uintptr_t) numToMix * 2;
+    }
+
+    // Save the current position and check if playback is done
+    if ((curSample >= totalInSamples) && (!voice.bIsLooped)) {
+        voice.state = AudioVoice::State::STOPPED;
+        voice.curSample = totalInSamples;
+    } else {
+        voice.curSample = curSample;
+    }
+
+    voice.curSampleFrac = 0;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Does the work of mixing an audio voice, specialized to a certain bit depth and channel count.
+// This is the slow path for audio which has not been converted to float samples at the output sample rate.
 //------------------------------------------------------------------------------------------------------------------------------------------
 template <uint16_t NumChannels, uint16_t BitDepth>
 static void mixVoiceAudioImpl(
@@ -164,8 +280,13 @@ AudioSystem::AudioSystem() noexcept
     , mpAudioOutputDevice(nullptr)
     , mpAudioDataMgr(nullptr)
     , mMasterVolume(DEFAULT_MASTER_VOLUME)
+    , mNextPlayId(1)
+    , mGameVoices()
+    , mMixMasterVolume(DEFAULT_MASTER_VOLUME)
     , mVoices()
-    , mFreeVoices()
+    , mVoicePlayIds()
+    , mpVoiceStatus()
+    , mCommands()
 {
 }
 
@@ -178,8 +299,8 @@ void AudioSystem::init(AudioOutputDevice& device, AudioDataMgr& dataMgr, const u
     ASSERT(!mbIsInitialized);
     ASSERT(!mbIsPaused);
     ASSERT(mMasterVolume == DEFAULT_MASTER_VOLUME);
+    ASSERT(mGameVoices.empty());
     ASSERT(mVoices.empty());
-    ASSERT(mFreeVoices.empty());
 
     // Sanity check input
     ASSERT(device.isInitialized());
@@ -188,16 +309,21 @@ void AudioSystem::init(AudioOutputDevice& device, AudioDataMgr& dataMgr, const u
     // Lock the device
     AudioDeviceLock lockAudioDevice(device);
 
-    // Initialize: note that we add the first voice indexes to the free list LAST so they are used FIRST
+    // Initialize: all voices start out stopped
     mbIsInitialized = true;
     mpAudioOutputDevice = &device;
     mpAudioDataMgr = &dataMgr;
+    mNextPlayId = 1;
+    mGameVoices.resize(maxVoices);
+    mMixMasterVolume = mMasterVolume;
     mVoices.resize(maxVoices);
-    mFreeVoices.reserve(maxVoices);
+    mVoicePlayIds.resize(maxVoices);
+    mpVoiceStatus.reset(new PublishedVoiceStatus[maxVoices]);
+    mCommands.clear();
 
-    for (uint32_t voiceIdx = maxVoices; voiceIdx > 0;) {
-        --voiceIdx;
-        mFreeVoices.push_back(voiceIdx);
+    for (uint32_t voiceIdx = 0; voiceIdx < maxVoices; ++voiceIdx) {
+        mpVoiceStatus[voiceIdx].stoppedPlayId.store(0, std::memory_order_relaxed);
+        mpVoiceStatus[voiceIdx].playIdAndPos.store(0, std::memory_order_relaxed);
     }
 
     // Register with the output device as an audio system
@@ -210,9 +336,14 @@ void AudioSystem::shutdown() noexcept {
         mpAudioOutputDevice->lockAudioDevice();
     }
 
-    mFreeVoices.clear();
+    mCommands.clear();
+    mpVoiceStatus.reset();
+    mVoicePlayIds.clear();
     mVoices.clear();
-    mMasterVolume = 1.0f;
+    mMixMasterVolume = DEFAULT_MASTER_VOLUME;
+    mGameVoices.clear();
+    mNextPlayId = 1;
+    mMasterVolume = DEFAULT_MASTER_VOLUME;
     mpAudioDataMgr = nullptr;
     mbIsPaused = false;
     mbIsInitialized = false;
@@ -227,47 +358,63 @@ void AudioSystem::shutdown() noexcept {
 AudioVoice AudioSystem::getVoiceState(const VoiceIdx voiceIdx) const noexcept {
     ASSERT(mbIsInitialized);
     ASSERT(voiceIdx < getNumVoices());
-    return mVoices[voiceIdx];
+
+    // Start with the state last set by the game thread and update with what the audio thread has published.
+    // If the audio thread has not started on the current playback yet then it is still at the start.
+    const GameVoice& gameVoice = mGameVoices[voiceIdx];
+    AudioVoice voice = gameVoice.voice;
+
+    if (!isGameVoiceActive(voiceIdx)) {
+        voice.state = AudioVoice::State::STOPPED;
+    }
+
+    const uint64_t playIdAndPos = mpVoiceStatus[voiceIdx].playIdAndPos.load(std::memory_order_acquire);
+    const bool bIsPosForCurrentPlay = ((uint32_t)(playIdAndPos >> 32) == gameVoice.playId);
+    voice.curSample = (bIsPosForCurrentPlay) ? (uint32_t) playIdAndPos : 0;
+    voice.curSampleFrac = 0;
+    return voice;
 }
 
 void AudioSystem::setVoiceState(const VoiceIdx voiceIdx, const AudioVoice& state) noexcept {
     ASSERT(mbIsInitialized);
     ASSERT(voiceIdx < getNumVoices());
 
-    AudioVoice& curState = mVoices[voiceIdx];
-    AudioDeviceLock lockAudioDevice(*mpAudioOutputDevice);
+    // If the voice is being started then it is a new playback
+    GameVoice& gameVoice = mGameVoices[voiceIdx];
 
-    // See if there is a change in the active state for the voice
-    const bool bActive = (curState.state != AudioVoice::State::STOPPED);
+    const bool bActive = isGameVoiceActive(voiceIdx);
     const bool bWillBeActive = (state.state != AudioVoice::State::STOPPED);
 
-    if (bActive != bWillBeActive) {
-        if (!bWillBeActive) {
-            mFreeVoices.push_back(voiceIdx);
-        }
-        else {
-            removeFromFreeVoiceList(voiceIdx);
-        }
+    if ((!bActive) && bWillBeActive) {
+        gameVoice.playId = mNextPlayId++;
     }
 
-    // Update the state of the sound
-    curState = state;
+    gameVoice.voice = state;
+
+    // Send the new state to the audio thread
+    Command command = {};
+    command.type = Command::Type::SET_VOICE;
+    command.voiceIdx = voiceIdx;
+    command.playId = gameVoice.playId;
+    command.voice = state;
+    sendCommand(command);
 }
 
 void AudioSystem::setMasterVolume(const float volume) noexcept {
     ASSERT(mbIsInitialized);
-    AudioDeviceLock lockAudioDevice(*mpAudioOutputDevice);
     mMasterVolume = volume;
+
+    Command command = {};
+    command.type = Command::Type::SET_MASTER_VOLUME;
+    command.masterVolume = volume;
+    sendCommand(command);
 }
 
 void AudioSystem::pause(const bool pause) noexcept {
     ASSERT(mbIsInitialized);
 
-    // N.B: safe to check paused state outside of lock since we will never modify this from the audio thread
-    if (mbIsPaused != pause) {
-        AudioDeviceLock lockAudioDevice(*mpAudioOutputDevice);
-        mbIsPaused = pause;
-    }
+    // N.B: the audio thread only ever reads the paused state, and the value is checked at the start of each mix
+    mbIsPaused.store(pause, std::memory_order_relaxed);
 }
 
 AudioSystem::VoiceIdx AudioSystem::play(
@@ -275,7 +422,9 @@ AudioSystem::VoiceIdx AudioSystem::play(
     const bool bLooped,
     const float lVolume,
     const float rVolume,
-    const bool bStopOtherInstances
+    const bool bStopOtherInstances,
+    const Priority priority,
+    const uint32_t maxInstances
 ) noexcept {
     ASSERT(mbIsInitialized);
 
@@ -287,34 +436,38 @@ AudioSystem::VoiceIdx AudioSystem::play(
         return INVALID_VOICE_IDX;
     }
 
-    AudioDeviceLock lockAudioDevice(*mpAudioOutputDevice);
-
     // If specified, stop other instances of this sound
     if (bStopOtherInstances) {
-        const uint32_t numVoices = (uint32_t) mVoices.size();
+        stopVoicesWithAudioData(audioDataHandle);
+    }
 
-        for (uint32_t voiceIdx = 0; voiceIdx < numVoices; ++voiceIdx) {
-            AudioVoice& voice = mVoices[voiceIdx];
+    // If there are already too many instances of this sound playing then try to replace one of them, otherwise find a free voice.
+    // If there are no free voices then try to steal one from a less important sound, and abort if that is not possible.
+    const float effectiveVolume = lVolume + rVolume;
+    VoiceIdx voiceIdx = INVALID_VOICE_IDX;
 
-            if (voice.state != AudioVoice::State::STOPPED) {
-                if (voice.audioDataHandle == audioDataHandle) {
-                    voice.state = AudioVoice::State::STOPPED;
-                    mFreeVoices.push_back(voiceIdx);
-                }
-            }
+    if ((maxInstances > 0) && (getNumVoicesWithAudioData(audioDataHandle) >= maxInstances)) {
+        voiceIdx = findVoiceToSteal(true, audioDataHandle, priority, effectiveVolume);
+    } else {
+        const uint32_t numVoices = getNumVoices();
+        voiceIdx = 0;
+
+        while ((voiceIdx < numVoices) && isGameVoiceActive(voiceIdx)) {
+            ++voiceIdx;
+        }
+
+        if (voiceIdx >= numVoices) {
+            voiceIdx = findVoiceToSteal(false, audioDataHandle, priority, effectiveVolume);
         }
     }
 
-    // Abort if there are no more free voices
-    if (mFreeVoices.empty()) {
+    if (voiceIdx == INVALID_VOICE_IDX)
         return INVALID_VOICE_IDX;
-    }
 
-    // Consume a voice and play
-    const VoiceIdx voiceIdx = mFreeVoices.back();
-    mFreeVoices.pop_back();
+    stopVoice(voiceIdx);
 
-    AudioVoice& voice = mVoices[voiceIdx];
+    // Play the sound on the voice
+    AudioVoice voice = {};
     voice.state = AudioVoice::State::PLAYING;
     voice.bIsLooped = bLooped;
     voice.curSampleFrac = 0;
@@ -322,6 +475,8 @@ AudioSystem::VoiceIdx AudioSystem::play(
     voice.audioDataHandle = audioDataHandle;
     voice.lVolume = lVolume;
     voice.rVolume = rVolume;
+    setVoiceState(voiceIdx, voice);
+    mGameVoices[voiceIdx].priority = priority;
 
     // Return the voice playing
     return voiceIdx;
@@ -329,11 +484,11 @@ AudioSystem::VoiceIdx AudioSystem::play(
 
 uint32_t AudioSystem::getNumVoicesWithAudioData(const uint32_t audioDataHandle) noexcept {
     uint32_t numVoicesMatching = 0;
-    AudioDeviceLock lockAudioDevice(*mpAudioOutputDevice);
-    
-    for (const AudioVoice& voice : mVoices) {
-        if (voice.audioDataHandle == audioDataHandle) {
-            if (voice.state != AudioVoice::State::STOPPED) {
+    const uint32_t numVoices = getNumVoices();
+
+    for (uint32_t voiceIdx = 0; voiceIdx < numVoices; ++voiceIdx) {
+        if (mGameVoices[voiceIdx].voice.audioDataHandle == audioDataHandle) {
+            if (isGameVoiceActive(voiceIdx)) {
                 ++numVoicesMatching;
             }
         }
@@ -344,17 +499,10 @@ uint32_t AudioSystem::getNumVoicesWithAudioData(const uint32_t audioDataHandle)
 
 void AudioSystem::stopAllVoices() noexcept {
     ASSERT(mbIsInitialized);
-
-    const uint32_t numVoices = (uint32_t) mVoices.size();
-    AudioDeviceLock lockAudioDevice(*mpAudioOutputDevice);
+    const uint32_t numVoices = getNumVoices();
 
     for (uint32_t voiceIdx = 0; voiceIdx < numVoices; ++voiceIdx) {
-        AudioVoice& voice = mVoices[voiceIdx];
-
-        if (voice.state != AudioVoice::State::STOPPED) {
-            voice.state = AudioVoice::State::STOPPED;
-            mFreeVoices.push_back(voiceIdx);
-        }
+        stopVoice(voiceIdx);
     }
 }
 
@@ -362,29 +510,23 @@ void AudioSystem::stopVoice(const VoiceIdx voiceIdx) noexcept {
     ASSERT(mbIsInitialized);
     ASSERT(voiceIdx < getNumVoices());
 
-    AudioVoice& voice = mVoices[voiceIdx];
-    AudioDeviceLock lockAudioDevice(*mpAudioOutputDevice);
+    if (isGameVoiceActive(voiceIdx)) {
+        mGameVoices[voiceIdx].voice.state = AudioVoice::State::STOPPED;
 
-    if (voice.state != AudioVoice::State::STOPPED) {
-        voice.state = AudioVoice::State::STOPPED;
-        mFreeVoices.push_back(voiceIdx);
+        Command command = {};
+        command.type = Command::Type::STOP_VOICE;
+        command.voiceIdx = voiceIdx;
+        sendCommand(command);
     }
 }
 
 void AudioSystem::stopVoicesWithAudioData(const uint32_t audioDataHandle) noexcept {
     ASSERT(mbIsInitialized);
-
-    const uint32_t numVoices = (uint32_t) mVoices.size();
-    AudioDeviceLock lockAudioDevice(*mpAudioOutputDevice);
+    const uint32_t numVoices = getNumVoices();
 
     for (uint32_t voiceIdx = 0; voiceIdx < numVoices; ++voiceIdx) {
-        AudioVoice& voice = mVoices[voiceIdx];
-
-        if (voice.audioDataHandle == audioDataHandle) {
-            if (voice.state != AudioVoice::State::STOPPED) {
-                voice.state = AudioVoice::State::STOPPED;
-                mFreeVoices.push_back(voiceIdx);
-            }
+        if (mGameVoices[voiceIdx].voice.audioDataHandle == audioDataHandle) {
+            stopVoice(voiceIdx);
         }
     }
 }
@@ -394,7 +536,13 @@ void AudioSystem::mixAudio(float* const pSamples, const uint32_t numSamples) noe
     ASSERT(pSamples);
     ASSERT(numSamples > 0);
 
-    const uint32_t numVoices = getNumVoices();
+    // Apply all changes requested by the game thread before mixing
+    processCommands();
+
+    if (isPaused())
+        return;
+
+    const uint32_t numVoices = (uint32_t) mVoices.size();
 
     for (uint32_t voiceIdx = 0; voiceIdx < numVoices; ++voiceIdx) {
         // Skip the voice if it is not active
@@ -408,39 +556,160 @@ void AudioSystem::mixAudio(float* const pSamples, const uint32_t numSamples) noe
 
         if (!pAudioData) {
             voice.state = AudioVoice::State::STOPPED;
-            mFreeVoices.push_back(voiceIdx);
+            publishVoiceStopped(voiceIdx);
             continue;
         }
 
-        // Mix in the voice audio
+        // Mix in the voice audio and let the game thread know where it is at
         mixVoiceAudio(voice, *pAudioData, pSamples, numSamples);
 
-        // If the voice is done playing now then add it to the free list
+        const uint32_t playId = mVoicePlayIds[voiceIdx];
+        mpVoiceStatus[voiceIdx].playIdAndPos.store(((uint64_t) playId << 32) | voice.curSample, std::memory_order_release);
+
+        // If the voice is done playing now then let the game thread know
         if (voice.state == AudioVoice::State::STOPPED) {
-            mFreeVoices.push_back(voiceIdx);
+            publishVoiceStopped(voiceIdx);
         }
     }
 }
 
-void AudioSystem::removeFromFreeVoiceList(const VoiceIdx voiceIdx) noexcept {
-    // N.B: This call assumes all locking of the audio device has already been done externally
-    const uint32_t numFreeVoices = (uint32_t) mFreeVoices.size();
-    uint32_t freeListIdx = UINT32_MAX;
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Game thread: tells if a voice is active. A voice becomes inactive when it is stopped by the game thread, or when the audio thread
+// publishes that the current playback of the voice has finished.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool AudioSystem::isGameVoiceActive(const VoiceIdx voiceIdx) const noexcept {
+    const GameVoice& gameVoice = mGameVoices[voiceIdx];
+
+    if (gameVoice.voice.state == AudioVoice::State::STOPPED)
+        return false;
+
+    const uint32_t stoppedPlayId = mpVoiceStatus[voiceIdx].stoppedPlayId.load(std::memory_order_acquire);
+    return (stoppedPlayId != gameVoice.playId);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Game thread: finds the least important active voice that a new sound with the given priority and effective volume may replace.
+// Optionally only voices playing the given audio are considered. Returns 'INVALID_VOICE_IDX' if no voice can be stolen.
+//------------------------------------------------------------------------------------------------------------------------------------------
+AudioSystem::VoiceIdx AudioSystem::findVoiceToSteal(
+    const bool bSameAudioDataOnly,
+    const uint32_t audioDataHandle,
+    const Priority priority,
+    const float effectiveVolume
+) const noexcept {
+    VoiceIdx bestVoiceIdx = INVALID_VOICE_IDX;
+    Priority bestPriority = DEFAULT_PRIORITY;
+    float bestVolume = 0.0f;
 
-    for (uint32_t i = 0; i < numFreeVoices; ++i) {
-        if (mFreeVoices[i] == voiceIdx) {
-            freeListIdx = i;
-            break;
+    const uint32_t numVoices = getNumVoices();
+
+    for (VoiceIdx voiceIdx = 0; voiceIdx < numVoices; ++voiceIdx) {
+        const GameVoice& gameVoice = mGameVoices[voiceIdx];
+
+        if (!isGameVoiceActive(voiceIdx))
+            continue;
+
+        if (bSameAudioDataOnly && (gameVoice.voice.audioDataHandle != audioDataHandle))
+            continue;
+
+        const float volume = gameVoice.voice.lVolume + gameVoice.voice.rVolume;
+        const bool bIsBetter = (
+            (bestVoiceIdx == INVALID_VOICE_IDX) ||
+            (gameVoice.priority < bestPriority) ||
+            ((gameVoice.priority == bestPriority) && (volume < bestVolume))
+        );
+
+        if (bIsBetter) {
+            bestVoiceIdx = voiceIdx;
+            bestPriority = gameVoice.priority;
+            bestVolume = volume;
         }
     }
 
-    if (freeListIdx < numFreeVoices) {
-        // Remove by swapping the back voice into place and popping
-        mFreeVoices[freeListIdx] = mFreeVoices.back();
-        mFreeVoices.pop_back();
+    // Only steal the voice if the new sound is at least as important
+    if (bestVoiceIdx != INVALID_VOICE_IDX) {
+        const bool bCanSteal = (
+            (bestPriority < priority) ||
+            ((bestPriority == priority) && (bestVolume <= effectiveVolume))
+        );
+
+        if (!bCanSteal)
+            return INVALID_VOICE_IDX;
+    }
+
+    return bestVoiceIdx;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Game thread: sends a command to the audio thread.
+// If the queue is full (the audio thread has stalled) then lock the device and process the queued commands here instead.
+// This is safe to do since the audio thread cannot be mixing while the lock is held.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void AudioSystem::sendCommand(const Command& command) noexcept {
+    if (mCommands.tryPush(command))
+        return;
+
+    AudioDeviceLock lockAudioDevice(*mpAudioOutputDevice);
+    processCommands();
+
+    [[maybe_unused]] const bool bPushed = mCommands.tryPush(command);
+    ASSERT(bPushed);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Audio thread: applies all commands sent by the game thread
+//------------------------------------------------------------------------------------------------------------------------------------------
+void AudioSystem::processCommands() noexcept {
+    Command command;
+
+    while (mCommands.tryPop(command)) {
+        switch (command.type) {
+            case Command::Type::SET_VOICE: {
+                ASSERT(command.voiceIdx < mVoices.size());
+                AudioVoice& voice = mVoices[command.voiceIdx];
+                uint32_t& playId = mVoicePlayIds[command.voiceIdx];
+
+                // A new playback of the voice starts from the beginning, otherwise preserve the current position
+                if (playId != command.playId) {
+                    playId = command.playId;
+                    voice = command.voice;
+                } else {
+                    const uint32_t curSample = voice.curSample;
+                    const uint16_t curSampleFrac = voice.curSampleFrac;
+                    voice = command.voice;
+                    voice.curSample = curSample;
+                    voice.curSampleFrac = curSampleFrac;
+                }
+
+                if (voice.state == AudioVoice::State::STOPPED) {
+                    publishVoiceStopped(command.voiceIdx);
+                }
+            }   break;
+
+            case Command::Type::STOP_VOICE: {
+                ASSERT(command.voiceIdx < mVoices.size());
+                AudioVoice& voice = mVoices[command.voiceIdx];
+
+                if (voice.state != AudioVoice::State::STOPPED) {
+                    voice.state = AudioVoice::State::STOPPED;
+                    publishVoiceStopped(command.voiceIdx);
+                }
+            }   break;
+
+            case Command::Type::SET_MASTER_VOLUME:
+                mMixMasterVolume = command.masterVolume;
+                break;
+        }
     }
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Audio thread: lets the game thread know the current playback of a voice has finished
+//------------------------------------------------------------------------------------------------------------------------------------------
+void AudioSystem::publishVoiceStopped(const VoiceIdx voiceIdx) noexcept {
+    mpVoiceStatus[voiceIdx].stoppedPlayId.store(mVoicePlayIds[voiceIdx], std::memory_order_release);
+}
+
 void AudioSystem::mixVoiceAudio(
     AudioVoice& voice,
     const AudioData& audioData,
@@ -449,23 +718,35 @@ void AudioSystem::mixVoiceAudio(
 ) noexcept {
     AudioOutputDevice& audioOutputDevice = *mpAudioOutputDevice;
 
+    // Fast path: the data is float samples at the output sample rate
+    if ((audioData.bitDepth == 32) && (audioData.sampleRate == audioOutputDevice.getSampleRate())) {
+        if (audioData.numChannels == 1) {
+            mixFloatVoiceAudioImpl<1>(mMixMasterVolume, voice, audioData, pSamples, numSamples);
+        } else {
+            ASSERT(audioData.numChannels == 2);
+            mixFloatVoiceAudioImpl<2>(mMixMasterVolume, voice, audioData, pSamples, numSamples);
+        }
+
+        return;
+    }
+
     if (audioData.numChannels == 1) {
         if (audioData.bitDepth == 8) {
-            mixVoiceAudioImpl<1, 8>(audioOutputDevice, mMasterVolume, voice, audioData, pSamples, numSamples);
+            mixVoiceAudioImpl<1, 8>(audioOutputDevice, mMixMasterVolume, voice, audioData, pSamples, numSamples);
         }
         else {
             ASSERT(audioData.bitDepth == 16);
-            mixVoiceAudioImpl<1, 16>(audioOutputDevice, mMasterVolume, voice, audioData, pSamples, numSamples);
+            mixVoiceAudioImpl<1, 16>(audioOutputDevice, mMixMasterVolume, voice, audioData, pSamples, numSamples);
         }
     }
     else {
         ASSERT(audioData.numChannels == 2);
 
         if (audioData.bitDepth == 8) {
-            mixVoiceAudioImpl<2, 8>(audioOutputDevice, mMasterVolume, voice, audioData, pSamples, numSamples);
+            mixVoiceAudioImpl<2, 8>(audioOutputDevice, mMixMasterVolume, voice, audioData, pSamples, numSamples);
         } else {
             ASSERT(audioData.bitDepth == 16);
-            mixVoiceAudioImpl<2, 16>(audioOutputDevice, mMasterVolume, voice, audioData, pSamples, numSamples);
+            mixVoiceAudioImpl<2, 16>(audioOutputDevice, mMixMasterVolume, voice, audioData, pSamples, numSamples);
         }
     }
 }
@@ -1,7 +1,10 @@
 #pragma once
 
 #include "AudioVoice.h"
+#include "Base/SpscQueue.h"
+#include <atomic>
 #include <cstdint>
+#include <memory>
 #include <vector>
 
 class AudioDataMgr;
@@ -11,6 +14,13 @@ struct AudioData;
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Manages a collection of playing audio voices.
 // Also has a master volume and pause setting for the system.
+//
+// Threading notes:
+//  (1) All functions except 'mixAudio' must be called from the same thread (the game thread).
+//  (2) The game thread does not lock the audio device to change voices or the volume. Instead it sends commands to the audio
+//      thread through a lock-free queue, which the audio thread drains at the start of each mix. The game thread keeps its own
+//      view of each voice so that it can allocate voices and answer queries immediately.
+//  (3) The audio thread publishes back when voices finish playing and their current position through atomics.
 //------------------------------------------------------------------------------------------------------------------------------------------
 class AudioSystem {
 public:
@@ -21,6 +31,10 @@ public:
     typedef uint32_t VoiceIdx;
     static constexpr VoiceIdx INVALID_VOICE_IDX = UINT32_MAX;
 
+    // Voice priorities: higher priority voices can steal the voices of lower priority ones when all voices are in use
+    typedef uint8_t Priority;
+    static constexpr Priority DEFAULT_PRIORITY = 0;
+
     AudioSystem() noexcept;
     ~AudioSystem() noexcept;
 
@@ -39,7 +53,7 @@ public:
     //------------------------------------------------------------------------------------------------------------------
     // Get or set the state of a particular voice and query the number of voices
     //------------------------------------------------------------------------------------------------------------------
-    inline uint32_t getNumVoices() const { return (uint32_t) mVoices.size(); }
+    inline uint32_t getNumVoices() const { return (uint32_t) mGameVoices.size(); }
     AudioVoice getVoiceState(const VoiceIdx voiceIdx) const noexcept;
     void setVoiceState(const VoiceIdx voiceIdx, const AudioVoice& state) noexcept;
 
@@ -52,20 +66,29 @@ public:
     //------------------------------------------------------------------------------------------------------------------
     // Pause or unpause the entire system and query if paused
     //------------------------------------------------------------------------------------------------------------------
-    inline bool isPaused() const noexcept { return mbIsPaused; }
+    inline bool isPaused() const noexcept { return mbIsPaused.load(std::memory_order_relaxed); }
     void pause(const bool pause) noexcept;
 
     //------------------------------------------------------------------------------------------------------------------
     // Try to play a particular audio piece with the given handle.
     // Returns the index of the voice allocated to the audio, or 'INVALID_VOICE_IDX' on failure.
     // Optionally, you can specify to stop other instances of the same sound.
+    //
+    // Voice allocation:
+    //  (1) If 'maxInstances' is non zero and that many voices are already playing the same audio, then the quietest of
+    //      those is replaced if it is no louder than the new sound. Otherwise the new sound is not played.
+    //  (2) If all voices are in use then the voice with the lowest priority, and the quietest of those, is stolen if it
+    //      has a lower priority than the new sound or the same priority and is no louder. Otherwise the new sound is not played.
+    // Loudness is judged by the effective volume of a voice: the sum of its left and right volumes.
     //------------------------------------------------------------------------------------------------------------------
     VoiceIdx play(
         const uint32_t audioDataHandle,
         const bool bLooped = false,
         const float lVolume = 1.0f,
         const float rVolume = 1.0f,
-        const bool bStopOtherInstances = false
+        const bool bStopOtherInstances = false,
+        const Priority priority = DEFAULT_PRIORITY,
+        const uint32_t maxInstances = 0
     ) noexcept;
 
     //------------------------------------------------------------------------------------------------------------------
@@ -86,12 +109,54 @@ public:
     //
     // This function should mix in (add) the requested number of audio samples in 2 channel stero
     // at the sample rate that the current audio device uses. The left/right stereo data should also
-    // be interleaved for each sample point.
+    // be interleaved for each sample point. Nothing is mixed if the system is paused, but pending
+    // commands are still processed.
     //------------------------------------------------------------------------------------------------------------------
     void mixAudio(float* const pSamples, const uint32_t numSamples) noexcept;
 
 private:
-    void removeFromFreeVoiceList(const VoiceIdx voiceIdx) noexcept;
+    // Max number of commands that can be waiting for the audio thread before the game thread has to lock the device
+    static constexpr uint32_t COMMAND_QUEUE_SIZE = 256;
+
+    // A command sent from the game thread to the audio thread
+    struct Command {
+        enum class Type : uint8_t {
+            SET_VOICE,              // Set the state of voice 'voiceIdx' to 'voice', a new playback if 'playId' changes
+            STOP_VOICE,             // Stop voice 'voiceIdx'
+            SET_MASTER_VOLUME       // Set the master volume to 'masterVolume'
+        };
+
+        Type        type;
+        VoiceIdx    voiceIdx;
+        uint32_t    playId;
+        float       masterVolume;
+        AudioVoice  voice;
+    };
+
+    // The game thread's view of a voice
+    struct GameVoice {
+        AudioVoice  voice;          // The state last set for the voice by the game thread
+        uint32_t    playId;         // Identifies the current playback of the voice
+        Priority    priority;       // Priority of the current playback, for deciding which voices to steal
+    };
+
+    // Voice status published by the audio thread for the game thread
+    struct PublishedVoiceStatus {
+        std::atomic<uint32_t>   stoppedPlayId;      // Id of the last playback that finished on the audio thread
+        std::atomic<uint64_t>   playIdAndPos;       // Id of the current playback (high 32-bits) and the current sample position
+    };
+
+    bool isGameVoiceActive(const VoiceIdx voiceIdx) const noexcept;
+    VoiceIdx findVoiceToSteal(
+        const bool bSameAudioDataOnly,
+        const uint32_t audioDataHandle,
+        const Priority priority,
+        const float effectiveVolume
+    ) const noexcept;
+
+    void sendCommand(const Command& command) noexcept;
+    void processCommands() noexcept;
+    void publishVoiceStopped(const VoiceIdx voiceIdx) noexcept;
 
     void mixVoiceAudio(
         AudioVoice& voice,
@@ -100,11 +165,16 @@ private:
         const uint32_t numSamples
     ) noexcept;
 
-    bool                        mbIsInitialized;
-    bool                        mbIsPaused;
-    AudioOutputDevice*          mpAudioOutputDevice;
-    AudioDataMgr*               mpAudioDataMgr;
-    float                       mMasterVolume;
-    std::vector<AudioVoice>     mVoices;
-    std::vector<uint32_t>       mFreeVoices;
+    bool                                        mbIsInitialized;
+    std::atomic<bool>                           mbIsPaused;
+    AudioOutputDevice*                          mpAudioOutputDevice;
+    AudioDataMgr*                               mpAudioDataMgr;
+    float                                       mMasterVolume;          // Game thread copy of the master volume
+    uint32_t                                    mNextPlayId;
+    std::vector<GameVoice>                      mGameVoices;            // Owned by the game thread
+    float                                       mMixMasterVolume;       // Audio thread copy of the master volume
+    std::vector<AudioVoice>                     mVoices;                // Owned by the audio thread
+    std::vector<uint32_t>                       mVoicePlayIds;          // Owned by the audio thread: current playback id for each voice
+    std::unique_ptr<PublishedVoiceStatus[]>     mpVoiceStatus;
+    SpscQueue<Command, COMMAND_QUEUE_SIZE>      mCommands;
 };
@@ -6,11 +6,97 @@
 #include "Map/MapUtil.h"
 #include "Sounds.h"
 #include "Things/MapObj.h"
+#include <algorithm>
 
 constexpr Fixed     S_CLIPPING_DIST = 3600 * 0x10000;       // Clip sounds beyond this distance
 constexpr Fixed     S_CLOSE_DIST    = 200 * 0x10000;        // Sounds at this distance or closer are full volume sounds
 constexpr int32_t   S_ATTENUATOR    = (S_CLIPPING_DIST - S_CLOSE_DIST) >> FRACBITS;
 constexpr Fixed     S_STEREO_SWING  = 96 * 0x10000;
+constexpr uint32_t  S_MIN_VOLUME    = 8;                    // Sounds quieter than this (out of 255, in the loudest channel) are not worth a voice
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// How important each sound is and how many instances of it may play at once (0 = no limit).
+// When all voices are busy, more important sounds steal voices from less important or quieter ones. Capping the instances
+// stops big fights from filling every voice with overlapping copies of the same sound.
+//------------------------------------------------------------------------------------------------------------------------------------------
+enum : uint8_t {
+    PRI_AMBIENT = 0,    // Idle monster noises, moving floors etc.
+    PRI_NORMAL  = 1,    // Monster sounds, projectiles, doors etc.
+    PRI_HIGH    = 2     // Player sounds, weapons, pickups and boss sounds
+};
+
+struct SoundInfo {
+    uint8_t     priority;
+    uint8_t     maxInstances;
+};
+
+static constexpr SoundInfo SOUND_INFO[NUMSFX] = {
+    { PRI_AMBIENT,  0 },    // sfx_None
+    { PRI_HIGH,     4 },    // sfx_pistol
+    { PRI_HIGH,     4 },    // sfx_shotgn
+    { PRI_HIGH,     2 },    // sfx_sgcock
+    { PRI_HIGH,     4 },    // sfx_plasma
+    { PRI_HIGH,     2 },    // sfx_bfg
+    { PRI_HIGH,     1 },    // sfx_sawup
+    { PRI_HIGH,     1 },    // sfx_sawidl
+    { PRI_HIGH,     1 },    // sfx_sawful
+    { PRI_HIGH,     1 },    // sfx_sawhit
+    { PRI_HIGH,     3 },    // sfx_rlaunc
+    { PRI_NORMAL,   3 },    // sfx_rfly
+    { PRI_NORMAL,   4 },    // sfx_rxplod
+    { PRI_NORMAL,   3 },    // sfx_firsht
+    { PRI_NORMAL,   3 },    // sfx_firbal
+    { PRI_NORMAL,   4 },    // sfx_firxpl
+    { PRI_AMBIENT,  2 },    // sfx_pstart
+    { PRI_AMBIENT,  2 },    // sfx_pstop
+    { PRI_NORMAL,   3 },    // sfx_doropn
+    { PRI_NORMAL,   3 },    // sfx_dorcls
+    { PRI_AMBIENT,  2 },    // sfx_stnmov
+    { PRI_HIGH,     2 },    // sfx_swtchn
+    { PRI_HIGH,     2 },    // sfx_swtchx
+    { PRI_HIGH,     1 },    // sfx_plpain
+    { PRI_NORMAL,   2 },    // sfx_dmpain
+    { PRI_NORMAL,   3 },    // sfx_popain
+    { PRI_NORMAL,   3 },    // sfx_slop
+    { PRI_HIGH,     2 },    // sfx_itemup
+    { PRI_HIGH,     2 },    // sfx_wpnup
+    { PRI_HIGH,     1 },    // sfx_oof
+    { PRI_HIGH,     2 },    // sfx_telept
+    { PRI_NORMAL,   2 },    // sfx_posit1
+    { PRI_NORMAL,   2 },    // sfx_posit2
+    { PRI_NORMAL,   2 },    // sfx_posit3
+    { PRI_NORMAL,   2 },    // sfx_bgsit1
+    { PRI_NORMAL,   2 },    // sfx_bgsit2
+    { PRI_NORMAL,   2 },    // sfx_sgtsit
+    { PRI_NORMAL,   2 },    // sfx_cacsit
+    { PRI_HIGH,     1 },    // sfx_brssit
+    { PRI_HIGH,     1 },    // sfx_cybsit
+    { PRI_HIGH,     1 },    // sfx_spisit
+    { PRI_NORMAL,   2 },    // sfx_sklatk
+    { PRI_NORMAL,   3 },    // sfx_sgtatk
+    { PRI_NORMAL,   3 },    // sfx_claw
+    { PRI_HIGH,     1 },    // sfx_pldeth
+    { PRI_NORMAL,   2 },    // sfx_podth1
+    { PRI_NORMAL,   2 },    // sfx_podth2
+    { PRI_NORMAL,   2 },    // sfx_podth3
+    { PRI_NORMAL,   2 },    // sfx_bgdth1
+    { PRI_NORMAL,   2 },    // sfx_bgdth2
+    { PRI_NORMAL,   2 },    // sfx_sgtdth
+    { PRI_NORMAL,   2 },    // sfx_cacdth
+    { PRI_NORMAL,   2 },    // sfx_skldth
+    { PRI_HIGH,     1 },    // sfx_brsdth
+    { PRI_HIGH,     1 },    // sfx_cybdth
+    { PRI_HIGH,     1 },    // sfx_spidth
+    { PRI_AMBIENT,  2 },    // sfx_posact
+    { PRI_AMBIENT,  2 },    // sfx_bgact
+    { PRI_AMBIENT,  2 },    // sfx_dmact
+    { PRI_HIGH,     1 },    // sfx_noway
+    { PRI_NORMAL,   4 },    // sfx_barexp
+    { PRI_HIGH,     2 },    // sfx_punch
+    { PRI_NORMAL,   2 },    // sfx_hoof
+    { PRI_NORMAL,   2 },    // sfx_metal
+    { PRI_AMBIENT,  2 },    // sfx_itmbk
+};
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Clear the sound buffers and stop all sound
@@ -58,14 +144,19 @@ uint32_t S_StartSound(const Fixed* const pOriginXY, const uint32_t soundId, cons
         }
     }
 
+    // Don't bother playing sounds that would be barely audible
+    if (std::max(leftVolume, rightVolume) < S_MIN_VOLUME)
+        return UINT32_MAX;
+
     // Convert audio volume to 0.0-1.0 range
     const float leftVolumeF = (float) leftVolume / 255.0f;
     const float rightVolumeF = (float) rightVolume / 255.0f;
+    const SoundInfo& soundInfo = SOUND_INFO[soundId];
 
     if (bStopOtherInstances) {
-        return Audio::playSound(soundId, leftVolumeF, rightVolumeF, true);
+        return Audio::playSound(soundId, leftVolumeF, rightVolumeF, true, soundInfo.priority, soundInfo.maxInstances);
     } else {
-        return Audio::playSound(soundId, leftVolumeF, rightVolumeF, false);
+        return Audio::playSound(soundId, leftVolumeF, rightVolumeF, false, soundInfo.priority, soundInfo.maxInstances);
     }
 }
 
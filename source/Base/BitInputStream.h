@@ -1,14 +1,19 @@
 #pragma once
 
+#include "Endian.h"
 #include "Macros.h"
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <type_traits>
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Utility class that allows for N bits (up to 64) of an unsigned type to be read from a stream in memory.
 // The most significant bits are read first.
 // The stream is merely a view/wrapper around the given memory chunk and does NOT own the memory.
+//
+// Bits are served from a 64-bit buffer which is refilled with a single 8 byte load whenever possible, rather than
+// extracting bits from the source data one byte at a time.
 //------------------------------------------------------------------------------------------------------------------------------------------
 class BitInputStream {
 public:
@@ -17,22 +22,27 @@ public:
     inline BitInputStream(const std::byte* const pData, const uint32_t size) noexcept
         : mpData(pData)
         , mSize(size)
-        , mCurByteIdx(0)
-        , mCurBitIdx(7)
+        , mNextByteIdx(0)
+        , mNumBufferedBits(0)
+        , mBitBuffer(0)
     {
     }
 
     inline void seekToByteIndex(const uint32_t byteIndex) THROWS {
-        if (mCurByteIdx > mSize) {
+        if (byteIndex > mSize) {
             throw StreamException();
         }
 
-        mCurByteIdx = byteIndex;
-        mCurBitIdx = 7;
+        mNextByteIdx = byteIndex;
+        mNumBufferedBits = 0;
+        mBitBuffer = 0;
     }
 
+    //------------------------------------------------------------------------------------------------------------------
+    // Gives the index of the byte containing the next bit to be read
+    //------------------------------------------------------------------------------------------------------------------
     inline uint32_t getCurByteIndex() const noexcept {
-        return mCurByteIdx;
+        return (getNumBitsConsumed() / 8);
     }
 
     //------------------------------------------------------------------------------------------------------------------
@@ -40,71 +50,89 @@ public:
     // Note: only unsigned integer types are supported at present!
     //------------------------------------------------------------------------------------------------------------------
     template <class OutType>
-    OutType readBitsAsUInt(const uint8_t numBits) THROWS {
+    inline OutType readBitsAsUInt(const uint8_t numBits) THROWS {
         static_assert(std::is_integral_v<OutType>);
         static_assert(std::is_unsigned_v<OutType>);
-
         ASSERT(numBits <= sizeof(OutType) * 8);
-        OutType out = 0;
-        uint8_t numBitsLeft = numBits;
-
-        while (numBitsLeft > 0) {
-            // Setup for reading up to 8 bits
-            if (mCurByteIdx >= mSize) {
-                throw StreamException();
-            }
-
-            const uint8_t curByte = (uint8_t) mpData[mCurByteIdx];
-            const uint8_t numByteBitsLeft = mCurBitIdx + 1;
-            const uint8_t numBitsToRead = (numBitsLeft > numByteBitsLeft) ? numByteBitsLeft : numBitsLeft;
 
-            // Make room in the output for the new bits
-            out <<= numBitsToRead;
+        if (numBits == 0)
+            return 0;
 
-            // Extract the required bits and add to the output
-            const uint8_t shiftBitsToLSB = (mCurBitIdx + uint8_t(1) - numBitsToRead);
-            const uint8_t readMask = (uint8_t) ~(uint8_t(0xFFu) << numBitsToRead);
-            const uint8_t readBits = (curByte >> shiftBitsToLSB) & readMask;
-            out |= readBits;
-
-            // Move onto the next byte if appropriate and count the bits read
-            if (numBitsToRead >= numByteBitsLeft) {
-                ++mCurByteIdx;
-                mCurBitIdx = 7;
-            }
-            else {
-                mCurBitIdx -= numBitsToRead;
+        // The buffer is guaranteed to hold at least 57 bits after a refill, so larger reads are done in two parts
+        if constexpr (sizeof(OutType) == sizeof(uint64_t)) {
+            if (numBits > MAX_BITS_PER_READ) {
+                const uint64_t hiBits = readBits((uint8_t)(numBits - 32));
+                const uint64_t loBits = readBits(32);
+                return (OutType)((hiBits << 32) | loBits);
             }
-
-            numBitsLeft -= numBitsToRead;
         }
 
-        return out;
+        return (OutType) readBits(numBits);
     }
 
     //------------------------------------------------------------------------------------------------------------------
     // Aligns the current stream pointer to the start of the next 64-bit boundary.
     //------------------------------------------------------------------------------------------------------------------
     void align64() THROWS {
-        uint32_t newCurByteIdx = mCurByteIdx;
+        const uint32_t curByteIdx = (getNumBitsConsumed() + 7) / 8;
+        const uint32_t newCurByteIdx = (curByteIdx + uint32_t(7)) & (~uint32_t(7));
+        seekToByteIndex(newCurByteIdx);
+    }
 
-        if (mCurBitIdx < 7) {
-            ++newCurByteIdx;
-        }
+private:
+    // The most bits that can be read in one go: after a refill the buffer has at least this many bits, unless the stream ends
+    static constexpr uint8_t MAX_BITS_PER_READ = 56;
+
+    inline uint32_t getNumBitsConsumed() const noexcept {
+        return mNextByteIdx * 8 - mNumBufferedBits;
+    }
 
-        newCurByteIdx = (newCurByteIdx + uint32_t(7)) & (~uint32_t(7));
+    //------------------------------------------------------------------------------------------------------------------
+    // Reads between 1 and 'MAX_BITS_PER_READ' bits from the buffer, refilling it first if required
+    //------------------------------------------------------------------------------------------------------------------
+    inline uint64_t readBits(const uint8_t numBits) THROWS {
+        ASSERT((numBits > 0) && (numBits <= MAX_BITS_PER_READ));
 
-        if (newCurByteIdx > mSize) {
-            throw StreamException();
+        if (mNumBufferedBits < numBits) {
+            refill();
+
+            if (mNumBufferedBits < numBits) {
+                throw StreamException();
+            }
         }
 
-        mCurByteIdx = newCurByteIdx;
-        mCurBitIdx = 7;
+        const uint64_t bits = mBitBuffer >> (64 - numBits);
+        mBitBuffer <<= numBits;
+        mNumBufferedBits -= numBits;
+        return bits;
+    }
+
+    //------------------------------------------------------------------------------------------------------------------
+    // Tops up the bit buffer with as many whole bytes as will fit.
+    // Note: the fast path may leave bits from the following bytes below the valid bits in the buffer, but since those are
+    // the same bits that the next refill will OR in at the same positions, this does no harm.
+    //------------------------------------------------------------------------------------------------------------------
+    inline void refill() noexcept {
+        if (mNextByteIdx + 8 <= mSize) {
+            uint64_t nextBytes;
+            std::memcpy(&nextBytes, mpData + mNextByteIdx, sizeof(uint64_t));
+
+            const uint32_t numBytesToAdd = (63 - mNumBufferedBits) / 8;
+            mBitBuffer |= Endian::bigToHost(nextBytes) >> mNumBufferedBits;
+            mNextByteIdx += numBytesToAdd;
+            mNumBufferedBits += numBytesToAdd * 8;
+        } else {
+            while ((mNumBufferedBits <= 56) && (mNextByteIdx < mSize)) {
+                mBitBuffer |= (uint64_t) mpData[mNextByteIdx] << (56 - mNumBufferedBits);
+                ++mNextByteIdx;
+                mNumBufferedBits += 8;
+            }
+        }
     }
 
-private:
     const std::byte* const  mpData;
     uint32_t                mSize;
-    uint32_t                mCurByteIdx;
-    uint8_t                 mCurBitIdx;
+    uint32_t                mNextByteIdx;       // Index of the next byte to be loaded into the bit buffer
+    uint32_t                mNumBufferedBits;   // Number of unread bits in the bit buffer
+    uint64_t                mBitBuffer;         // Unread bits, with the next bit to be read in the most significant bit
 };
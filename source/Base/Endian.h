@@ -60,6 +60,17 @@ inline int32_t bigToHost(const int32_t num) {
     #endif
 }
 
+inline uint64_t bigToHost(const uint64_t num) {
+    #if BIG_ENDIAN == 1
+        return num;
+    #else
+        return (
+            ((uint64_t) bigToHost((uint32_t) num) << 32) |
+            ((uint64_t) bigToHost((uint32_t)(num >> 32)))
+        );
+    #endif
+}
+
 template <class T>
 inline void convertBigToHost(T& value) noexcept {
     #if BIG_ENDIAN != 1
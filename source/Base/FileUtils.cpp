@@ -6,11 +6,14 @@
 #include "Finally.h"
 
 #include <cstdint>
+#include <cstdio>
 #include <cstring>
+#include <string>
 
 // MacOS: working around missing support for <filesystem> in everything except the latest bleeding edge OS and Xcode.
 // Use standard Unix file functions instead for now, but some day this can be removed.
 #ifdef __MACOSX__
+    #include <sys/stat.h>
     #include <unistd.h>
 #else
     #include <filesystem>
@@ -129,4 +132,86 @@ bool fileExists(const char* filePath) noexcept {
     }
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Creates the given directory and any missing parent directories.
+// Returns 'true' if the directory exists after the call.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool createDirectories(const char* dirPath) noexcept {
+    ASSERT(dirPath);
+
+    try {
+        // MacOS: working around missing support for <filesystem> in everything except the latest bleeding edge OS and Xcode.
+        // Create each path component in turn with the standard Unix functions instead.
+        #ifdef __MACOSX__
+            std::string path = dirPath;
+
+            for (size_t i = 1; i <= path.size(); ++i) {
+                if (i == path.size() || path[i] == '/') {
+                    const std::string subPath = path.substr(0, i);
+                    mkdir(subPath.c_str(), 0755);
+                }
+            }
+
+            struct stat dirStat = {};
+            return ((stat(dirPath, &dirStat) == 0) && S_ISDIR(dirStat.st_mode));
+        #else
+            std::filesystem::create_directories(dirPath);
+            return std::filesystem::is_directory(dirPath);
+        #endif
+    } catch (...) {
+        return false;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Renames or moves a file, replacing the destination file if it already exists.
+// Returns 'true' on success.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool renameFile(const char* const oldPath, const char* const newPath) noexcept {
+    ASSERT(oldPath);
+    ASSERT(newPath);
+
+    try {
+        #ifdef __MACOSX__
+            return (std::rename(oldPath, newPath) == 0);
+        #else
+            std::filesystem::rename(oldPath, newPath);
+            return true;
+        #endif
+    } catch (...) {
+        return false;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Gets the size and last modification time of the given file, returning 'true' on success.
+// The modification time is in platform specific units and should only be used to check whether a file has changed.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool getFileSizeAndModTime(const char* const filePath, uint64_t& sizeOut, int64_t& modTimeOut) noexcept {
+    ASSERT(filePath);
+    sizeOut = 0;
+    modTimeOut = 0;
+
+    try {
+        #ifdef __MACOSX__
+            struct stat fileStat = {};
+
+            if (stat(filePath, &fileStat) != 0)
+                return false;
+
+            sizeOut = (uint64_t) fileStat.st_size;
+            modTimeOut = (int64_t) fileStat.st_mtime;
+            return true;
+        #else
+            sizeOut = (uint64_t) std::filesystem::file_size(filePath);
+            modTimeOut = (int64_t) std::filesystem::last_write_time(filePath).time_since_epoch().count();
+            return true;
+        #endif
+    } catch (...) {
+        sizeOut = 0;
+        modTimeOut = 0;
+        return false;
+    }
+}
+
 END_NAMESPACE(FileUtils)
@@ -3,6 +3,7 @@
 #include "Macros.h"
 
 #include <cstddef>
+#include <cstdint>
 
 BEGIN_NAMESPACE(FileUtils)
 
@@ -22,5 +23,8 @@ bool writeDataToFile(
 ) noexcept;
 
 bool fileExists(const char* filePath) noexcept;
+bool createDirectories(const char* dirPath) noexcept;
+bool renameFile(const char* const oldPath, const char* const newPath) noexcept;
+bool getFileSizeAndModTime(const char* const filePath, uint64_t& sizeOut, int64_t& modTimeOut) noexcept;
 
 END_NAMESPACE(FileUtils)
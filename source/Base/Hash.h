@@ -0,0 +1,73 @@
+#pragma once
+
+#include "Base/Macros.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Non-cryptographic hash functions for identifying data: not suitable for anything security related!
+//------------------------------------------------------------------------------------------------------------------------------------------
+BEGIN_NAMESPACE(Hash)
+
+// The starting values for a new hash
+static constexpr uint64_t FNV1A_64_INIT = 0xCBF29CE484222325;
+static constexpr uint32_t CRC32_INIT = 0;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Hashes the given bytes using 64-bit FNV-1a, continuing on from the given hash value.
+// Data in several pieces can be hashed by passing the result for one piece in as the starting hash for the next.
+//------------------------------------------------------------------------------------------------------------------------------------------
+inline uint64_t fnv1a64(const void* const pData, const size_t numBytes, const uint64_t startHash = FNV1A_64_INIT) noexcept {
+    ASSERT(pData || (numBytes == 0));
+
+    const uint8_t* const pBytes = (const uint8_t*) pData;
+    uint64_t hash = startHash;
+
+    for (size_t i = 0; i < numBytes; ++i) {
+        hash ^= pBytes[i];
+        hash *= 0x00000100000001B3;
+    }
+
+    return hash;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Builds the lookup table for the standard (reflected) CRC-32, using the polynomial 0xEDB88320
+//------------------------------------------------------------------------------------------------------------------------------------------
+inline constexpr std::array<uint32_t, 256> makeCrc32Table() noexcept {
+    std::array<uint32_t, 256> table = {};
+
+    for (uint32_t i = 0; i < 256; ++i) {
+        uint32_t crc = i;
+
+        for (uint32_t bit = 0; bit < 8; ++bit) {
+            crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320 : (crc >> 1);
+        }
+
+        table[i] = crc;
+    }
+
+    return table;
+}
+
+static constexpr std::array<uint32_t, 256> CRC32_TABLE = makeCrc32Table();
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Computes the standard CRC-32 of the given bytes, continuing on from the given CRC value.
+// This works in an unrelated way to FNV-1a, so it is useful as a second check when a single hash colliding would be bad.
+//------------------------------------------------------------------------------------------------------------------------------------------
+inline uint32_t crc32(const void* const pData, const size_t numBytes, const uint32_t startCrc = CRC32_INIT) noexcept {
+    ASSERT(pData || (numBytes == 0));
+
+    const uint8_t* const pBytes = (const uint8_t*) pData;
+    uint32_t crc = ~startCrc;
+
+    for (size_t i = 0; i < numBytes; ++i) {
+        crc = CRC32_TABLE[(crc ^ pBytes[i]) & 0xFF] ^ (crc >> 8);
+    }
+
+    return ~crc;
+}
+
+END_NAMESPACE(Hash)
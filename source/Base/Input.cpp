@@ -489,6 +489,18 @@ float getMouseXMovement() noexcept {
     return gMouseMovementX;
 }
 
+float getLateMouseXMovement() noexcept {
+    if (!windowHasFocus())
+        return 0.0f;
+
+    // Note: the mouse is re-centered on every update, so its position relative to the center is the movement since then
+    SDL_PumpEvents();
+
+    int mouseX = 0;
+    SDL_GetMouseState(&mouseX, nullptr);
+    return (float)(mouseX - (int32_t) Video::gVideoOutputWidth / 2);
+}
+
 float getMouseYMovement() noexcept {
     return gMouseMovementY;
 }
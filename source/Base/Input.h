@@ -71,6 +71,10 @@ float getControllerInputValue(const ControllerInput input) noexcept;
 float getMouseXMovement() noexcept;
 float getMouseYMovement() noexcept;
 
+// Samples how much the mouse has moved on the x axis since the last 'update', without consuming any input events.
+// Used to late latch mouse turning right before a frame is drawn; the same movement is still reported by the next 'update'.
+float getLateMouseXMovement() noexcept;
+
 // The the current movement amount for a mouse wheel axis
 float getMouseWheelAxisMovement(const uint8_t axis) noexcept;
 
@@ -0,0 +1,121 @@
+#include "MappedFile.h"
+
+#if WIN32
+    #include <Windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+MappedFile::MappedFile() noexcept
+    : mpData(nullptr)
+    , mSize(0)
+    , mpFileMapping(nullptr)
+{
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : mpData(other.mpData)
+    , mSize(other.mSize)
+    , mpFileMapping(other.mpFileMapping)
+{
+    other.mpData = nullptr;
+    other.mSize = 0;
+    other.mpFileMapping = nullptr;
+}
+
+MappedFile::~MappedFile() noexcept {
+    close();
+}
+
+bool MappedFile::open(const char* const pFilePath) noexcept {
+    ASSERT(pFilePath);
+    close();
+
+    #if WIN32
+        // Open the file and figure out its size
+        const HANDLE fileHandle = CreateFileA(
+            pFilePath,
+            GENERIC_READ,
+            FILE_SHARE_READ,
+            nullptr,
+            OPEN_EXISTING,
+            FILE_ATTRIBUTE_NORMAL,
+            nullptr
+        );
+
+        if (fileHandle == INVALID_HANDLE_VALUE)
+            return false;
+
+        LARGE_INTEGER fileSize = {};
+        const bool bGotFileSize = GetFileSizeEx(fileHandle, &fileSize);
+
+        if ((!bGotFileSize) || (fileSize.QuadPart <= 0)) {
+            CloseHandle(fileHandle);
+            return false;
+        }
+
+        // Create the file mapping and map a view of the entire file.
+        // Note: the file handle is no longer needed once the mapping object has been created.
+        const HANDLE mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        CloseHandle(fileHandle);
+
+        if (!mappingHandle)
+            return false;
+
+        const void* const pView = MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+
+        if (!pView) {
+            CloseHandle(mappingHandle);
+            return false;
+        }
+
+        mpData = (const std::byte*) pView;
+        mSize = (size_t) fileSize.QuadPart;
+        mpFileMapping = mappingHandle;
+    #else
+        // Open the file and figure out its size
+        const int fileDesc = ::open(pFilePath, O_RDONLY);
+
+        if (fileDesc < 0)
+            return false;
+
+        struct stat fileStat = {};
+
+        if ((fstat(fileDesc, &fileStat) != 0) || (fileStat.st_size <= 0)) {
+            ::close(fileDesc);
+            return false;
+        }
+
+        // Map the entire file.
+        // Note: the file descriptor is no longer needed once the mapping has been made.
+        void* const pView = mmap(nullptr, (size_t) fileStat.st_size, PROT_READ, MAP_PRIVATE, fileDesc, 0);
+        ::close(fileDesc);
+
+        if (pView == MAP_FAILED)
+            return false;
+
+        mpData = (const std::byte*) pView;
+        mSize = (size_t) fileStat.st_size;
+    #endif
+
+    return true;
+}
+
+void MappedFile::close() noexcept {
+    if (!mpData)
+        return;
+
+    #if WIN32
+        UnmapViewOfFile(mpData);
+        CloseHandle((HANDLE) mpFileMapping);
+    #else
+        munmap((void*) mpData, mSize);
+    #endif
+
+    mpData = nullptr;
+    mSize = 0;
+    mpFileMapping = nullptr;
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "Macros.h"
+#include <cstddef>
+#include <cstdint>
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// A read only view of an entire file on disk which has been mapped into memory by the operating system.
+// The file data is paged in on demand, so opening a mapped file is cheap even if the file is large.
+// The mapping is released (and can only be released) by closing the file or destroying this object.
+//------------------------------------------------------------------------------------------------------------------------------------------
+class MappedFile {
+public:
+    MappedFile() noexcept;
+    MappedFile(MappedFile&& other) noexcept;
+    ~MappedFile() noexcept;
+
+    // Note: if a file is already opened and an attempt is made to open another file then the current file is closed!
+    bool open(const char* const pFilePath) noexcept;
+    void close() noexcept;
+
+    inline bool isOpen() const noexcept { return (mpData != nullptr); }
+    inline const std::byte* getData() const noexcept { return mpData; }
+    inline size_t getSize() const noexcept { return mSize; }
+
+private:
+    MappedFile(const MappedFile& other) = delete;
+    MappedFile& operator = (const MappedFile& other) = delete;
+
+    const std::byte*    mpData;
+    size_t              mSize;
+    void*               mpFileMapping;  // Windows only: the handle to the file mapping object
+};
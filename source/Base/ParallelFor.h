@@ -0,0 +1,57 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Runs the given function for every index in the range [0, count) spread across a number of short lived threads, with the calling
+// thread also taking part. Returns once all indexes have been processed. Indexes are handed out one at a time from a shared counter,
+// so items which take very different amounts of time to process still balance well.
+//
+// Notes:
+//  (1) The function is called concurrently from multiple threads and MUST be thread safe and 'noexcept'.
+//  (2) No threads are started unless there are at least 'minItemsPerThread' items for each thread, since starting threads is not
+//      free. If the work is too small then everything is just done on the calling thread.
+//------------------------------------------------------------------------------------------------------------------------------------------
+template <class Func>
+void parallelFor(const uint32_t count, const uint32_t minItemsPerThread, const Func& func) noexcept {
+    // Decide how many threads to use, including the calling thread
+    const uint32_t maxThreads = std::max(std::thread::hardware_concurrency(), 1u);
+    const uint32_t numThreads = std::min(maxThreads, count / std::max(minItemsPerThread, 1u));
+
+    if (numThreads <= 1) {
+        for (uint32_t i = 0; i < count; ++i) {
+            func(i);
+        }
+
+        return;
+    }
+
+    // Each thread grabs the next unprocessed index until there are none left
+    std::atomic<uint32_t> nextIdx(0);
+
+    const auto threadMain = [&]() noexcept {
+        for (uint32_t i = nextIdx.fetch_add(1, std::memory_order_relaxed); i < count; i = nextIdx.fetch_add(1, std::memory_order_relaxed)) {
+            func(i);
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(numThreads - 1);
+
+    // Note: if a thread fails to start then the threads that did start (and this one) just pick up its share of the work
+    try {
+        for (uint32_t i = 0; i + 1 < numThreads; ++i) {
+            threads.emplace_back(threadMain);
+        }
+    } catch (...) {}
+
+    threadMain();
+
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+}
@@ -9,7 +9,25 @@
 struct Resource {
     uint32_t    number;
     uint32_t    type;
-    uint32_t    offset;     // Offset within the resource file
-    uint32_t    size;       // Size of the resource
-    std::byte*  pData;      // Non null if the resource is loaded
+    uint32_t    offset;         // Offset within the resource file
+    uint32_t    size;           // Size of the resource
+    std::byte*  pData;          // Non null if the resource is loaded
+    uint32_t    pinCount;       // While non zero the resource is never evicted from memory
+    bool        bReleased;      // Set once the resource is not needed: it may then be evicted from memory to stay within budget
+    uint32_t    lruPrevIdx;     // Index of the next MORE recently used resident resource in the manager or 'UINT32_MAX' if none
+    uint32_t    lruNextIdx;     // Index of the next LESS recently used resident resource in the manager or 'UINT32_MAX' if none
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// A handle to a resource in the manager which can be cached by users and used to access the resource in constant time.
+// Handles are only valid for the lifetime of the resource manager that issued them.
+//------------------------------------------------------------------------------------------------------------------------------------------
+struct ResourceHandle {
+    static constexpr uint32_t INVALID_INDEX = UINT32_MAX;
+
+    uint32_t index;     // Index of the resource within the manager's list of resources
+
+    inline bool isValid() const noexcept {
+        return (index != INVALID_INDEX);
+    }
 };
@@ -40,10 +40,17 @@ struct ResourceHeader {
     }
 };
 
+static constexpr uint32_t INVALID_IDX = UINT32_MAX;
+
 ResourceMgr::ResourceMgr() noexcept
     : mpResourceFile(nullptr)
     , mResources()
+    , mResourceIndexes()
     , mEndResourceNum(0)
+    , mMemoryBudget(0)
+    , mLruHeadIdx(INVALID_IDX)
+    , mLruTailIdx(INVALID_IDX)
+    , mStats()
 {
 }
 
@@ -128,78 +135,244 @@ void ResourceMgr::init(const char* const fileName) noexcept {
                 resource.type = pGroupHeader->resourceType;
                 resource.offset = pResourceHeader->offset;
                 resource.size = pResourceHeader->size;
+                resource.lruPrevIdx = INVALID_IDX;
+                resource.lruNextIdx = INVALID_IDX;
 
                 ++resourceNum;
             }
         }
     }
 
-    // Sort all of the resource headers so they can be binary searched
+    // Sort all of the resource headers by number and build the lookup table of resource number to index.
+    // Resource numbers are dense, so this allows for constant time lookup without wasting much memory.
     std::sort(mResources.begin(), mResources.end(), compareResourcesByNumber);
+    mResourceIndexes.resize(mEndResourceNum, ResourceHandle::INVALID_INDEX);
+
+    for (uint32_t resourceIdx = 0; resourceIdx < (uint32_t) mResources.size(); ++resourceIdx) {
+        uint32_t& lutEntry = mResourceIndexes[mResources[resourceIdx].number];
+
+        if (lutEntry == ResourceHandle::INVALID_INDEX) {
+            lutEntry = resourceIdx;
+        }
+    }
 }
 
 void ResourceMgr::destroy() noexcept {
     mEndResourceNum = 0;
     freeAllResources();
     mResources.clear();
+    mResourceIndexes.clear();
     mpResourceFile.reset();
+    mStats = {};
 }
 
-const Resource* ResourceMgr::getResource(const uint32_t number) const noexcept {
-    Resource searchValue;
-    searchValue.number = number;
-    auto iter = std::lower_bound(mResources.begin(), mResources.end(), searchValue, compareResourcesByNumber);
+ResourceHandle ResourceMgr::getResourceHandle(const uint32_t number) const noexcept {
+    const uint32_t resourceIdx = (number < mEndResourceNum) ? mResourceIndexes[number] : ResourceHandle::INVALID_INDEX;
+    return ResourceHandle{ resourceIdx };
+}
 
-    if (iter != mResources.end()) {
-        const Resource* const pResourceHeader = &(*iter);
-        return (pResourceHeader->number == number) ? pResourceHeader : nullptr;
-    }
+const Resource* ResourceMgr::getResource(const uint32_t number) const noexcept {
+    const ResourceHandle handle = getResourceHandle(number);
+    return (handle.isValid()) ? &mResources[handle.index] : nullptr;
+}
 
-    return nullptr;
+const Resource& ResourceMgr::getResource(const ResourceHandle handle) const noexcept {
+    ASSERT(handle.index < mResources.size());
+    return mResources[handle.index];
 }
 
 const Resource* ResourceMgr::loadResource(const uint32_t number) noexcept {
-    ASSERT(mpResourceFile);
-    Resource* const pResource = getMutableResource(number);
+    const ResourceHandle handle = getResourceHandle(number);
 
-    if (!pResource) {
+    if (!handle.isValid()) {
         FATAL_ERROR_F("Invalid resource number to load: %u!", unsigned(number));
     }
 
-    if (!pResource->pData) {
-        pResource->pData = MemAlloc(pResource->size);
+    return &loadResource(handle);
+}
+
+const Resource& ResourceMgr::loadResource(const ResourceHandle handle) noexcept {
+    ASSERT(mpResourceFile);
+    ASSERT(handle.index < mResources.size());
+    Resource& resource = mResources[handle.index];
+
+    ++mStats.numLoads;
+
+    if (resource.pData) {
+        // Already in memory: just make it the most recently used resource
+        ++mStats.numResidentHits;
+        lruUnlink(resource);
+        lruLinkFront(resource);
+    } else {
+        // Need to read from storage: make room for the resource first (if we can) to stay within the budget
+        evictToFitBudget(resource.size);
+        ++mStats.numStorageReads;
+
+        resource.pData = MemAlloc(resource.size);
 
         try {
-            mpResourceFile->seek(pResource->offset);
-            mpResourceFile->readBytes(pResource->pData, pResource->size);
+            mpResourceFile->seek(resource.offset);
+            mpResourceFile->readBytes(resource.pData, resource.size);
         } catch (...) {
-            FATAL_ERROR_F("Failed to read resource number %u!", unsigned(number));
+            FATAL_ERROR_F("Failed to read resource number %u!", unsigned(resource.number));
         }
+
+        mStats.numResidentBytes += resource.size;
+        mStats.peakResidentBytes = std::max(mStats.peakResidentBytes, mStats.numResidentBytes);
+        lruLinkFront(resource);
     }
 
-    return pResource;
+    resource.bReleased = false;
+    return resource;
+}
+
+const Resource* ResourceMgr::releaseResource(const uint32_t number) noexcept {
+    const ResourceHandle handle = getResourceHandle(number);
+    return (handle.isValid()) ? &releaseResource(handle) : nullptr;
+}
+
+const Resource& ResourceMgr::releaseResource(const ResourceHandle handle) noexcept {
+    ASSERT(handle.index < mResources.size());
+    Resource& resource = mResources[handle.index];
+
+    if (resource.pData) {
+        resource.bReleased = true;
+        evictToFitBudget(0);
+    }
+
+    return resource;
 }
 
 const Resource* ResourceMgr::freeResource(const uint32_t number) noexcept {
     Resource* const pResource = getMutableResource(number);
 
-    if (pResource) {
-        freeResource(*pResource);
+    if (pResource && pResource->pData) {
+        if (pResource->pinCount > 0) {
+            pResource->bReleased = true;
+        } else {
+            evictResource(*pResource);
+        }
     }
 
     return pResource;
 }
 
+void ResourceMgr::pinResource(const uint32_t number) noexcept {
+    Resource* const pResource = getMutableResource(number);
+
+    if (!pResource) {
+        FATAL_ERROR_F("Invalid resource number to pin: %u!", unsigned(number));
+    }
+
+    ++pResource->pinCount;
+}
+
+void ResourceMgr::unpinResource(const uint32_t number) noexcept {
+    Resource* const pResource = getMutableResource(number);
+
+    if (pResource) {
+        ASSERT_LOG(pResource->pinCount > 0, "Unpinning a resource that is not pinned!");
+
+        if (pResource->pinCount > 0) {
+            --pResource->pinCount;
+        }
+
+        // If the resource is now evictable then we might be able to get back within budget
+        if ((pResource->pinCount == 0) && pResource->bReleased) {
+            evictToFitBudget(0);
+        }
+    }
+}
+
+void ResourceMgr::setMemoryBudget(const uint32_t numBytes) noexcept {
+    mMemoryBudget = numBytes;
+    evictToFitBudget(0);
+}
+
 bool ResourceMgr::compareResourcesByNumber(const Resource& r1, const Resource& r2) noexcept {
     return (r1.number < r2.number);
 }
 
-void ResourceMgr::freeResource(Resource& resource) noexcept {
-    MEM_FREE_AND_NULL(resource.pData);
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Unloads the data for the given resource and removes it from the LRU list, regardless of whether it is in use or pinned
+//------------------------------------------------------------------------------------------------------------------------------------------
+void ResourceMgr::evictResource(Resource& resource) noexcept {
+    if (resource.pData) {
+        lruUnlink(resource);
+        mStats.numResidentBytes -= resource.size;
+        MEM_FREE_AND_NULL(resource.pData);
+    }
+
+    resource.bReleased = false;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Evicts released and unpinned resources, least recently used first, until the given number of extra bytes fits in the budget.
+// Gives up if no more resources can be evicted. With a budget of '0' this evicts all released and unpinned resources.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void ResourceMgr::evictToFitBudget(const uint32_t numExtraBytes) noexcept {
+    uint32_t resourceIdx = mLruTailIdx;
+
+    while ((resourceIdx != INVALID_IDX) && ((uint64_t) mStats.numResidentBytes + numExtraBytes > mMemoryBudget)) {
+        Resource& resource = mResources[resourceIdx];
+        resourceIdx = resource.lruPrevIdx;
+
+        if (resource.bReleased && (resource.pinCount == 0)) {
+            ++mStats.numEvictions;
+            mStats.numBytesEvicted += resource.size;
+            evictResource(resource);
+        }
+    }
 }
 
 void ResourceMgr::freeAllResources() noexcept {
     for (Resource& resource : mResources) {
-        freeResource(resource);
+        evictResource(resource);
     }
+
+    ASSERT(mLruHeadIdx == INVALID_IDX);
+    ASSERT(mLruTailIdx == INVALID_IDX);
+    ASSERT(mStats.numResidentBytes == 0);
+}
+
+uint32_t ResourceMgr::getResourceIndex(const Resource& resource) const noexcept {
+    return (uint32_t)(&resource - mResources.data());
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Adds the given resource to the front of the LRU list (most recently used)
+//------------------------------------------------------------------------------------------------------------------------------------------
+void ResourceMgr::lruLinkFront(Resource& resource) noexcept {
+    const uint32_t resourceIdx = getResourceIndex(resource);
+    ASSERT((resource.lruPrevIdx == INVALID_IDX) && (resource.lruNextIdx == INVALID_IDX));
+
+    resource.lruNextIdx = mLruHeadIdx;
+
+    if (mLruHeadIdx != INVALID_IDX) {
+        mResources[mLruHeadIdx].lruPrevIdx = resourceIdx;
+    } else {
+        mLruTailIdx = resourceIdx;
+    }
+
+    mLruHeadIdx = resourceIdx;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Removes the given resource from the LRU list
+//------------------------------------------------------------------------------------------------------------------------------------------
+void ResourceMgr::lruUnlink(Resource& resource) noexcept {
+    if (resource.lruPrevIdx != INVALID_IDX) {
+        mResources[resource.lruPrevIdx].lruNextIdx = resource.lruNextIdx;
+    } else {
+        mLruHeadIdx = resource.lruNextIdx;
+    }
+
+    if (resource.lruNextIdx != INVALID_IDX) {
+        mResources[resource.lruNextIdx].lruPrevIdx = resource.lruPrevIdx;
+    } else {
+        mLruTailIdx = resource.lruPrevIdx;
+    }
+
+    resource.lruPrevIdx = INVALID_IDX;
+    resource.lruNextIdx = INVALID_IDX;
 }
@@ -5,9 +5,32 @@
 #include <vector>
 
 struct Resource;
+struct ResourceHandle;
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Manages a 3DO doom resource file and the resources within it
+// Statistics for how the resource manager is using memory and how often it has to go to storage
+//------------------------------------------------------------------------------------------------------------------------------------------
+struct ResourceMgrStats {
+    uint64_t    numLoads;               // Total number of resource load requests
+    uint64_t    numResidentHits;        // Load requests where the resource was already in memory
+    uint64_t    numStorageReads;        // Load requests where the resource had to be read from storage
+    uint64_t    numEvictions;           // Number of times a released resource was evicted to stay within the memory budget
+    uint64_t    numBytesEvicted;        // Total bytes evicted to stay within the memory budget
+    uint32_t    numResidentBytes;       // Bytes of resource data currently in memory
+    uint32_t    peakResidentBytes;      // Highest value seen for 'numResidentBytes'
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Manages a 3DO doom resource file and the resources within it.
+//
+// Residency policy:
+//  (1) A resource is 'in use' from when it is loaded until it is released or freed. In use resources are never evicted.
+//  (2) Released resources stay in memory so that reloads are cheap, until they need to be evicted to stay within the memory
+//      budget. The least recently used resources are evicted first.
+//  (3) Pinned resources are never evicted, even if released. Pins are counted and may be placed on resources not yet loaded.
+//  (4) Freeing a resource evicts it immediately unless it is pinned, in which case it is just released.
+//  (5) The budget is a target rather than a hard limit: in use and pinned resources may push usage above it.
+//      A budget of '0' (the default) means nothing is kept after release: released resources are freed straight away unless pinned.
 //------------------------------------------------------------------------------------------------------------------------------------------
 class ResourceMgr {
 public:
@@ -17,10 +40,30 @@ public:
     void init(const char* const fileName) noexcept;
     void destroy() noexcept;
 
+    // Lookup a resource handle by number: the handle is invalid if the resource does not exist
+    ResourceHandle getResourceHandle(const uint32_t number) const noexcept;
+
     const Resource* getResource(const uint32_t number) const noexcept;
+    const Resource& getResource(const ResourceHandle handle) const noexcept;
     const Resource* loadResource(const uint32_t number) noexcept;
+    const Resource& loadResource(const ResourceHandle handle) noexcept;
+    const Resource* releaseResource(const uint32_t number) noexcept;
+    const Resource& releaseResource(const ResourceHandle handle) noexcept;
     const Resource* freeResource(const uint32_t number) noexcept;
 
+    void pinResource(const uint32_t number) noexcept;
+    void unpinResource(const uint32_t number) noexcept;
+
+    void setMemoryBudget(const uint32_t numBytes) noexcept;
+
+    inline uint32_t getMemoryBudget() const noexcept {
+        return mMemoryBudget;
+    }
+
+    inline const ResourceMgrStats& getStats() const noexcept {
+        return mStats;
+    }
+
     inline uint32_t getEndResourceNum() const noexcept {
         return mEndResourceNum;
     }
@@ -28,9 +71,15 @@ public:
 private:
     static bool compareResourcesByNumber(const Resource& r1, const Resource& r2) noexcept;
 
-    static void freeResource(Resource& resource) noexcept;
+    void evictResource(Resource& resource) noexcept;
+    void evictToFitBudget(const uint32_t numExtraBytes) noexcept;
     void freeAllResources() noexcept;
 
+    void lruLinkFront(Resource& resource) noexcept;
+    void lruUnlink(Resource& resource) noexcept;
+
+    uint32_t getResourceIndex(const Resource& resource) const noexcept;
+
     inline Resource* getMutableResource(const uint32_t number) noexcept {
         // Note: const casting to save duplicating the same code!
         return const_cast<Resource*>(getResource(number));
@@ -38,5 +87,10 @@ private:
 
     std::unique_ptr<GameDataFS::InputStream>    mpResourceFile;
     std::vector<Resource>                       mResources;
+    std::vector<uint32_t>                       mResourceIndexes;   // Index in 'mResources' for each resource number or 'UINT32_MAX' if no such resource
     uint32_t                                    mEndResourceNum;    // 1 past the last valid resource number
+    uint32_t                                    mMemoryBudget;      // Max bytes of resource data to keep in memory (if possible)
+    uint32_t                                    mLruHeadIdx;        // Index of the most recently used resident resource or 'UINT32_MAX' if none
+    uint32_t                                    mLruTailIdx;        // Index of the least recently used resident resource or 'UINT32_MAX' if none
+    ResourceMgrStats                            mStats;
 };
@@ -0,0 +1,14 @@
+#pragma once
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Detects which SIMD instruction sets can be used unconditionally for the target being compiled for.
+// Code using SIMD should check these defines and always provide a plain scalar fallback path.
+//------------------------------------------------------------------------------------------------------------------------------------------
+
+// Whether SSE2 is available: it is always available on x64, and on 32-bit x86 it depends on the compiler settings
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define SIMD_USE_SSE2 1
+    #include <emmintrin.h>
+#else
+    #define SIMD_USE_SSE2 0
+#endif
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// A fixed capacity lock-free queue for passing items from exactly one producer thread to exactly one consumer thread.
+//
+// Notes:
+//  (1) Only one thread may push and only one thread may pop at any given time. If some other synchronization guarantees
+//      that the usual consumer is not running (a lock for example) then another thread may temporarily act as consumer.
+//  (2) The capacity must be a power of two.
+//------------------------------------------------------------------------------------------------------------------------------------------
+template <class T, uint32_t Capacity>
+class SpscQueue {
+public:
+    static_assert((Capacity > 0) && ((Capacity & (Capacity - 1)) == 0), "Capacity must be a power of two!");
+
+    inline SpscQueue() noexcept
+        : mWriteIdx(0)
+        , mReadIdx(0)
+        , mItems()
+    {
+    }
+
+    //--------------------------------------------------------------------------------------------------------------------------------------
+    // Producer side: try to add an item to the queue, returning 'false' if the queue is full
+    //--------------------------------------------------------------------------------------------------------------------------------------
+    inline bool tryPush(const T& item) noexcept {
+        const uint32_t writeIdx = mWriteIdx.load(std::memory_order_relaxed);
+        const uint32_t readIdx = mReadIdx.load(std::memory_order_acquire);
+
+        if (writeIdx - readIdx >= Capacity)
+            return false;
+
+        mItems[writeIdx & (Capacity - 1)] = item;
+        mWriteIdx.store(writeIdx + 1, std::memory_order_release);
+        return true;
+    }
+
+    //--------------------------------------------------------------------------------------------------------------------------------------
+    // Consumer side: try to remove an item from the queue, returning 'false' if the queue is empty
+    //--------------------------------------------------------------------------------------------------------------------------------------
+    inline bool tryPop(T& item) noexcept {
+        const uint32_t readIdx = mReadIdx.load(std::memory_order_relaxed);
+        const uint32_t writeIdx = mWriteIdx.load(std::memory_order_acquire);
+
+        if (readIdx == writeIdx)
+            return false;
+
+        item = mItems[readIdx & (Capacity - 1)];
+        mReadIdx.store(readIdx + 1, std::memory_order_release);
+        return true;
+    }
+
+    //--------------------------------------------------------------------------------------------------------------------------------------
+    // Discards all items in the queue: neither the producer or consumer may be using the queue when this is called!
+    //--------------------------------------------------------------------------------------------------------------------------------------
+    inline void clear() noexcept {
+        mWriteIdx.store(0, std::memory_order_relaxed);
+        mReadIdx.store(0, std::memory_order_relaxed);
+    }
+
+private:
+    // Note: the read and write indexes are kept on separate cache lines to avoid false sharing between the two threads
+    alignas(64) std::atomic<uint32_t>   mWriteIdx;
+    alignas(64) std::atomic<uint32_t>   mReadIdx;
+    alignas(64) T                       mItems[Capacity];
+};
@@ -1,6 +1,7 @@
 #include "CelImages.h"
 
 #include "Base/Resource.h"
+#include "Game/AssetCache.h"
 #include "Game/Resources.h"
 #include <vector>
 
@@ -12,6 +13,75 @@ BEGIN_NAMESPACE(CelImages)
 // tradeoff is probably worth it.
 static std::vector<CelImageArray> gImageArrays;
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Try to read a set of decoded images from the asset cache, returning 'false' on failure.
+// The cache payload is the number of images and load flags, followed by the size, offsets and pixels for each image.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool readCachedImages(CelImageArray& imageArray, const AssetCache::Key& cacheKey) noexcept {
+    AssetCache::Entry cacheEntry;
+
+    if (!AssetCache::read(cacheKey, cacheEntry))
+        return false;
+
+    try {
+        ByteInputStream stream = cacheEntry.getPayloadStream();
+        const uint32_t numImages = stream.read<uint32_t>();
+        const CelLoadFlags loadFlags = stream.read<CelLoadFlags>();
+
+        // Sanity check the image count against the amount of data before allocating anything
+        if ((numImages == 0) || (numImages > stream.getNumBytesLeft() / sizeof(uint16_t[4])))
+            return false;
+
+        imageArray.numImages = numImages;
+        imageArray.loadFlags = loadFlags;
+        imageArray.pImages = new CelImage[numImages];
+
+        for (uint32_t imageIdx = 0; imageIdx < numImages; ++imageIdx) {
+            CelImage& image = imageArray.pImages[imageIdx];
+            image.width = stream.read<uint16_t>();
+            image.height = stream.read<uint16_t>();
+            image.offsetX = stream.read<int16_t>();
+            image.offsetY = stream.read<int16_t>();
+
+            const uint32_t numPixels = (uint32_t) image.width * (uint32_t) image.height;
+            stream.ensureBytesLeft(numPixels * sizeof(uint16_t));
+            image.pPixels = new uint16_t[numPixels];
+            stream.readBytes((std::byte*) image.pPixels, numPixels * sizeof(uint16_t));
+        }
+
+        // Expect to have consumed all of the data, if not then the entry is invalid
+        if (stream.hasBytesLeft()) {
+            imageArray.free();
+            return false;
+        }
+
+        return true;
+    } catch (...) {
+        imageArray.free();
+        return false;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Save a set of decoded images to the asset cache
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void writeCachedImages(const CelImageArray& imageArray, const AssetCache::Key& cacheKey) noexcept {
+    AssetCache::PayloadWriter payload;
+    payload.write(imageArray.numImages);
+    payload.write(imageArray.loadFlags);
+
+    for (uint32_t imageIdx = 0; imageIdx < imageArray.numImages; ++imageIdx) {
+        const CelImage& image = imageArray.pImages[imageIdx];
+        payload.write(image.width);
+        payload.write(image.height);
+        payload.write(image.offsetX);
+        payload.write(image.offsetY);
+        payload.writeBytes(image.pPixels, (uint32_t) image.width * (uint32_t) image.height * sizeof(uint16_t));
+    }
+
+    AssetCache::write(cacheKey, payload);
+}
+
 static void loadImages(
     CelImageArray& imageArray,
     const uint32_t resourceNum,
@@ -25,6 +95,20 @@ static void loadImages(
     const std::byte* const pResourceData = pResource->pData;
     const uint32_t resourceSize = pResource->size;
 
+    // Use the already decoded images in the asset cache if available.
+    // Note: the same resource decoded with different flags or as an array vs single image gets a different cache entry.
+    // Only hash the resource to make the cache key if the cache is actually in use.
+    const bool bUseAssetCache = AssetCache::isEnabled();
+    const uint32_t cacheVariant = loadFlags | ((bLoadImageArray) ? 0x80000000 : 0);
+    const AssetCache::Key cacheKey = (bUseAssetCache) ?
+        AssetCache::makeKey(AssetCache::AssetType::CEL_IMAGES, pResourceData, resourceSize, cacheVariant) :
+        AssetCache::Key{};
+
+    if (bUseAssetCache && readCachedImages(imageArray, cacheKey)) {
+        Resources::release(resourceNum);
+        return;
+    }
+
     // Read each individual image.
     // Note: could be dealing with an array of images or just one.
     if (bLoadImageArray) {
@@ -41,8 +125,12 @@ static void loadImages(
         }
     }
 
-    // After we are done we can free the raw resource - done at this point
-    Resources::free(resourceNum);
+    if (bUseAssetCache) {
+        writeCachedImages(imageArray, cacheKey);
+    }
+
+    // After we are done we can release the raw resource - done at this point
+    Resources::release(resourceNum);
 }
 
 void init() noexcept {
@@ -119,7 +207,7 @@ void freeImages(const uint32_t resourceNum) noexcept {
 
 void releaseImages(const uint32_t resourceNum) noexcept {
     // Note: function does nothing at the moment deliberately, just here as a statement of intent.
-    // For why this is, see 'Resources::release()'.
+    // Decoded images are not subject to the memory budget for raw resources (see 'Resources::release()') and are simply kept.
     MARK_UNUSED(resourceNum);
 }
 
@@ -7,11 +7,30 @@
 // Simple struct describing the data for an image in RGBA5551 format, stored either column major or row major layout.
 // Since all images & textures in 3DO Doom are ultimately described in terms of a series of RGBA5551 colors, we can use
 // this format as the single uniform format throughout the code.
+//
+// Optionally an image can instead use indexed color storage, where each pixel is a 4 or 8-bit index into a color lookup table.
+// This is how 3DO textures are originally stored, and it takes up much less memory. In that case 'pPixels' is null.
 //------------------------------------------------------------------------------------------------------------------------------------------
 struct ImageData {
     uint32_t    width;
     uint32_t    height;
     uint16_t*   pPixels;
+    uint8_t*    pColorIdxs;         // Indexed color storage: the color index for each pixel. With 4-bit indexes the first pixel is in the high nibble.
+    uint16_t*   pPLUT;              // Indexed color storage: the color lookup table (host endian). The color indexes share this allocation.
+    uint32_t    bitsPerColorIdx;    // Indexed color storage: 4 or 8 bits per pixel, or '0' if the image is not using indexed color storage
+
+    // Get the color of the pixel at the given index in the image, regardless of how the image is stored
+    inline uint16_t getPixel(const uint32_t pixelIdx) const noexcept {
+        if (bitsPerColorIdx == 0)
+            return pPixels[pixelIdx];
+
+        if (bitsPerColorIdx == 4) {
+            const uint32_t colorIdx = (pColorIdxs[pixelIdx >> 1] >> ((~pixelIdx & 1u) << 2)) & 0x0Fu;
+            return pPLUT[colorIdx];
+        }
+
+        return pPLUT[pColorIdxs[pixelIdx]];
+    }
 };
 
 //------------------------------------------------------------------------------------------------------------------------------------------
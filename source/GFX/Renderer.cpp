@@ -1,9 +1,11 @@
 #include "Renderer_Internal.h"
 
+#include "Base/Simd.h"
 #include "Base/Tables.h"
 #include "Blit.h"
 #include "Game/Config.h"
 #include "Game/Data.h"
+#include "Map/MapData.h"
 #include "Sprites.h"
 #include "Textures.h"
 #include "Things/MapObj.h"
@@ -30,47 +32,13 @@ static constexpr ScreenSize REFERENCE_SCREEN_SIZES[6] = {
 // Internal renderer cross module globals
 //------------------------------------------------------------------------------------------------------------------------------------------
 float                           gDebugCameraZOffset;
-Fixed                           gViewXFrac;
-Fixed                           gViewYFrac;
-Fixed                           gViewZFrac;
-float                           gViewX;
-float                           gViewY;
-float                           gViewZ;
-float                           gViewDirX;
-float                           gViewDirY;
-float                           gViewPerpX;
-float                           gViewPerpY;
-angle_t                         gViewAngleBAM;
-float                           gViewAngle;
-Fixed                           gViewCosFrac;
-Fixed                           gViewSinFrac;
-float                           gViewCos;
-float                           gViewSin;
-float                           gNearPlaneW;
-float                           gNearPlaneH;
-float                           gNearPlaneHalfW;
-float                           gNearPlaneHalfH;
-float                           gNearPlaneP1x;
-float                           gNearPlaneP1y;
-float                           gNearPlaneP2x;
-float                           gNearPlaneP2y;
-float                           gNearPlaneTz;
-float                           gNearPlaneBz;
-float                           gNearPlaneXStepPerViewCol;
-float                           gNearPlaneYStepPerViewCol;
-float                           gNearPlaneZStepPerViewColPixel;
-ProjectionMatrix                gProjMatrix;
-uint32_t                        gExtraLight;
-std::vector<angle_t>            gScreenXToAngleBAM;
-std::vector<DrawSeg>            gDrawSegs;
-std::vector<SegClip>            gSegClip;
-std::vector<OccludingColumns>   gOccludingCols;
-uint32_t                        gNumFullSegCols;
-std::vector<WallFragment>       gWallFragments;
-std::vector<FlatFragment>       gFloorFragments;
-std::vector<FlatFragment>       gCeilFragments;
-std::vector<SkyFragment>        gSkyFragments;
-std::vector<DrawSprite>         gDrawSprites;
+std::vector<uint8_t>            gLightTable;
+uint32_t                        gLightTableNumDists;
+float                           gLightTableDistScale;
+float                           gLightTableMaxDistIdx;
+
+// The render context used to draw the player's view
+static RenderContext            gPlayerViewContext;
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Load in the "TextureInfo" array so that the game knows all about the wall and sky textures (Width,Height).
@@ -96,18 +64,20 @@ static void initData() noexcept {
     initMathTables();
 }
 
-static void setupSegYClipArrayForDraw() noexcept {
+static void setupSegYClipArrayForDraw(RenderContext& ctx) noexcept {
     // Ensure the array is the correct size for the screen
-    if (gSegClip.size() != g3dViewWidth) {
-        gSegClip.resize(g3dViewWidth);
+    const uint32_t viewW = ctx.viewWidth;
+
+    if (ctx.segClip.size() != viewW) {
+        ctx.segClip.resize(viewW);
     }
 
     // Clear 8 entries in the y clip array at a time so the ops can be pipelined
-    const SegClip segClipClearVal = SegClip{ (int16_t) -1, (int16_t) g3dViewHeight };
+    const SegClip segClipClearVal = SegClip{ (int16_t) -1, (int16_t) ctx.viewHeight };
 
-    SegClip* pSegClip = gSegClip.data();
-    SegClip* const pEndClipBounds8 = pSegClip + (uintptr_t)(g3dViewWidth / 8) * 8;
-    SegClip* const pEndClipBounds = pSegClip + gSegClip.size();
+    SegClip* pSegClip = ctx.segClip.data();
+    SegClip* const pEndClipBounds8 = pSegClip + (uintptr_t)(viewW / 8) * 8;
+    SegClip* const pEndClipBounds = pSegClip + ctx.segClip.size();
 
     while (pSegClip < pEndClipBounds8) {
         pSegClip[0] = segClipClearVal;
@@ -128,19 +98,21 @@ static void setupSegYClipArrayForDraw() noexcept {
     }
 
     // Reset: this gets incremented every time segs fully occupy a screen column
-    gNumFullSegCols = 0;
+    ctx.numFullSegCols = 0;
 }
 
-static void setupOccludingColumnsArrayForDraw() noexcept {
+static void setupOccludingColumnsArrayForDraw(RenderContext& ctx) noexcept {
     // Ensure the array is the correct size for the screen
-    if (gOccludingCols.size() != g3dViewWidth) {
-        gOccludingCols.resize(g3dViewWidth);
+    const uint32_t viewW = ctx.viewWidth;
+
+    if (ctx.occludingCols.size() != viewW) {
+        ctx.occludingCols.resize(viewW);
     }
 
     // Clear 8 entries in array at a time so the ops can be pipelined
-    OccludingColumns* pOccludingCols = gOccludingCols.data();
-    OccludingColumns* const pEndOccludingCols8 = pOccludingCols + (uintptr_t)(g3dViewWidth / 8) * 8;
-    OccludingColumns* const pEndOccludingCols = pOccludingCols + gOccludingCols.size();
+    OccludingColumns* pOccludingCols = ctx.occludingCols.data();
+    OccludingColumns* const pEndOccludingCols8 = pOccludingCols + (uintptr_t)(viewW / 8) * 8;
+    OccludingColumns* const pEndOccludingCols = pOccludingCols + ctx.occludingCols.size();
 
     while (pOccludingCols < pEndOccludingCols8) {
         pOccludingCols[0].count = 0;
@@ -161,80 +133,317 @@ static void setupOccludingColumnsArrayForDraw() noexcept {
     }
 }
 
-static void preDrawSetup() noexcept {
-    // Set the position and angle of the view from the player
-    const player_t& player = gPlayer;
-    const mobj_t& mapObj = *player.mo;
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Makes sure the render context is setup for a view of the given size and aspect ratio, rebuilding the tables which depend on the view
+// size if needed.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void setupViewSizeDependentTables(
+    RenderContext& ctx,
+    const uint32_t viewW,
+    const uint32_t viewH,
+    const float aspectRatio
+) noexcept {
+    ASSERT((viewW > 1) && (viewH > 0));
+    ASSERT(viewH <= INT16_MAX);
+
+    // Allocate the column major render target for the 3D view, if using it
+    if (Config::gbColumnMajor3dView) {
+        ctx.colMajorPixels.resize((size_t) viewW * viewH);
+    } else {
+        ctx.colMajorPixels.clear();
+    }
 
-    gViewXFrac = mapObj.x;
-    gViewYFrac = mapObj.y;
-    gViewX = fixed16ToFloat(mapObj.x);
-    gViewY = fixed16ToFloat(mapObj.y);
-    gViewZFrac = player.viewz;
-    gViewZ = fixed16ToFloat(player.viewz);
-    gViewAngleBAM = mapObj.angle;
-    gViewAngle = bamAngleToRadians(mapObj.angle);
+    // Near plane width and height: the width is fixed by the field of view and the height by the aspect ratio
+    ctx.nearPlaneW = Z_NEAR * std::tan(FOV * 0.5f) * 2.0f;
+    ctx.nearPlaneH = ctx.nearPlaneW / aspectRatio;
+    ctx.nearPlaneHalfW = ctx.nearPlaneW * 0.5f;
+    ctx.nearPlaneHalfH = ctx.nearPlaneH * 0.5f;
 
-    if (Config::gbAllowDebugCameraUpDownMovement) {
-        gViewZFrac += floatToFixed16(gDebugCameraZOffset);
-        gViewZ += gDebugCameraZOffset;
+    // Compute the partial projection matrix
+    {
+        // This is largely based on GLM's 'perspectiveRH_ZO' - see definition of 'ProjectionMatrix'
+        // for more details about these calculations:
+        const float f = std::tan(FOV * 0.5f);
+        const float a = aspectRatio;
+
+        ctx.projMatrix.r0c0 = 1.0f / f;
+        ctx.projMatrix.r1c1 = -a / f;
+        ctx.projMatrix.r2c2 = -Z_FAR / (Z_NEAR - Z_FAR);
+        ctx.projMatrix.r2c3 = -(Z_NEAR * Z_FAR) / (Z_FAR - Z_NEAR);
     }
 
+    // Note: the tables below only depend on the view size and the near plane width, which is the same for every aspect ratio
+    if ((ctx.viewWidth == viewW) && (ctx.viewHeight == viewH))
+        return;
+
+    ctx.viewWidth = viewW;
+    ctx.viewHeight = viewH;
+
+    // Compute the screen pixel to view angle table
+    ctx.screenXToAngleBAM.resize(viewW);
+
+    {
+        float screenXToT = 1.0f / ((float) viewW - 1.0f);
+
+        for (uint32_t x = 0; x < viewW; ++x) {
+            const float t = ((float) x + 0.5f) * screenXToT;
+            const float nearPlaneX = t * ctx.nearPlaneW - ctx.nearPlaneHalfW;
+            const float angleRad = std::atan2(Z_NEAR, nearPlaneX);
+            const angle_t angleBAM = radiansToBamAngle(angleRad);
+            ctx.screenXToAngleBAM[x] = angleBAM;
+        }
+    }
+
+    // Compute the distances at which flats switch to smaller mip levels.
+    // Switch at the distance where a screen pixel covers 2, 4 and 8 world units (texels) respectively:
+    static_assert(C_ARRAY_SIZE(ctx.flatMipLevelDists) == Texture::MAX_MIP_LEVELS - 1);
+    const float distPerWorldUnitPerPixel = (Z_NEAR * (float) viewW) / ctx.nearPlaneW;
+
+    for (uint32_t i = 0; i < C_ARRAY_SIZE(ctx.flatMipLevelDists); ++i) {
+        ctx.flatMipLevelDists[i] = (float)(2u << i) * distPerWorldUnitPerPixel;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Makes sure the per line and per sector info in the render context is sized for the current map
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void setupMapDependentArrays(RenderContext& ctx) noexcept {
+    if ((ctx.lineDrawInfos.size() == gNumLines) && (ctx.sectorValidCounts.size() == gNumSectors))
+        return;
+
+    // Note: the valid counts must all start out lower than the context's valid count
+    ctx.lineDrawInfos.clear();
+    ctx.lineDrawInfos.resize(gNumLines);
+    ctx.sectorValidCounts.clear();
+    ctx.sectorValidCounts.resize(gNumSectors);
+    ctx.validCount = 0;
+}
+
+static void preDrawSetup(RenderContext& ctx, const ViewParams& viewParams, const RenderTarget& target, const float aspectRatio) noexcept {
+    setupViewSizeDependentTables(ctx, target.width, target.height, aspectRatio);
+    setupMapDependentArrays(ctx);
+
+    // Set the position and angle of the view
+    ctx.viewXFrac = viewParams.x;
+    ctx.viewYFrac = viewParams.y;
+    ctx.viewZFrac = viewParams.z;
+    ctx.viewX = fixed16ToFloat(viewParams.x);
+    ctx.viewY = fixed16ToFloat(viewParams.y);
+    ctx.viewZ = fixed16ToFloat(viewParams.z);
+    ctx.viewAngleBAM = viewParams.angle;
+    ctx.viewAngle = bamAngleToRadians(ctx.viewAngleBAM);
+
     // Precompute sine and cosine of view angle
     {
-        const uint32_t angleIdx = gViewAngleBAM >> ANGLETOFINESHIFT;    // Precalc angle index
-        gViewSinFrac = gFineSine[angleIdx];                             // Get the base sine value
-        gViewCosFrac = gFineCosine[angleIdx];                           // Get the base cosine value
-        gViewSin = std::sin(-gViewAngle + FMath::ANGLE_90<float>);
-        gViewCos = std::cos(-gViewAngle + FMath::ANGLE_90<float>);
+        const uint32_t angleIdx = ctx.viewAngleBAM >> ANGLETOFINESHIFT;     // Precalc angle index
+        ctx.viewSinFrac = gFineSine[angleIdx];                              // Get the base sine value
+        ctx.viewCosFrac = gFineCosine[angleIdx];                            // Get the base cosine value
+        ctx.viewSin = std::sin(-ctx.viewAngle + FMath::ANGLE_90<float>);
+        ctx.viewCos = std::cos(-ctx.viewAngle + FMath::ANGLE_90<float>);
     }
 
     // View vectors
-    gViewDirX = std::cos(gViewAngle);
-    gViewDirY = std::sin(gViewAngle);
-    gViewPerpX = gViewDirY;
-    gViewPerpY = -gViewDirX;
+    ctx.viewDirX = std::cos(ctx.viewAngle);
+    ctx.viewDirY = std::sin(ctx.viewAngle);
+    ctx.viewPerpX = ctx.viewDirY;
+    ctx.viewPerpY = -ctx.viewDirX;
 
     // Near plane left and right side x,y and top and bottom z
-    gNearPlaneP1x = gViewX + gViewDirX * Z_NEAR - gNearPlaneHalfW * gViewPerpX;
-    gNearPlaneP1y = gViewY + gViewDirY * Z_NEAR - gNearPlaneHalfW * gViewPerpY;
-    gNearPlaneP2x = gViewX + gViewDirX * Z_NEAR + gNearPlaneHalfW * gViewPerpX;
-    gNearPlaneP2y = gViewY + gViewDirY * Z_NEAR + gNearPlaneHalfW * gViewPerpY;
-    gNearPlaneTz = gViewZ + gNearPlaneHalfH;
-    gNearPlaneBz = gViewZ - gNearPlaneHalfH;
+    ctx.nearPlaneP1x = ctx.viewX + ctx.viewDirX * Z_NEAR - ctx.nearPlaneHalfW * ctx.viewPerpX;
+    ctx.nearPlaneP1y = ctx.viewY + ctx.viewDirY * Z_NEAR - ctx.nearPlaneHalfW * ctx.viewPerpY;
+    ctx.nearPlaneP2x = ctx.viewX + ctx.viewDirX * Z_NEAR + ctx.nearPlaneHalfW * ctx.viewPerpX;
+    ctx.nearPlaneP2y = ctx.viewY + ctx.viewDirY * Z_NEAR + ctx.nearPlaneHalfW * ctx.viewPerpY;
+    ctx.nearPlaneTz = ctx.viewZ + ctx.nearPlaneHalfH;
+    ctx.nearPlaneBz = ctx.viewZ - ctx.nearPlaneHalfH;
 
     // World X and Y step per column of screen pixels at the near plane
-    gNearPlaneXStepPerViewCol = (gNearPlaneP2x - gNearPlaneP1x) / ((float) g3dViewWidth);
-    gNearPlaneYStepPerViewCol = (gNearPlaneP2y - gNearPlaneP1y) / ((float) g3dViewWidth);
-    gNearPlaneZStepPerViewColPixel = (gNearPlaneBz - gNearPlaneTz) / ((float) g3dViewHeight);
+    ctx.nearPlaneXStepPerViewCol = (ctx.nearPlaneP2x - ctx.nearPlaneP1x) / ((float) ctx.viewWidth);
+    ctx.nearPlaneYStepPerViewCol = (ctx.nearPlaneP2y - ctx.nearPlaneP1y) / ((float) ctx.viewWidth);
+    ctx.nearPlaneZStepPerViewColPixel = (ctx.nearPlaneBz - ctx.nearPlaneTz) / ((float) ctx.viewHeight);
 
     // Clear render arrays & buffers
-    setupSegYClipArrayForDraw();
-    setupOccludingColumnsArrayForDraw();
-
-    gWallFragments.clear();
-    gFloorFragments.clear();
-    gCeilFragments.clear();
-    gSkyFragments.clear();
-    gDrawSprites.clear();
+    setupSegYClipArrayForDraw(ctx);
+    setupOccludingColumnsArrayForDraw(ctx);
+
+    ctx.wallFragments.clear();
+    ctx.floorFragments.clear();
+    ctx.ceilFragments.clear();
+    ctx.skyFragments.clear();
+    ctx.drawSprites.clear();
+
+    // Decide where the 3D view gets drawn to
+    ctx.target = target;
+
+    if (!ctx.colMajorPixels.empty()) {
+        ctx.p3dViewPixels = ctx.colMajorPixels.data();
+        ctx.pixelsColStride = ctx.viewHeight;
+        ctx.pixelsRowStride = 1;
+    } else {
+        ctx.p3dViewPixels = target.pPixels;
+        ctx.pixelsColStride = 1;
+        ctx.pixelsRowStride = target.pitch;
+    }
 
     // Other misc setup
-    gExtraLight = player.extralight << 6;       // Init the extra lighting value
+    ctx.extraLight = viewParams.extraLight;
+    ctx.bMarkDrawnLinesAsMapped = viewParams.bMarkDrawnLinesAsMapped;
+    ctx.bLoadMissingSprites = viewParams.bLoadMissingSprites;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// If the 3D view is being drawn to the column major 3D view buffer, transposes it into the (row major) render target.
+// The transpose is done in square tiles so that the columns being read from and the rows being written to both stay in the cache.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void copyColMajor3dViewToTarget(const RenderContext& ctx) noexcept {
+    if (ctx.colMajorPixels.empty())
+        return;
+
+    constexpr uint32_t TILE_SIZE = 32;
+
+    const uint32_t viewW = ctx.viewWidth;
+    const uint32_t viewH = ctx.viewHeight;
+    const uint32_t dstPitch = ctx.target.pitch;
+    const uint32_t* const pSrcPixels = ctx.colMajorPixels.data();
+    uint32_t* const pDstPixels = ctx.target.pPixels;
+
+    for (uint32_t tileY = 0; tileY < viewH; tileY += TILE_SIZE) {
+        const uint32_t tileEndY = std::min(tileY + TILE_SIZE, viewH);
+
+        for (uint32_t tileX = 0; tileX < viewW; tileX += TILE_SIZE) {
+            const uint32_t tileEndX = std::min(tileX + TILE_SIZE, viewW);
+            uint32_t y = tileY;
+
+            #if SIMD_USE_SSE2
+                // Transpose 4x4 blocks of pixels: load 4 pixels from each of 4 columns and store them as 4 pixels in each of 4 rows
+                for (; y + 4 <= tileEndY; y += 4) {
+                    uint32_t x = tileX;
+
+                    for (; x + 4 <= tileEndX; x += 4) {
+                        const uint32_t* const pSrcCol = pSrcPixels + (uintptr_t) x * viewH + y;
+                        const __m128i col0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrcCol));
+                        const __m128i col1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrcCol + viewH));
+                        const __m128i col2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrcCol + (uintptr_t) viewH * 2));
+                        const __m128i col3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSrcCol + (uintptr_t) viewH * 3));
+
+                        const __m128i rows01Lo = _mm_unpacklo_epi32(col0, col1);
+                        const __m128i rows01Hi = _mm_unpacklo_epi32(col2, col3);
+                        const __m128i rows23Lo = _mm_unpackhi_epi32(col0, col1);
+                        const __m128i rows23Hi = _mm_unpackhi_epi32(col2, col3);
+
+                        uint32_t* const pDstRow = pDstPixels + (uintptr_t) y * dstPitch + x;
+                        _mm_storeu_si128(reinterpret_cast<__m128i*>(pDstRow), _mm_unpacklo_epi64(rows01Lo, rows01Hi));
+                        _mm_storeu_si128(reinterpret_cast<__m128i*>(pDstRow + dstPitch), _mm_unpackhi_epi64(rows01Lo, rows01Hi));
+                        _mm_storeu_si128(reinterpret_cast<__m128i*>(pDstRow + (uintptr_t) dstPitch * 2), _mm_unpacklo_epi64(rows23Lo, rows23Hi));
+                        _mm_storeu_si128(reinterpret_cast<__m128i*>(pDstRow + (uintptr_t) dstPitch * 3), _mm_unpackhi_epi64(rows23Lo, rows23Hi));
+                    }
+
+                    // Leftover columns at the right edge of the view
+                    for (; x < tileEndX; ++x) {
+                        const uint32_t* const pSrcCol = pSrcPixels + (uintptr_t) x * viewH + y;
+
+                        for (uint32_t i = 0; i < 4; ++i) {
+                            pDstPixels[(uintptr_t)(y + i) * dstPitch + x] = pSrcCol[i];
+                        }
+                    }
+                }
+            #endif
+
+            // Leftover rows at the bottom of the tile (or everything, if SSE2 is not available)
+            for (; y < tileEndY; ++y) {
+                uint32_t* const pDstRow = pDstPixels + (uintptr_t) y * dstPitch;
+
+                for (uint32_t x = tileX; x < tileEndX; ++x) {
+                    pDstRow[x] = pSrcPixels[(uintptr_t) x * viewH + y];
+                }
+            }
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Reserves space in a new render context for a typical amount of things to draw, to avoid allocations while drawing the first frames
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void reserveRenderContextMemory(RenderContext& ctx) noexcept {
+    ctx.wallFragments.reserve(1024 * 8);
+    ctx.floorFragments.reserve(1024 * 8);
+    ctx.ceilFragments.reserve(1024 * 8);
+    ctx.skyFragments.reserve(1024);
+    ctx.drawSprites.reserve(128);
 }
 
 void init() noexcept {
     initData();     // Init resource managers and all of the lookup tables
-
-    // Fragment reserve
-    gWallFragments.reserve(1024 * 8);
-    gFloorFragments.reserve(1024 * 8);
-    gCeilFragments.reserve(1024 * 8);
-    gSkyFragments.reserve(1024);
-    gDrawSprites.reserve(128);
+    reserveRenderContextMemory(gPlayerViewContext);
 }
 
 void shutdown() noexcept {
-    // Nothing to do here yet...
+    gPlayerViewContext = {};
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Computes the light multiplier for the given light level and distance from the camera, for light diminishing effects.
+// This is the exact calculation which is used to build the light table.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static float computeLightMulForDist(const uint32_t lightLevel, const float dist) noexcept {
+    const float distFactorLinear = std::max(dist - gLightSubs[lightLevel], 0.0f);
+    const float distFactorQuad = std::sqrt(distFactorLinear);
+    const float lightDiminish = distFactorQuad * gLightCoefs[lightLevel];
+
+    float lightValue = 255.0f - lightDiminish;
+    lightValue = std::max(lightValue, gLightMins[lightLevel]);
+    lightValue = std::min(lightValue, (float) lightLevel);
+
+    const float lightMul = lightValue * (1.0f / MAX_LIGHT_VALUE);
+    return std::max(lightMul, MIN_LIGHT_MUL);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Builds the 2D light table from the per light level lighting parameters.
+// The table holds the light value for every light level at regularly spaced distances, so lighting is just a table lookup.
+// Light values are stored as 8-bit to keep the table small: this adds at most half a color level of error.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void initLightTable() noexcept {
+    constexpr uint32_t NUM_LIGHT_LEVELS = C_ARRAY_SIZE(gLightCoefs);
+
+    // Figure out the distance past which every light level is fully diminished, no need to store entries past that
+    float maxDist = 0.0f;
+
+    for (uint32_t lightLevel = 0; lightLevel < NUM_LIGHT_LEVELS; ++lightLevel) {
+        const float lightMin = std::max(gLightMins[lightLevel], MIN_LIGHT_MUL * MAX_LIGHT_VALUE);
+        const float sqrtDist = std::max(255.0f - lightMin, 0.0f) / gLightCoefs[lightLevel];
+        maxDist = std::max(maxDist, gLightSubs[lightLevel] + sqrtDist * sqrtDist);
+    }
+
+    // Fill in the table
+    gLightTableDistScale = (float) Config::gLightTableDistResolution;
+    gLightTableNumDists = (uint32_t) std::ceil(maxDist * gLightTableDistScale) + 1;
+    gLightTableMaxDistIdx = (float)(gLightTableNumDists - 1);
+    gLightTable.resize((size_t) NUM_LIGHT_LEVELS * gLightTableNumDists);
+
+    for (uint32_t lightLevel = 0; lightLevel < NUM_LIGHT_LEVELS; ++lightLevel) {
+        uint8_t* const pLightValues = &gLightTable[(size_t) lightLevel * gLightTableNumDists];
+
+        for (uint32_t distIdx = 0; distIdx < gLightTableNumDists; ++distIdx) {
+            const float lightMul = computeLightMulForDist(lightLevel, (float) distIdx / gLightTableDistScale);
+            pLightValues[distIdx] = (uint8_t) std::min(lightMul * MAX_LIGHT_VALUE + 0.5f, MAX_LIGHT_VALUE);
+        }
+    }
+
+    #if ASSERTS_ENABLED == 1
+        // Sanity check the table against the exact calculation for a selection of light levels.
+        // Quantizing distance to 1 world unit and light to 8-bits should never be off by more than a few color levels (worst case is
+        // up close in bright light).
+        constexpr float MAX_LIGHT_TABLE_ERROR = 3.0f / MAX_LIGHT_VALUE;
+
+        for (uint32_t lightLevel = 0; lightLevel < NUM_LIGHT_LEVELS; lightLevel += 15) {
+            const LightParams lightParams = getLightParams(lightLevel);
+
+            for (float dist = -1.0f; dist < maxDist + 16.0f; dist += 0.25f) {
+                const float error = std::abs(lightParams.getLightMulForDist(dist) - computeLightMulForDist(lightLevel, dist));
+                ASSERT(error <= MAX_LIGHT_TABLE_ERROR);
+            }
+        }
+    #endif
 }
 
 void initMathTables() noexcept {
@@ -262,40 +471,6 @@ void initMathTables() noexcept {
     gGunXScale = (float) g3dViewWidth / 320.0f;     // Get the 3DO scale factor for the gun shape and the y scale
     gGunYScale = (float) g3dViewHeight / 160.0f;
 
-    // Near plane width and height
-    gNearPlaneW = Z_NEAR * std::tan(FOV * 0.5f) * 2.0f;
-    gNearPlaneH = gNearPlaneW / VIEW_ASPECT_RATIO;
-    gNearPlaneHalfW = gNearPlaneW * 0.5f;
-    gNearPlaneHalfH = gNearPlaneH * 0.5f;
-
-    // Compute the partial projection matrix
-    {
-        // This is largely based on GLM's 'perspectiveRH_ZO' - see definition of 'ProjectionMatrix'
-        // for more details about these calculations:
-        const float f = std::tan(FOV * 0.5f);
-        const float a = VIEW_ASPECT_RATIO;
-
-        gProjMatrix.r0c0 = 1.0f / f;
-        gProjMatrix.r1c1 = -a / f;
-        gProjMatrix.r2c2 = -Z_FAR / (Z_NEAR - Z_FAR);
-        gProjMatrix.r2c3 = -(Z_NEAR * Z_FAR) / (Z_FAR - Z_NEAR);
-    }
-
-    // Compute the screen pixel to view angle table
-    gScreenXToAngleBAM.resize(g3dViewWidth);
-
-    {
-        float screenXToT = 1.0f / ((float) g3dViewWidth - 1.0f);
-
-        for (uint32_t x = 0; x < g3dViewWidth; ++x) {
-            const float t = ((float) x + 0.5f) * screenXToT;
-            const float nearPlaneX = t * gNearPlaneW - gNearPlaneHalfW;
-            const float angleRad = std::atan2(Z_NEAR, nearPlaneX);
-            const angle_t angleBAM = radiansToBamAngle(angleRad);
-            gScreenXToAngleBAM[x] = angleBAM;
-        }
-    }
-
     // Create the lighting tables
     for (uint32_t i = 0; i < 256; ++i) {
         constexpr float LIGHT_MIN_PERCENT = 1.0f / 5.0f;
@@ -310,42 +485,86 @@ void initMathTables() noexcept {
         gLightSubs[i] = maxBrightRange;
         gLightCoefs[i] = LIGHT_COEF_BASE - lightLevel * LIGHT_COEF_ADJUST_FACTOR;
     }
+
+    initLightTable();
 }
 
-void drawPlayerView() noexcept {
-    preDrawSetup();                 // Init variables based on camera angle
-    doBspTraversal();               // Traverse the BSP tree and build lists of walls, floors (visplanes) and sprites to render
-    drawAllSkyFragments();
-    drawAllFloorFragments();
-    drawAllCeilingFragments();
-    drawAllWallFragments();
-    drawAllSprites();
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Draws a 3D view using the given aspect ratio for the perspective projection
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void drawViewWithAspectRatio(
+    RenderContext& ctx,
+    const ViewParams& viewParams,
+    const RenderTarget& target,
+    const float aspectRatio
+) noexcept {
+    preDrawSetup(ctx, viewParams, target, aspectRatio);     // Init variables based on camera angle
+    doBspTraversal(ctx);                                    // Traverse the BSP tree and build lists of walls, floors (visplanes) and sprites to render
+    drawAllSkyFragments(ctx);
+    drawAllFloorFragments(ctx);
+    drawAllCeilingFragments(ctx);
+    drawAllWallFragments(ctx);
+    drawAllSprites(ctx);
+    copyColMajor3dViewToTarget(ctx);                        // If drawing to a column major buffer, move the 3D view into the target
+}
+
+void drawPlayerView(const angle_t lateTurnAngle) noexcept {
+    // Set the position and angle of the view from the player
+    const player_t& player = gPlayer;
+    const mobj_t& mapObj = *player.mo;
+
+    ViewParams viewParams = {};
+    viewParams.x = mapObj.x;
+    viewParams.y = mapObj.y;
+    viewParams.z = player.viewz;
+    viewParams.angle = mapObj.angle + lateTurnAngle;    // Note: includes late latched mouse turning (if any) sampled by the caller
+    viewParams.extraLight = player.extralight << 6;     // Init the extra lighting value
+    viewParams.bMarkDrawnLinesAsMapped = true;
+    viewParams.bLoadMissingSprites = true;
+
+    if (Config::gbAllowDebugCameraUpDownMovement) {
+        viewParams.z += floatToFixed16(gDebugCameraZOffset);
+    }
+
+    // Draw the 3D view to its area of the framebuffer.
+    // Note: the framebuffer pointer can change from frame to frame, so this must be redone every frame.
+    RenderTarget target = {};
+    target.pPixels = Video::gpFrameBuffer + (uintptr_t) g3dViewYOffset * Video::gScreenWidth + g3dViewXOffset;
+    target.width = g3dViewWidth;
+    target.height = g3dViewHeight;
+    target.pitch = Video::gScreenWidth;
+
+    // Note: the player view always uses the original aspect ratio for projection, regardless of the chosen screen size
+    drawViewWithAspectRatio(gPlayerViewContext, viewParams, target, VIEW_ASPECT_RATIO);
     drawWeapons();                  // Draw the weapons on top of the screen
     doPostFx();                     // Draw color overlay if needed
 }
 
-float LightParams::getLightMulForDist(const float dist) const noexcept {
-    const float distFactorLinear = std::max(dist - lightSub, 0.0f);
-    const float distFactorQuad = std::sqrt(distFactorLinear);
-    const float lightDiminish = distFactorQuad * lightCoef;
+RenderContext* createRenderContext() noexcept {
+    RenderContext* const pContext = new RenderContext();
+    reserveRenderContextMemory(*pContext);
+    return pContext;
+}
 
-    float lightValue = 255.0f - lightDiminish;
-    lightValue = std::max(lightValue, lightMin);
-    lightValue = std::min(lightValue, lightMax);
+void destroyRenderContext(RenderContext*& pContext) noexcept {
+    delete pContext;
+    pContext = nullptr;
+}
 
-    const float lightMul = lightValue * (1.0f / MAX_LIGHT_VALUE);
-    return std::max(lightMul, MIN_LIGHT_MUL);
+void drawView(RenderContext& ctx, const ViewParams& viewParams, const RenderTarget& target) noexcept {
+    // Scale the projection aspect ratio by how much wider or narrower the target is than the original 3D view.
+    // A target with the same shape as the original view looks the same as the player's view does.
+    ASSERT((target.width > 0) && (target.height > 0));
+    constexpr float REF_VIEW_ASPECT = (float) REFERENCE_3D_VIEW_WIDTH / (float) REFERENCE_3D_VIEW_HEIGHT;
+    const float targetAspect = (float) target.width / (float) target.height;
+    drawViewWithAspectRatio(ctx, viewParams, target, VIEW_ASPECT_RATIO * (targetAspect / REF_VIEW_ASPECT));
 }
 
 LightParams getLightParams(const uint32_t sectorLightLevel) noexcept {
-    const uint32_t lightMax = std::min(sectorLightLevel, (uint32_t) C_ARRAY_SIZE(gLightCoefs) - 1);
+    const uint32_t lightLevel = std::min(sectorLightLevel, (uint32_t) C_ARRAY_SIZE(gLightCoefs) - 1);
 
     LightParams out;
-    out.lightMin = gLightMins[lightMax];
-    out.lightMax = (float) lightMax;
-    out.lightSub = gLightSubs[lightMax];
-    out.lightCoef = gLightCoefs[lightMax];
-
+    out.pLightValues = &gLightTable[(size_t) lightLevel * gLightTableNumDists];
     return out;
 }
 
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "Base/Angle.h"
+#include "Base/Fixed.h"
 #include "Base/Macros.h"
 #include <cstdint>
 
@@ -12,10 +14,56 @@ extern float gDebugCameraZOffset;
 static constexpr uint32_t REFERENCE_3D_VIEW_WIDTH = 280;
 static constexpr uint32_t REFERENCE_3D_VIEW_HEIGHT = 160;
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Holds all of the state needed to render a 3D view: the viewpoint, the lists of things to draw, clipping info and so on.
+// Each context can render one view at a time, but separate contexts can be used to render different views in parallel on different threads.
+// The definition is internal to the renderer.
+//------------------------------------------------------------------------------------------------------------------------------------------
+struct RenderContext;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Where a 3D view is drawn to: XRGB8888 pixels stored row by row, with 'pitch' pixels from the start of one row to the next
+//------------------------------------------------------------------------------------------------------------------------------------------
+struct RenderTarget {
+    uint32_t*   pPixels;
+    uint32_t    width;
+    uint32_t    height;
+    uint32_t    pitch;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Describes the viewpoint for rendering a 3D view and some options for the render
+//------------------------------------------------------------------------------------------------------------------------------------------
+struct ViewParams {
+    Fixed       x;                              // View position
+    Fixed       y;
+    Fixed       z;
+    angle_t     angle;                          // View angle
+    uint32_t    extraLight;                     // Extra light added to all sectors (from gun blasts)
+    bool        bMarkDrawnLinesAsMapped;        // Reveal lines that were drawn on the automap? Only the player's view should do this.
+    bool        bLoadMissingSprites;            // Request loading of sprites that are not loaded yet? Must only be done on the main thread.
+};
+
 void init() noexcept;               // Initialize the renderer (done once)
 void shutdown() noexcept;
 
 void initMathTables() noexcept;     // Re-initialize the renderer math tables; must be done if screen size changes!
-void drawPlayerView() noexcept;     // Render the 3d view for the player
+
+// Render the 3d view for the player, with the given extra turning applied to the view angle.
+// The extra turning is for late latched mouse movement: the renderer itself never reads input.
+void drawPlayerView(const angle_t lateTurnAngle) noexcept;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Notes:
+//  (1) 'drawView' renders the 3D view for the given viewpoint into the given target, which can be any size.
+//      The projection is adjusted to the shape of the target so that the view is not stretched: a target with the same shape as the
+//      original 3D view (see 'REFERENCE_3D_VIEW_WIDTH/HEIGHT') is projected the same way as the player's view.
+//      It only draws the world and sprites: no player weapon or post effects.
+//  (2) Different contexts can be used with 'drawView' on different threads at the same time. While this is happening the game must
+//      not be updated and textures and sprites must not be loaded or freed, since the map data and assets are shared by all views.
+//------------------------------------------------------------------------------------------------------------------------------------------
+RenderContext* createRenderContext() noexcept;
+void destroyRenderContext(RenderContext*& pContext) noexcept;
+void drawView(RenderContext& ctx, const ViewParams& viewParams, const RenderTarget& target) noexcept;
 
 END_NAMESPACE(Renderer)
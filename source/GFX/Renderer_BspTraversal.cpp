@@ -14,14 +14,16 @@ BEGIN_NAMESPACE(Renderer)
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Given a sector pointer, and if I hadn't already rendered the sprites, make valid sprites for the sprite list.
 //------------------------------------------------------------------------------------------------------------------------------------------
-static void addSectorSpritesToFrame(sector_t& sector) noexcept {
-    if (sector.validcount != gValidCount) {     // Has this been processed?
-        sector.validcount = gValidCount;        // Mark it
+static void addSectorSpritesToFrame(RenderContext& ctx, const sector_t& sector) noexcept {
+    uint32_t& sectorValidCount = ctx.sectorValidCounts[&sector - gpSectors];
+
+    if (sectorValidCount != ctx.validCount) {   // Has this been processed?
+        sectorValidCount = ctx.validCount;      // Mark it
         mobj_t* pThing = sector.thinglist;      // Init the thing list
 
         // Traverse the linked list and add each sprite
         while (pThing) {
-            addSpriteToFrame(*pThing);
+            addSpriteToFrame(ctx, *pThing);
             pThing = pThing->snext;
         }
     }
@@ -30,16 +32,16 @@ static void addSectorSpritesToFrame(sector_t& sector) noexcept {
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Given a subsector pointer, pass all walls to the rendering engine. Also pass all the sprites.
 //------------------------------------------------------------------------------------------------------------------------------------------
-static void addSubsectorToFrame(subsector_t& sub) noexcept {
-    sector_t& sector = *sub.sector;     // Get the front sector
-    addSectorSpritesToFrame(sector);    // Prepare sprites for rendering
+static void addSubsectorToFrame(RenderContext& ctx, subsector_t& sub) noexcept {
+    sector_t& sector = *sub.sector;         // Get the front sector
+    addSectorSpritesToFrame(ctx, sector);   // Prepare sprites for rendering
 
     // Pass all line segments in the subsector to the renderer
     seg_t* pLineSeg = sub.firstline;
     seg_t* const pEndLineSeg = pLineSeg + sub.numsublines;
 
     while (pLineSeg < pEndLineSeg) {
-        addSegToFrame(*pLineSeg);
+        addSegToFrame(ctx, *pLineSeg);
         ++pLineSeg;
     }
 }
@@ -47,13 +49,13 @@ static void addSubsectorToFrame(subsector_t& sub) noexcept {
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Transform a 2d xy point to view space
 //------------------------------------------------------------------------------------------------------------------------------------------
-static inline void transformXYPointToViewSpace(vertexf_t& point) noexcept {
+static inline void transformXYPointToViewSpace(const RenderContext& ctx, vertexf_t& point) noexcept {
     // Transform by view position and then view angle; similar to the code in other render functions:
-    point.x -= gViewX;
-    point.y -= gViewY;
+    point.x -= ctx.viewX;
+    point.y -= ctx.viewY;
 
-    const float viewCos = gViewCos;
-    const float viewSin = gViewSin;
+    const float viewCos = ctx.viewCos;
+    const float viewSin = ctx.viewSin;
     const float rotatedX = viewCos * point.x - viewSin * point.y;
     const float rotatedY = viewSin * point.x + viewCos * point.y;
 
@@ -65,19 +67,19 @@ static inline void transformXYPointToViewSpace(vertexf_t& point) noexcept {
 // Transform a 2d xy point to clip space.
 // The 'y' component becomes the 'w' component in clip space.
 //------------------------------------------------------------------------------------------------------------------------------------------
-static inline void transformXYPointToClipSpace(vertexf_t& point) noexcept {
+static inline void transformXYPointToClipSpace(const RenderContext& ctx, vertexf_t& point) noexcept {
     // Notes:
     //  (1) We treat 'y' as if it were 'z' for the purposes of these calculations, since the
     //      projection matrix has 'z' as the depth value and not y (Doom coord sys).
     //  (2) We assume that the point always starts off with an implicit 'w' value of '1'.
     //  (3) W = Y in this calculation, so I don't bother assigning to it.
-    point.x *= gProjMatrix.r0c0;
+    point.x *= ctx.projMatrix.r0c0;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Some basic rejection checks to see if we should process a BSP node.
 //------------------------------------------------------------------------------------------------------------------------------------------
-static bool checkBBox(const Fixed bspcoord[BOXCOUNT]) noexcept {
+static bool checkBBox(const RenderContext& ctx, const Fixed bspcoord[BOXCOUNT]) noexcept {
     // Get the float coords first
     const float boxLx = fixed16ToFloat(bspcoord[BOXLEFT]);
     const float boxRx = fixed16ToFloat(bspcoord[BOXRIGHT]);
@@ -89,10 +91,10 @@ static bool checkBBox(const Fixed bspcoord[BOXCOUNT]) noexcept {
     vertexf_t p2 = { boxRx, boxTy };
     vertexf_t p3 = { boxRx, boxBy };
     vertexf_t p4 = { boxLx, boxBy };
-    transformXYPointToViewSpace(p1);
-    transformXYPointToViewSpace(p2);
-    transformXYPointToViewSpace(p3);
-    transformXYPointToViewSpace(p4);
+    transformXYPointToViewSpace(ctx, p1);
+    transformXYPointToViewSpace(ctx, p2);
+    transformXYPointToViewSpace(ctx, p3);
+    transformXYPointToViewSpace(ctx, p4);
 
     // If all are behind the camera then we can ignore completely
     const bool bAllPtsBehind = (
@@ -106,10 +108,10 @@ static bool checkBBox(const Fixed bspcoord[BOXCOUNT]) noexcept {
         return false;
     
     // Transform to clip space and see if the box is offscreen to the left or right
-    transformXYPointToClipSpace(p1);
-    transformXYPointToClipSpace(p2);
-    transformXYPointToClipSpace(p3);
-    transformXYPointToClipSpace(p4);
+    transformXYPointToClipSpace(ctx, p1);
+    transformXYPointToClipSpace(ctx, p2);
+    transformXYPointToClipSpace(ctx, p3);
+    transformXYPointToClipSpace(ctx, p4);
 
     // See if all the points are either to the left or right of the view frustrum left and right planes.
     // 'y' is now actually the 'w' coordinate value in clip space, so we can do normal clipspace checks here:
@@ -141,27 +143,27 @@ static bool checkBBox(const Fixed bspcoord[BOXCOUNT]) noexcept {
 // Traverse the BSP tree starting from a tree node (Or sector) and recursively subdivide if needed.
 // Use a cross product from the line cast from the viewxy to the bspxy and the bsp line itself.
 //------------------------------------------------------------------------------------------------------------------------------------------
-static void addBspNodeToFrame(node_t* const pNode) noexcept {
+static void addBspNodeToFrame(RenderContext& ctx, node_t* const pNode) noexcept {
     // Is this node actual pointing to a sub sector?
     if (isBspNodeASubSector(pNode)) {
         // Process the sub sector.
         // N.B: Need to fix up the pointer as well due to the lowest bit set as a flag!
         subsector_t* const pSubSector = (subsector_t*) getActualBspNodePtr(pNode);
-        addSubsectorToFrame(*pSubSector);
+        addSubsectorToFrame(ctx, *pSubSector);
         return;
     }
     
     // If we have filled the screen then exit now - don't traverse the BSP any further
-    if (gNumFullSegCols >= g3dViewWidth)
+    if (ctx.numFullSegCols >= ctx.viewWidth)
         return;
     
     // Decide which side the view point is on
-    uint32_t side = PointOnVectorSide(gViewXFrac, gViewYFrac, pNode->Line);     // Is this the front side?
-    addBspNodeToFrame((node_t*) pNode->Children[side]);                         // Process the side closer to me
-    side ^= 1;                                                                  // Swap the side
+    uint32_t side = PointOnVectorSide(ctx.viewXFrac, ctx.viewYFrac, pNode->Line);   // Is this the front side?
+    addBspNodeToFrame(ctx, (node_t*) pNode->Children[side]);                        // Process the side closer to me
+    side ^= 1;                                                                      // Swap the side
 
-    if (checkBBox(pNode->bbox[side])) {                         // Is the viewing rect on both sides?
-        addBspNodeToFrame((node_t*) pNode->Children[side]);     // Render the back side
+    if (checkBBox(ctx, pNode->bbox[side])) {                        // Is the viewing rect on both sides?
+        addBspNodeToFrame(ctx, (node_t*) pNode->Children[side]);    // Render the back side
     }
 }
 
@@ -169,9 +171,9 @@ static void addBspNodeToFrame(node_t* const pNode) noexcept {
 // Find all walls that can be rendered in the current view plane. I make it handle the whole
 // screen by placing fake posts on the farthest left and right sides in solidsegs 0 and 1.
 //------------------------------------------------------------------------------------------------------------------------------------------
-void doBspTraversal() noexcept {
-    ++gValidCount;                          // For sprite recursion
-    addBspNodeToFrame(gpBSPTreeRoot);       // Begin traversing the BSP tree for all walls in render range
+void doBspTraversal(RenderContext& ctx) noexcept {
+    ++ctx.validCount;                           // For sprite recursion
+    addBspNodeToFrame(ctx, gpBSPTreeRoot);      // Begin traversing the BSP tree for all walls in render range
 }
 
 END_NAMESPACE(Renderer)
@@ -3,7 +3,6 @@
 #include "Base/Tables.h"
 #include "Blit.h"
 #include "Textures.h"
-#include "Video.h"
 
 BEGIN_NAMESPACE(Renderer)
 
@@ -70,22 +69,28 @@ static inline void doRayFlatPlaneIntersection(
 // columns into horizontal ones.
 //------------------------------------------------------------------------------------------------------------------------------------------
 template <DrawFlatMode MODE>
-static inline void drawFlatColumn(const FlatFragment flatFrag) noexcept {
+static inline void drawFlatColumn(const RenderContext& ctx, const FlatFragment flatFrag) noexcept {
     // Cache some useful values
-    const float viewX = gViewX;
-    const float viewY = gViewY;
-    const float viewZ = gViewZ;
+    const float viewX = ctx.viewX;
+    const float viewY = ctx.viewY;
+    const float viewZ = ctx.viewZ;
     const float flatPlaneZ = flatFrag.worldZ;
-    const float nearPlaneTz = gNearPlaneTz;
-    const float nearPlaneZStep = gNearPlaneZStepPerViewColPixel;
+    const float nearPlaneTz = ctx.nearPlaneTz;
+    const float nearPlaneZStep = ctx.nearPlaneZStepPerViewColPixel;
 
     const LightParams& lightParams = getLightParams(flatFrag.sectorLightLevel);
-    const uint16_t* const pSrcPixels = flatFrag.pImageData->pPixels;
+    const Texture& texture = *flatFrag.pTexture;
+
+    // Distances at which to switch to smaller mip levels, if the texture has them
+    const uint32_t numMipLevels = texture.numMipLevels;
+    const float mipLevel1Dist = (numMipLevels > 1) ? ctx.flatMipLevelDists[0] : INFINITY;
+    const float mipLevel2Dist = (numMipLevels > 2) ? ctx.flatMipLevelDists[1] : INFINITY;
+    const float mipLevel3Dist = (numMipLevels > 3) ? ctx.flatMipLevelDists[2] : INFINITY;
 
     // The x and y coordinate in world space of the screen column being drawn.
     // Note: take the horizontal center position of the pixel to improve accuracy, hence + 0.5 here:
-    const float nearPlaneX = gNearPlaneP1x + ((float) flatFrag.x + 0.5f) * gNearPlaneXStepPerViewCol;
-    const float nearPlaneY = gNearPlaneP1y + ((float) flatFrag.x + 0.5f) * gNearPlaneYStepPerViewCol;
+    const float nearPlaneX = ctx.nearPlaneP1x + ((float) flatFrag.x + 0.5f) * ctx.nearPlaneXStepPerViewCol;
+    const float nearPlaneY = ctx.nearPlaneP1y + ((float) flatFrag.x + 0.5f) * ctx.nearPlaneYStepPerViewCol;
 
     // Compute the xz direction of the ray going from the view through this screen column.
     // Since this is constant per screen column pixel, we only need to do this once here:
@@ -105,9 +110,6 @@ static inline void drawFlatColumn(const FlatFragment flatFrag) noexcept {
         endDstY = (int32_t)(flatFrag.y - 1);
     }
 
-    const uint32_t startScreenX = g3dViewXOffset + flatFrag.x;
-    const uint32_t startScreenY = g3dViewYOffset + (uint32_t) curDstY;
-
     // This is where we store the intersection of a ray going from the view point to the flat plane.
     // The ray passes through whatever near plane pixel on the screen we are rendering and we update
     // the ray and location of intersection for whatever pixel we are drawing...
@@ -143,8 +145,8 @@ static inline void drawFlatColumn(const FlatFragment flatFrag) noexcept {
     }
 
     // Draw the column!
-    const uint32_t screenWidth = Video::gScreenWidth;
-    uint32_t* pDstPixel = Video::gpFrameBuffer + (uintptr_t) startScreenY * screenWidth + startScreenX;
+    const uint32_t dstRowStride = ctx.pixelsRowStride;
+    uint32_t* pDstPixel = get3dViewColumnPixels(ctx, flatFrag.x) + (uintptr_t) curDstY * dstRowStride;
 
     while (true) {
         // Are we done?
@@ -156,19 +158,30 @@ static inline void drawFlatColumn(const FlatFragment flatFrag) noexcept {
                 break;
         }
 
+        // Get the distance to the view point and use it to decide which mip level to sample from
+        const float distToView = FMath::distance3d(intersectX, intersectY, intersectZ, viewX, viewY, viewZ);
+        const uint32_t mipLevel = (
+            (uint32_t)(distToView >= mipLevel1Dist) +
+            (uint32_t)(distToView >= mipLevel2Dist) +
+            (uint32_t)(distToView >= mipLevel3Dist)
+        );
+
         // Get the source pixel (ARGB1555 format).
-        // Note that the flat texture is always expected to be 64x64, hence we can wraparound with a simple bitwise AND:
-        const uint32_t curSrcXInt = (uint32_t) intersectX & 63;
-        const uint32_t curSrcYInt = (uint32_t) intersectY & 63;
-        const uint16_t srcPixelARGB1555 = pSrcPixels[curSrcYInt * 64 + curSrcXInt];
+        // Note that the flat texture is always expected to be 64x64, hence we can wraparound with a simple bitwise AND.
+        // Each mip level halves the size of the texture, so the texture coordinate and row size are scaled down to match:
+        // If the texture uses indexed color then the pixel is looked up in the texture's color lookup table.
+        const ImageData& srcImage = texture.getMipLevel(mipLevel);
+        const uint32_t curSrcXInt = ((uint32_t) intersectX & 63) >> mipLevel;
+        const uint32_t curSrcYInt = ((uint32_t) intersectY & 63) >> mipLevel;
+        const uint32_t srcPixelIdx = curSrcYInt * (64 >> mipLevel) + curSrcXInt;
+        const uint16_t srcPixelARGB1555 = (srcImage.pColorIdxs) ? srcImage.pPLUT[srcImage.pColorIdxs[srcPixelIdx]] : srcImage.pPixels[srcPixelIdx];
 
         // Extract RGB components and shift such that the maximum value is 255 instead of 31.
         const uint16_t texR = (uint16_t)((srcPixelARGB1555 & uint16_t(0b0111110000000000)) >> 7);
         const uint16_t texG = (uint16_t)((srcPixelARGB1555 & uint16_t(0b0000001111100000)) >> 2);
         const uint16_t texB = (uint16_t)((srcPixelARGB1555 & uint16_t(0b0000000000011111)) << 3);
 
-        // Get the distance to the view point and light multiplier for that distance
-        const float distToView = FMath::distance3d(intersectX, intersectY, intersectZ, viewX, viewY, viewZ);
+        // Get the light multiplier for the distance to the view point
         const float lightMul = lightParams.getLightMulForDist(distToView);
 
         // Get the texture colors in 0-255 float format.
@@ -188,10 +201,10 @@ static inline void drawFlatColumn(const FlatFragment flatFrag) noexcept {
         // Move onto the next pixel
         if constexpr (MODE == DrawFlatMode::FLOOR) {
             ++curDstY;
-            pDstPixel += screenWidth;
+            pDstPixel += dstRowStride;
         } else {
             --curDstY;
-            pDstPixel -= screenWidth;
+            pDstPixel -= dstRowStride;
         }
 
         // Compute the ray/plane intersection for the upcoming pixel to get its texture coordinate
@@ -216,15 +229,15 @@ static inline void drawFlatColumn(const FlatFragment flatFrag) noexcept {
     }
 }
 
-void drawAllFloorFragments() noexcept {
-    for (const FlatFragment& flatFrag : gFloorFragments) {
-        drawFlatColumn<DrawFlatMode::FLOOR>(flatFrag);
+void drawAllFloorFragments(RenderContext& ctx) noexcept {
+    for (const FlatFragment& flatFrag : ctx.floorFragments) {
+        drawFlatColumn<DrawFlatMode::FLOOR>(ctx, flatFrag);
     }
 }
 
-void drawAllCeilingFragments() noexcept {
-    for (const FlatFragment& flatFrag : gCeilFragments) {
-        drawFlatColumn<DrawFlatMode::CEILING>(flatFrag);
+void drawAllCeilingFragments(RenderContext& ctx) noexcept {
+    for (const FlatFragment& flatFrag : ctx.ceilFragments) {
+        drawFlatColumn<DrawFlatMode::CEILING>(ctx, flatFrag);
     }
 }
 
@@ -7,6 +7,7 @@
 #include "Base/Angle.h"
 #include "Game/DoomDefines.h"
 #include "Renderer.h"
+#include <algorithm>
 #include <cstddef>
 #include <vector>
 
@@ -15,6 +16,7 @@ struct line_t;
 struct mobj_t;
 struct seg_t;
 struct SpriteFrameAngle;
+struct SpriteSpan;
 struct Texture;
 
 namespace Renderer {
@@ -60,14 +62,11 @@ namespace Renderer {
     // Describes lighting params for an input light level
     //------------------------------------------------------------------------------------------------------------------
     struct LightParams {
-        float   lightMin;       // Minimum light value allowed
-        float   lightMax;       // Maximum light value allowed
-        float   lightSub;       // Subtract this as part of the light diminishing calculations
-        float   lightCoef;      // Controls the falloff for light diminishing
+        const uint8_t*  pLightValues;   // Row of the light table for this light level: light values (0-255) at regularly spaced distances
 
         // For these light parameters, gives a light multiplier that can be applied to textures etc.
         // after doing light diminishing effects. Requires the distance of the object from the camera.
-        float getLightMulForDist(const float dist) const noexcept;
+        inline float getLightMulForDist(const float dist) const noexcept;
     };
 
     //------------------------------------------------------------------------------------------------------------------
@@ -176,6 +175,8 @@ namespace Renderer {
     //------------------------------------------------------------------------------------------------------------------
     struct DrawSprite {
         const uint16_t*     pPixels;            // Pixels for the sprite (in column major format)
+        const uint32_t*     pColSpanIdxs;       // Where each column's opaque spans start in 'pSpans' (see 'SpriteFrameAngle')
+        const SpriteSpan*   pSpans;             // Runs of opaque pixels in each column of the sprite
         float               worldX;             // World center X position of the sprite (used for occlusion tests)
         float               worldY;             // World center Y position of the sprite (used for occlusion tests)
         float               screenLx;           // Left and right screen X values
@@ -204,6 +205,8 @@ namespace Renderer {
         float               texYStep;               // Stepping to use for the 'Y' texture coordinate
         float               texYSubPixelAdjust;     // Sub-pixel adjustment for 'Y' texture coordinate. Applied to every pixel after the first.
         const uint16_t*     pSpriteColPixels;       // The image data for the sprite (in column major format)
+        const SpriteSpan*   pOpaqueSpans;           // The runs of opaque pixels in the sprite column: only these parts of the column need to be drawn
+        uint32_t            numOpaqueSpans;
         float               spriteWorldX;           // World center of the sprite: X
         float               spriteWorldY;           // World center of the sprite: Y
     };
@@ -273,71 +276,161 @@ namespace Renderer {
         float               worldX;                 // World position at the wall which the column was generated at
         float               worldY;
         float               worldZ;
-        const ImageData*    pImageData;
+        const Texture*      pTexture;               // The flat texture, which has the image data for each mip level
+    };
+
+    //------------------------------------------------------------------------------------------------------------------
+    // Interpolated attributes for a single screen column of a seg that is being emitted.
+    // Some of these are unused depending on what types of fragments the seg emits.
+    //------------------------------------------------------------------------------------------------------------------
+    struct SegColumnAttribs {
+        uint32_t    x;          // Screen column
+        float       depth;      // Depth of the seg at this column
+        float       texX;       // X texture coordinate (walls)
+        float       worldX;     // World X and Y of the seg at this column (floors)
+        float       worldY;
+        float       upperTz;    // Top and bottom Z values for walls and floors
+        float       upperBz;
+        float       lowerTz;
+        float       lowerBz;
+    };
+
+    //------------------------------------------------------------------------------------------------------------------
+    // Per view info for a line in the map, recorded when the line is drawn and used later for sprite clipping.
+    // Kept separately for each render context rather than in the line itself so that multiple views can be drawn at once.
+    //------------------------------------------------------------------------------------------------------------------
+    struct LineDrawInfo {
+        float       v1DrawDepth;            // Depth of v1 and v2 when drawn
+        float       v2DrawDepth;
+        uint32_t    validCount;             // Matches the context's 'validCount' if 'bIsInFrontOfSprite' is up to date for the current sprite
+        uint8_t     drawnSideIndex;         // Which side of the line is being rendered
+        bool        bIsInFrontOfSprite;     // Used during sprite clipping: stores if the line is considered in front of the sprite
+    };
+
+    //------------------------------------------------------------------------------------------------------------------
+    // All of the state for rendering a 3D view.
+    // Each 3D view currently being drawn needs its own context, see 'Renderer.h'.
+    //------------------------------------------------------------------------------------------------------------------
+    struct RenderContext {
+        // Viewpoint and options
+        Fixed                           viewXFrac;                          // Camera x,y,z
+        Fixed                           viewYFrac;
+        Fixed                           viewZFrac;
+        float                           viewX;                              // Camera x,y,z
+        float                           viewY;
+        float                           viewZ;
+        float                           viewDirX;                           // View 2D forward/direction vector
+        float                           viewDirY;
+        float                           viewPerpX;                          // View 2D perpendicular/right vector
+        float                           viewPerpY;
+        angle_t                         viewAngleBAM;                       // Camera angle
+        float                           viewAngle;                          // Camera angle
+        Fixed                           viewCosFrac;                        // Camera sine, cosine from angle
+        Fixed                           viewSinFrac;
+        float                           viewCos;                            // Camera sine, cosine from angle
+        float                           viewSin;
+        float                           nearPlaneP1x;                       // Near plane left side x,y
+        float                           nearPlaneP1y;
+        float                           nearPlaneP2x;                       // Near plane right side x,y
+        float                           nearPlaneP2y;
+        float                           nearPlaneTz;                        // Near plane top and bottom z
+        float                           nearPlaneBz;
+        float                           nearPlaneXStepPerViewCol;           // How much to step world x and y for each successive screen column of pixels at the near plane
+        float                           nearPlaneYStepPerViewCol;
+        float                           nearPlaneZStepPerViewColPixel;      // How much to step world z for each successive pixel in a screen column at the near plane
+        uint32_t                        extraLight;                         // Bumped light from gun blasts
+        bool                            bMarkDrawnLinesAsMapped;            // Reveal drawn lines on the automap?
+        bool                            bLoadMissingSprites;                // Request loading of sprites that are not loaded yet?
+
+        // The size of the view and tables that depend on it
+        uint32_t                        viewWidth;                          // Size of the 3D view in pixels
+        uint32_t                        viewHeight;
+        std::vector<angle_t>            screenXToAngleBAM;                  // Convert from a screen X coordinate to a Doom format (BAM) angle
+        float                           flatMipLevelDists[3];               // Distance from the view at which flats switch to mip level 1, 2 and 3
+        float                           nearPlaneW;                         // Width and height of the near plane
+        float                           nearPlaneH;
+        float                           nearPlaneHalfW;                     // Half width and height of the near plane
+        float                           nearPlaneHalfH;
+        ProjectionMatrix                projMatrix;                         // 3D projection matrix for the view's aspect ratio
+
+        // Where the view is drawn to
+        RenderTarget                    target;                             // The final destination for the view
+        uint32_t*                       p3dViewPixels;                      // Top left pixel of where the 3D view is drawn to: either the target or the column major 3D view buffer
+        uint32_t                        pixelsColStride;                    // How many pixels to skip to move right one column in the 3D view render target
+        uint32_t                        pixelsRowStride;                    // How many pixels to skip to move down one row in the 3D view render target
+        std::vector<uint32_t>           colMajorPixels;                     // Column major render target for the 3D view (if enabled), transposed into the target once the view is drawn
+
+        // Clipping and things to draw
+        std::vector<SegClip>            segClip;                            // Used to clip seg columns (walls + floors) vertically as segs are being submitted. One entry per screen column.
+        std::vector<OccludingColumns>   occludingCols;                      // Used to clip sprite columns. One entry per screen column.
+        uint32_t                        numFullSegCols;                     // The number of columns that will accept no more seg pixels. Used to stop emitting segs when we have filled the screen.
+        std::vector<SegColumnAttribs>   segColumnAttribs;                   // The attributes for each visible column of the seg currently being emitted
+        std::vector<WallFragment>       wallFragments;                      // Wall fragments to be drawn
+        std::vector<FlatFragment>       floorFragments;                     // Floor fragments to be drawn
+        std::vector<FlatFragment>       ceilFragments;                      // Ceiling fragments to be drawn
+        std::vector<SkyFragment>        skyFragments;                       // Sky fragments to be drawn
+        std::vector<DrawSprite>         drawSprites;                        // Sprites to be drawn that will later be turned into fragments (after depth sort)
+
+        // Per view info for map lines and sectors (indexed by line and sector number)
+        std::vector<LineDrawInfo>       lineDrawInfos;                      // Info recorded for each line when it is drawn
+        std::vector<uint32_t>           sectorValidCounts;                  // Set to 'validCount' once a sector's sprites have been added to the frame
+        uint32_t                        validCount;                         // Incremented to invalidate the per line and sector marks
+
+        // The sky texture pre-scaled to the height of the 3D view and converted to XRGB8888, stored column by column.
+        // Rebuilt whenever the sky texture or the 3D view height changes.
+        // Note: the texture number is checked as well as the data pointer, since after textures are freed between maps a
+        // different sky texture might be loaded at the same address.
+        std::vector<uint32_t>           skyColumnCache;
+        uint32_t                        skyCacheTexNum;
+        const void*                     pSkyCacheSrcData;
+        uint32_t                        skyCacheNumCols;
+        uint32_t                        skyCacheColHeight;
     };
 
     //==================================================================================================================
-    // Globals shared throughout the renderer - defined in Renderer.cpp
+    // Globals shared by all render contexts - defined in Renderer.cpp
     //==================================================================================================================
 
-    extern Fixed                            gViewXFrac;                         // Camera x,y,z
-    extern Fixed                            gViewYFrac;
-    extern Fixed                            gViewZFrac;
-    extern float                            gViewX;                             // Camera x,y,z
-    extern float                            gViewY;
-    extern float                            gViewZ;
-    extern float                            gViewDirX;                          // View 2D forward/direction vector
-    extern float                            gViewDirY;
-    extern float                            gViewPerpX;                         // View 2D perpendicular/right vector
-    extern float                            gViewPerpY;
-    extern angle_t                          gViewAngleBAM;                      // Camera angle
-    extern float                            gViewAngle;                         // Camera angle
-    extern Fixed                            gViewCosFrac;                       // Camera sine, cosine from angle
-    extern Fixed                            gViewSinFrac;
-    extern float                            gViewCos;                           // Camera sine, cosine from angle
-    extern float                            gViewSin;
-    extern float                            gNearPlaneW;                        // Width and height of the near plane
-    extern float                            gNearPlaneH;
-    extern float                            gNearPlaneHalfW;                    // Half width and height of the near plane
-    extern float                            gNearPlaneHalfH;
-    extern float                            gNearPlaneP1x;                      // Near plane left side x,y
-    extern float                            gNearPlaneP1y;
-    extern float                            gNearPlaneP2x;                      // Near plane right side x,y
-    extern float                            gNearPlaneP2y;
-    extern float                            gNearPlaneTz;                       // Near plane top and bottom z
-    extern float                            gNearPlaneBz;
-    extern float                            gNearPlaneXStepPerViewCol;          // How much to step world x and y for each successive screen column of pixels at the near plane
-    extern float                            gNearPlaneYStepPerViewCol;
-    extern float                            gNearPlaneZStepPerViewColPixel;     // How much to step world z for each successive pixel in a screen column at the near plane
-    extern ProjectionMatrix                 gProjMatrix;                        // 3D projection matrix
-    extern uint32_t                         gExtraLight;                        // Bumped light from gun blasts
-    extern std::vector<angle_t>             gScreenXToAngleBAM;                 // Convert from a screen X coordinate to a Doom format (BAM) angle
-    extern std::vector<DrawSeg>             gDrawSegs;
-    extern std::vector<SegClip>             gSegClip;                           // Used to clip seg columns (walls + floors) vertically as segs are being submitted. One entry per screen column.
-    extern std::vector<OccludingColumns>    gOccludingCols;                     // Used to clip sprite columns. One entry per screen column.
-    extern uint32_t                         gNumFullSegCols;                    // The number of columns that will accept no more seg pixels. Used to stop emitting segs when we have filled the screen.
-    extern std::vector<WallFragment>        gWallFragments;                     // Wall fragments to be drawn
-    extern std::vector<FlatFragment>        gFloorFragments;                    // Floor fragments to be drawn
-    extern std::vector<FlatFragment>        gCeilFragments;                     // Ceiling fragments to be drawn
-    extern std::vector<SkyFragment>         gSkyFragments;                      // Sky fragments to be drawn
-    extern std::vector<DrawSprite>          gDrawSprites;                       // Sprites to be drawn that will later be turned into fragments (after depth sort)
+    extern std::vector<uint8_t>             gLightTable;                        // Light values for each of the 256 light levels, with 'gLightTableNumDists' distances per light level
+    extern uint32_t                         gLightTableNumDists;                // Number of distances in the light table for each light level
+    extern float                            gLightTableDistScale;               // Multiply a distance by this to get a light table distance index
+    extern float                            gLightTableMaxDistIdx;              // The last distance index in the light table, as a float
     
     //==================================================================================================================
     // Functions
     //==================================================================================================================
 
-    void doBspTraversal() noexcept;
-    void addSegToFrame(seg_t& seg) noexcept;
-    void addSpriteToFrame(const mobj_t& thing) noexcept;
-    void drawAllLineSegs() noexcept;
-    void drawAllWallFragments() noexcept;
-    void drawAllFloorFragments() noexcept;
-    void drawAllCeilingFragments() noexcept;
-    void drawAllSkyFragments() noexcept;
-    void drawAllSprites() noexcept;
+    void doBspTraversal(RenderContext& ctx) noexcept;
+    void addSegToFrame(RenderContext& ctx, seg_t& seg) noexcept;
+    void addSpriteToFrame(RenderContext& ctx, const mobj_t& thing) noexcept;
+    void drawAllWallFragments(RenderContext& ctx) noexcept;
+    void drawAllFloorFragments(RenderContext& ctx) noexcept;
+    void drawAllCeilingFragments(RenderContext& ctx) noexcept;
+    void drawAllSkyFragments(RenderContext& ctx) noexcept;
+    void drawAllSprites(RenderContext& ctx) noexcept;
     void drawWeapons() noexcept;
     void doPostFx() noexcept;
 
     // Get light parameters for a floor or wall at the given light level
     LightParams getLightParams(const uint32_t sectorLightLevel) noexcept;
+
+    //------------------------------------------------------------------------------------------------------------------
+    // Looks up the light multiplier for the given distance in the light table, using the nearest distance in the table.
+    // Distances past the end of the table are fully diminished, so they just use the last entry.
+    // Note: the table stores 8-bit light values to save memory, so the minimum multiplier is re-applied after converting.
+    //------------------------------------------------------------------------------------------------------------------
+    inline float LightParams::getLightMulForDist(const float dist) const noexcept {
+        const float distIdx = std::min(std::max(dist * gLightTableDistScale + 0.5f, 0.0f), gLightTableMaxDistIdx);
+        const float lightMul = (float) pLightValues[(uint32_t) distIdx] * (1.0f / MAX_LIGHT_VALUE);
+        return std::max(lightMul, MIN_LIGHT_MUL);
+    }
+
+    //------------------------------------------------------------------------------------------------------------------
+    // Gives the top pixel of the given column in the 3D view render target for the given context.
+    // Successive pixels in the column are 'pixelsRowStride' pixels apart, which is just 1 for a column major target.
+    // Column drawing code can treat the column as a 1 pixel wide image and work with either type of render target.
+    //------------------------------------------------------------------------------------------------------------------
+    inline uint32_t* get3dViewColumnPixels(const RenderContext& ctx, const uint32_t viewX) noexcept {
+        return ctx.p3dViewPixels + (uintptr_t) viewX * ctx.pixelsColStride;
+    }
 }
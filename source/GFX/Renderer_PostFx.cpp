@@ -1,5 +1,6 @@
 #include "Renderer_Internal.h"
 
+#include "Base/Simd.h"
 #include "Base/Tables.h"
 #include "Game/Data.h"
 #include "Video.h"
@@ -7,68 +8,104 @@
 
 BEGIN_NAMESPACE(Renderer)
 
-static void doInvulnerabilityEffect() noexcept {
-    // The invunerability effect in 3DO Doom was a simple bit inverse.
-    // The 3DO game did not use the palette switching technique that the PC version did because there was no palette...
-    const uint32_t viewH = g3dViewHeight;
-    const uint32_t screenH = Video::gScreenWidth;
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Inverts the RGB values for a row of pixels, for the invulnerability effect.
+// The invunerability effect in 3DO Doom was a simple bit inverse.
+// The 3DO game did not use the palette switching technique that the PC version did because there was no palette...
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void invertPixelRow(uint32_t* const pPixels, const uint32_t numPixels) noexcept {
+    uint32_t pixelIdx = 0;
 
-    for (uint32_t y = 0; y <= viewH; ++y) {
-        // Process this row of pixels and invert RGB values
-        uint32_t* pPixel = &Video::gpFrameBuffer[g3dViewXOffset + (g3dViewYOffset + y) * screenH];
-        uint32_t* const pEndPixel = pPixel + g3dViewWidth;
+    #if SIMD_USE_SSE2
+        const __m128i rgbMask = _mm_set1_epi32(0x00FFFFFF);
 
-        while (pPixel < pEndPixel) {
-            const uint32_t color = *pPixel;
-            *pPixel = (~color) & 0x00FFFFFFu;
-            ++pPixel;
+        for (; pixelIdx + 4 <= numPixels; pixelIdx += 4) {
+            __m128i* const pPixels4 = reinterpret_cast<__m128i*>(pPixels + pixelIdx);
+            _mm_storeu_si128(pPixels4, _mm_andnot_si128(_mm_loadu_si128(pPixels4), rgbMask));
         }
+    #endif
+
+    for (; pixelIdx < numPixels; ++pixelIdx) {
+        pPixels[pixelIdx] = (~pPixels[pixelIdx]) & 0x00FFFFFFu;
     }
 }
 
-static void doTintEffect(const uint32_t r5, const uint32_t g5, const uint32_t b5) noexcept {
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Modulates the RGB values for a row of pixels by the given 16.16 fixed point multipliers (which must be less than 256.0).
+// Each color component becomes 'min((color * mul) >> 16, 255)', which is exactly what fixed point multiplying and clamping gives.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void tintPixelRow(
+    uint32_t* const pPixels,
+    const uint32_t numPixels,
+    const Fixed rMul,
+    const Fixed gMul,
+    const Fixed bMul
+) noexcept {
+    uint32_t pixelIdx = 0;
+
+    #if SIMD_USE_SSE2
+        // Work on 16-bit color components, 2 pixels per vector in BGRA order.
+        // Split the multipliers into integer and fractional parts so they fit 16-bit lanes: 'c * mul >> 16' is 'c * int + (c * frac >> 16)'.
+        // The alpha multiplier is zero, like the alpha of the output in the scalar code.
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i mulInt = _mm_setr_epi16(
+            (int16_t)(bMul >> 16), (int16_t)(gMul >> 16), (int16_t)(rMul >> 16), 0,
+            (int16_t)(bMul >> 16), (int16_t)(gMul >> 16), (int16_t)(rMul >> 16), 0
+        );
+        const __m128i mulFrac = _mm_setr_epi16(
+            (int16_t)(bMul & FRACMASK), (int16_t)(gMul & FRACMASK), (int16_t)(rMul & FRACMASK), 0,
+            (int16_t)(bMul & FRACMASK), (int16_t)(gMul & FRACMASK), (int16_t)(rMul & FRACMASK), 0
+        );
+
+        for (; pixelIdx + 4 <= numPixels; pixelIdx += 4) {
+            __m128i* const pPixels4 = reinterpret_cast<__m128i*>(pPixels + pixelIdx);
+            const __m128i pixels = _mm_loadu_si128(pPixels4);
+            const __m128i pixelsLo = _mm_unpacklo_epi8(pixels, zero);
+            const __m128i pixelsHi = _mm_unpackhi_epi8(pixels, zero);
+            const __m128i tintedLo = _mm_add_epi16(_mm_mullo_epi16(pixelsLo, mulInt), _mm_mulhi_epu16(pixelsLo, mulFrac));
+            const __m128i tintedHi = _mm_add_epi16(_mm_mullo_epi16(pixelsHi, mulInt), _mm_mulhi_epu16(pixelsHi, mulFrac));
+
+            // Note: packing with unsigned saturation also does the clamp to 255
+            _mm_storeu_si128(pPixels4, _mm_packus_epi16(tintedLo, tintedHi));
+        }
+    #endif
+
+    for (; pixelIdx < numPixels; ++pixelIdx) {
+        const uint32_t color = pPixels[pixelIdx];
+        const uint32_t r = std::min(((color >> 16) & 0xFFu) * (uint32_t) rMul >> 16, 255u);
+        const uint32_t g = std::min(((color >> 8) & 0xFFu) * (uint32_t) gMul >> 16, 255u);
+        const uint32_t b = std::min((color & 0xFFu) * (uint32_t) bMul >> 16, 255u);
+        pPixels[pixelIdx] = (r << 16) | (g << 8) | b;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Does either the invulnerability effect or a tint over the 3D view, in a single pass
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void applyPostFxTo3dView(const bool bInvert, const uint32_t r5, const uint32_t g5, const uint32_t b5) noexcept {
     // If there is no effect do nothing
-    if (r5 == 0 && g5 == 0 && b5 == 0)
+    if ((!bInvert) && (r5 == 0) && (g5 == 0) && (b5 == 0))
         return;
 
     // Create a fixed point multiplier for RGB values
     constexpr Fixed COL5_MAX_FRAC = intToFixed16(31);
-    constexpr Fixed COL8_MAX_FRAC = intToFixed16(255);
     constexpr Fixed EFFECT_STRENGHT = intToFixed16(2);
 
     const Fixed rMul = FRACUNIT + fixed16Mul(fixed16Div(intToFixed16((int32_t) r5), COL5_MAX_FRAC), EFFECT_STRENGHT);
     const Fixed gMul = FRACUNIT + fixed16Mul(fixed16Div(intToFixed16((int32_t) g5), COL5_MAX_FRAC), EFFECT_STRENGHT);
     const Fixed bMul = FRACUNIT + fixed16Mul(fixed16Div(intToFixed16((int32_t) b5), COL5_MAX_FRAC), EFFECT_STRENGHT);
 
-    // Modulate all of the RGB values in the framebuffer
-    const uint32_t screenH = g3dViewHeight;
-
-    for (uint32_t y = 0; y <= screenH; ++y) {
-        // Process this row of pixels
-        uint32_t* pPixel = &Video::gpFrameBuffer[g3dViewXOffset + (g3dViewYOffset + y) * Video::gScreenWidth];
-        uint32_t* const pEndPixel = pPixel + g3dViewWidth;
-
-        while (pPixel < pEndPixel) {
-            // Get the old colors from 0-1
-            const uint32_t color = *pPixel;
-            const Fixed oldRFrac = intToFixed16((color >> 16) & 0xFFu);
-            const Fixed oldGFrac = intToFixed16((color >> 8) & 0xFFu);
-            const Fixed oldBFrac = intToFixed16(color & 0xFFu);
-
-            // Modulate and clamp
-            const Fixed rFrac = std::min(fixed16Mul(oldRFrac, rMul), COL8_MAX_FRAC);
-            const Fixed gFrac = std::min(fixed16Mul(oldGFrac, gMul), COL8_MAX_FRAC);
-            const Fixed bFrac = std::min(fixed16Mul(oldBFrac, bMul), COL8_MAX_FRAC);
-
-            // Make a framebuffer color
-            const uint32_t finalColor = (
-                ((uint32_t) fixed16ToInt(rFrac) << 16) |
-                ((uint32_t) fixed16ToInt(gFrac) << 8) |
-                ((uint32_t) fixed16ToInt(bFrac))
-            );
-
-            *pPixel = finalColor;
-            ++pPixel;
+    // Process each row of the 3D view
+    const uint32_t viewW = g3dViewWidth;
+    const uint32_t viewH = g3dViewHeight;
+    const uint32_t screenW = Video::gScreenWidth;
+    uint32_t* pRow = &Video::gpFrameBuffer[g3dViewXOffset + g3dViewYOffset * screenW];
+
+    for (uint32_t y = 0; y < viewH; ++y, pRow += screenW) {
+        if (bInvert) {
+            invertPixelRow(pRow, viewW);
+        } else {
+            tintPixelRow(pRow, viewW, rMul, gMul, bMul);
         }
     }
 }
@@ -88,7 +125,7 @@ void doPostFx() noexcept {
     );
 
     if (bDoInvunFx) {
-        doInvulnerabilityEffect();
+        applyPostFxTo3dView(true, 0, 0, 0);
         return;
     }
 
@@ -125,7 +162,7 @@ void doPostFx() noexcept {
     greenFx = std::min(greenFx, 31u);
     blueFx = std::min(blueFx, 31u);
 
-    doTintEffect(redFx, greenFx, blueFx);
+    applyPostFxTo3dView(false, redFx, greenFx, blueFx);
 }
 
 END_NAMESPACE(Renderer)
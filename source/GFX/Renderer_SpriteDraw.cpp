@@ -8,7 +8,6 @@
 #include "Sprites.h"
 #include "Things/Info.h"
 #include "Things/MapObj.h"
-#include "Video.h"
 
 BEGIN_NAMESPACE(Renderer)
 
@@ -16,6 +15,7 @@ BEGIN_NAMESPACE(Renderer)
 // Transforms a sprite world position into viewspace and tells if it should be culled due to being behind the camera
 //------------------------------------------------------------------------------------------------------------------------------------------
 static inline void transformWorldCoordsToViewSpace(
+    const RenderContext& ctx,
     const float worldX,
     const float worldY,
     const float worldZ,
@@ -25,14 +25,14 @@ static inline void transformWorldCoordsToViewSpace(
     bool& shouldCullSprite
 ) noexcept {
     // Transform by view position first
-    const float translatedX = worldX - gViewX;
-    const float translatedY = worldY - gViewY;
-    viewZOut = worldZ - gViewZ + SPRITE_EXTRA_Z_OFFSET;     // Node: have to apply a weird hack offset here (3DO Doom did this)
+    const float translatedX = worldX - ctx.viewX;
+    const float translatedY = worldY - ctx.viewY;
+    viewZOut = worldZ - ctx.viewZ + SPRITE_EXTRA_Z_OFFSET;     // Node: have to apply a weird hack offset here (3DO Doom did this)
 
     // Do 2D rotation by view angle.
     // Rotation matrix formula from: https://en.wikipedia.org/wiki/Rotation_matrix
-    const float viewCos = gViewCos;
-    const float viewSin = gViewSin;
+    const float viewCos = ctx.viewCos;
+    const float viewSin = ctx.viewSin;
     viewXOut = viewCos * translatedX - viewSin * translatedY;
     viewYOut = viewSin * translatedX + viewCos * translatedY;
 
@@ -45,6 +45,7 @@ static inline void transformWorldCoordsToViewSpace(
 // Also tells if we should cull the sprite due to it being off screen.
 //------------------------------------------------------------------------------------------------------------------------------------------
 static void transformSpriteXBoundsAndWToClipSpace(
+    const RenderContext& ctx,
     const float viewLx,
     const float viewRx,
     const float viewY,
@@ -57,8 +58,8 @@ static void transformSpriteXBoundsAndWToClipSpace(
     //  (1) We treat 'y' as if it were 'z' for the purposes of these calculations, since the
     //      projection matrix has 'z' as the depth value and not y (Doom coord sys).
     //  (2) We assume that the sprite always starts off with an implicit 'w' value of '1'.
-    clipLxOut = viewLx * gProjMatrix.r0c0;
-    clipRxOut = viewRx * gProjMatrix.r0c0;
+    clipLxOut = viewLx * ctx.projMatrix.r0c0;
+    clipRxOut = viewRx * ctx.projMatrix.r0c0;
     clipWOut = viewY;   // Note: r3c2 is an implicit 1.0 - hence we just do this!
 
     // A screen coordinate will be onscreen if the coord is >= -w and <= w
@@ -79,12 +80,15 @@ static uint8_t getThingSpriteAngleForViewpoint(const mobj_t& thing, const Fixed
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Gets the sprite frame for the given map thing and figures out if we need to draw full bright or transparent
+// Gets the sprite frame for the given map thing and figures out if we need to draw full bright or transparent.
+// Returns 'false' if the sprite is not loaded yet, in which case the thing is not drawn this frame.
+// If allowed, sprites which are not loaded yet are requested to be loaded in the background once the frame is done.
 //------------------------------------------------------------------------------------------------------------------------------------------
-static void getSpriteDetailsForMapObj(
+static bool getSpriteDetailsForMapObj(
     const mobj_t& thing,
     const Fixed viewXFrac,
     const Fixed viewYFrac,
+    const bool bLoadMissingSprites,
     const SpriteFrameAngle*& pSpriteFrameAngle,
     bool& bIsSpriteFullBright,
     bool& bIsSpriteTransparent
@@ -103,8 +107,21 @@ static void getSpriteDetailsForMapObj(
 
     const uint8_t spriteAngle = getThingSpriteAngleForViewpoint(thing, viewXFrac, viewYFrac);
 
-    // Load the current sprite for the thing and then the frame angle we want
-    const Sprite* const pSprite = Sprites::load(spriteResourceNum);
+    // Get the current sprite for the thing and then the frame angle we want.
+    // Don't stall the frame waiting on or reading sprites which are not loaded yet, just skip drawing the thing until the sprite is ready.
+    // Note: only the main thread can request sprites to be loaded, other threads can only use sprites which are already loaded.
+    const Sprite* pSprite;
+
+    if (bLoadMissingSprites) {
+        pSprite = Sprites::getIfLoaded(spriteResourceNum);
+    } else {
+        pSprite = Sprites::get(spriteResourceNum);
+        pSprite = (pSprite->pFrames) ? pSprite : nullptr;
+    }
+
+    if (!pSprite)
+        return false;
+
     ASSERT(spriteFrameNum < pSprite->numFrames);
     ASSERT(spriteAngle < NUM_SPRITE_DIRECTIONS);
 
@@ -113,6 +130,7 @@ static void getSpriteDetailsForMapObj(
 
     // Figure out other sprite flags
     bIsSpriteTransparent = ((thing.flags & MF_SHADOW) != 0);
+    return true;
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -120,6 +138,7 @@ static void getSpriteDetailsForMapObj(
 // Also tells if we should cull the sprite due to it being off screen.
 //------------------------------------------------------------------------------------------------------------------------------------------
 static void transformSpriteZValuesToClipSpace(
+    const RenderContext& ctx,
     const float viewTz,
     const float viewBz,
     const float clipW,
@@ -127,8 +146,8 @@ static void transformSpriteZValuesToClipSpace(
     float& clipBz,
     bool& shouldCullSprite
 ) noexcept {
-    clipTz = viewTz * gProjMatrix.r1c1;
-    clipBz = viewBz * gProjMatrix.r1c1;
+    clipTz = viewTz * ctx.projMatrix.r1c1;
+    clipBz = viewBz * ctx.projMatrix.r1c1;
 
     // A screen coordinate will be onscreen if the coord is >= -w and <= w
     shouldCullSprite = (
@@ -141,6 +160,7 @@ static void transformSpriteZValuesToClipSpace(
 // Transforms the sprite coordinates to screen space (pixel values)
 //------------------------------------------------------------------------------------------------------------------------------------------
 static void transformSpriteCoordsToScreenSpace(
+    const RenderContext& ctx,
     const float clipLx,
     const float clipRx,
     const float clipTz,
@@ -152,8 +172,8 @@ static void transformSpriteCoordsToScreenSpace(
     float& screenBy
 ) noexcept {
     // Note: have to subtract a bit here because at 100% of the range we don't want to be >= screen width or height!
-    const float screenW = (float) g3dViewWidth - 0.5f;
-    const float screenH = (float) g3dViewHeight - 0.5f;
+    const float screenW = (float) ctx.viewWidth - 0.5f;
+    const float screenH = (float) ctx.viewHeight - 0.5f;
 
     // Do perspective division for all the coordinates to transform into normalized device coords
     const float clipInvW = 1.0f / clipW;
@@ -173,13 +193,18 @@ static void transformSpriteCoordsToScreenSpace(
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Determine the light multiplier for the given thing
 //------------------------------------------------------------------------------------------------------------------------------------------
-static float determineLightMultiplierForThing(const mobj_t& thing, const bool bIsFullBright, const float depth) noexcept {
+static float determineLightMultiplierForThing(
+    const RenderContext& ctx,
+    const mobj_t& thing,
+    const bool bIsFullBright,
+    const float depth
+) noexcept {
     uint32_t sectorLightLevel;
 
     if (bIsFullBright) {
         sectorLightLevel = 255;
     } else {
-        sectorLightLevel = thing.subsector->sector->lightlevel + gExtraLight;
+        sectorLightLevel = thing.subsector->sector->lightlevel + ctx.extraLight;
     }
 
     const LightParams lightParams = getLightParams(sectorLightLevel);
@@ -190,7 +215,7 @@ static float determineLightMultiplierForThing(const mobj_t& thing, const bool bI
 // Generate a 'DrawSprite' for the given thing and add to the list for this frame.
 // Does basic culling as well also.
 //------------------------------------------------------------------------------------------------------------------------------------------
-void addSpriteToFrame(const mobj_t& thing) noexcept {
+void addSpriteToFrame(RenderContext& ctx, const mobj_t& thing) noexcept {
     // The player never gets added for obvious reasons
     if (thing.player)
         return;
@@ -205,7 +230,7 @@ void addSpriteToFrame(const mobj_t& thing) noexcept {
     float viewY;
     float viewZ;
     bool bCullSprite;
-    transformWorldCoordsToViewSpace(worldX, worldY, worldZ, viewX, viewY, viewZ, bCullSprite);
+    transformWorldCoordsToViewSpace(ctx, worldX, worldY, worldZ, viewX, viewY, viewZ, bCullSprite);
 
     if (bCullSprite)
         return;
@@ -214,7 +239,19 @@ void addSpriteToFrame(const mobj_t& thing) noexcept {
     bool bIsSpriteFullBright;
     bool bIsSpriteTransparent;
     const SpriteFrameAngle* spriteFrameAngle;
-    getSpriteDetailsForMapObj(thing, gViewXFrac, gViewYFrac, spriteFrameAngle, bIsSpriteFullBright, bIsSpriteTransparent);
+
+    const bool bGotSpriteDetails = getSpriteDetailsForMapObj(
+        thing,
+        ctx.viewXFrac,
+        ctx.viewYFrac,
+        ctx.bLoadMissingSprites,
+        spriteFrameAngle,
+        bIsSpriteFullBright,
+        bIsSpriteTransparent
+    );
+
+    if (!bGotSpriteDetails)
+        return;
 
     ASSERT(spriteFrameAngle->width > 0);
     ASSERT(spriteFrameAngle->height > 0);
@@ -229,7 +266,7 @@ void addSpriteToFrame(const mobj_t& thing) noexcept {
     float clipLx;
     float clipRx;
     float clipW;
-    transformSpriteXBoundsAndWToClipSpace(viewLx, viewRx, viewY, clipLx, clipRx, clipW, bCullSprite);
+    transformSpriteXBoundsAndWToClipSpace(ctx, viewLx, viewRx, viewY, clipLx, clipRx, clipW, bCullSprite);
 
     if (bCullSprite)
         return;
@@ -240,7 +277,7 @@ void addSpriteToFrame(const mobj_t& thing) noexcept {
 
     float clipTz;
     float clipBz;
-    transformSpriteZValuesToClipSpace(viewTz, viewBz, clipW, clipTz, clipBz, bCullSprite);
+    transformSpriteZValuesToClipSpace(ctx, viewTz, viewBz, clipW, clipTz, clipBz, bCullSprite);
 
     if (bCullSprite)
         return;
@@ -250,14 +287,16 @@ void addSpriteToFrame(const mobj_t& thing) noexcept {
     float screenRx;
     float screenTy;
     float screenBy;
-    transformSpriteCoordsToScreenSpace(clipLx, clipRx, clipTz, clipBz, clipW, screenLx, screenRx, screenTy, screenBy);
+    transformSpriteCoordsToScreenSpace(ctx, clipLx, clipRx, clipTz, clipBz, clipW, screenLx, screenRx, screenTy, screenBy);
 
     // Determine the light multiplier for the sprite
-    const float lightMul = determineLightMultiplierForThing(thing, bIsSpriteFullBright, clipW);
+    const float lightMul = determineLightMultiplierForThing(ctx, thing, bIsSpriteFullBright, clipW);
 
     // Makeup the draw sprite and add to the list
     DrawSprite drawSprite;
     drawSprite.pPixels = spriteFrameAngle->pTexture;
+    drawSprite.pColSpanIdxs = spriteFrameAngle->pColSpanIdxs;
+    drawSprite.pSpans = spriteFrameAngle->pSpans;
     drawSprite.worldX = worldX;
     drawSprite.worldY = worldY;
     drawSprite.screenLx = screenLx;
@@ -271,16 +310,16 @@ void addSpriteToFrame(const mobj_t& thing) noexcept {
     drawSprite.bFlip = spriteFrameAngle->flipped;
     drawSprite.bTransparent = bIsSpriteTransparent;
     
-    gDrawSprites.push_back(drawSprite);
+    ctx.drawSprites.push_back(drawSprite);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Sorts all sprites in the 3d view submitted to the renderer from back to front
 //------------------------------------------------------------------------------------------------------------------------------------------
-static void sortAllSprites() noexcept {
+static void sortAllSprites(RenderContext& ctx) noexcept {
     std::sort(
-        gDrawSprites.begin(),
-        gDrawSprites.end(),
+        ctx.drawSprites.begin(),
+        ctx.drawSprites.end(),
         [](const DrawSprite& s1, const DrawSprite& s2) noexcept {
             return (s1.depth > s2.depth);
         }
@@ -300,20 +339,22 @@ enum class SpriteFlipMode {
 // Modifies the given top and bottom y clip bounds.
 //------------------------------------------------------------------------------------------------------------------------------------------
 static void clipSpriteFragmentAgainstOccludingCols(
+    RenderContext& ctx,
     const SpriteFragment& frag,
     const OccludingColumns& cols,
     int16_t& yClipT,
     int16_t& yClipB
 ) noexcept {
-    const uint32_t validCount = gValidCount;
+    const uint32_t validCount = ctx.validCount;
     const uint32_t numCols = cols.count;
     BLIT_ASSERT(numCols <= OccludingColumns::MAX_ENTRIES);
     
     for (uint32_t i = 0; i < numCols; ++i) {
         // Grab the line associated with this column and see if we did an 'in front' test against this column
-        line_t& line = *cols.pLines[i];
+        const line_t& line = *cols.pLines[i];
+        LineDrawInfo& lineDrawInfo = ctx.lineDrawInfos[&line - gpLines];
 
-        if (line.validCount != validCount) {
+        if (lineDrawInfo.validCount != validCount) {
             // Get the min and max depths of the line. These are used for tests that take precedence over
             // the cross-product test determining whether the sprite is in front of the line:
             //
@@ -328,21 +369,21 @@ static void clipSpriteFragmentAgainstOccludingCols(
             // issues in some places however with parallel lines that are subdivided, often a sprite will be
             // seen to be clipped at the subdivisions...
             //
-            const float lineMinDepth = std::min(line.v1DrawDepth, line.v2DrawDepth);
-            const float lineMaxDepth = std::max(line.v1DrawDepth, line.v2DrawDepth);
+            const float lineMinDepth = std::min(lineDrawInfo.v1DrawDepth, lineDrawInfo.v2DrawDepth);
+            const float lineMaxDepth = std::max(lineDrawInfo.v1DrawDepth, lineDrawInfo.v2DrawDepth);
 
             if (frag.depth > lineMaxDepth) {
-                line.bIsInFrontOfSprite = true;
+                lineDrawInfo.bIsInFrontOfSprite = true;
             } 
             else if (frag.depth < lineMinDepth) {
-                line.bIsInFrontOfSprite = false;
+                lineDrawInfo.bIsInFrontOfSprite = false;
             }
             else {
                 // Okay, this is where we do the magic cross product check to see if the sprite is in 'front' of the line.
                 // This is the same method as the 'SegBehindPoint' function in the original 3DO Doom code:
                 float spriteRx, spriteRy, lineDx, lineDy;
 
-                if (line.drawnSideIndex == 0) {
+                if (lineDrawInfo.drawnSideIndex == 0) {
                     spriteRx = frag.spriteWorldX - line.v1f.x;
                     spriteRy = frag.spriteWorldY - line.v1f.y;
                     lineDx = line.v2f.x - line.v1f.x;
@@ -356,15 +397,15 @@ static void clipSpriteFragmentAgainstOccludingCols(
 
                 const float a = spriteRx * lineDy;
                 const float b = spriteRy * lineDx;
-                line.bIsInFrontOfSprite = (a < b);
+                lineDrawInfo.bIsInFrontOfSprite = (a < b);
             }
 
             // Don't run this calculation again for this sprite
-            line.validCount = validCount;
+            lineDrawInfo.validCount = validCount;
         }
 
         // Ignore this line if it is not in front of the sprite
-        if (!line.bIsInFrontOfSprite)
+        if (!lineDrawInfo.bIsInFrontOfSprite)
             continue;
         
         // This line occludes the sprite: update the clip bounds
@@ -375,57 +416,16 @@ static void clipSpriteFragmentAgainstOccludingCols(
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Clips and draws a single sprite fragment
+// Draws part of a sprite fragment which has already been clipped, starting at the given texture coordinate and screen y position
 //------------------------------------------------------------------------------------------------------------------------------------------
-static void clipAndDrawSpriteFragment(const SpriteFragment& frag) noexcept {
-    BLIT_ASSERT(frag.x < g3dViewWidth);
-
-    // Firstly figure out the top and bottom clip bounds for the sprite fragment
-    int16_t yClipT = -1;
-    int16_t yClipB = (int16_t) g3dViewHeight;
-
-    {
-        const OccludingColumns& occludingCols = gOccludingCols[frag.x];
-        clipSpriteFragmentAgainstOccludingCols(frag, occludingCols, yClipT, yClipB);
-    }
-
-    // If we are drawing nothing then bail
-    if (yClipT >= yClipB)
-        return;
-    
-    // Do clipping against the top of the bounds
-    float srcTexY = 0.0f;
-    float srcTexYSubPixelAdjust = frag.texYSubPixelAdjust;
-    int32_t dstY = frag.y;
-    uint32_t dstCount = frag.height;
-
-    if (dstY <= yClipT) {
-        const uint32_t numPixelsOffscreen = (uint32_t)(yClipT - dstY + 1);
-
-        if (numPixelsOffscreen >= dstCount)
-            return;
-
-        srcTexY = frag.texYStep * (float) numPixelsOffscreen + srcTexYSubPixelAdjust;
-        srcTexYSubPixelAdjust = 0.0f;
-        dstY += numPixelsOffscreen;
-        dstCount -= numPixelsOffscreen;
-    }
-
-    // Do clipping against the bottom of the bounds
-    {
-        const uint32_t endY = (uint32_t) dstY + dstCount;
-
-        if ((int32_t) endY > yClipB) {
-            const uint32_t numPixelsOffscreen = (uint32_t)((int32_t) endY - yClipB);
-
-            if (numPixelsOffscreen >= dstCount)
-                return;
-
-            dstCount -= numPixelsOffscreen;
-        }
-    }
-
-    // Draw the actual sprite column
+static void drawSpriteFragmentPart(
+    const RenderContext& ctx,
+    const SpriteFragment& frag,
+    const float srcTexY,
+    const float srcTexYSubPixelAdjust,
+    const int32_t dstY,
+    const uint32_t dstCount
+) noexcept {
     if (!frag.isTransparent) {
         Blit::blitColumn<
             Blit::BCF_STEP_Y |
@@ -441,11 +441,11 @@ static void clipAndDrawSpriteFragment(const SpriteFragment& frag) noexcept {
             srcTexY,
             0.0f,
             srcTexYSubPixelAdjust,
-            Video::gpFrameBuffer + (uintptr_t) g3dViewYOffset * Video::gScreenWidth + g3dViewXOffset,
-            g3dViewWidth,
-            g3dViewHeight,
-            Video::gScreenWidth,
-            frag.x,
+            get3dViewColumnPixels(ctx, frag.x),
+            1,
+            ctx.viewHeight,
+            ctx.pixelsRowStride,
+            0,
             dstY,
             dstCount,
             0.0f,
@@ -471,11 +471,11 @@ static void clipAndDrawSpriteFragment(const SpriteFragment& frag) noexcept {
             srcTexY,
             0.0f,
             srcTexYSubPixelAdjust,
-            Video::gpFrameBuffer + (uintptr_t) g3dViewYOffset * Video::gScreenWidth + g3dViewXOffset,
-            g3dViewWidth,
-            g3dViewHeight,
-            Video::gScreenWidth,
-            frag.x,
+            get3dViewColumnPixels(ctx, frag.x),
+            1,
+            ctx.viewHeight,
+            ctx.pixelsRowStride,
+            0,
             dstY,
             dstCount,
             0.0f,
@@ -488,11 +488,126 @@ static void clipAndDrawSpriteFragment(const SpriteFragment& frag) noexcept {
     }
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Clips and draws a single sprite fragment
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void clipAndDrawSpriteFragment(RenderContext& ctx, const SpriteFragment& frag) noexcept {
+    BLIT_ASSERT(frag.x < ctx.viewWidth);
+
+    // Firstly figure out the top and bottom clip bounds for the sprite fragment
+    int16_t yClipT = -1;
+    int16_t yClipB = (int16_t) ctx.viewHeight;
+
+    {
+        const OccludingColumns& occludingCols = ctx.occludingCols[frag.x];
+        clipSpriteFragmentAgainstOccludingCols(ctx, frag, occludingCols, yClipT, yClipB);
+    }
+
+    // If we are drawing nothing then bail
+    if (yClipT >= yClipB)
+        return;
+    
+    // Do clipping against the top of the bounds
+    float srcTexY = 0.0f;
+    float srcTexYSubPixelAdjust = frag.texYSubPixelAdjust;
+    int32_t dstY = frag.y;
+    uint32_t dstCount = frag.height;
+
+    if (dstY <= yClipT) {
+        const uint32_t numPixelsOffscreen = (uint32_t)(yClipT - dstY + 1);
+
+        if (numPixelsOffscreen >= dstCount)
+            return;
+
+        srcTexY = frag.texYStep * (float) numPixelsOffscreen + srcTexYSubPixelAdjust;
+        srcTexYSubPixelAdjust = 0.0f;
+        dstY += numPixelsOffscreen;
+        dstCount -= numPixelsOffscreen;
+    }
+
+    // Do clipping against the bottom of the bounds
+    {
+        const uint32_t endY = (uint32_t) dstY + dstCount;
+
+        if ((int32_t) endY > yClipB) {
+            const uint32_t numPixelsOffscreen = (uint32_t)((int32_t) endY - yClipB);
+
+            if (numPixelsOffscreen >= dstCount)
+                return;
+
+            dstCount -= numPixelsOffscreen;
+        }
+    }
+
+    // Only draw the parts of the column where the sprite is opaque, skipping over runs of pixels that sample transparent texels.
+    // To give exactly the same output as drawing the whole column in one go, the texture coordinate is stepped here in the same way
+    // that the blitter steps it, and each part drawn starts from the stepped coordinate of its first pixel. Once a pixel samples
+    // outside of the texture nothing more is skipped, so the blitter's handling of the bottom edge of the texture is unchanged.
+    // The parts drawn never overlap, so transparent sprites never blend the same pixel twice.
+    const float texYStep = frag.texYStep;
+
+    if (texYStep <= 0.0f) {
+        drawSpriteFragmentPart(ctx, frag, srcTexY, srcTexYSubPixelAdjust, dstY, dstCount);
+        return;
+    }
+
+    const SpriteSpan* pSpan = frag.pOpaqueSpans;
+    const SpriteSpan* const pEndSpan = frag.pOpaqueSpans + frag.numOpaqueSpans;
+
+    float stepTexY = srcTexY + srcTexYSubPixelAdjust;   // The blitter's stepped coordinate: the sub pixel adjustment applies after the 1st pixel
+    bool bInRun = false;
+    uint32_t runBeginPixel = 0;
+    float runBeginTexY = 0.0f;
+    float runBeginSubPixelAdjust = 0.0f;
+
+    for (uint32_t pixel = 0; pixel < dstCount; ++pixel) {
+        // Get the texel sampled for this pixel
+        if (pixel > 0) {
+            stepTexY += texYStep;
+        }
+
+        const float texY = (pixel > 0) ? stepTexY : srcTexY;
+        const uint32_t texYInt = (uint32_t) texY;
+        const bool bOutsideTexture = (texYInt >= frag.texH);
+
+        // Is the texel opaque? Note: the texels sampled only ever increase, so the spans can be checked in order.
+        bool bDrawPixel = bOutsideTexture;
+
+        if (!bOutsideTexture) {
+            while ((pSpan < pEndSpan) && (pSpan->endY <= texYInt)) {
+                ++pSpan;
+            }
+
+            bDrawPixel = ((pSpan < pEndSpan) && (pSpan->beginY <= texYInt));
+        }
+
+        // Start or finish a run of pixels to draw
+        if (bDrawPixel && (!bInRun)) {
+            bInRun = true;
+            runBeginPixel = pixel;
+            runBeginTexY = texY;
+            runBeginSubPixelAdjust = (pixel > 0) ? 0.0f : srcTexYSubPixelAdjust;
+        }
+        else if ((!bDrawPixel) && bInRun) {
+            bInRun = false;
+            drawSpriteFragmentPart(ctx, frag, runBeginTexY, runBeginSubPixelAdjust, dstY + (int32_t) runBeginPixel, pixel - runBeginPixel);
+        }
+
+        // Draw everything else in the current run once outside of the texture, so the blitter sees the edge exactly as before
+        if (bOutsideTexture)
+            break;
+    }
+
+    if (bInRun) {
+        drawSpriteFragmentPart(ctx, frag, runBeginTexY, runBeginSubPixelAdjust, dstY + (int32_t) runBeginPixel, dstCount - runBeginPixel);
+    }
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Emit the sprite fragments for one draw sprite
 //------------------------------------------------------------------------------------------------------------------------------------------
 template <SpriteFlipMode FLIP_MODE>
-static void drawSprite(const DrawSprite& sprite) noexcept {
+static void drawSprite(RenderContext& ctx, const DrawSprite& sprite) noexcept {
     BLIT_ASSERT(sprite.screenRx >= sprite.screenLx);
     BLIT_ASSERT(sprite.screenBy >= sprite.screenTy);
 
@@ -548,15 +663,15 @@ static void drawSprite(const DrawSprite& sprite) noexcept {
     // If we do also cancel any extra columns we might have ordered:
     int32_t endScreenX;
 
-    if (spriteRxInt >= (int32_t) g3dViewWidth) {
-        endScreenX = (int32_t) g3dViewWidth;
+    if (spriteRxInt >= (int32_t) ctx.viewWidth) {
+        endScreenX = (int32_t) ctx.viewWidth;
         bDoExtraCol = false;
     } else {
         endScreenX = spriteRxInt + 1;
     }
 
     // Increment this marker for clipping checks
-    ++gValidCount;
+    ++ctx.validCount;
 
     // Emit the columns
     {
@@ -569,7 +684,7 @@ static void drawSprite(const DrawSprite& sprite) noexcept {
         }
 
         while (curScreenX < endScreenX) {
-            BLIT_ASSERT(curScreenX >= 0 && curScreenX < (int32_t) g3dViewWidth);
+            BLIT_ASSERT(curScreenX >= 0 && curScreenX < (int32_t) ctx.viewWidth);
             const uint16_t texX = (uint16_t) texXf;
 
             if (texX >= texW)
@@ -586,10 +701,12 @@ static void drawSprite(const DrawSprite& sprite) noexcept {
             frag.texYStep = texYStep;
             frag.texYSubPixelAdjust = texSubPixelYAdjust;
             frag.pSpriteColPixels = sprite.pPixels + (uintptr_t) texX * texHInt;
+            frag.pOpaqueSpans = sprite.pSpans + sprite.pColSpanIdxs[texX];
+            frag.numOpaqueSpans = sprite.pColSpanIdxs[texX + 1] - sprite.pColSpanIdxs[texX];
             frag.spriteWorldX = sprite.worldX;
             frag.spriteWorldY = sprite.worldY;
 
-            clipAndDrawSpriteFragment(frag);
+            clipAndDrawSpriteFragment(ctx, frag);
 
             ++curScreenX;
             ++curColNum;
@@ -606,7 +723,7 @@ static void drawSprite(const DrawSprite& sprite) noexcept {
     if (bDoExtraCol) {
         curScreenX = spriteRxInt + 1;
 
-        if (curScreenX < (int32_t) g3dViewWidth) {
+        if (curScreenX < (int32_t) ctx.viewWidth) {
             const uint16_t texX = (FLIP_MODE == SpriteFlipMode::FLIPPED) ? 0 : texWInt - 1;
 
             SpriteFragment frag;
@@ -620,10 +737,12 @@ static void drawSprite(const DrawSprite& sprite) noexcept {
             frag.texYStep = texYStep;
             frag.texYSubPixelAdjust = texSubPixelYAdjust;
             frag.pSpriteColPixels = sprite.pPixels + (uintptr_t) texX * texHInt;
+            frag.pOpaqueSpans = sprite.pSpans + sprite.pColSpanIdxs[texX];
+            frag.numOpaqueSpans = sprite.pColSpanIdxs[texX + 1] - sprite.pColSpanIdxs[texX];
             frag.spriteWorldX = sprite.worldX;
             frag.spriteWorldY = sprite.worldY;
 
-            clipAndDrawSpriteFragment(frag);
+            clipAndDrawSpriteFragment(ctx, frag);
         }
     }
 }
@@ -631,14 +750,14 @@ static void drawSprite(const DrawSprite& sprite) noexcept {
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Draw all the sprites in the 3D view from back to front
 //------------------------------------------------------------------------------------------------------------------------------------------
-void drawAllSprites() noexcept {
-    sortAllSprites();
+void drawAllSprites(RenderContext& ctx) noexcept {
+    sortAllSprites(ctx);
 
-    for (const DrawSprite& sprite : gDrawSprites) {
+    for (const DrawSprite& sprite : ctx.drawSprites) {
         if (sprite.bFlip) {
-            drawSprite<SpriteFlipMode::FLIPPED>(sprite);
+            drawSprite<SpriteFlipMode::FLIPPED>(ctx, sprite);
         } else {
-            drawSprite<SpriteFlipMode::NOT_FLIPPED>(sprite);
+            drawSprite<SpriteFlipMode::NOT_FLIPPED>(ctx, sprite);
         }
     }
 }
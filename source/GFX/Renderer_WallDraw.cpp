@@ -4,7 +4,8 @@
 #include "Blit.h"
 #include "Map/Setup.h"
 #include "Textures.h"
-#include "Video.h"
+#include <algorithm>
+#include <cstring>
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Code for drawing walls and skies in the game.
@@ -17,54 +18,142 @@
 BEGIN_NAMESPACE(Renderer)
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Draws a single column of the sky
+// Makes sure the sky column cache for the render context is up to date for the current sky texture and 3D view height
 //------------------------------------------------------------------------------------------------------------------------------------------
-static void drawSkyColumn(const uint32_t viewX, const uint32_t maxColHeight) noexcept {
-    // Figure out the angle this sky column is at.
-    // From that figure out the texture coordinate: the sky texture is 256 pixels wide and repeats 4 times over a circle.
-    const angle_t angle = gViewAngleBAM + gScreenXToAngleBAM[viewX];
-    const uint32_t texX = (angle >> 22) & 0xFFu;
-
-    // Figure out the sky column height and texel step (y)
+static void updateSkyColumnCache(RenderContext& ctx) noexcept {
+    // Figure out the sky column height for this view size
     const Texture* const pTex = (const Texture*) Textures::getWall(gSkyTextureNum);
     const ImageData& texImg = pTex->data;
 
     const uint32_t skyTexH = texImg.height;
-    const Fixed skyScale = fixed16Div(intToFixed16((int32_t) g3dViewHeight), intToFixed16(Renderer::REFERENCE_3D_VIEW_HEIGHT));
+    const Fixed skyScale = fixed16Div(intToFixed16((int32_t) ctx.viewHeight), intToFixed16(Renderer::REFERENCE_3D_VIEW_HEIGHT));
     const Fixed scaledColHeight = fixed16Mul(intToFixed16((int32_t) skyTexH), skyScale);
     const uint32_t roundColHeight = ((scaledColHeight & FRACMASK) != 0) ? 1 : 0;
     const uint32_t colHeight = (uint32_t) fixed16ToInt(scaledColHeight) + roundColHeight;
-    BLIT_ASSERT(colHeight < g3dViewHeight);
+    BLIT_ASSERT(colHeight < ctx.viewHeight);
+
+    // If nothing has changed then the cache is still good
+    const void* const pSrcData = (texImg.pPixels) ? (const void*) texImg.pPixels : (const void*) texImg.pColorIdxs;
+    const bool bCacheValid = (
+        (ctx.skyCacheTexNum == gSkyTextureNum) &&
+        (ctx.pSkyCacheSrcData == pSrcData) &&
+        (ctx.skyCacheNumCols == texImg.width) &&
+        (ctx.skyCacheColHeight == colHeight)
+    );
+
+    if (bCacheValid)
+        return;
+
+    ctx.skyCacheTexNum = gSkyTextureNum;
+    ctx.pSkyCacheSrcData = pSrcData;
+    ctx.skyCacheNumCols = texImg.width;
+    ctx.skyCacheColHeight = colHeight;
+    ctx.skyColumnCache.resize((size_t) texImg.width * colHeight);
 
+    // Resample every column of the sky texture to the column height.
+    // Note: this steps through the texture in exactly the same way that 'Blit::blitColumn' would, so the results are identical.
     const float texYStep = fixed16ToFloat(Blit::calcTexelStep(skyTexH, colHeight));
 
-    // Draw the sky column
-    Blit::blitColumn<
-        Blit::BCF_STEP_Y
-    >(
-        texImg.pPixels,
-        texImg.width,
-        texImg.height,
-        (float) texX,
-        0.0f,
-        0.0f,
-        0.0f,
-        Video::gpFrameBuffer + (uintptr_t) g3dViewYOffset * Video::gScreenWidth + g3dViewXOffset,
-        g3dViewWidth,
-        g3dViewHeight,
-        Video::gScreenWidth,
-        (int32_t) viewX,
-        0,
-        std::min(colHeight, maxColHeight),
-        0,
-        texYStep
-    );
+    for (uint32_t texX = 0; texX < texImg.width; ++texX) {
+        const uint32_t srcColPixelIdx = texX * skyTexH;
+        uint32_t* const pDstCol = ctx.skyColumnCache.data() + (uintptr_t) texX * colHeight;
+        uint32_t texY = 0;
+        float nextTexY = 0.0f;
+
+        for (uint32_t y = 0; y < colHeight; ++y) {
+            BLIT_ASSERT(texY < skyTexH);
+            const uint16_t srcPixelARGB1555 = texImg.getPixel(srcColPixelIdx + texY);
+            const uint32_t texR = (srcPixelARGB1555 & uint16_t(0b0111110000000000)) >> 7;
+            const uint32_t texG = (srcPixelARGB1555 & uint16_t(0b0000001111100000)) >> 2;
+            const uint32_t texB = (srcPixelARGB1555 & uint16_t(0b0000000000011111)) << 3;
+            pDstCol[y] = (texR << 16) | (texG << 8) | texB;
+
+            nextTexY += texYStep;
+            texY = (uint32_t) nextTexY;
+        }
+    }
 }
 
-void drawAllWallFragments() noexcept {
-    for (const WallFragment& wallFrag : gWallFragments) {
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Draws a single column of the sky by copying it from the sky column cache
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void drawSkyColumn(const RenderContext& ctx, const uint32_t viewX, const uint32_t maxColHeight) noexcept {
+    // Figure out the angle this sky column is at.
+    // From that figure out the texture coordinate: the sky texture is 256 pixels wide and repeats 4 times over a circle.
+    const angle_t angle = ctx.viewAngleBAM + ctx.screenXToAngleBAM[viewX];
+    const uint32_t texX = (angle >> 22) & 0xFFu;
+    BLIT_ASSERT(texX < ctx.skyCacheNumCols);
+
+    // Copy the column to the 3D view
+    const uint32_t colHeight = std::min(ctx.skyCacheColHeight, maxColHeight);
+    const uint32_t* const pSrcCol = ctx.skyColumnCache.data() + (uintptr_t) texX * ctx.skyCacheColHeight;
+    uint32_t* const pDstCol = get3dViewColumnPixels(ctx, viewX);
+    const uint32_t dstRowStride = ctx.pixelsRowStride;
+
+    if (dstRowStride == 1) {
+        std::memcpy(pDstCol, pSrcCol, colHeight * sizeof(uint32_t));
+    } else {
+        for (uint32_t y = 0; y < colHeight; ++y) {
+            pDstCol[(uintptr_t) y * dstRowStride] = pSrcCol[y];
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Draws a wall fragment for a texture using indexed color storage (16 colors, 4-bit color indexes).
+// Since the light level is the same for the entire column, the 16 colors are lit once up front and each pixel is then just a lookup.
+// Produces exactly the same output as drawing the wall using 'Blit::blitColumn'.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void drawIndexedWallFragment(const RenderContext& ctx, const WallFragment& wallFrag) noexcept {
+    const ImageData& wallImage = *wallFrag.pImageData;
+    BLIT_ASSERT(wallImage.bitsPerColorIdx == 4);
+
+    // Light all the colors in the lookup table
+    uint32_t litColors[16];
+    const float lightMul = wallFrag.lightMul;
+
+    for (uint32_t i = 0; i < 16; ++i) {
+        const uint16_t colorARGB1555 = wallImage.pPLUT[i];
+        const float r = std::min((float)((colorARGB1555 & uint16_t(0b0111110000000000)) >> 7) * lightMul, 255.0f);
+        const float g = std::min((float)((colorARGB1555 & uint16_t(0b0000001111100000)) >> 2) * lightMul, 255.0f);
+        const float b = std::min((float)((colorARGB1555 & uint16_t(0b0000000000011111)) << 3) * lightMul, 255.0f);
+        litColors[i] = (uint32_t(r) << 16) | (uint32_t(g) << 8) | uint32_t(b);
+    }
+
+    // Draw the column, stepping through the texture the same way that 'Blit::blitColumn' does
+    const uint32_t texH = wallImage.height;
+    const uint32_t texX = Blit::wrapXCoord<Blit::BCF_H_WRAP_WRAP>((int32_t) wallFrag.texcoordX, wallImage.width);
+    const uint32_t colStartPixelIdx = texX * texH;
+    const uint8_t* const pColorIdxs = wallImage.pColorIdxs;
+
+    const uint32_t dstRowStride = ctx.pixelsRowStride;
+    uint32_t* pDstPixel = get3dViewColumnPixels(ctx, wallFrag.x) + (uintptr_t) wallFrag.y * dstRowStride;
+    uint32_t* const pEndDstPixel = pDstPixel + (uintptr_t) wallFrag.height * dstRowStride;
+
+    uint32_t curTexYInt = (uint32_t) wallFrag.texcoordY;
+    float nextTexY = wallFrag.texcoordY + wallFrag.texcoordYSubPixelAdjust;     // Note: the adjustment is applied AFTER the first pixel
+    const float texYStep = wallFrag.texcoordYStep;
+
+    while (pDstPixel < pEndDstPixel) {
+        const uint32_t pixelIdx = colStartPixelIdx + Blit::wrapYCoord<Blit::BCF_V_WRAP_WRAP>((int32_t) curTexYInt, texH);
+        const uint32_t colorIdx = (pColorIdxs[pixelIdx >> 1] >> ((~pixelIdx & 1u) << 2)) & 0x0Fu;
+        *pDstPixel = litColors[colorIdx];
+
+        nextTexY += texYStep;
+        curTexYInt = (uint32_t) nextTexY;
+        pDstPixel += dstRowStride;
+    }
+}
+
+void drawAllWallFragments(RenderContext& ctx) noexcept {
+    for (const WallFragment& wallFrag : ctx.wallFragments) {
         const ImageData& wallImage = *wallFrag.pImageData;
 
+        if (wallImage.bitsPerColorIdx != 0) {
+            drawIndexedWallFragment(ctx, wallFrag);
+            continue;
+        }
+
         Blit::blitColumn<
             Blit::BCF_STEP_Y |
             Blit::BCF_H_WRAP_WRAP |
@@ -78,11 +167,11 @@ void drawAllWallFragments() noexcept {
             wallFrag.texcoordY,
             0.0f,
             wallFrag.texcoordYSubPixelAdjust,
-            Video::gpFrameBuffer + (uintptr_t) g3dViewYOffset * Video::gScreenWidth + g3dViewXOffset,
-            g3dViewWidth,
-            g3dViewHeight,
-            Video::gScreenWidth,
-            wallFrag.x,
+            get3dViewColumnPixels(ctx, wallFrag.x),
+            1,
+            ctx.viewHeight,
+            ctx.pixelsRowStride,
+            0,
             wallFrag.y,
             wallFrag.height,
             0,
@@ -94,9 +183,14 @@ void drawAllWallFragments() noexcept {
     }
 }
 
-void drawAllSkyFragments() noexcept {
-    for (const SkyFragment& skyFrag : gSkyFragments) {
-        drawSkyColumn(skyFrag.x, skyFrag.height);
+void drawAllSkyFragments(RenderContext& ctx) noexcept {
+    if (ctx.skyFragments.empty())
+        return;
+
+    updateSkyColumnCache(ctx);
+
+    for (const SkyFragment& skyFrag : ctx.skyFragments) {
+        drawSkyColumn(ctx, skyFrag.x, skyFrag.height);
     }
 }
 
@@ -17,6 +17,12 @@ BEGIN_NAMESPACE(Renderer)
 //------------------------------------------------------------------------------------------------------------------------------------------
 static constexpr float MIN_DEPTH_FOR_FLAT_PIXEL_CLAMP = 128.0f;
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// When working out the attributes for each column of a seg, the exact perspective correct values (which need a divide) are only computed
+// at most this many columns apart. The values for the columns in between are linearly interpolated.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static constexpr uint32_t SEG_COLUMN_SPAN_SIZE = 8;
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Populate vertex attributes for the given seg that are interpolated across the seg during rendering.
 // These attributes are not affected by any transforms, but *ARE* clipped.
@@ -43,15 +49,15 @@ static void populateSegVertexAttribs(const seg_t& seg, DrawSeg& drawSeg) noexcep
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Transforms a single point into view space
 //------------------------------------------------------------------------------------------------------------------------------------------
-static void transformPointToViewSpace(float& x, float& y) noexcept {
+static void transformPointToViewSpace(const RenderContext& ctx, float& x, float& y) noexcept {
     // Transform by the view position
-    x -= gViewX;
-    y -= gViewY;
+    x -= ctx.viewX;
+    y -= ctx.viewY;
 
     // Do rotation by view angle and save the result
     // Rotation matrix formula from: https://en.wikipedia.org/wiki/Rotation_matrix
-    const float viewSin = gViewSin;
-    const float viewCos = gViewCos;
+    const float viewSin = ctx.viewSin;
+    const float viewCos = ctx.viewCos;
     const float xRot = viewCos * x - viewSin * y;
     const float yRot = viewSin * x + viewCos * y;
     x = xRot;
@@ -61,13 +67,13 @@ static void transformPointToViewSpace(float& x, float& y) noexcept {
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Transforms the XY coordinates for the seg into view space
 //------------------------------------------------------------------------------------------------------------------------------------------
-static void transformSegXYToViewSpace(const seg_t& inSeg, DrawSeg& outSeg) noexcept {    
+static void transformSegXYToViewSpace(const RenderContext& ctx, const seg_t& inSeg, DrawSeg& outSeg) noexcept {
     outSeg.p1x = inSeg.v1.x;
     outSeg.p1y = inSeg.v1.y;
     outSeg.p2x = inSeg.v2.x;
     outSeg.p2y = inSeg.v2.y;
-    transformPointToViewSpace(outSeg.p1x, outSeg.p1y);
-    transformPointToViewSpace(outSeg.p2x, outSeg.p2y);
+    transformPointToViewSpace(ctx, outSeg.p1x, outSeg.p1y);
+    transformPointToViewSpace(ctx, outSeg.p2x, outSeg.p2y);
 }
 
 static bool isScreenSpaceSegBackFacing(const DrawSeg& seg) noexcept {
@@ -78,7 +84,7 @@ static bool isScreenSpaceSegBackFacing(const DrawSeg& seg) noexcept {
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Transforms the XY and W coordinates for the seg into clip space
 //------------------------------------------------------------------------------------------------------------------------------------------
-static void transformSegXYWToClipSpace(DrawSeg& seg) noexcept {
+static void transformSegXYWToClipSpace(const RenderContext& ctx, DrawSeg& seg) noexcept {
     // Notes:
     //  (1) We treat 'y' as if it were 'z' for the purposes of these calculations, since the
     //      projection matrix has 'z' as the depth value and not y (Doom coord sys).
@@ -86,10 +92,10 @@ static void transformSegXYWToClipSpace(DrawSeg& seg) noexcept {
     const float y1Orig = seg.p1y;
     const float y2Orig = seg.p2y;
 
-    seg.p1x *= gProjMatrix.r0c0;
-    seg.p2x *= gProjMatrix.r0c0;
-    seg.p1y = gProjMatrix.r2c2 * y1Orig + gProjMatrix.r2c3;
-    seg.p2y = gProjMatrix.r2c2 * y2Orig + gProjMatrix.r2c3;
+    seg.p1x *= ctx.projMatrix.r0c0;
+    seg.p2x *= ctx.projMatrix.r0c0;
+    seg.p1y = ctx.projMatrix.r2c2 * y1Orig + ctx.projMatrix.r2c3;
+    seg.p2y = ctx.projMatrix.r2c2 * y2Orig + ctx.projMatrix.r2c3;
     seg.p1w = y1Orig;   // Note: r3c2 is an implicit 1.0 - hence we just do this!
     seg.p2w = y2Orig;   // Note: r3c2 is an implicit 1.0 - hence we just do this!
 }
@@ -282,8 +288,8 @@ static bool clipSegAgainstRightPlane(DrawSeg& seg) noexcept {
 // Add the clip space Z (height) values to the seg.
 // We add these lazily after other clipping operations have succeeded.
 //------------------------------------------------------------------------------------------------------------------------------------------
-static void addClipSpaceZValuesForSeg(DrawSeg& drawSeg, const seg_t& seg) noexcept {
-    const float viewZ = gViewZ;
+static void addClipSpaceZValuesForSeg(const RenderContext& ctx, DrawSeg& drawSeg, const seg_t& seg) noexcept {
+    const float viewZ = ctx.viewZ;
 
     const float frontFloorZ = fixed16ToFloat(seg.frontsector->floorheight);
     const float frontCeilZ = fixed16ToFloat(seg.frontsector->ceilingheight);
@@ -293,10 +299,10 @@ static void addClipSpaceZValuesForSeg(DrawSeg& drawSeg, const seg_t& seg) noexce
     drawSeg.bEmitCeiling = (frontCeilViewZ > 0.0f);
     drawSeg.bEmitFloor = (frontFloorViewZ < 0.0f);
 
-    drawSeg.p1tz = frontCeilViewZ * gProjMatrix.r1c1;
-    drawSeg.p1bz = frontFloorViewZ * gProjMatrix.r1c1;
-    drawSeg.p2tz = frontCeilViewZ * gProjMatrix.r1c1;
-    drawSeg.p2bz = frontFloorViewZ * gProjMatrix.r1c1;
+    drawSeg.p1tz = frontCeilViewZ * ctx.projMatrix.r1c1;
+    drawSeg.p1bz = frontFloorViewZ * ctx.projMatrix.r1c1;
+    drawSeg.p2tz = frontCeilViewZ * ctx.projMatrix.r1c1;
+    drawSeg.p2bz = frontFloorViewZ * ctx.projMatrix.r1c1;
 
     if (seg.backsector) {
         const float backFloorZ = fixed16ToFloat(seg.backsector->floorheight);
@@ -304,10 +310,10 @@ static void addClipSpaceZValuesForSeg(DrawSeg& drawSeg, const seg_t& seg) noexce
         const float backFloorViewZ = backFloorZ - viewZ;
         const float backCeilViewZ = backCeilZ - viewZ;
 
-        drawSeg.p1tz_back = backCeilViewZ * gProjMatrix.r1c1;
-        drawSeg.p1bz_back = backFloorViewZ * gProjMatrix.r1c1;
-        drawSeg.p2tz_back = backCeilViewZ * gProjMatrix.r1c1;
-        drawSeg.p2bz_back = backFloorViewZ * gProjMatrix.r1c1;
+        drawSeg.p1tz_back = backCeilViewZ * ctx.projMatrix.r1c1;
+        drawSeg.p1bz_back = backFloorViewZ * ctx.projMatrix.r1c1;
+        drawSeg.p2tz_back = backCeilViewZ * ctx.projMatrix.r1c1;
+        drawSeg.p2bz_back = backFloorViewZ * ctx.projMatrix.r1c1;
 
         // Whether to emit upper and lower wall occluders
         const float clipFloorZ = std::max(frontFloorZ, backFloorZ);
@@ -384,10 +390,10 @@ static void doPerspectiveDivisionForSeg(DrawSeg& seg) noexcept {
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Transform the seg xz coordinates from normalized device coords into screen pixel coords.
 //------------------------------------------------------------------------------------------------------------------------------------------
-static void transformSegXZToScreenSpace(DrawSeg& seg) noexcept {
+static void transformSegXZToScreenSpace(const RenderContext& ctx, DrawSeg& seg) noexcept {
     // Note: have to subtract a bit here because at 100% of the range we don't want to be >= screen width or height!
-    const float viewW = (float) g3dViewWidth - 0.5f;
-    const float viewH = (float) g3dViewHeight - 0.5f;
+    const float viewW = (float) ctx.viewWidth - 0.5f;
+    const float viewH = (float) ctx.viewHeight - 0.5f;
 
     // All coords are in the range -1 to +1 now.
     // Bring in the range 0-1 and then expand to screen width and height:
@@ -429,6 +435,7 @@ namespace FragEmitFlags {
 //------------------------------------------------------------------------------------------------------------------------------------------
 template <FragEmitFlagsT FLAGS>
 static inline void addWallColumnPartToClipBounds(
+    RenderContext& ctx,
     SegClip& clipBounds,
     [[maybe_unused]] const int32_t zt,
     [[maybe_unused]] const int32_t zb
@@ -446,7 +453,7 @@ static inline void addWallColumnPartToClipBounds(
     // Decide what to do
     if constexpr (FLAGS == FragEmitFlags::MID_WALL) {
         clipBounds = SegClip{ 0, 0 };
-        ++gNumFullSegCols;
+        ++ctx.numFullSegCols;
     }
     else {
         if constexpr (FLAGS == FragEmitFlags::UPPER_WALL) {
@@ -457,7 +464,7 @@ static inline void addWallColumnPartToClipBounds(
 
         if (clipBounds.top + 1 >= clipBounds.bottom) {
             clipBounds = SegClip{ 0, 0 };
-            ++gNumFullSegCols;
+            ++ctx.numFullSegCols;
         }
     }
 }
@@ -468,6 +475,7 @@ static inline void addWallColumnPartToClipBounds(
 //------------------------------------------------------------------------------------------------------------------------------------------
 template <FragEmitFlagsT FLAGS>
 static uint32_t clipAndEmitWallColumn(
+    RenderContext& ctx,
     const uint32_t x,
     const float zt,
     const float zb,
@@ -478,16 +486,16 @@ static uint32_t clipAndEmitWallColumn(
     SegClip& clipBounds,
     const LightParams& lightParams,
     const float segLightMul,
-    const ImageData& texImage
+    const Texture& texture
 ) noexcept {
-    ASSERT(x < g3dViewWidth);
+    ASSERT(x < ctx.viewWidth);
 
     // This fake loop allows us to discard the column due to clipping
     uint32_t numColumnsEmitted = 0;
 
     do {
         // Don't emit anything if size is <= 0, except if a mid wall (occlude everything in that case)
-        if (zt >= zb || zb < 0.0f || zt >= (float) g3dViewHeight) {
+        if (zt >= zb || zb < 0.0f || zt >= (float) ctx.viewHeight) {
             if constexpr (FLAGS == FragEmitFlags::MID_WALL) {
                 break;
             } else {
@@ -496,14 +504,26 @@ static uint32_t clipAndEmitWallColumn(
         }
 
         // This is how much to step the texture in the Y direction for this column
-        const float texYStep = (texBy - texTy) / (zb - zt);
+        float texYStep = (texBy - texTy) / (zb - zt);
+
+        // If the texture has mip levels then pick the one where stepping 1 pixel down the screen moves roughly 1 texel.
+        // Scale the texture coordinates to suit the smaller image: each level is half the size of the one before it.
+        uint32_t mipLevel = 0;
+        float mipTexScale = 1.0f;
+
+        while ((texYStep * mipTexScale >= 2.0f) && (mipLevel + 1 < texture.numMipLevels)) {
+            ++mipLevel;
+            mipTexScale *= 0.5f;
+        }
+
+        float curTexTy = texTy * mipTexScale;
+        float curTexBy = texBy * mipTexScale;
+        texYStep *= mipTexScale;
 
         int32_t curZbInt = (int32_t) zb;
         int32_t curZtInt = (int32_t) zt;
         float curZt = zt;
         float curZb = zb;
-        float curTexTy = texTy;
-        float curTexBy = texBy;
         float texYSubPixelAdjustment;
 
         if (curZtInt <= clipBounds.top) {
@@ -541,10 +561,10 @@ static uint32_t clipAndEmitWallColumn(
         }
 
         // Sanity checks
-        BLIT_ASSERT(x <= g3dViewWidth);
+        BLIT_ASSERT(x <= ctx.viewWidth);
         BLIT_ASSERT(curZtInt <= curZbInt);
-        BLIT_ASSERT(curZtInt >= 0 && curZtInt < (int32_t) g3dViewHeight);
-        BLIT_ASSERT(curZbInt >= 0 && curZbInt < (int32_t) g3dViewHeight);
+        BLIT_ASSERT(curZtInt >= 0 && curZtInt < (int32_t) ctx.viewHeight);
+        BLIT_ASSERT(curZbInt >= 0 && curZbInt < (int32_t) ctx.viewHeight);
 
         // Emit the column fragment
         const int32_t columnHeight = curZbInt - curZtInt + 1;
@@ -553,20 +573,20 @@ static uint32_t clipAndEmitWallColumn(
         frag.x = (uint16_t) x;
         frag.y = (uint16_t) curZtInt;
         frag.height = (uint16_t) columnHeight;
-        frag.texcoordX = (uint16_t) texX;
+        frag.texcoordX = (uint16_t)((uint16_t) texX >> mipLevel);
         frag.texcoordY = curTexTy;
         frag.texcoordYSubPixelAdjust = texYSubPixelAdjustment;
         frag.texcoordYStep = texYStep;
         frag.lightMul = lightParams.getLightMulForDist(depth) * segLightMul;
-        frag.pImageData = &texImage;
+        frag.pImageData = &texture.getMipLevel(mipLevel);
 
-        gWallFragments.push_back(frag);
+        ctx.wallFragments.push_back(frag);
         numColumnsEmitted = 1;
 
     } while (false);
 
     // Add this column to the clip bounds for this screen column
-    addWallColumnPartToClipBounds<FLAGS>(clipBounds, (int32_t) zt, (int32_t) std::floor(zb));
+    addWallColumnPartToClipBounds<FLAGS>(ctx, clipBounds, (int32_t) zt, (int32_t) std::floor(zb));
     return numColumnsEmitted;
 }
 
@@ -576,6 +596,7 @@ static uint32_t clipAndEmitWallColumn(
 //------------------------------------------------------------------------------------------------------------------------------------------
 template <FragEmitFlagsT FLAGS>
 static uint32_t clipAndEmitFlatColumn(
+    RenderContext& ctx,
     const uint32_t x,
     const float zt,
     const float zb,
@@ -586,10 +607,10 @@ static uint32_t clipAndEmitFlatColumn(
     const float worldZ,
     const bool bClampFirstColumnPixel,
     const uint8_t sectorLightLevel,
-    const ImageData& texture
+    const Texture& texture
 ) noexcept {
     static_assert(FLAGS == FragEmitFlags::FLOOR || FLAGS == FragEmitFlags::CEILING);
-    ASSERT(x < g3dViewWidth);
+    ASSERT(x < ctx.viewWidth);
 
     // Only bother emitting wall fragments if the column height would be > 0
     if (zt >= zb)
@@ -630,13 +651,13 @@ static uint32_t clipAndEmitFlatColumn(
         frag.worldX = worldX;
         frag.worldY = worldY;
         frag.worldZ = worldZ;
-        frag.pImageData = &texture;
+        frag.pTexture = &texture;
 
         if constexpr (FLAGS == FragEmitFlags::FLOOR) {
-            gFloorFragments.push_back(frag);
+            ctx.floorFragments.push_back(frag);
         } else {
             static_assert(FLAGS == FragEmitFlags::CEILING);
-            gCeilFragments.push_back(frag);
+            ctx.ceilFragments.push_back(frag);
         }
     }
 
@@ -646,7 +667,7 @@ static uint32_t clipAndEmitFlatColumn(
             clipBounds = SegClip{ (int16_t) zbInt, clipBounds.bottom };
         } else {
             clipBounds = SegClip{ 0, 0 };
-            gNumFullSegCols++;
+            ctx.numFullSegCols++;
         }
     }
     else {
@@ -654,7 +675,7 @@ static uint32_t clipAndEmitFlatColumn(
             clipBounds = SegClip{ clipBounds.top, (int16_t) ztInt };
         } else {
             clipBounds = SegClip{ 0, 0 };
-            gNumFullSegCols++;
+            ctx.numFullSegCols++;
         }
     }
 
@@ -675,25 +696,26 @@ enum class EmitOccluderMode {
 //------------------------------------------------------------------------------------------------------------------------------------------
 template <EmitOccluderMode MODE>
 static void emitOccluderColumn(
+    RenderContext& ctx,
     const uint32_t x,
     const int32_t screenYCoord,
     const float depth,
     line_t& line
 ) noexcept {
     static_assert(MODE == EmitOccluderMode::TOP || MODE == EmitOccluderMode::BOTTOM);
-    ASSERT(x < g3dViewWidth);
+    ASSERT(x < ctx.viewWidth);
 
     // Ignore the request if the bound is already offscreen
     if constexpr (MODE == EmitOccluderMode::TOP) {
         if (screenYCoord < 0)
             return;
     } else {
-        if (screenYCoord >= (int32_t) g3dViewHeight)
+        if (screenYCoord >= (int32_t) ctx.viewHeight)
             return;
     }
 
     // Determine if we need a new occluder column
-    OccludingColumns& occludingCols = gOccludingCols[x];
+    OccludingColumns& occludingCols = ctx.occludingCols[x];
     const uint32_t numOccludingCols = occludingCols.count;
     const uint32_t curOccluderIdx = numOccludingCols - 1;
 
@@ -711,7 +733,7 @@ static void emitOccluderColumn(
 
         if constexpr (MODE == EmitOccluderMode::TOP) {
             bounds.top = (int16_t) screenYCoord;
-            bounds.bottom = (int16_t) g3dViewHeight;
+            bounds.bottom = (int16_t) ctx.viewHeight;
         } else {
             bounds.top = -1;
             bounds.bottom = (int16_t) screenYCoord;
@@ -781,7 +803,7 @@ static void emitOccluderColumn(
 // Returns the number of wall and floor columns emitted, for the purposes of marking automap lines as visible.
 //------------------------------------------------------------------------------------------------------------------------------------------
 template <FragEmitFlagsT FLAGS>
-static uint32_t emitDrawSegColumns(const DrawSeg& drawSeg, seg_t& seg) noexcept {
+static uint32_t emitDrawSegColumns(RenderContext& ctx, const DrawSeg& drawSeg, seg_t& seg) noexcept {
     //------------------------------------------------------------------------------------------------------------------
     // Some setup logic
     //------------------------------------------------------------------------------------------------------------------
@@ -809,9 +831,9 @@ static uint32_t emitDrawSegColumns(const DrawSeg& drawSeg, seg_t& seg) noexcept
     // Sanity checks: x values should be clipped to be within screen range!
     // x1 should also be >= x2!
     ASSERT(x1 >= 0);
-    ASSERT(x1 < (int32_t) g3dViewWidth);
+    ASSERT(x1 < (int32_t) ctx.viewWidth);
     ASSERT(x2 >= 0);
-    ASSERT(x2 < (int32_t) g3dViewWidth);
+    ASSERT(x2 < (int32_t) ctx.viewWidth);
     ASSERT(x1 <= x2);
 
     //-----------------------------------------------------------------------------------------------------------------
@@ -894,7 +916,7 @@ static uint32_t emitDrawSegColumns(const DrawSeg& drawSeg, seg_t& seg) noexcept
     uint32_t sectorLightLevel = frontSector.lightlevel;
 
     if (sectorLightLevel < 240) {
-        sectorLightLevel += gExtraLight;
+        sectorLightLevel += ctx.extraLight;
     }
 
     sectorLightLevel = std::min(sectorLightLevel, 255u);
@@ -1133,20 +1155,127 @@ static uint32_t emitDrawSegColumns(const DrawSeg& drawSeg, seg_t& seg) noexcept
     }
 
     //------------------------------------------------------------------------------------------------------------------
-    // The number of steps in the x direction we have made.
-    // Increment on each column.
+    // Computes the exact (perspective correct) attributes for a column, given the number of x steps made from the
+    // start of the seg. This requires a divide, so it is only done at the ends of each span of columns.
+    //------------------------------------------------------------------------------------------------------------------
+    const auto getExactColumnAttribs = [&](const float xStepCount, const bool bIsLastColumn) noexcept {
+        SegColumnAttribs attribs = {};
+
+        // 1/w and w (depth)
+        const float wInv = (!bIsLastColumn) ? p1InvW + invWStep * xStepCount : p2InvW;
+        const float w = 1.0f / wInv;
+        attribs.depth = w;
+
+        // X texture coordinate (for walls)
+        if constexpr (EMIT_ANY_WALL) {
+            attribs.texX = (p1TexX + texXStep * xStepCount) * w;
+        }
+
+        // World X and Y (for floors)
+        if constexpr (EMIT_ANY_FLAT) {
+            attribs.worldX = (p1WorldX + worldXStep * xStepCount) * w;
+            attribs.worldY = (p1WorldY + worldYStep * xStepCount) * w;
+        }
+
+        // Bottom and top Z values for walls and floors
+        if constexpr (EMIT_MID_WALL || EMIT_UPPER_WALL || EMIT_CEILING) {
+            attribs.upperTz = p1UpperTz + upperTzStep * xStepCount;
+        }
+
+        if constexpr (EMIT_UPPER_WALL || EMIT_UPPER_WALL_OCCLUDER) {
+            attribs.upperBz = p1UpperBz + upperBzStep * xStepCount;
+        }
+
+        if constexpr (EMIT_LOWER_WALL || EMIT_LOWER_WALL_OCCLUDER) {
+            attribs.lowerTz = p1LowerTz + lowerTzStep * xStepCount;
+        }
+
+        if constexpr (EMIT_MID_WALL || EMIT_LOWER_WALL || EMIT_FLOOR) {
+            attribs.lowerBz = p1LowerBz + lowerBzStep * xStepCount;
+        }
+
+        return attribs;
+    };
+
+    //------------------------------------------------------------------------------------------------------------------
+    // Work out the attributes for every column of the seg which is not already fully occluded.
+    //
+    // The first column is at x step count '0' and column 'i' after that is at step count 'i' plus a sub pixel adjustment
+    // based on the fractional x position of the seg. This helps ensure stability and prevents 'wiggle' as the camera moves
+    // about. This is similar to the stability adjustment we do for the V texture coordinate on walls.
     //
-    // Note: we also do a sub pixel adjustement based on the fractional x position of the pixel.
-    // This helps ensure stability and prevents 'wiggle' as the camera moves about.
-    // This is similar to the stability adjustment we do for the V texture coordinate on walls.
+    // After the first column, the exact attributes are only computed every 'SEG_COLUMN_SPAN_SIZE' columns and affinely
+    // interpolated (forward differenced) in between. Over such a short span the error in the perspective correct values
+    // is negligible, and the 'z' values are linear anyway.
     //------------------------------------------------------------------------------------------------------------------
-    float curXStepCount = 0.0f;
-    float nextXStepCount = -(drawSeg.p1x - (float) x1);     // Adjustement for sub-pixel pos to prevent wiggle
+    const uint32_t numCols = (uint32_t)(x2 - x1) + 1;
+    const float xStepCountAdjust = -(drawSeg.p1x - (float) x1);     // Adjustement for sub-pixel pos to prevent wiggle
+
+    std::vector<SegColumnAttribs>& segColumnAttribs = ctx.segColumnAttribs;
+    std::vector<SegClip>& segClip = ctx.segClip;
+    segColumnAttribs.clear();
+
+    const auto addColumnIfVisible = [&](const uint32_t colIdx, const SegColumnAttribs& attribs) noexcept {
+        const uint32_t x = (uint32_t) x1 + colIdx;
+        const SegClip& clipBounds = segClip[x];
+
+        if (clipBounds.top < clipBounds.bottom) {
+            SegColumnAttribs& col = segColumnAttribs.emplace_back(attribs);
+            col.x = x;
+        }
+    };
+
+    addColumnIfVisible(0, getExactColumnAttribs(0.0f, (numCols == 1)));
+
+    if (numCols > 1) {
+        const uint32_t lastColIdx = numCols - 1;
+        SegColumnAttribs spanStart = getExactColumnAttribs(1.0f + xStepCountAdjust, (lastColIdx == 1));
+
+        for (uint32_t spanStartIdx = 1; true;) {
+            const uint32_t spanEndIdx = std::min(spanStartIdx + SEG_COLUMN_SPAN_SIZE, lastColIdx);
+
+            if (spanEndIdx == spanStartIdx) {
+                addColumnIfVisible(spanStartIdx, spanStart);
+                break;
+            }
+
+            // Step from the exact attributes at the start of the span towards those at the end
+            const SegColumnAttribs spanEnd = getExactColumnAttribs((float) spanEndIdx + xStepCountAdjust, (spanEndIdx == lastColIdx));
+            const float spanStepDivider = 1.0f / (float)(spanEndIdx - spanStartIdx);
+
+            SegColumnAttribs step;
+            step.depth = (spanEnd.depth - spanStart.depth) * spanStepDivider;
+            step.texX = (spanEnd.texX - spanStart.texX) * spanStepDivider;
+            step.worldX = (spanEnd.worldX - spanStart.worldX) * spanStepDivider;
+            step.worldY = (spanEnd.worldY - spanStart.worldY) * spanStepDivider;
+            step.upperTz = (spanEnd.upperTz - spanStart.upperTz) * spanStepDivider;
+            step.upperBz = (spanEnd.upperBz - spanStart.upperBz) * spanStepDivider;
+            step.lowerTz = (spanEnd.lowerTz - spanStart.lowerTz) * spanStepDivider;
+            step.lowerBz = (spanEnd.lowerBz - spanStart.lowerBz) * spanStepDivider;
+
+            SegColumnAttribs cur = spanStart;
+
+            for (uint32_t colIdx = spanStartIdx; colIdx < spanEndIdx; ++colIdx) {
+                addColumnIfVisible(colIdx, cur);
+                cur.depth += step.depth;
+                cur.texX += step.texX;
+                cur.worldX += step.worldX;
+                cur.worldY += step.worldY;
+                cur.upperTz += step.upperTz;
+                cur.upperBz += step.upperBz;
+                cur.lowerTz += step.lowerTz;
+                cur.lowerBz += step.lowerBz;
+            }
+
+            spanStart = spanEnd;
+            spanStartIdx = spanEndIdx;
+        }
+    }
 
     //------------------------------------------------------------------------------------------------------------------
     // Caching some useful stuff
     //------------------------------------------------------------------------------------------------------------------
-    const float viewH = (float) g3dViewHeight;
+    const float viewH = (float) ctx.viewHeight;
 
     [[maybe_unused]] bool bEmitFloor;
     [[maybe_unused]] bool bEmitCeiling;
@@ -1175,207 +1304,164 @@ static uint32_t emitDrawSegColumns(const DrawSeg& drawSeg, seg_t& seg) noexcept
     }
 
     //------------------------------------------------------------------------------------------------------------------
-    // Emit each column
+    // Emit all fragments and occluding columns, one type of fragment at a time across all of the visible columns.
+    // Each column only affects its own clip bounds and occluders, so this is the same as emitting each column in turn.
     //------------------------------------------------------------------------------------------------------------------
+    const SegColumnAttribs* const pColsBeg = segColumnAttribs.data();
+    const SegColumnAttribs* const pColsEnd = pColsBeg + segColumnAttribs.size();
     uint32_t numWallAndFlatCols = 0;
 
-    for (uint32_t x = (uint32_t) x1; x <= (uint32_t) x2; ++x) {
-        //--------------------------------------------------------------------------------------------------------------
-        // Grab the clip bounds for this column.
-        // If it is fully filled (top >= bottom) then just skip over it and go to the next step
-        //--------------------------------------------------------------------------------------------------------------
-        SegClip& clipBounds = gSegClip[x];
-
-        if (clipBounds.top >= clipBounds.bottom) {
-            nextXStepCount += 1.0f;
-            curXStepCount = nextXStepCount;
-            continue;
-        }
-
-        //--------------------------------------------------------------------------------------------------------------
-        // Do stepping for this column and figure out these quantities following through simple linear interpolation.
-        // Do perspective correct adjustments where required.
-        //--------------------------------------------------------------------------------------------------------------
-
-        // 1/w and w (depth)
-        const float wInv = (x < (uint32_t) x2) ? p1InvW + invWStep * curXStepCount : p2InvW;
-        const float w = 1.0f / wInv;
-        const float depth = w;
-
-        // X texture coordinate (for walls)
-        [[maybe_unused]] float texX;
-
-        if constexpr (EMIT_ANY_WALL) {
-            texX = (p1TexX + texXStep * curXStepCount) * w;
-        }
-
-        // World X and Y (for floors)
-        [[maybe_unused]] float worldX;
-        [[maybe_unused]] float worldY;
-
-        if constexpr (EMIT_ANY_FLAT) {
-            worldX = (p1WorldX + worldXStep * curXStepCount) * w;
-            worldY = (p1WorldY + worldYStep * curXStepCount) * w;
-        }
-
-        // Bottom and top Z values for walls and floors
-        [[maybe_unused]] float upperTz;
-        [[maybe_unused]] float upperBz;
-        [[maybe_unused]] float lowerTz;
-        [[maybe_unused]] float lowerBz;
-
-        if constexpr (EMIT_MID_WALL || EMIT_UPPER_WALL || EMIT_CEILING) {
-            upperTz = p1UpperTz + upperTzStep * curXStepCount;
-        }
-
-        if constexpr (EMIT_UPPER_WALL || EMIT_UPPER_WALL_OCCLUDER) {
-            upperBz = p1UpperBz + upperBzStep * curXStepCount;
-        }
-
-        if constexpr (EMIT_LOWER_WALL || EMIT_LOWER_WALL_OCCLUDER) {
-            lowerTz = p1LowerTz + lowerTzStep * curXStepCount;
-        }
-
-        if constexpr (EMIT_MID_WALL || EMIT_LOWER_WALL || EMIT_FLOOR) {
-            lowerBz = p1LowerBz + lowerBzStep * curXStepCount;
-        }
-
-        //--------------------------------------------------------------------------------------------------------------
-        // Move onto the next pixel for future steps
-        //--------------------------------------------------------------------------------------------------------------
-        nextXStepCount += 1.0f;
-        curXStepCount = nextXStepCount;
-
-        //--------------------------------------------------------------------------------------------------------------
-        // Emit all fragments and occluding columns
-        //--------------------------------------------------------------------------------------------------------------
-        if constexpr (EMIT_FLOOR) {
-            if (bEmitFloor) {
+    if constexpr (EMIT_FLOOR) {
+        if (bEmitFloor) {
+            for (const SegColumnAttribs* pCol = pColsBeg; pCol < pColsEnd; ++pCol) {
                 const bool bClampFirstColPixel = (
                     bCanClampFirstFloorColumnPixel &&
-                    (depth >= MIN_DEPTH_FOR_FLAT_PIXEL_CLAMP)
+                    (pCol->depth >= MIN_DEPTH_FOR_FLAT_PIXEL_CLAMP)
                 );
 
                 numWallAndFlatCols += clipAndEmitFlatColumn<FragEmitFlags::FLOOR>(
-                    x,
-                    lowerBz,
+                    ctx,
+                    pCol->x,
+                    pCol->lowerBz,
                     viewH,
-                    clipBounds,
-                    depth,
-                    worldX,
-                    worldY,
+                    segClip[pCol->x],
+                    pCol->depth,
+                    pCol->worldX,
+                    pCol->worldY,
                     lowerWorldBz,
                     bClampFirstColPixel,
                     (uint8_t) sectorLightLevel,
-                    pFloorTex->data
+                    *pFloorTex
                 );
             }
         }
+    }
 
-        if constexpr (EMIT_CEILING) {
-            if (bEmitCeiling && pCeilingTex) {
+    if constexpr (EMIT_CEILING) {
+        if (bEmitCeiling && pCeilingTex) {
+            for (const SegColumnAttribs* pCol = pColsBeg; pCol < pColsEnd; ++pCol) {
                 const bool bClampFirstColPixel = (
                     bCanClampFirstCeilingColumnPixel &&
-                    (depth >= MIN_DEPTH_FOR_FLAT_PIXEL_CLAMP)
+                    (pCol->depth >= MIN_DEPTH_FOR_FLAT_PIXEL_CLAMP)
                 );
 
                 numWallAndFlatCols += clipAndEmitFlatColumn<FragEmitFlags::CEILING>(
-                    x,
+                    ctx,
+                    pCol->x,
                     0.0f,
-                    upperTz,
-                    clipBounds,
-                    depth,
-                    worldX,
-                    worldY,
+                    pCol->upperTz,
+                    segClip[pCol->x],
+                    pCol->depth,
+                    pCol->worldX,
+                    pCol->worldY,
                     upperWorldTz,
                     bClampFirstColPixel,
                     (uint8_t) sectorLightLevel,
-                    pCeilingTex->data
+                    *pCeilingTex
                 );
             }
         }
+    }
 
-        if constexpr (EMIT_SKY) {
-            if ((!pCeilingTex) && (upperTz > 0)) {
-                SkyFragment skyFrag;
-                skyFrag.x = (uint16_t) x;
-                skyFrag.height = (uint16_t) std::ceil(upperTz);
+    if constexpr (EMIT_SKY) {
+        if (!pCeilingTex) {
+            for (const SegColumnAttribs* pCol = pColsBeg; pCol < pColsEnd; ++pCol) {
+                if (pCol->upperTz > 0) {
+                    SkyFragment skyFrag;
+                    skyFrag.x = (uint16_t) pCol->x;
+                    skyFrag.height = (uint16_t) std::ceil(pCol->upperTz);
 
-                gSkyFragments.push_back(skyFrag);
+                    ctx.skyFragments.push_back(skyFrag);
+                }
             }
         }
+    }
 
-        if constexpr (EMIT_MID_WALL) {
+    if constexpr (EMIT_MID_WALL) {
+        for (const SegColumnAttribs* pCol = pColsBeg; pCol < pColsEnd; ++pCol) {
             numWallAndFlatCols += clipAndEmitWallColumn<FragEmitFlags::MID_WALL>(
-                x,
-                upperTz,
-                lowerBz,
-                texX,
+                ctx,
+                pCol->x,
+                pCol->upperTz,
+                pCol->lowerBz,
+                pCol->texX,
                 midTexTy,
                 midTexBy,
-                depth,
-                clipBounds,
+                pCol->depth,
+                segClip[pCol->x],
                 lightParams,
                 seg.lightMul,
-                pMidTex->data
+                *pMidTex
             );
         }
+    }
 
-        if constexpr (EMIT_LOWER_WALL) {
+    if constexpr (EMIT_LOWER_WALL) {
+        for (const SegColumnAttribs* pCol = pColsBeg; pCol < pColsEnd; ++pCol) {
             numWallAndFlatCols += clipAndEmitWallColumn<FragEmitFlags::LOWER_WALL>(
-                x,
-                lowerTz,
-                lowerBz,
-                texX,
+                ctx,
+                pCol->x,
+                pCol->lowerTz,
+                pCol->lowerBz,
+                pCol->texX,
                 lowerTexTy,
                 lowerTexBy,
-                depth,
-                clipBounds,
+                pCol->depth,
+                segClip[pCol->x],
                 lightParams,
                 seg.lightMul,
-                pLowerTex->data
+                *pLowerTex
             );
         }
+    }
 
-        if constexpr (EMIT_UPPER_WALL) {
+    if constexpr (EMIT_UPPER_WALL) {
+        for (const SegColumnAttribs* pCol = pColsBeg; pCol < pColsEnd; ++pCol) {
             numWallAndFlatCols += clipAndEmitWallColumn<FragEmitFlags::UPPER_WALL>(
-                x,
-                upperTz,
-                upperBz,
-                texX,
+                ctx,
+                pCol->x,
+                pCol->upperTz,
+                pCol->upperBz,
+                pCol->texX,
                 upperTexTy,
                 upperTexBy,
-                depth,
-                clipBounds,
+                pCol->depth,
+                segClip[pCol->x],
                 lightParams,
                 seg.lightMul,
-                pUpperTex->data
+                *pUpperTex
             );
         }
+    }
+
+    for (const SegColumnAttribs* pCol = pColsBeg; pCol < pColsEnd; ++pCol) {
+        const uint32_t x = pCol->x;
 
         if constexpr (EMIT_MID_WALL_OCCLUDER) {
             // A solid wall will gobble up the entire screen and occlude everything!
-            emitOccluderColumn<EmitOccluderMode::TOP>(x, (int32_t) g3dViewHeight, depth, *seg.linedef);
+            emitOccluderColumn<EmitOccluderMode::TOP>(ctx, x, (int32_t) ctx.viewHeight, pCol->depth, *seg.linedef);
         } else {
             // Even if it's not asked for, if we find the column at this pixel is now
             // fully occluded then mark that as the case with an occluder column:
+            const SegClip& clipBounds = segClip[x];
+
             if (clipBounds.top >= clipBounds.bottom) {
-                emitOccluderColumn<EmitOccluderMode::TOP>(x, (int32_t) g3dViewHeight, depth, *seg.linedef);
+                emitOccluderColumn<EmitOccluderMode::TOP>(ctx, x, (int32_t) ctx.viewHeight, pCol->depth, *seg.linedef);
                 continue;
             }
         }
 
         if constexpr (EMIT_LOWER_WALL_OCCLUDER) {
             if (bEmitLowerWallOccluder) {
-                const float z = (bLowerWallOccluderUsesBackZ) ? lowerTz : lowerBz;
-                emitOccluderColumn<EmitOccluderMode::BOTTOM>(x, (int32_t) z, depth, *seg.linedef);
+                const float z = (bLowerWallOccluderUsesBackZ) ? pCol->lowerTz : pCol->lowerBz;
+                emitOccluderColumn<EmitOccluderMode::BOTTOM>(ctx, x, (int32_t) z, pCol->depth, *seg.linedef);
             }
         }
 
         if constexpr (EMIT_UPPER_WALL_OCCLUDER) {
             if (bEmitUpperWallOccluder) {
-                const float z = (bUpperWallOccluderUsesBackZ) ? upperBz : upperTz;
-                emitOccluderColumn<EmitOccluderMode::TOP>(x, (int32_t) z, depth, *seg.linedef);
+                const float z = (bUpperWallOccluderUsesBackZ) ? pCol->upperBz : pCol->upperTz;
+                emitOccluderColumn<EmitOccluderMode::TOP>(ctx, x, (int32_t) z, pCol->depth, *seg.linedef);
             }
         }
     }
@@ -1383,14 +1469,15 @@ static uint32_t emitDrawSegColumns(const DrawSeg& drawSeg, seg_t& seg) noexcept
     return numWallAndFlatCols;
 }
 
-void addSegToFrame(seg_t& seg) noexcept {
-    // First transform the seg into viewspace and populate vertex attributes
-    DrawSeg drawSeg;
+void addSegToFrame(RenderContext& ctx, seg_t& seg) noexcept {
+    // First transform the seg into viewspace and populate vertex attributes.
+    // Note: zero initialized since some fields (like the wall occluder flags) are only set for two sided segs.
+    DrawSeg drawSeg = {};
     populateSegVertexAttribs(seg, drawSeg);
-    transformSegXYToViewSpace(seg, drawSeg);
+    transformSegXYToViewSpace(ctx, seg, drawSeg);
 
     // Next transform to clip space and clip against the front and left + right planes
-    transformSegXYWToClipSpace(drawSeg);
+    transformSegXYWToClipSpace(ctx, drawSeg);
 
     if (!clipSegAgainstFrontPlane(drawSeg))
         return;
@@ -1403,19 +1490,20 @@ void addSegToFrame(seg_t& seg) noexcept {
 
     // Now that the seg is not rejected fill in the height values.
     // This function and also determines if we can draw the ceiling/floor and emit occluders based on those z values.
-    addClipSpaceZValuesForSeg(drawSeg, seg);
+    addClipSpaceZValuesForSeg(ctx, drawSeg, seg);
 
     // Do perspective division and transform the seg to screen space
     doPerspectiveDivisionForSeg(drawSeg);
-    transformSegXZToScreenSpace(drawSeg);
+    transformSegXZToScreenSpace(ctx, drawSeg);
 
     // Determine if the seg is back facing and cull if it is
     if (isScreenSpaceSegBackFacing(drawSeg))
         return;
     
     // Line: mark what side of the line we are drawing and get the depths of the two endpoints
-    line_t& line = *seg.linedef;
-    line.drawnSideIndex = seg.getLineSideIndex();
+    const line_t& line = *seg.linedef;
+    LineDrawInfo& lineDrawInfo = ctx.lineDrawInfos[&line - gpLines];
+    lineDrawInfo.drawnSideIndex = seg.getLineSideIndex();
 
     {
         // The depth of each endpoint is simply the y value after it's been transformed to viewspace
@@ -1423,10 +1511,10 @@ void addSegToFrame(seg_t& seg) noexcept {
         float y1 = line.v1f.y;
         float x2 = line.v2f.x;
         float y2 = line.v2f.y;
-        transformPointToViewSpace(x1, y1);
-        transformPointToViewSpace(x2, y2);
-        line.v1DrawDepth = y1;
-        line.v2DrawDepth = y2;
+        transformPointToViewSpace(ctx, x1, y1);
+        transformPointToViewSpace(ctx, x2, y2);
+        lineDrawInfo.v1DrawDepth = y1;
+        lineDrawInfo.v2DrawDepth = y2;
     }
 
     // Emit all wall and floor fragments for the seg
@@ -1440,7 +1528,7 @@ void addSegToFrame(seg_t& seg) noexcept {
             FragEmitFlags::FLOOR |
             FragEmitFlags::CEILING |
             FragEmitFlags::SKY
-        >(drawSeg, seg);
+        >(ctx, drawSeg, seg);
     } else {
         // Two sided seg that may have upper and lower parts to draw.
         // Note: need to ignore upper walls if back sector has a sky ceiling
@@ -1453,7 +1541,7 @@ void addSegToFrame(seg_t& seg) noexcept {
                 FragEmitFlags::FLOOR |
                 FragEmitFlags::CEILING |
                 FragEmitFlags::SKY
-            >(drawSeg, seg);
+            >(ctx, drawSeg, seg);
         } else {
             numWallAndFloorColumnsEmitted = emitDrawSegColumns<
                 FragEmitFlags::LOWER_WALL |
@@ -1461,12 +1549,13 @@ void addSegToFrame(seg_t& seg) noexcept {
                 FragEmitFlags::UPPER_WALL_OCCLUDER |
                 FragEmitFlags::FLOOR |
                 FragEmitFlags::CEILING
-            >(drawSeg, seg);
+            >(ctx, drawSeg, seg);
         }
     }
 
-    // Grab the flags for the seg's linedef and mark it as seen if we emitted any wall or floor columns (since it's visible)
-    if (numWallAndFloorColumnsEmitted > 0) {
+    // Grab the flags for the seg's linedef and mark it as seen if we emitted any wall or floor columns (since it's visible).
+    // Only the player's view does this, since it affects what the automap shows.
+    if ((numWallAndFloorColumnsEmitted > 0) && ctx.bMarkDrawnLinesAsMapped) {
         line_t& lineDef = *seg.linedef;
         lineDef.flags |= ML_MAPPED;
     }
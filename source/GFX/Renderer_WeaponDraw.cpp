@@ -37,7 +37,8 @@ static void DrawAWeapon(const pspdef_t& psp, const bool bShadow) noexcept {
     if ((playerSpriteState.SpriteFrame & FF_FULLBRIGHT) != 0) {
         lightMul = 1.0f;
     } else {
-        const LightParams& lightParams = getLightParams(gPlayer.mo->subsector->sector->lightlevel + gExtraLight);
+        const uint32_t extraLight = gPlayer.extralight << 6;    // Bumped light from gun blasts
+        const LightParams& lightParams = getLightParams(gPlayer.mo->subsector->sector->lightlevel + extraLight);
         lightMul = lightParams.getLightMulForDist(0.0f);
     }
 
@@ -3,16 +3,49 @@
 #include "Base/Endian.h"
 #include "Base/Mem.h"
 #include "Base/Resource.h"
+#include "Game/AssetCache.h"
 #include "Game/DoomRez.h"
 #include "Game/Resources.h"
 #include "ThreeDO/CelUtils.h"
 #include <algorithm>
+#include <condition_variable>
+#include <deque>
 #include <map>
+#include <mutex>
+#include <thread>
 #include <vector>
 
 BEGIN_NAMESPACE(Sprites)
 
-static std::vector<Sprite> gSprites;
+static std::vector<Sprite>          gSprites;
+static std::vector<ResourceHandle>  gSpriteResourceHandles;     // Handle for the raw resource of each sprite, for constant time access
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// A sprite which is being decoded in the background by the sprite decoder thread
+//------------------------------------------------------------------------------------------------------------------------------------------
+struct AsyncSpriteLoad {
+    uint32_t            resourceNum;
+    const std::byte*    pSpriteData;    // The raw sprite data: the resource is kept loaded by the main thread until the decode is done
+    uint32_t            spriteDataSize;
+    Sprite              sprite;         // The decoded sprite, filled in by the decoder thread
+    bool                bDecodedOk;     // Set by the decoder thread: 'false' if the sprite data was invalid
+};
+
+// Background sprite decoding.
+// Note: only the main thread ever touches 'gSprites', the resource manager or the pending flags; the decoder thread only decodes.
+static std::thread                      gDecoderThread;
+static std::mutex                       gDecoderMutex;
+static std::condition_variable          gDecodeQueuedCondVar;       // Signalled when a sprite is queued for decoding or on shutdown
+static std::condition_variable          gDecodeFinishedCondVar;     // Signalled when the decoder thread finishes decoding a sprite
+static std::deque<AsyncSpriteLoad>      gQueuedDecodes;             // Sprites waiting to be decoded
+static std::vector<AsyncSpriteLoad>     gFinishedDecodes;           // Sprites decoded and waiting to be handed over to the main thread
+static bool                             gbDecoderThreadQuit;
+static std::vector<bool>                gbSpriteLoadPending;        // For each sprite: whether it is currently queued or being decoded
+static uint32_t                         gNumPendingLoads;
+
+// Sprites that were wanted while drawing but not loaded: loading is started later by 'startRequestedLoads', outside of rendering
+static std::vector<uint32_t>            gRequestedLoads;
+static std::vector<bool>                gbSpriteLoadRequested;      // For each sprite: whether it is in the 'gRequestedLoads' list
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Header for sprite data.
@@ -45,6 +78,20 @@ static constexpr uint32_t SPR_OFFSET_FLAG_ROTATED = uint32_t(0x40000000);
 // Bit mask to remove sprite offsets flags
 static constexpr uint32_t REMOVE_SPR_OFFSET_FLAGS_MASK = uint32_t(0x3FFFFFFF);
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// A decoded sprite image and the map of image data offsets (within the sprite resource) to decoded images
+//------------------------------------------------------------------------------------------------------------------------------------------
+struct DecodedImage {
+    uint16_t*   pPixels;
+    uint32_t*   pColSpanIdxs;   // Opaque span info for the image, built after decoding
+    SpriteSpan* pSpans;
+    uint16_t    width;
+    uint16_t    height;
+    uint16_t    _unused[2];
+};
+
+typedef std::map<uint32_t, DecodedImage> DecodedImageMap;
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Get the sprite for a particular resource number.
 // The resource number MUST be that for a sprite.
@@ -57,12 +104,24 @@ static Sprite& getSpriteForResourceNum(const uint32_t resourceNum) noexcept {
     return gSprites[spriteIndex];
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Get the handle for the raw resource of a particular sprite.
+// The resource number MUST be that for a sprite.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static ResourceHandle getSpriteResourceHandle(const uint32_t resourceNum) noexcept {
+    ASSERT(resourceNum >= getFirstSpriteResourceNum());
+    ASSERT(resourceNum < getEndSpriteResourceNum());
+
+    const uint32_t spriteIndex = resourceNum - getFirstSpriteResourceNum();
+    return gSpriteResourceHandles[spriteIndex];
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Frees the texture data associated with a sprite
 //------------------------------------------------------------------------------------------------------------------------------------------
 static void freeSprite(Sprite& sprite) noexcept {
-    // Gather up all the texture data pointers that need to be freed
-    std::vector<uint16_t*> tmpTexturePtrList;
+    // Gather up all the texture and opaque span data pointers that need to be freed
+    std::vector<void*> tmpTexturePtrList;
 
     {
         SpriteFrame* pCurSpriteFrame = sprite.pFrames;
@@ -77,6 +136,11 @@ static void freeSprite(Sprite& sprite) noexcept {
                 if (pAngleTexture && pAngleTexture != pPrevTexture) {
                     tmpTexturePtrList.push_back(pAngleTexture);
                     pPrevTexture = pAngleTexture;
+
+                    // Note: opaque span data is unique to each texture, so it can be de-duplicated the same way
+                    if (angle.pColSpanIdxs) {
+                        tmpTexturePtrList.push_back(angle.pColSpanIdxs);
+                    }
                 }
             }
 
@@ -89,9 +153,9 @@ static void freeSprite(Sprite& sprite) noexcept {
 
     // Now free all the pointers and cleanup the temp list
     {
-        uint16_t* pPrevFreedTexture = nullptr;
+        void* pPrevFreedTexture = nullptr;
 
-        for (uint16_t* pTexture : tmpTexturePtrList) {
+        for (void* pTexture : tmpTexturePtrList) {
             if (pTexture != pPrevFreedTexture) {
                 MemFree(pTexture);
                 pPrevFreedTexture = pTexture;
@@ -106,6 +170,65 @@ static void freeSprite(Sprite& sprite) noexcept {
     sprite = {};
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Frees the pixels and opaque span data for all the given decoded images (if any) and clears them
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void freeDecodedImages(DecodedImageMap& decodedImages) noexcept {
+    for (auto& [imageDataOffset, decodedImage] : decodedImages) {
+        delete[] decodedImage.pPixels;
+        MemFree(decodedImage.pColSpanIdxs);
+        decodedImage = {};
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Finds the runs of opaque pixels in each column of a decoded sprite image, so that sprite drawing can skip the transparent parts.
+// Note: decoded sprite images are COLUMN MAJOR, so each row of the decoded image is actually a column of the sprite.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void buildOpaqueSpans(DecodedImage& decodedImage) noexcept {
+    const uint32_t numCols = decodedImage.height;
+    const uint32_t colHeight = decodedImage.width;
+
+    // Find all the spans first
+    std::vector<SpriteSpan> spans;
+    std::vector<uint32_t> colSpanIdxs;
+    colSpanIdxs.reserve(numCols + 1);
+
+    for (uint32_t x = 0; x < numCols; ++x) {
+        const uint16_t* const pColPixels = decodedImage.pPixels + (uintptr_t) x * colHeight;
+        colSpanIdxs.push_back((uint32_t) spans.size());
+
+        for (uint32_t y = 0; y < colHeight;) {
+            // Skip transparent pixels
+            if ((pColPixels[y] & 0x8000u) == 0) {
+                ++y;
+                continue;
+            }
+
+            // Found the start of an opaque span, find where it ends
+            const uint32_t beginY = y;
+
+            while ((y < colHeight) && (pColPixels[y] & 0x8000u)) {
+                ++y;
+            }
+
+            spans.push_back(SpriteSpan{ (uint16_t) beginY, (uint16_t) y });
+        }
+    }
+
+    colSpanIdxs.push_back((uint32_t) spans.size());
+
+    // Put the span indexes for each column and the spans themselves in a single allocation
+    const size_t colSpanIdxsSize = colSpanIdxs.size() * sizeof(uint32_t);
+    const size_t spansSize = spans.size() * sizeof(SpriteSpan);
+    std::byte* const pSpanData = (std::byte*) MemAlloc((uint32_t)(colSpanIdxsSize + spansSize));
+
+    decodedImage.pColSpanIdxs = (uint32_t*) pSpanData;
+    decodedImage.pSpans = (SpriteSpan*)(pSpanData + colSpanIdxsSize);
+    std::copy(colSpanIdxs.begin(), colSpanIdxs.end(), decodedImage.pColSpanIdxs);
+    std::copy(spans.begin(), spans.end(), decodedImage.pSpans);
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Reads the data for a sprite frame header
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -116,54 +239,86 @@ static SpriteImageHeader readSpriteFrameHeader(const std::byte* const pData) noe
     return header;
 }
 
-void init() noexcept {
-    ASSERT(gSprites.empty());
-    gSprites.resize(getNumSprites());
-}
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Try to read all the decoded images for a sprite from the asset cache, returning 'false' on failure.
+// The cache payload is the number of images followed by the data offset, size and pixels for each image.
+// The data offsets must match exactly the images that are requested to be decoded.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool readCachedSpriteImages(DecodedImageMap& decodedImages, const AssetCache::Key& cacheKey) noexcept {
+    AssetCache::Entry cacheEntry;
 
-void shutdown() noexcept {
-    freeAll();
-    gSprites.clear();
-}
+    if (!AssetCache::read(cacheKey, cacheEntry))
+        return false;
 
-void freeAll() noexcept {
-    for (Sprite& sprite : gSprites) {
-        freeSprite(sprite);
-    }
-}
+    try {
+        ByteInputStream stream = cacheEntry.getPayloadStream();
+        const uint32_t numImages = stream.read<uint32_t>();
 
-uint32_t getNumSprites() noexcept {
-    return uint32_t(rLASTSPRITE - rFIRSTSPRITE);
-}
+        if (numImages != decodedImages.size())
+            return false;
 
-uint32_t getFirstSpriteResourceNum() noexcept {
-    return uint32_t(rFIRSTSPRITE);
-}
+        bool bReadAllImages = true;
 
-uint32_t getEndSpriteResourceNum() noexcept {
-    return uint32_t(rLASTSPRITE);
-}
+        for (auto& [imageDataOffset, decodedImage] : decodedImages) {
+            const uint32_t cachedImageDataOffset = stream.read<uint32_t>();
+            const uint16_t width = stream.read<uint16_t>();
+            const uint16_t height = stream.read<uint16_t>();
 
-const Sprite* get(const uint32_t resourceNum) noexcept {
-    Sprite& sprite = getSpriteForResourceNum(resourceNum);
-    return &sprite;
-}
+            if ((cachedImageDataOffset != imageDataOffset) || (width == 0) || (height == 0)) {
+                bReadAllImages = false;
+                break;
+            }
 
-const Sprite* load(const uint32_t resourceNum) noexcept {
-    // Just give back the sprite if it is already loaded
-    Sprite& sprite = getSpriteForResourceNum(resourceNum);
-    const bool bIsSpriteLoaded = (sprite.pFrames != nullptr);
+            const uint32_t numPixels = (uint32_t) width * (uint32_t) height;
+            stream.ensureBytesLeft(numPixels * sizeof(uint16_t));
+            decodedImage.pPixels = new uint16_t[numPixels];
+            decodedImage.width = width;
+            decodedImage.height = height;
+            stream.readBytes((std::byte*) decodedImage.pPixels, numPixels * sizeof(uint16_t));
+        }
 
-    if (bIsSpriteLoaded) {
-        return &sprite;
+        if (bReadAllImages && (!stream.hasBytesLeft()))
+            return true;
+    } catch (...) {
+        // Fall through to cleanup below
+    }
+
+    // Failed to read the cache entry: discard any partially read images
+    freeDecodedImages(decodedImages);
+    return false;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Save all the decoded images for a sprite to the asset cache
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void writeCachedSpriteImages(const DecodedImageMap& decodedImages, const AssetCache::Key& cacheKey) noexcept {
+    AssetCache::PayloadWriter payload;
+    payload.write((uint32_t) decodedImages.size());
+
+    for (const auto& [imageDataOffset, decodedImage] : decodedImages) {
+        payload.write(imageDataOffset);
+        payload.write(decodedImage.width);
+        payload.write(decodedImage.height);
+        payload.writeBytes(decodedImage.pPixels, (uint32_t) decodedImage.width * (uint32_t) decodedImage.height * sizeof(uint16_t));
     }
 
-    // Otherwise load the raw sprite data and then determine the number of sprite frames defined for this resource by
-    // reading the offset to the data for the first sprite frame. This offset tells us the size of the 'uint32_t' frame
-    // offsets array at the start of the data, and thus the number of frames:
-    const Resource* const pSpriteResouce = Resources::load(resourceNum);
-    const uint32_t spriteDataSize = pSpriteResouce->size;
-    const std::byte* const pSpriteData = (const std::byte*) pSpriteResouce->pData;
+    AssetCache::write(cacheKey, payload);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Decodes all of the frames of a sprite from the raw sprite data, returning 'false' if the data is invalid.
+// This does not touch any global state besides the asset cache, so it can be called from the sprite decoder thread.
+// Failure is not reported here since that must be done on the main thread: the caller should raise a fatal error.
+// On failure everything allocated for the sprite is freed and the sprite is left empty.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool decodeSprite(
+    Sprite& sprite,
+    const uint32_t resourceNum,
+    const std::byte* const pSpriteData,
+    const uint32_t spriteDataSize
+) noexcept {
+    // Determine the number of sprite frames defined for this resource by reading the offset to the data for the first sprite frame.
+    // This offset tells us the size of the 'uint32_t' frame offsets array at the start of the data, and thus the number of frames:
     const uint32_t* const pFrameOffsets = (const uint32_t*) pSpriteData;
 
     const uint32_t firstFrameOffset = Endian::bigToHost(pFrameOffsets[0]);
@@ -181,14 +336,7 @@ const Sprite* load(const uint32_t resourceNum) noexcept {
 
     // Store what offsets in the data are requested to be decoded here and the actual decoded image.
     // Only want to load each unique images - some frames may use duplicate or flipped sprite data!
-    struct DecodedImage {
-        uint16_t*   pPixels;
-        uint16_t    width;
-        uint16_t    height;
-        uint16_t    _unused[2];
-    };
-
-    std::map<uint32_t, DecodedImage> decodedImages;
+    DecodedImageMap decodedImages;
 
     // Start reading the info for each frame and build up a list of what we need to decode
     for (uint32_t frameIdx = 0; frameIdx < numFrames; ++frameIdx) {
@@ -251,40 +399,61 @@ const Sprite* load(const uint32_t resourceNum) noexcept {
         }
     }
 
-    // Now start loading the data for all images
-    for (auto iter = decodedImages.begin(), endIter = decodedImages.end(); iter != endIter; ++iter) {
-        // Figure out the size of the data for the image to decode.
-        // Either use the offset of the next image to determine this or the offset of the entire sprite data's end:
-        const uint32_t imageDataOffset = iter->first;
-        DecodedImage& decodedImage = iter->second;
-
-        uint32_t imageDataSize;
-        auto nextIter = iter;
-        ++nextIter;
-
-        if (nextIter != endIter) {
-            const uint32_t nextImageOffset = nextIter->first;
-            imageDataSize = nextImageOffset - imageDataOffset;
-        } else {
-            imageDataSize = spriteDataSize - imageDataOffset;
+    // Use the already decoded images in the asset cache if available, otherwise decode them and save them to the cache.
+    // Only hash the sprite data to make the cache key if the cache is actually in use.
+    const bool bUseAssetCache = AssetCache::isEnabled();
+    const AssetCache::Key cacheKey = (bUseAssetCache) ?
+        AssetCache::makeKey(AssetCache::AssetType::SPRITE, pSpriteData, spriteDataSize) :
+        AssetCache::Key{};
+
+    if ((!bUseAssetCache) || (!readCachedSpriteImages(decodedImages, cacheKey))) {
+        // Now start loading the data for all images
+        for (auto iter = decodedImages.begin(), endIter = decodedImages.end(); iter != endIter; ++iter) {
+            // Figure out the size of the data for the image to decode.
+            // Either use the offset of the next image to determine this or the offset of the entire sprite data's end:
+            const uint32_t imageDataOffset = iter->first;
+            DecodedImage& decodedImage = iter->second;
+
+            uint32_t imageDataSize;
+            auto nextIter = iter;
+            ++nextIter;
+
+            if (nextIter != endIter) {
+                const uint32_t nextImageOffset = nextIter->first;
+                imageDataSize = nextImageOffset - imageDataOffset;
+            } else {
+                imageDataSize = spriteDataSize - imageDataOffset;
+            }
+
+            // Decode the sprite's image
+            CelImage celImg;
+            const bool bLoadedSpriteOk = CelUtils::loadRezFileCelImage(
+                pSpriteData + imageDataOffset,
+                imageDataSize,
+                CelLoadFlagBits::NONE,
+                celImg
+            );
+
+            if (!bLoadedSpriteOk) {
+                freeDecodedImages(decodedImages);
+                delete[] sprite.pFrames;
+                sprite = {};
+                return false;
+            }
+
+            decodedImage.pPixels = celImg.pPixels;
+            decodedImage.width = celImg.width;
+            decodedImage.height = celImg.height;
         }
-        
-        // Decode the sprite's image
-        CelImage celImg;
-        const bool bLoadedSpriteOk = CelUtils::loadRezFileCelImage(
-            pSpriteData + imageDataOffset,
-            imageDataSize,
-            CelLoadFlagBits::NONE,
-            celImg
-        );
-
-        if (!bLoadedSpriteOk) {
-            FATAL_ERROR("Failed to load a sprite used by the game!");
+
+        if (bUseAssetCache) {
+            writeCachedSpriteImages(decodedImages, cacheKey);
         }
+    }
 
-        decodedImage.pPixels = celImg.pPixels;
-        decodedImage.width = celImg.width;
-        decodedImage.height = celImg.height;
+    // Find the opaque parts of each image
+    for (auto& decodedImageKvp : decodedImages) {
+        buildOpaqueSpans(decodedImageKvp.second);
     }
 
     // Now once we have all the image data, fill in the actual texture info for all sprite frames
@@ -301,16 +470,266 @@ const Sprite* load(const uint32_t resourceNum) noexcept {
             // Note: Doom sprites are stored in COLUMN MAJOR format, so the width is actually the height and visa versa...
             // Swap them here to account for this!
             angle.pTexture = decodedImage.pPixels;
+            angle.pColSpanIdxs = decodedImage.pColSpanIdxs;
+            angle.pSpans = decodedImage.pSpans;
             angle.width = decodedImage.height;
             angle.height = decodedImage.width;
         }
     }
 
-    // Finally return the newly loaded sprite
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Main loop for the sprite decoder thread: decodes queued sprites until told to quit
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void decoderThreadMain() noexcept {
+    std::unique_lock<std::mutex> lock(gDecoderMutex);
+
+    while (true) {
+        gDecodeQueuedCondVar.wait(lock, []() noexcept { return (gbDecoderThreadQuit || (!gQueuedDecodes.empty())); });
+
+        if (gQueuedDecodes.empty())
+            break;
+
+        // Decode the sprite without holding the lock, so the main thread can keep queuing
+        AsyncSpriteLoad load = gQueuedDecodes.front();
+        gQueuedDecodes.pop_front();
+
+        lock.unlock();
+        load.bDecodedOk = decodeSprite(load.sprite, load.resourceNum, load.pSpriteData, load.spriteDataSize);
+        lock.lock();
+
+        gFinishedDecodes.push_back(load);
+        gDecodeFinishedCondVar.notify_all();
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Makes sprites that the decoder thread has finished decoding available for use.
+// Also releases the raw sprite data for each finished sprite since it is no longer needed.
+// Sprites that failed to decode are reported here, since fatal errors must be raised on the main thread.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void collectFinishedDecodes() noexcept {
+    if (gNumPendingLoads == 0)
+        return;
+
+    std::vector<AsyncSpriteLoad> finishedDecodes;
+
+    {
+        std::lock_guard<std::mutex> lock(gDecoderMutex);
+        finishedDecodes.swap(gFinishedDecodes);
+    }
+
+    for (AsyncSpriteLoad& load : finishedDecodes) {
+        if (!load.bDecodedOk) {
+            FATAL_ERROR("Failed to load a sprite used by the game!");
+        }
+
+        getSpriteForResourceNum(load.resourceNum) = load.sprite;
+        gbSpriteLoadPending[load.resourceNum - getFirstSpriteResourceNum()] = false;
+        Resources::release(getSpriteResourceHandle(load.resourceNum));
+        --gNumPendingLoads;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Tells if a sprite is queued for decoding or currently being decoded by the decoder thread
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool isLoadPending(const uint32_t resourceNum) noexcept {
+    return gbSpriteLoadPending[resourceNum - getFirstSpriteResourceNum()];
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Blocks until the given sprite has finished decoding in the background, if it is being decoded
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void waitForPendingLoad(const uint32_t resourceNum) noexcept {
+    collectFinishedDecodes();
+
+    while (isLoadPending(resourceNum)) {
+        {
+            std::unique_lock<std::mutex> lock(gDecoderMutex);
+            gDecodeFinishedCondVar.wait(lock, []() noexcept { return (!gFinishedDecodes.empty()); });
+        }
+
+        collectFinishedDecodes();
+    }
+}
+
+void init() noexcept {
+    ASSERT(gSprites.empty());
+    gSprites.resize(getNumSprites());
+    gbSpriteLoadPending.resize(getNumSprites());
+    gbSpriteLoadRequested.resize(getNumSprites());
+    gSpriteResourceHandles.resize(getNumSprites());
+
+    for (uint32_t spriteIdx = 0; spriteIdx < getNumSprites(); ++spriteIdx) {
+        gSpriteResourceHandles[spriteIdx] = Resources::getHandle(getFirstSpriteResourceNum() + spriteIdx);
+    }
+
+    // Start up the background sprite decoder thread.
+    // If that fails then sprites requested to load in the background are just loaded immediately instead.
+    gbDecoderThreadQuit = false;
+
+    try {
+        gDecoderThread = std::thread(decoderThreadMain);
+    } catch (...) {}
+}
+
+void shutdown() noexcept {
+    freeAll();
+
+    // Stop the decoder thread: there is nothing left for it to decode at this point
+    if (gDecoderThread.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(gDecoderMutex);
+            gbDecoderThreadQuit = true;
+        }
+
+        gDecodeQueuedCondVar.notify_all();
+        gDecoderThread.join();
+    }
+
+    gSprites.clear();
+    gbSpriteLoadPending.clear();
+    gbSpriteLoadRequested.clear();
+    gRequestedLoads.clear();
+    gSpriteResourceHandles.clear();
+}
+
+void freeAll() noexcept {
+    waitForAllPendingLoads();
+
+    // Forget about sprites that were requested but never started loading
+    for (const uint32_t resourceNum : gRequestedLoads) {
+        gbSpriteLoadRequested[resourceNum - getFirstSpriteResourceNum()] = false;
+    }
+
+    gRequestedLoads.clear();
+
+    for (Sprite& sprite : gSprites) {
+        freeSprite(sprite);
+    }
+}
+
+uint32_t getNumSprites() noexcept {
+    return uint32_t(rLASTSPRITE - rFIRSTSPRITE);
+}
+
+uint32_t getFirstSpriteResourceNum() noexcept {
+    return uint32_t(rFIRSTSPRITE);
+}
+
+uint32_t getEndSpriteResourceNum() noexcept {
+    return uint32_t(rLASTSPRITE);
+}
+
+const Sprite* get(const uint32_t resourceNum) noexcept {
+    Sprite& sprite = getSpriteForResourceNum(resourceNum);
     return &sprite;
 }
 
+const Sprite* load(const uint32_t resourceNum) noexcept {
+    // If the sprite is being decoded in the background then just wait for that to finish
+    waitForPendingLoad(resourceNum);
+
+    // Just give back the sprite if it is already loaded
+    Sprite& sprite = getSpriteForResourceNum(resourceNum);
+    const bool bIsSpriteLoaded = (sprite.pFrames != nullptr);
+
+    if (bIsSpriteLoaded) {
+        return &sprite;
+    }
+
+    // Otherwise load the raw sprite data, decode it and then release the raw data since it is no longer needed
+    const ResourceHandle resourceHandle = getSpriteResourceHandle(resourceNum);
+    const Resource& spriteResource = Resources::load(resourceHandle);
+    if (!decodeSprite(sprite, resourceNum, (const std::byte*) spriteResource.pData, spriteResource.size)) {
+        FATAL_ERROR("Failed to load a sprite used by the game!");
+    }
+
+    Resources::release(resourceHandle);
+    return &sprite;
+}
+
+void loadAsync(const uint32_t resourceNum) noexcept {
+    collectFinishedDecodes();
+
+    // Nothing to do if the sprite is already loaded or being loaded
+    const Sprite& sprite = getSpriteForResourceNum(resourceNum);
+
+    if (sprite.pFrames || isLoadPending(resourceNum))
+        return;
+
+    // If there is no decoder thread then just load the sprite now
+    if (!gDecoderThread.joinable()) {
+        load(resourceNum);
+        return;
+    }
+
+    // Load the raw data for the sprite on this thread (the resource manager is not thread safe) and queue it for decoding.
+    // Note: resources in use are never evicted, so the data stays valid until it is released once the decode is done.
+    const Resource& spriteResource = Resources::load(getSpriteResourceHandle(resourceNum));
+
+    AsyncSpriteLoad asyncLoad = {};
+    asyncLoad.resourceNum = resourceNum;
+    asyncLoad.pSpriteData = (const std::byte*) spriteResource.pData;
+    asyncLoad.spriteDataSize = spriteResource.size;
+
+    gbSpriteLoadPending[resourceNum - getFirstSpriteResourceNum()] = true;
+    ++gNumPendingLoads;
+
+    {
+        std::lock_guard<std::mutex> lock(gDecoderMutex);
+        gQueuedDecodes.push_back(asyncLoad);
+    }
+
+    gDecodeQueuedCondVar.notify_one();
+}
+
+const Sprite* getIfLoaded(const uint32_t resourceNum) noexcept {
+    collectFinishedDecodes();
+    const Sprite& sprite = getSpriteForResourceNum(resourceNum);
+
+    if (sprite.pFrames)
+        return &sprite;
+
+    // Not loaded yet and not being loaded: ask for it to be loaded later.
+    // Note: the raw sprite data is NOT read here since this is called while drawing and the read could stall the frame.
+    const uint32_t spriteIdx = resourceNum - getFirstSpriteResourceNum();
+
+    if ((!gbSpriteLoadPending[spriteIdx]) && (!gbSpriteLoadRequested[spriteIdx])) {
+        gbSpriteLoadRequested[spriteIdx] = true;
+        gRequestedLoads.push_back(resourceNum);
+    }
+
+    return nullptr;
+}
+
+void startRequestedLoads() noexcept {
+    for (const uint32_t resourceNum : gRequestedLoads) {
+        gbSpriteLoadRequested[resourceNum - getFirstSpriteResourceNum()] = false;
+        loadAsync(resourceNum);
+    }
+
+    gRequestedLoads.clear();
+}
+
+void waitForAllPendingLoads() noexcept {
+    collectFinishedDecodes();
+
+    while (gNumPendingLoads > 0) {
+        {
+            std::unique_lock<std::mutex> lock(gDecoderMutex);
+            gDecodeFinishedCondVar.wait(lock, []() noexcept { return (!gFinishedDecodes.empty()); });
+        }
+
+        collectFinishedDecodes();
+    }
+}
+
 void free(const uint32_t resourceNum) noexcept {
+    waitForPendingLoad(resourceNum);
     Sprite& sprite = getSpriteForResourceNum(resourceNum);
     freeSprite(sprite);
 }
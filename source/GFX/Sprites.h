@@ -14,11 +14,21 @@
 // The number of sprite angles in Doom (45 degree angle increments)
 static constexpr uint32_t NUM_SPRITE_DIRECTIONS = 8;
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// A run of opaque pixels in one column of a sprite texture: pixels in the range [beginY, endY) all have their alpha bit set
+//------------------------------------------------------------------------------------------------------------------------------------------
+struct SpriteSpan {
+    uint16_t    beginY;
+    uint16_t    endY;
+};
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Represents the image to use for one angle of one frame in a sprite
 //------------------------------------------------------------------------------------------------------------------------------------------
 struct SpriteFrameAngle {
     uint16_t*   pTexture;       // The sprite texture to use for the frame. This texture is in RGBA5551 format and COLUMN MAJOR.
+    uint32_t*   pColSpanIdxs;   // For each column plus 1 more: where the column's opaque spans start in 'pSpans'. Column 'x' has spans [pColSpanIdxs[x], pColSpanIdxs[x + 1]).
+    SpriteSpan* pSpans;         // The opaque spans for all columns of the sprite texture. Shares the same allocation as 'pColSpanIdxs'.
     uint16_t    width;          // Width of sprite texture
     uint16_t    height : 15;    // Height of sprite texture
     uint16_t    flipped : 1;    // If '1' then the frame is flipped horizontally when rendered
@@ -55,11 +65,21 @@ uint32_t getEndSpriteResourceNum() noexcept;        // N.B: 1 past the end index
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Notes:
 //  (1) With 'load' sprites are only loaded if not already loaded.
-//  (2) Resource number given MUST be within the range of resource numbers used for sprites!
+//      If the sprite is being loaded in the background then 'load' waits for that to finish.
+//  (2) 'loadAsync' queues the sprite to be decoded on a background thread, if not already loaded or being loaded.
+//  (3) 'getIfLoaded' never waits or reads data: it gives back null if the sprite is not loaded yet and requests for it to be loaded.
+//      'startRequestedLoads' starts loading all requested sprites in the background: it should be called once a frame, outside of
+//      rendering, since it reads the raw sprite data.
+//      'waitForAllPendingLoads' blocks until every sprite being loaded in the background is ready.
+//  (4) Resource number given MUST be within the range of resource numbers used for sprites!
 //      To check if valid, query the start and end sprite resource number.
 //------------------------------------------------------------------------------------------------------------------------------------------
 const Sprite* get(const uint32_t resourceNum) noexcept;
 const Sprite* load(const uint32_t resourceNum) noexcept;
+void loadAsync(const uint32_t resourceNum) noexcept;
+const Sprite* getIfLoaded(const uint32_t resourceNum) noexcept;
+void startRequestedLoads() noexcept;
+void waitForAllPendingLoads() noexcept;
 void free(const uint32_t resourceNum) noexcept;
 
 END_NAMESPACE(Sprites)
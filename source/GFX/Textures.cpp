@@ -1,8 +1,12 @@
 #include "Textures.h"
 
 #include "Base/Endian.h"
+#include "Base/Resource.h"
+#include "Game/AssetCache.h"
+#include "Game/Config.h"
 #include "Game/DoomRez.h"
 #include "Game/Resources.h"
+#include <cstring>
 #include <vector>
 
 BEGIN_NAMESPACE(Textures)
@@ -140,22 +144,211 @@ static void decodeFlatTextureImage(Texture& tex, const std::byte* const pBytes)
     }
 }
 
-static void loadTexture(Texture& tex, uint32_t textureNum, const bool bIsWallTexture) noexcept {
-    const std::byte* const pRawTexBytes = Resources::loadData(tex.resourceNum);
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Store a 3DO Doom wall or flat texture using indexed color, which is just a copy of the texture's color lookup table and color indexes.
+// Wall textures have a 16 color lookup table and 4-bit color indexes, flats have a 32 color lookup table and 5-bit indexes in a byte.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void storeIndexedTextureImage(Texture& tex, const std::byte* const pBytes, const bool bIsWallTexture) noexcept {
+    const uint32_t numPLUTColors = (bIsWallTexture) ? 16 : 32;
+    const uint32_t bitsPerColorIdx = (bIsWallTexture) ? 4 : 8;
+    const uint32_t numPixels = tex.data.width * tex.data.height;
+    const uint32_t numColorIdxBytes = (numPixels * bitsPerColorIdx + 7) / 8;
+
+    // Allocate the lookup table and the color indexes together
+    const uint32_t plutSize = numPLUTColors * (uint32_t) sizeof(uint16_t);
+    std::byte* const pImageBytes = MemAlloc(plutSize + numColorIdxBytes);
+
+    tex.data.pPixels = nullptr;
+    tex.data.pPLUT = reinterpret_cast<uint16_t*>(pImageBytes);
+    tex.data.pColorIdxs = reinterpret_cast<uint8_t*>(pImageBytes + plutSize);
+    tex.data.bitsPerColorIdx = bitsPerColorIdx;
+
+    // Copy the lookup table (correcting endian) and then the color indexes as-is
+    const uint16_t* const pSrcPLUT = reinterpret_cast<const uint16_t*>(pBytes);
+
+    for (uint32_t i = 0; i < numPLUTColors; ++i) {
+        tex.data.pPLUT[i] = Endian::bigToHost(pSrcPLUT[i]);
+    }
+
+    std::memcpy(tex.data.pColorIdxs, pBytes + plutSize, numColorIdxBytes);
+
+    // Flats only use 5-bits of each color index (32 colors max)
+    if (!bIsWallTexture) {
+        for (uint32_t i = 0; i < numColorIdxBytes; ++i) {
+            tex.data.pColorIdxs[i] &= uint8_t(0x1F);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Try to read the decoded pixels for a texture from the asset cache, returning 'false' on failure
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool readCachedTextureImage(Texture& tex, const AssetCache::Key& cacheKey) noexcept {
+    AssetCache::Entry cacheEntry;
+
+    if (!AssetCache::read(cacheKey, cacheEntry))
+        return false;
+
+    // The payload is just the raw pixels, so it must be exactly the expected size
+    const uint32_t numPixelBytes = tex.data.width * tex.data.height * (uint32_t) sizeof(uint16_t);
+
+    if (cacheEntry.payloadSize != numPixelBytes)
+        return false;
+
+    tex.data.pPixels = reinterpret_cast<uint16_t*>(MemAlloc(numPixelBytes));
+    std::memcpy(tex.data.pPixels, cacheEntry.pPayload, numPixelBytes);
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Makes a half size version of an ARGB1555 image by averaging each 2x2 block of pixels (a box filter).
+// The image can be either row or column major: the 'major' and 'minor' dimensions are columns and rows respectively for column major
+// images, and rows and columns for row major images. Both dimensions must be even.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void downsampleImage(
+    const uint16_t* const pSrcPixels,
+    uint16_t* const pDstPixels,
+    const uint32_t srcMajorSize,
+    const uint32_t srcMinorSize
+) noexcept {
+    ASSERT((srcMajorSize % 2 == 0) && (srcMinorSize % 2 == 0));
+    const uint32_t dstMajorSize = srcMajorSize / 2;
+    const uint32_t dstMinorSize = srcMinorSize / 2;
+
+    for (uint32_t major = 0; major < dstMajorSize; ++major) {
+        const uint16_t* const pSrcLine1 = pSrcPixels + (size_t) major * 2 * srcMinorSize;
+        const uint16_t* const pSrcLine2 = pSrcLine1 + srcMinorSize;
+        uint16_t* const pDstLine = pDstPixels + (size_t) major * dstMinorSize;
+
+        for (uint32_t minor = 0; minor < dstMinorSize; ++minor) {
+            const uint32_t pix1 = pSrcLine1[minor * 2 + 0];
+            const uint32_t pix2 = pSrcLine1[minor * 2 + 1];
+            const uint32_t pix3 = pSrcLine2[minor * 2 + 0];
+            const uint32_t pix4 = pSrcLine2[minor * 2 + 1];
+
+            // Average each color component (with rounding), and use alpha if most of the pixels have it
+            const uint32_t r = (((pix1 >> 10) & 0x1F) + ((pix2 >> 10) & 0x1F) + ((pix3 >> 10) & 0x1F) + ((pix4 >> 10) & 0x1F) + 2) / 4;
+            const uint32_t g = (((pix1 >> 5) & 0x1F) + ((pix2 >> 5) & 0x1F) + ((pix3 >> 5) & 0x1F) + ((pix4 >> 5) & 0x1F) + 2) / 4;
+            const uint32_t b = ((pix1 & 0x1F) + (pix2 & 0x1F) + (pix3 & 0x1F) + (pix4 & 0x1F) + 2) / 4;
+            const uint32_t a = ((pix1 >> 15) + (pix2 >> 15) + (pix3 >> 15) + (pix4 >> 15) >= 2) ? 1 : 0;
+
+            pDstLine[minor] = (uint16_t)((a << 15) | (r << 10) | (g << 5) | b);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Builds the mip levels for a texture, if mipmapping is enabled.
+// Each level is half the size of the previous one, stopping when a dimension would become odd or too small.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void buildTextureMipLevels(Texture& tex, const bool bIsWallTexture) noexcept {
+    constexpr uint32_t MIN_MIP_SIZE = 4;
+    tex.numMipLevels = 1;
+
+    if (!Config::gbMipmapTextures)
+        return;
+
+    // If the texture uses indexed color then expand it to get the source for the first mip level.
+    // The mip levels themselves are not indexed since filtering creates new colors.
+    std::vector<uint16_t> expandedPixels;
+    uint16_t* pLevel0Pixels = tex.data.pPixels;
+
+    if (tex.data.bitsPerColorIdx != 0) {
+        const uint32_t numPixels = tex.data.width * tex.data.height;
+        expandedPixels.resize(numPixels);
+
+        for (uint32_t i = 0; i < numPixels; ++i) {
+            expandedPixels[i] = tex.data.getPixel(i);
+        }
+
+        pLevel0Pixels = expandedPixels.data();
+    }
+
+    while (tex.numMipLevels < Texture::MAX_MIP_LEVELS) {
+        const ImageData& srcImg = tex.getMipLevel(tex.numMipLevels - 1);
+        const bool bCanHalveSize = (
+            (srcImg.width % 2 == 0) &&
+            (srcImg.height % 2 == 0) &&
+            (srcImg.width / 2 >= MIN_MIP_SIZE) &&
+            (srcImg.height / 2 >= MIN_MIP_SIZE)
+        );
+
+        if (!bCanHalveSize)
+            break;
+
+        ImageData& dstImg = tex.mipData[tex.numMipLevels - 1];
+        dstImg.width = srcImg.width / 2;
+        dstImg.height = srcImg.height / 2;
+        dstImg.pPixels = reinterpret_cast<uint16_t*>(MemAlloc(dstImg.width * dstImg.height * sizeof(uint16_t)));
+
+        // Note: wall textures are column major, flats are row major
+        const uint16_t* const pSrcPixels = (tex.numMipLevels == 1) ? pLevel0Pixels : srcImg.pPixels;
+
+        if (bIsWallTexture) {
+            downsampleImage(pSrcPixels, dstImg.pPixels, srcImg.width, srcImg.height);
+        } else {
+            downsampleImage(pSrcPixels, dstImg.pPixels, srcImg.height, srcImg.width);
+        }
 
-    if (bIsWallTexture) {
-        decodeWallTextureImage(tex, pRawTexBytes);
+        ++tex.numMipLevels;
     }
-    else {
-        decodeFlatTextureImage(tex, pRawTexBytes);
+}
+
+static void loadTexture(Texture& tex, uint32_t textureNum, const bool bIsWallTexture) noexcept {
+    const Resource& resource = Resources::load(tex.resourceHandle);
+    const std::byte* const pRawTexBytes = resource.pData;
+
+    // If using indexed color then there is no decoding to do, the texture data is just copied
+    if (Config::gbIndexedColorTextures) {
+        storeIndexedTextureImage(tex, pRawTexBytes, bIsWallTexture);
+        Resources::release(tex.resourceHandle);
+        tex.animTexNum = textureNum;
+        buildTextureMipLevels(tex, bIsWallTexture);
+        return;
     }
 
-    Resources::free(tex.resourceNum);       // Don't need the raw data anymore!
+    // Use the decoded pixels from the asset cache if available, otherwise decode and save them to the cache.
+    // Only hash the resource to make the cache key if the cache is actually in use.
+    const bool bUseAssetCache = AssetCache::isEnabled();
+    const AssetCache::Key cacheKey = (bUseAssetCache) ?
+        AssetCache::makeKey(
+            (bIsWallTexture) ? AssetCache::AssetType::WALL_TEXTURE : AssetCache::AssetType::FLAT_TEXTURE,
+            pRawTexBytes,
+            resource.size
+        ) :
+        AssetCache::Key{};
+
+    if ((!bUseAssetCache) || (!readCachedTextureImage(tex, cacheKey))) {
+        if (bIsWallTexture) {
+            decodeWallTextureImage(tex, pRawTexBytes);
+        }
+        else {
+            decodeFlatTextureImage(tex, pRawTexBytes);
+        }
+
+        if (bUseAssetCache) {
+            AssetCache::PayloadWriter payload;
+            payload.writeBytes(tex.data.pPixels, tex.data.width * tex.data.height * (uint32_t) sizeof(uint16_t));
+            AssetCache::write(cacheKey, payload);
+        }
+    }
+
+    Resources::release(tex.resourceHandle);     // Don't need the raw data anymore!
     tex.animTexNum = textureNum;            // Initially the texture is not animated to display another frame
+    buildTextureMipLevels(tex, bIsWallTexture);
 }
 
 static void freeTexture(Texture& tex) noexcept {
     MEM_FREE_AND_NULL(tex.data.pPixels);
+    MEM_FREE_AND_NULL(tex.data.pPLUT);      // Note: this also frees the color indexes
+    tex.data.pColorIdxs = nullptr;
+    tex.data.bitsPerColorIdx = 0;
+
+    for (ImageData& mipImg : tex.mipData) {
+        MEM_FREE_AND_NULL(mipImg.pPixels);
+    }
+
+    tex.numMipLevels = 0;
 }
 
 static void freeTextures(std::vector<Texture>& textures) noexcept {
@@ -201,12 +394,13 @@ void init() noexcept {
             texture.data.width = info.width;
             texture.data.height = info.height;
             texture.resourceNum = header.firstWallTexture + wallTexNum;
+            texture.resourceHandle = Resources::getHandle(texture.resourceNum);
             texture.animTexNum = wallTexNum;    // Points to itself initallly (no anim)
         }
     }
 
     // Now done with this resource
-    Resources::free(rTEXTURE1);
+    Resources::release(rTEXTURE1);
 
     // We don't have texture info for flats, all flats for 3DO are 64x64.
     // This was done orignally to help optimize the flat renderer, which was done in software on the 3DO's CPU.
@@ -218,6 +412,7 @@ void init() noexcept {
             texture.data.width = 64;
             texture.data.height = 64;
             texture.resourceNum = header.firstFlatTexture + flatTexNum;
+            texture.resourceHandle = Resources::getHandle(texture.resourceNum);
         }
     }
 }
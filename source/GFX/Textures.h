@@ -1,6 +1,7 @@
 #pragma once
 
 #include "Base/Macros.h"
+#include "Base/Resource.h"
 #include "ImageData.h"
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -13,9 +14,21 @@
 // Describes a texture for a wall or flat (floor)
 //------------------------------------------------------------------------------------------------------------------------------------------
 struct Texture {
-    ImageData   data;           // The image data for the texture
-    uint32_t    resourceNum;    // What resource this came from
-    uint32_t    animTexNum;     // Number of the texture to use in place of this one currently, if the texture is animated
+    // Maximum number of mip levels for a texture, including the full size image (level 0)
+    static constexpr uint32_t MAX_MIP_LEVELS = 4;
+
+    ImageData       data;                           // The image data for the texture
+    ImageData       mipData[MAX_MIP_LEVELS - 1];    // Box filtered half size, quarter size etc. versions of the image (mip levels 1+) if built
+    uint32_t        numMipLevels;                   // How many mip levels the texture has, including the full size image
+    uint32_t        resourceNum;                    // What resource this came from
+    ResourceHandle  resourceHandle;                 // Handle for the resource this came from, used to access it in constant time
+    uint32_t        animTexNum;                     // Number of the texture to use in place of this one currently, if the texture is animated
+
+    // Get the image data for the given mip level, which must be valid
+    inline const ImageData& getMipLevel(const uint32_t level) const noexcept {
+        ASSERT(level < numMipLevels);
+        return (level == 0) ? data : mipData[level - 1];
+    }
 };
 
 BEGIN_NAMESPACE(Textures)
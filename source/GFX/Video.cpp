@@ -1,10 +1,17 @@
 #include "Video.h"
 
+#include "Base/Simd.h"
 #include "Game/Config.h"
 #include "Game/DoomDefines.h"
 #include <algorithm>
 #include <cmath>
+#include <condition_variable>
+#include <cstring>
+#include <memory>
+#include <mutex>
 #include <SDL.h>
+#include <thread>
+#include <vector>
 
 BEGIN_NAMESPACE(Video)
 
@@ -13,6 +20,20 @@ static SDL_Renderer*    gRenderer;
 static SDL_Texture*     gFramebufferTexture;
 static SDL_Rect         gOutputRect;
 
+// State for asynchronous presentation.
+// When enabled the presentation thread owns the SDL renderer and framebuffer texture, and the game draws to one of a small set of CPU
+// framebuffers. Finished framebuffers are queued for the presentation thread, which hands them back once they are uploaded to the GPU.
+static bool                                     gbAsyncPresentation;
+static std::thread                              gPresentThread;
+static std::mutex                               gPresentMutex;
+static std::condition_variable                  gFrameQueuedCondVar;        // Signalled when a frame is queued for presentation or on shutdown
+static std::condition_variable                  gFrameBufferFreedCondVar;   // Signalled when a framebuffer can be drawn to again
+static std::vector<std::unique_ptr<uint32_t[]>> gPresentFrameBuffers;       // Storage for all of the framebuffers
+static std::vector<uint32_t*>                   gFreeFrameBuffers;          // Framebuffers which are free to be drawn to
+static std::vector<uint32_t*>                   gQueuedFrameBuffers;        // Framebuffers waiting to be presented, oldest first
+static bool                                     gbPresentThreadQuit;
+static bool                                     gbPresentThreadInitDone;
+
 uint32_t    gScreenWidth;
 uint32_t    gScreenHeight;
 uint32_t    gVideoOutputWidth;
@@ -131,48 +152,228 @@ static void determineTargetVideoMode() noexcept {
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Truncates an XRGB8888 color as if it were stored as an XRGB1555 color, and converts back to XRGB8888.
-// Used for 16-bit framebuffer simulation.
+// Truncates framebuffer colors to RGB555 - similar to the framebuffer format used by the original 3DO game.
+// Optionally also copies the truncated pixels to a second framebuffer in the same pass.
+//
+// Note: truncating an XRGB8888 color as if it were stored as an XRGB1555 color and converting back to XRGB8888 just clears the low 3 bits
+// of each color component (re-expanding the 5 bits by '255 / 248' never carries into the kept bits), so this is just a mask.
 //------------------------------------------------------------------------------------------------------------------------------------------
-static inline uint32_t truncateFramebufferColorTo16Bit(const uint32_t colorIn) noexcept {
-    uint32_t r = (colorIn & 0x00F80000);
-    uint32_t g = (colorIn & 0x0000F800);
-    uint32_t b = (colorIn & 0x000000F8);
-    r = ((r * 255) / 248) & 0x00F80000;
-    g = ((g * 255) / 248) & 0x0000F800;
-    b = ((b * 255) / 248) & 0x000000F8;
-    return (r | g | b);
+static void do16BitFramebufferSimulation(uint32_t* const pFrameBuffer, uint32_t* const pCopyFrameBuffer = nullptr) noexcept {
+    constexpr uint32_t COLOR_MASK_16_BIT = 0x00F8F8F8u;
+    const uint32_t numPixels = gScreenWidth * gScreenHeight;
+    uint32_t pixelIdx = 0;
+
+    #if SIMD_USE_SSE2
+        // Do 8 pixels at a time first
+        const __m128i colorMask = _mm_set1_epi32((int32_t) COLOR_MASK_16_BIT);
+
+        for (; pixelIdx + 8 <= numPixels; pixelIdx += 8) {
+            __m128i* const pPixels = reinterpret_cast<__m128i*>(pFrameBuffer + pixelIdx);
+            const __m128i pixels1 = _mm_and_si128(_mm_loadu_si128(pPixels + 0), colorMask);
+            const __m128i pixels2 = _mm_and_si128(_mm_loadu_si128(pPixels + 1), colorMask);
+            _mm_storeu_si128(pPixels + 0, pixels1);
+            _mm_storeu_si128(pPixels + 1, pixels2);
+
+            if (pCopyFrameBuffer) {
+                __m128i* const pCopyPixels = reinterpret_cast<__m128i*>(pCopyFrameBuffer + pixelIdx);
+                _mm_storeu_si128(pCopyPixels + 0, pixels1);
+                _mm_storeu_si128(pCopyPixels + 1, pixels2);
+            }
+        }
+    #endif
+
+    // Do the rest
+    for (; pixelIdx < numPixels; ++pixelIdx) {
+        const uint32_t color = pFrameBuffer[pixelIdx] & COLOR_MASK_16_BIT;
+        pFrameBuffer[pixelIdx] = color;
+
+        if (pCopyFrameBuffer) {
+            pCopyFrameBuffer[pixelIdx] = color;
+        }
+    }
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Truncates framebuffer colors to RGB555 - similar to the framebuffer format used by the original 3DO game
+// Creates the SDL renderer and the framebuffer texture, and clears the renderer to black.
+// Returns 'false' on failure, in which case nothing is left created.
 //------------------------------------------------------------------------------------------------------------------------------------------
-static void do16BitFramebufferSimulation() noexcept {
-    // Truncate 8 pixels at a time first
-    const uint32_t numPixels = gScreenWidth * gScreenHeight;
-    const uint32_t numPixels8 = (numPixels / 8u) * 8u;
+static bool createRendererAndFramebufferTexture() noexcept {
+    gRenderer = SDL_CreateRenderer(gWindow, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
+
+    if (!gRenderer)
+        return false;
 
-    uint32_t* pCurPixel = gpFrameBuffer;
-    uint32_t* const pEndPixel = gpFrameBuffer + numPixels;
-    uint32_t* const pEndPixel8 = gpFrameBuffer + numPixels8;
+    gFramebufferTexture = SDL_CreateTexture(
+        gRenderer,
+        SDL_PIXELFORMAT_ARGB8888,
+        SDL_TEXTUREACCESS_STREAMING,
+        (int32_t) gScreenWidth,
+        (int32_t) gScreenHeight
+    );
 
-    while (pCurPixel < pEndPixel8) {
-        pCurPixel[0] = truncateFramebufferColorTo16Bit(pCurPixel[0]);
-        pCurPixel[1] = truncateFramebufferColorTo16Bit(pCurPixel[1]);
-        pCurPixel[2] = truncateFramebufferColorTo16Bit(pCurPixel[2]);
-        pCurPixel[3] = truncateFramebufferColorTo16Bit(pCurPixel[3]);
-        pCurPixel[4] = truncateFramebufferColorTo16Bit(pCurPixel[4]);
-        pCurPixel[5] = truncateFramebufferColorTo16Bit(pCurPixel[5]);
-        pCurPixel[6] = truncateFramebufferColorTo16Bit(pCurPixel[6]);
-        pCurPixel[7] = truncateFramebufferColorTo16Bit(pCurPixel[7]);
-        pCurPixel += 8;
+    if (!gFramebufferTexture) {
+        SDL_DestroyRenderer(gRenderer);
+        gRenderer = nullptr;
+        return false;
     }
 
-    // Do the rest
-    while (pCurPixel < pEndPixel) {
-        pCurPixel[0] = truncateFramebufferColorTo16Bit(pCurPixel[0]);
-        ++pCurPixel;
+    // Clear the renderer to black
+    SDL_SetRenderDrawColor(gRenderer, 0, 0, 0, 0);
+    SDL_RenderClear(gRenderer);
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Entry point for the presentation thread.
+// Creates the renderer (SDL rendering must all happen on the one thread) then presents queued frames until told to quit.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void presentThreadMain() noexcept {
+    const bool bCreatedRenderer = createRendererAndFramebufferTexture();
+
+    {
+        std::lock_guard<std::mutex> lock(gPresentMutex);
+        gbPresentThreadInitDone = true;
+    }
+
+    gFrameBufferFreedCondVar.notify_all();
+
+    if (!bCreatedRenderer)
+        return;
+
+    while (true) {
+        // Wait for the next frame to present
+        uint32_t* pFrameBuffer = nullptr;
+
+        {
+            std::unique_lock<std::mutex> lock(gPresentMutex);
+            gFrameQueuedCondVar.wait(lock, []() noexcept { return (gbPresentThreadQuit || (!gQueuedFrameBuffers.empty())); });
+
+            if (gbPresentThreadQuit)
+                break;
+
+            pFrameBuffer = gQueuedFrameBuffers.front();
+            gQueuedFrameBuffers.erase(gQueuedFrameBuffers.begin());
+        }
+
+        // Upload the frame, after which the game can reuse the framebuffer while we wait on vsync
+        SDL_UpdateTexture(gFramebufferTexture, nullptr, pFrameBuffer, (int) gScreenWidth * (int) sizeof(uint32_t));
+
+        {
+            std::lock_guard<std::mutex> lock(gPresentMutex);
+            gFreeFrameBuffers.push_back(pFrameBuffer);
+        }
+
+        gFrameBufferFreedCondVar.notify_one();
+        SDL_RenderCopy(gRenderer, gFramebufferTexture, nullptr, &gOutputRect);
+        SDL_RenderPresent(gRenderer);
     }
+
+    // Note: destroying the renderer also destroys the framebuffer texture
+    SDL_DestroyRenderer(gRenderer);
+    gRenderer = nullptr;
+    gFramebufferTexture = nullptr;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Allocates the framebuffers used for asynchronous presentation and starts the presentation thread.
+// Makes the first framebuffer the current one to draw to.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void startPresentThread() noexcept {
+    const uint32_t numFrameBuffers = std::min(std::max(Config::gNumPresentFramebuffers, 2u), 3u);
+    const size_t numPixels = (size_t) gScreenWidth * gScreenHeight;
+
+    for (uint32_t i = 0; i < numFrameBuffers; ++i) {
+        std::unique_ptr<uint32_t[]>& pFrameBuffer = gPresentFrameBuffers.emplace_back(new uint32_t[numPixels]());
+        gFreeFrameBuffers.push_back(pFrameBuffer.get());
+    }
+
+    gpFrameBuffer = gFreeFrameBuffers.back();
+    gFreeFrameBuffers.pop_back();
+    gbPresentThreadQuit = false;
+    gbPresentThreadInitDone = false;
+
+    try {
+        gPresentThread = std::thread(presentThreadMain);
+    } catch (...) {
+        FATAL_ERROR("Failed to start the video presentation thread!");
+    }
+
+    // Wait for the thread to create the renderer and check that it succeeded
+    bool bCreatedRenderer = false;
+
+    {
+        std::unique_lock<std::mutex> lock(gPresentMutex);
+        gFrameBufferFreedCondVar.wait(lock, []() noexcept { return gbPresentThreadInitDone; });
+        bCreatedRenderer = (gRenderer != nullptr);
+    }
+
+    if (!bCreatedRenderer) {
+        gPresentThread.join();
+        FATAL_ERROR("Failed to create renderer!");
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Stops the presentation thread and frees the framebuffers used for asynchronous presentation
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void stopPresentThread() noexcept {
+    {
+        std::lock_guard<std::mutex> lock(gPresentMutex);
+        gbPresentThreadQuit = true;
+    }
+
+    gFrameQueuedCondVar.notify_all();
+
+    if (gPresentThread.joinable()) {
+        gPresentThread.join();
+    }
+
+    gFreeFrameBuffers.clear();
+    gQueuedFrameBuffers.clear();
+    gPresentFrameBuffers.clear();
+    gbPresentThreadQuit = false;
+    gbPresentThreadInitDone = false;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Queues the current framebuffer for presentation on the presentation thread, then gets a new framebuffer to draw to.
+// Waits if all framebuffers are still in use by the presentation thread.
+//
+// Note: the contents of the finished frame are copied to the new framebuffer, since some screens (e.g the pause screen) only draw
+// on top of the previous frame. If 16-bit framebuffer simulation is enabled then it is done in the same pass as this copy.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void queueFrameBufferForPresent() noexcept {
+    uint32_t* const pFinishedFrameBuffer = gpFrameBuffer;
+
+    // Get the framebuffer to draw the next frame to.
+    // In 'latest frame wins' mode any frames which have not started presenting yet are dropped in favor of this one.
+    {
+        std::unique_lock<std::mutex> lock(gPresentMutex);
+
+        if (Config::gbPresentLatestFrameOnly) {
+            gFreeFrameBuffers.insert(gFreeFrameBuffers.end(), gQueuedFrameBuffers.begin(), gQueuedFrameBuffers.end());
+            gQueuedFrameBuffers.clear();
+        }
+
+        gFrameBufferFreedCondVar.wait(lock, []() noexcept { return (!gFreeFrameBuffers.empty()); });
+        gpFrameBuffer = gFreeFrameBuffers.back();
+        gFreeFrameBuffers.pop_back();
+    }
+
+    // Finalize the finished frame, carrying over its contents to the next one
+    if (Config::gbSimulate16BitFramebuffer) {
+        do16BitFramebufferSimulation(pFinishedFrameBuffer, gpFrameBuffer);
+    } else {
+        std::memcpy(gpFrameBuffer, pFinishedFrameBuffer, sizeof(uint32_t) * (size_t) gScreenWidth * gScreenHeight);
+    }
+
+    // Hand the finished frame over to the presentation thread
+    {
+        std::lock_guard<std::mutex> lock(gPresentMutex);
+        gQueuedFrameBuffers.push_back(pFinishedFrameBuffer);
+    }
+
+    gFrameQueuedCondVar.notify_one();
 }
 
 void init() noexcept {
@@ -204,32 +405,26 @@ void init() noexcept {
         FATAL_ERROR("Unable to create a window!");
     }
 
-    // Create the renderer and framebuffer texture
-    gRenderer = SDL_CreateRenderer(gWindow, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_PRESENTVSYNC);
-
-    if (!gRenderer) {
-        FATAL_ERROR("Failed to create renderer!");
-    }
+    // Create the renderer and framebuffer texture.
+    // If presenting asynchronously then this is done by the presentation thread, which owns the renderer.
+    // Note: on MacOS all rendering must happen on the main thread, so asynchronous presentation is not possible there.
+    #ifdef __MACOSX__
+        gbAsyncPresentation = false;
+    #else
+        gbAsyncPresentation = Config::gbAsyncPresentation;
+    #endif
 
-    gFramebufferTexture = SDL_CreateTexture(
-        gRenderer,
-        SDL_PIXELFORMAT_ARGB8888,
-        SDL_TEXTUREACCESS_STREAMING,
-        (int32_t) gScreenWidth,
-        (int32_t) gScreenHeight
-    );
+    if (gbAsyncPresentation) {
+        startPresentThread();
+    } else {
+        if (!createRendererAndFramebufferTexture()) {
+            FATAL_ERROR("Failed to create renderer!");
+        }
 
-    if (!gFramebufferTexture) {
-        FATAL_ERROR("Failed to create a framebuffer texture!");
+        // Immediately lock the framebuffer texture for updating
+        lockFramebufferTexture();
     }
 
-    // Clear the renderer to black
-    SDL_SetRenderDrawColor(gRenderer, 0, 0, 0, 0);
-    SDL_RenderClear(gRenderer);
-
-    // Immediately lock the framebuffer texture for updating
-    lockFramebufferTexture();
-
     // This can be used to take a screenshot for the screen wipe effect
     gpSavedFrameBuffer = new uint32_t[(size_t) gScreenWidth * gScreenHeight];
 
@@ -242,10 +437,16 @@ void shutdown() noexcept {
     delete[] gpSavedFrameBuffer;
     gpSavedFrameBuffer = nullptr;
     gpFrameBuffer = nullptr;
+
+    if (gbAsyncPresentation) {
+        stopPresentThread();
+        gbAsyncPresentation = false;
+    }
     
     if (gRenderer) {
         SDL_DestroyRenderer(gRenderer);
         gRenderer = nullptr;
+        gFramebufferTexture = nullptr;
     }
 
     if (gWindow) {
@@ -366,8 +567,13 @@ void saveFrameBuffer() noexcept {
 }
 
 void present() noexcept {
+    if (gbAsyncPresentation) {
+        queueFrameBufferForPresent();
+        return;
+    }
+
     if (Config::gbSimulate16BitFramebuffer) {
-        do16BitFramebufferSimulation();
+        do16BitFramebufferSimulation(gpFrameBuffer);
     }
 
     unlockFramebufferTexture();
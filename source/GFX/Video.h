@@ -47,7 +47,9 @@ SDL_Window* getWindow() noexcept;
 // This should be done prior to calling 'present'.
 void saveFrameBuffer() noexcept;
 
-// Presents the framebuffer to the screen
+// Presents the framebuffer to the screen.
+// If presenting asynchronously then the frame is handed off to the presentation thread and 'gpFrameBuffer' changes to point to
+// a different framebuffer, which starts out with a copy of the frame just presented.
 void present() noexcept;
 
 // Helper that combines various end of frame operations.
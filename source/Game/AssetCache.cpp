@@ -0,0 +1,281 @@
+#include "AssetCache.h"
+
+#include "Base/FileUtils.h"
+#include "Base/Finally.h"
+#include "Base/FourCID.h"
+#include "Base/Hash.h"
+#include "Config.h"
+#include "DoomDefines.h"
+#include "DoomRez.h"
+#include "GFX/CelImages.h"
+#include "GFX/Sprites.h"
+#include "GFX/Textures.h"
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <SDL.h>
+#include <string>
+
+BEGIN_NAMESPACE(AssetCache)
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Bump this whenever the format of any of the decoded data changes, so that old cache entries are not used.
+// The version is written into each cache file and also forms part of each file name.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static constexpr uint32_t CACHE_FORMAT_VERSION = 2;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Header for each cache file: the payload of decoded data follows directly after it.
+// Note: the header size is a multiple of 16 bytes so the payload is suitably aligned in a memory mapped file.
+//------------------------------------------------------------------------------------------------------------------------------------------
+struct CacheFileHeader {
+    FourCID     magic;              // Should read 'PDAC'
+    uint32_t    formatVersion;      // Should match 'CACHE_FORMAT_VERSION'
+    uint32_t    assetType;
+    uint32_t    variant;
+    uint64_t    sourceHash;
+    uint32_t    sourceSize;
+    uint32_t    payloadSize;
+    uint32_t    sourceCrc32;
+    uint32_t    reserved[3];        // Unused, zeroed: pads the header to a multiple of 16 bytes
+};
+
+static_assert(sizeof(CacheFileHeader) % 16 == 0);
+
+static const FourCID    CACHE_FILE_MAGIC = FourCID("PDAC");
+static bool             gbIsEnabled;
+static std::string      gCacheDir;      // Note: has a path separator appended to it!
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Determines the directory to store cached assets in if one has not been explicitly specified in the config
+//------------------------------------------------------------------------------------------------------------------------------------------
+static std::string determineDefaultCacheDir() noexcept {
+    char* const pPrefPath = SDL_GetPrefPath(SAVE_FILE_ORG, SAVE_FILE_PRODUCT);
+    auto cleanupPrefPath = finally([&](){
+        SDL_free(pPrefPath);
+    });
+
+    if (!pPrefPath)
+        return {};
+
+    std::string path = pPrefPath;
+    path += "AssetCache";   // Note: path is guaranteed to have a separator at the end, as per SDL docs!
+    return path;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Makes up the path to the cache file for the given key
+//------------------------------------------------------------------------------------------------------------------------------------------
+static std::string getCacheFilePath(const Key& key) noexcept {
+    char fileName[64];
+    std::snprintf(
+        fileName,
+        sizeof(fileName),
+        "%u_%016" PRIx64 "_%08x_%u.pdac",
+        (unsigned) key.type,
+        key.sourceHash,
+        (unsigned) key.variant,
+        (unsigned) CACHE_FORMAT_VERSION
+    );
+
+    return gCacheDir + fileName;
+}
+
+void init() noexcept {
+    gbIsEnabled = false;
+
+    if (!Config::gbUseAssetCache)
+        return;
+
+    // Figure out where the cache lives and make sure the directory exists.
+    // If we can't create the cache dir then just run without the cache.
+    gCacheDir = (!Config::gAssetCacheDirectoryPath.empty()) ? Config::gAssetCacheDirectoryPath : determineDefaultCacheDir();
+
+    if (gCacheDir.empty())
+        return;
+
+    if (!FileUtils::createDirectories(gCacheDir.c_str()))
+        return;
+
+    if ((gCacheDir.back() != '/') && (gCacheDir.back() != '\\')) {
+        #if WIN32
+            gCacheDir.push_back('\\');
+        #else
+            gCacheDir.push_back('/');
+        #endif
+    }
+
+    gbIsEnabled = true;
+}
+
+void shutdown() noexcept {
+    gbIsEnabled = false;
+    gCacheDir.clear();
+    gCacheDir.shrink_to_fit();
+}
+
+bool isEnabled() noexcept {
+    return gbIsEnabled;
+}
+
+Key makeKey(const AssetType type, const std::byte* const pSrcData, const uint32_t srcSize, const uint32_t variant) noexcept {
+    ASSERT(pSrcData || srcSize == 0);
+
+    // The source data is identified by two unrelated hashes, so that a collision in one alone never picks up the wrong asset
+    Key key;
+    key.type = type;
+    key.variant = variant;
+    key.sourceSize = srcSize;
+    key.sourceCrc32 = Hash::crc32(pSrcData, srcSize);
+    key.sourceHash = Hash::fnv1a64(pSrcData, srcSize);
+    return key;
+}
+
+bool read(const Key& key, Entry& entryOut) noexcept {
+    entryOut.file.close();
+    entryOut.pPayload = nullptr;
+    entryOut.payloadSize = 0;
+
+    if (!gbIsEnabled)
+        return false;
+
+    // Try to map the file: will fail if the file does not exist
+    const std::string filePath = getCacheFilePath(key);
+
+    if (!entryOut.file.open(filePath.c_str()))
+        return false;
+
+    // Validate the header against what we expect for this key
+    const std::byte* const pFileData = entryOut.file.getData();
+    const size_t fileSize = entryOut.file.getSize();
+
+    if (fileSize < sizeof(CacheFileHeader)) {
+        entryOut.file.close();
+        return false;
+    }
+
+    CacheFileHeader header;
+    std::memcpy(&header, pFileData, sizeof(CacheFileHeader));
+
+    const bool bHeaderOk = (
+        (header.magic == CACHE_FILE_MAGIC) &&
+        (header.formatVersion == CACHE_FORMAT_VERSION) &&
+        (header.assetType == (uint32_t) key.type) &&
+        (header.variant == key.variant) &&
+        (header.sourceHash == key.sourceHash) &&
+        (header.sourceSize == key.sourceSize) &&
+        (header.sourceCrc32 == key.sourceCrc32) &&
+        (header.payloadSize == fileSize - sizeof(CacheFileHeader))
+    );
+
+    if (!bHeaderOk) {
+        entryOut.file.close();
+        return false;
+    }
+
+    entryOut.pPayload = pFileData + sizeof(CacheFileHeader);
+    entryOut.payloadSize = header.payloadSize;
+    return true;
+}
+
+void write(const Key& key, const PayloadWriter& payload) noexcept {
+    if (!gbIsEnabled)
+        return;
+
+    // Makeup the header and write it along with the payload to a temporary file
+    CacheFileHeader header = {};
+    header.magic = CACHE_FILE_MAGIC;
+    header.formatVersion = CACHE_FORMAT_VERSION;
+    header.assetType = (uint32_t) key.type;
+    header.variant = key.variant;
+    header.sourceHash = key.sourceHash;
+    header.sourceSize = key.sourceSize;
+    header.payloadSize = payload.getSize();
+    header.sourceCrc32 = key.sourceCrc32;
+
+    const std::string filePath = getCacheFilePath(key);
+    const std::string tmpFilePath = filePath + ".tmp";
+
+    const bool bWroteFile = (
+        FileUtils::writeDataToFile(tmpFilePath.c_str(), (const std::byte*) &header, sizeof(CacheFileHeader)) &&
+        FileUtils::writeDataToFile(tmpFilePath.c_str(), payload.getData(), payload.getSize(), true)
+    );
+
+    // Move the file into place once it is fully written so that other instances of the game never see partial files.
+    // If anything fails then just leave the asset uncached, it will be decoded again next time.
+    if (bWroteFile) {
+        FileUtils::renameFile(tmpFilePath.c_str(), filePath.c_str());
+    }
+
+    std::remove(tmpFilePath.c_str());
+}
+
+void prebuildAll() noexcept {
+    // All wall and flat textures
+    for (uint32_t texNum = 0; texNum < Textures::getNumWallTextures(); ++texNum) {
+        Textures::loadWall(texNum);
+        Textures::freeWall(texNum);
+    }
+
+    for (uint32_t texNum = 0; texNum < Textures::getNumFlatTextures(); ++texNum) {
+        Textures::loadFlat(texNum);
+        Textures::freeFlat(texNum);
+    }
+
+    // All Doom format sprites.
+    // Note: the player weapon sprites at the start of the sprite range are CEL image arrays instead.
+    for (uint32_t resourceNum = rSPR_BIGFISTS; resourceNum <= rSPR_BIGCHAINSAW; ++resourceNum) {
+        CelImages::loadImages(resourceNum, CelLoadFlagBits::MASKED | CelLoadFlagBits::HAS_OFFSETS);
+        CelImages::freeImages(resourceNum);
+    }
+
+    for (uint32_t resourceNum = rSPR_ZOMBIE; resourceNum < Sprites::getEndSpriteResourceNum(); ++resourceNum) {
+        Sprites::load(resourceNum);
+        Sprites::free(resourceNum);
+    }
+
+    // All CEL images used by the UI, decoded in the same way that the UI code uses them
+    struct UIImage {
+        uint32_t        resourceNum;
+        CelLoadFlags    loadFlags;
+        bool            bIsArray;
+    };
+
+    static constexpr UIImage UI_IMAGES[] = {
+        { rBACKGROUNDMASK + 0,  CelLoadFlagBits::MASKED,    false   },
+        { rBACKGROUNDMASK + 1,  CelLoadFlagBits::MASKED,    false   },
+        { rBACKGROUNDMASK + 2,  CelLoadFlagBits::MASKED,    false   },
+        { rBACKGROUNDMASK + 3,  CelLoadFlagBits::MASKED,    false   },
+        { rBACKGROUNDMASK + 4,  CelLoadFlagBits::MASKED,    false   },
+        { rBACKGROUNDMASK + 5,  CelLoadFlagBits::MASKED,    false   },
+        { rTITLE,               CelLoadFlagBits::NONE,      false   },
+        { rIDCREDITS,           CelLoadFlagBits::NONE,      false   },
+        { rCREDITS,             CelLoadFlagBits::NONE,      false   },
+        { rLOGCREDITS,          CelLoadFlagBits::NONE,      false   },
+        { rBACKGRNDBROWN,       CelLoadFlagBits::NONE,      false   },
+        { rCHARSET,             CelLoadFlagBits::MASKED,    true    },
+        { rPAUSED,              CelLoadFlagBits::NONE,      false   },
+        { rLOADING,             CelLoadFlagBits::NONE,      false   },
+        { rBIGNUMB,             CelLoadFlagBits::MASKED,    true    },
+        { rINTERMIS,            CelLoadFlagBits::MASKED,    true    },
+        { rSTBAR,               CelLoadFlagBits::NONE,      false   },
+        { rSBARSHP,             CelLoadFlagBits::MASKED,    true    },
+        { rFACES,               CelLoadFlagBits::MASKED,    true    },
+        { rSKULLS,              CelLoadFlagBits::MASKED,    true    },
+        { rMAINDOOM,            CelLoadFlagBits::NONE,      false   },
+        { rMAINMENU,            CelLoadFlagBits::MASKED,    true    },
+        { rSLIDER,              CelLoadFlagBits::MASKED,    true    },
+    };
+
+    for (const UIImage& image : UI_IMAGES) {
+        if (image.bIsArray) {
+            CelImages::loadImages(image.resourceNum, image.loadFlags);
+        } else {
+            CelImages::loadImage(image.resourceNum, image.loadFlags);
+        }
+
+        CelImages::freeImages(image.resourceNum);
+    }
+}
+
+END_NAMESPACE(AssetCache)
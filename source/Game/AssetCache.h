@@ -0,0 +1,106 @@
+#pragma once
+
+#include "Base/ByteInputStream.h"
+#include "Base/MappedFile.h"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// A cache on disk of decoded game assets (CEL images, sprites, textures and sounds) which are ready to use.
+// Decoding the native 3DO formats only needs to be done once per install, after that the decoded data can just be copied
+// out of a memory mapped cache file.
+//
+// Notes:
+//  (1) The cache is content addressed: each cache file is named after a hash of the source data it was decoded from.
+//      If the source data changes in any way (a different game disc for example) then the old entries are simply not
+//      found anymore, and stale or corrupt files are rejected by validating the header against the source data.
+//      The header also holds a CRC-32 of the source data, so that an entry is only used if two unrelated hashes both match.
+//  (2) Cache files are stored in the native endian and layout of the host machine, they are not portable.
+//  (3) Failures to read or write the cache are never fatal: the game just decodes the asset from scratch instead.
+//------------------------------------------------------------------------------------------------------------------------------------------
+BEGIN_NAMESPACE(AssetCache)
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// What type of decoded asset a cache entry holds
+//------------------------------------------------------------------------------------------------------------------------------------------
+enum class AssetType : uint32_t {
+    CEL_IMAGES      = 0,
+    SPRITE          = 1,
+    WALL_TEXTURE    = 2,
+    FLAT_TEXTURE    = 3,
+    SOUND           = 4
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Identifies a cache entry: made up from the source data the asset was decoded from and how it was decoded
+//------------------------------------------------------------------------------------------------------------------------------------------
+struct Key {
+    AssetType   type;
+    uint32_t    variant;        // Loader specific: used to distinguish different decodings of the same data (load flags etc.)
+    uint32_t    sourceSize;     // Size of the source data
+    uint32_t    sourceCrc32;    // CRC-32 of the source data: a second, independent check of the source data identity
+    uint64_t    sourceHash;     // Hash of the source data
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Builds up the payload of decoded data for a cache entry before it is written
+//------------------------------------------------------------------------------------------------------------------------------------------
+class PayloadWriter {
+public:
+    template <class T>
+    inline void write(const T& value) noexcept {
+        writeBytes(&value, (uint32_t) sizeof(T));
+    }
+
+    inline void writeBytes(const void* const pData, const uint32_t numBytes) noexcept {
+        const std::byte* const pBytes = (const std::byte*) pData;
+        mBytes.insert(mBytes.end(), pBytes, pBytes + numBytes);
+    }
+
+    inline const std::byte* getData() const noexcept { return mBytes.data(); }
+    inline uint32_t getSize() const noexcept { return (uint32_t) mBytes.size(); }
+
+private:
+    std::vector<std::byte> mBytes;
+};
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// A cache entry that has been found and validated, with its file mapped into memory
+//------------------------------------------------------------------------------------------------------------------------------------------
+struct Entry {
+    MappedFile          file;
+    const std::byte*    pPayload;
+    uint32_t            payloadSize;
+
+    inline Entry() noexcept
+        : file()
+        , pPayload(nullptr)
+        , payloadSize(0)
+    {
+    }
+
+    inline ByteInputStream getPayloadStream() const noexcept {
+        return ByteInputStream(pPayload, payloadSize);
+    }
+};
+
+void init() noexcept;
+void shutdown() noexcept;
+bool isEnabled() noexcept;
+
+// Makes the cache key for an asset of the given type decoded from the given source data
+Key makeKey(const AssetType type, const std::byte* const pSrcData, const uint32_t srcSize, const uint32_t variant = 0) noexcept;
+
+// Try to find the specified cache entry, returning 'false' if it is not present or invalid
+bool read(const Key& key, Entry& entryOut) noexcept;
+
+// Save the decoded data for the specified cache entry, replacing whatever is there already
+void write(const Key& key, const PayloadWriter& payload) noexcept;
+
+// Decodes all graphical assets used by the game, so those parts of the cache are populated.
+// Expects all the asset managers (textures, sprites etc.) to be initialized.
+// Sounds are not included since loading them requires an audio device; they are cached the first time the game loads them instead.
+void prebuildAll() noexcept;
+
+END_NAMESPACE(AssetCache)
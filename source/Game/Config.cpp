@@ -59,6 +59,31 @@ CDImagePath = Doom3DO.img
 UseDataDirectory = 0
 DataDirectoryPath = C:\Users\<MY_NAME>\<WHATEVER>\Doom3DO_DiscExtracted
 
+#---------------------------------------------------------------------------------------------------
+# Decoded asset cache settings.
+#
+# When enabled ('1') the game saves the textures, sprites, images and sounds that it decodes from the
+# native 3DO formats to a cache folder on disk, so they don't need to be decoded again the next time
+# the game is launched or a level is loaded. Cache entries are checked against the game data they
+# were decoded from, so stale entries are never used. It is always safe to delete the cache folder.
+#
+# If the cache folder path is left empty then a folder named 'AssetCache' alongside this config
+# file is used. To fill the graphics part of the cache up front launch the game with
+# '--build-asset-cache'; sounds are cached the first time the game is run.
+#---------------------------------------------------------------------------------------------------
+UseAssetCache = 1
+AssetCacheDirectoryPath =
+
+#---------------------------------------------------------------------------------------------------
+# Memory budget (in KiB) for raw game resources that are kept in memory after use, so that they can be
+# quickly reused without reading them from the game data again. When the budget is exceeded the least
+# recently used resources are unloaded first. Resources that are currently in use are never unloaded.
+#
+# The default of '0' means nothing is kept: raw resources are freed as soon as they are no longer needed.
+# The entire resource file is only ~4 MiB, so a budget of '4096' is enough to keep everything in memory.
+#---------------------------------------------------------------------------------------------------
+ResourceMemoryBudgetKB = 0
+
 )";
 
 static constexpr const char* const DEFAULT_CONFIG_INI_SECTION_3 =
@@ -137,6 +162,45 @@ IntegerOutputScaling = 0
 #---------------------------------------------------------------------------------------------------
 AspectCorrectOutputScaling = 1
 
+#---------------------------------------------------------------------------------------------------
+# Frame rate cap, in frames per second.
+#
+# If '0' then there is no cap and the game draws a frame as soon as there is a new game tick (60 Hz)
+# to show. If set to a lower value, for example '30', then the game waits at least this long between
+# frames and simulates multiple ticks per frame as required to keep running at the correct speed.
+#---------------------------------------------------------------------------------------------------
+FrameRateCap = 0
+
+#---------------------------------------------------------------------------------------------------
+# Present frames on a separate thread, toggle.
+#
+# If '1' (enabled) then uploading finished frames to the GPU and waiting for vsync happens on a
+# dedicated presentation thread, so the game can simulate and draw the next frame in the meantime.
+# If '0' (disabled) then frames are presented on the game thread, which then stalls during vsync.
+# Disabled by default: the game can then be a frame ahead of what is on screen, which adds up to a
+# frame of input latency, and each frame must be copied an extra time to hand it over to the thread.
+# Note: this setting is ignored on MacOS, where all rendering must happen on the main thread.
+#---------------------------------------------------------------------------------------------------
+AsyncPresentation = 0
+
+#---------------------------------------------------------------------------------------------------
+# Number of framebuffers to use for asynchronous presentation: must be '2' or '3'.
+#
+# With '2' the game draws one frame while the previous frame is being presented. With '3' the game
+# can get a further frame ahead, which smooths over uneven frame times at the cost of more latency.
+#---------------------------------------------------------------------------------------------------
+NumPresentFramebuffers = 2
+
+#---------------------------------------------------------------------------------------------------
+# Always present the latest frame, toggle (low latency mode).
+#
+# If '1' (enabled) then a finished frame replaces any older frame still waiting to be presented,
+# and the older frame is discarded. This minimizes input latency, but frames may be dropped.
+# If '0' (disabled) then every finished frame is presented in order.
+# Only applies when 'AsyncPresentation' is enabled.
+#---------------------------------------------------------------------------------------------------
+PresentLatestFrameOnly = 0
+
 )";
 
 static constexpr const char* const DEFAULT_CONFIG_INI_SECTION_4 =
@@ -158,6 +222,38 @@ Simulate16BitFramebuffer = 0
 #---------------------------------------------------------------------------------------------------
 DoFakeContrast = 1
 
+#---------------------------------------------------------------------------------------------------
+# Resolution of the light diminishing lookup table: the number of table entries per world unit of
+# distance from the camera. Allowed values are 1-4.
+#
+# Lighting for walls, floors and sprites is looked up in a precomputed table for speed. Higher
+# values give slightly smoother lighting very close to the camera, at the cost of more memory
+# (roughly 1.2 MB of table per unit of resolution). The default of '1' is accurate to within a
+# couple of color levels, which is not normally noticeable.
+#---------------------------------------------------------------------------------------------------
+LightTableDistResolution = 1
+
+#---------------------------------------------------------------------------------------------------
+# If set to '1' then smaller, pre-filtered versions (mipmaps) of wall and floor textures are used
+# for distant surfaces. This reduces shimmering and makes drawing distant surfaces faster, at the
+# cost of distant textures looking smoother than in the original 3DO Doom.
+#---------------------------------------------------------------------------------------------------
+MipmapTextures = 0
+
+#---------------------------------------------------------------------------------------------------
+# If set to '1' then the 3D view is drawn to an offscreen buffer stored column by column, which is
+# then copied into the framebuffer in one pass. Walls, floors, sprites and the sky are all drawn as
+# vertical columns, so this makes drawing them much more cache friendly at high render scales.
+#---------------------------------------------------------------------------------------------------
+ColumnMajor3dView = 1
+
+#---------------------------------------------------------------------------------------------------
+# If set to '1' then wall and floor textures are kept in their original 3DO indexed color format
+# (color lookup table plus 4 or 5-bit color indexes) instead of being expanded to 16-bit color.
+# This uses 2-4x less memory for textures, which is kinder on the CPU cache.
+#---------------------------------------------------------------------------------------------------
+IndexedColorTextures = 0
+
 )";
 
 static constexpr const char* const DEFAULT_CONFIG_INI_SECTION_5 =
@@ -245,6 +341,13 @@ R"(#############################################################################
 #---------------------------------------------------------------------------------------------------
 TurnSensitivity = 1.0
 
+#---------------------------------------------------------------------------------------------------
+# If enabled then mouse turning that happens after the game has simulated is applied to the camera
+# right before the frame is drawn, rather than waiting for the next game tick. This makes mouse
+# turning feel more responsive. The game itself still applies the turn on the next tick.
+#---------------------------------------------------------------------------------------------------
+LateLatchMouseTurn = 1
+
 #---------------------------------------------------------------------------------------------------
 # Whether to invert the mouse wheel x and y axis
 #---------------------------------------------------------------------------------------------------
@@ -561,19 +664,31 @@ static std::string gTmpActionStr;   // Re-use this buffer during parsing to prev
 std::string                 gGameDataCDImagePath;
 bool                        gbUseGameDataDirectory;
 std::string                 gGameDataDirectoryPath;
+bool                        gbUseAssetCache;
+std::string                 gAssetCacheDirectoryPath;
+uint32_t                    gResourceMemoryBudgetKB;
 bool                        gbFullscreen;
 uint32_t                    gRenderScale;
 int32_t                     gOutputResolutionW;
 int32_t                     gOutputResolutionH;
 bool                        gbIntegerOutputScaling;
 bool                        gbAspectCorrectOutputScaling;
+uint32_t                    gFrameRateCap;
+bool                        gbAsyncPresentation;
+uint32_t                    gNumPresentFramebuffers;
+bool                        gbPresentLatestFrameOnly;
 bool                        gbSimulate16BitFramebuffer;
 bool                        gbDoFakeContrast;
+uint32_t                    gLightTableDistResolution;
+bool                        gbMipmapTextures;
+bool                        gbColumnMajor3dView;
+bool                        gbIndexedColorTextures;
 float                       gInputAnalogToDigitalThreshold;
 bool                        gbDefaultAlwaysRun;
 Controls::MenuActionBits    gKeyboardMenuActions[Input::NUM_KEYBOARD_KEYS];
 Controls::GameActionBits    gKeyboardGameActions[Input::NUM_KEYBOARD_KEYS];
 float                       gMouseTurnSensitivity;
+bool                        gbLateLatchMouseTurn;
 bool                        gbInvertMouseWheelAxis[Input::NUM_MOUSE_WHEEL_AXES];
 Controls::MenuActionBits    gMouseMenuActions[NUM_MOUSE_BUTTONS];
 Controls::GameActionBits    gMouseGameActions[NUM_MOUSE_BUTTONS];
@@ -1035,6 +1150,15 @@ static void handleConfigEntry(const IniUtils::Entry& entry) noexcept {
         else if (entry.key == "DataDirectoryPath") {
             gGameDataDirectoryPath = entry.value;
         }
+        else if (entry.key == "UseAssetCache") {
+            gbUseAssetCache = entry.getBoolValue(gbUseAssetCache);
+        }
+        else if (entry.key == "AssetCacheDirectoryPath") {
+            gAssetCacheDirectoryPath = entry.value;
+        }
+        else if (entry.key == "ResourceMemoryBudgetKB") {
+            gResourceMemoryBudgetKB = entry.getUintValue(gResourceMemoryBudgetKB);
+        }
     }
     else if (entry.section == "Video") {
         if (entry.key == "Fullscreen") {
@@ -1055,6 +1179,18 @@ static void handleConfigEntry(const IniUtils::Entry& entry) noexcept {
         else if (entry.key == "AspectCorrectOutputScaling") {
             gbAspectCorrectOutputScaling = entry.getBoolValue(gbAspectCorrectOutputScaling);
         }
+        else if (entry.key == "FrameRateCap") {
+            gFrameRateCap = entry.getUintValue(gFrameRateCap);
+        }
+        else if (entry.key == "AsyncPresentation") {
+            gbAsyncPresentation = entry.getBoolValue(gbAsyncPresentation);
+        }
+        else if (entry.key == "NumPresentFramebuffers") {
+            gNumPresentFramebuffers = std::min(std::max(entry.getUintValue(gNumPresentFramebuffers), 2u), 3u);
+        }
+        else if (entry.key == "PresentLatestFrameOnly") {
+            gbPresentLatestFrameOnly = entry.getBoolValue(gbPresentLatestFrameOnly);
+        }
     }
     else if (entry.section == "Graphics") {
         if (entry.key == "Simulate16BitFramebuffer") {
@@ -1063,6 +1199,18 @@ static void handleConfigEntry(const IniUtils::Entry& entry) noexcept {
         else if (entry.key == "DoFakeContrast") {
             gbDoFakeContrast = entry.getBoolValue(gbDoFakeContrast);
         }
+        else if (entry.key == "LightTableDistResolution") {
+            gLightTableDistResolution = std::min(std::max(entry.getUintValue(gLightTableDistResolution), 1u), 4u);
+        }
+        else if (entry.key == "MipmapTextures") {
+            gbMipmapTextures = entry.getBoolValue(gbMipmapTextures);
+        }
+        else if (entry.key == "ColumnMajor3dView") {
+            gbColumnMajor3dView = entry.getBoolValue(gbColumnMajor3dView);
+        }
+        else if (entry.key == "IndexedColorTextures") {
+            gbIndexedColorTextures = entry.getBoolValue(gbIndexedColorTextures);
+        }
     }
     else if (entry.section == "InputGeneral") {
         if (entry.key == "AnalogToDigitalThreshold") {
@@ -1087,6 +1235,9 @@ static void handleConfigEntry(const IniUtils::Entry& entry) noexcept {
         if (entry.key == "TurnSensitivity") {
             gMouseTurnSensitivity = entry.getFloatValue(gMouseTurnSensitivity);
         }
+        else if (entry.key == "LateLatchMouseTurn") {
+            gbLateLatchMouseTurn = entry.getBoolValue(gbLateLatchMouseTurn);
+        }
         else if (entry.key == "InvertMWheelXAxis") {
             gbInvertMouseWheelAxis[0] = entry.getBoolValue(gbInvertMouseWheelAxis[0]);
         }
@@ -1128,6 +1279,9 @@ static void clear() noexcept {
     gGameDataCDImagePath = "Doom3DO.img";
     gbUseGameDataDirectory = false;
     gGameDataDirectoryPath.clear();
+    gbUseAssetCache = true;
+    gAssetCacheDirectoryPath.clear();
+    gResourceMemoryBudgetKB = 0;
 
     gbFullscreen = true;
     gRenderScale = 1;
@@ -1135,9 +1289,17 @@ static void clear() noexcept {
     gOutputResolutionH = -1;
     gbIntegerOutputScaling = true;
     gbAspectCorrectOutputScaling = true;
+    gFrameRateCap = 0;
+    gbAsyncPresentation = false;
+    gNumPresentFramebuffers = 2;
+    gbPresentLatestFrameOnly = false;
 
     gbSimulate16BitFramebuffer = false;
     gbDoFakeContrast = true;
+    gLightTableDistResolution = 1;
+    gbMipmapTextures = false;
+    gbColumnMajor3dView = true;
+    gbIndexedColorTextures = false;
 
     gInputAnalogToDigitalThreshold = 0.5f;
     gbDefaultAlwaysRun = false;
@@ -1146,6 +1308,7 @@ static void clear() noexcept {
     std::memset(gKeyboardGameActions, 0, sizeof(gKeyboardGameActions));
 
     gMouseTurnSensitivity = 1.0f;
+    gbLateLatchMouseTurn = true;
     gbInvertMouseWheelAxis[0] = false;
     gbInvertMouseWheelAxis[1] = false;
     std::memset(gMouseMenuActions, 0, sizeof(gMouseMenuActions));
@@ -1203,6 +1366,8 @@ void shutdown() noexcept {
     gGameDataCDImagePath.shrink_to_fit();
     gGameDataDirectoryPath.clear();
     gGameDataDirectoryPath.shrink_to_fit();
+    gAssetCacheDirectoryPath.clear();
+    gAssetCacheDirectoryPath.shrink_to_fit();
 }
 
 END_NAMESPACE(Config)
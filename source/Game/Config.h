@@ -10,6 +10,9 @@ BEGIN_NAMESPACE(Config)
 extern std::string  gGameDataCDImagePath;
 extern bool         gbUseGameDataDirectory;
 extern std::string  gGameDataDirectoryPath;
+extern bool         gbUseAssetCache;
+extern std::string  gAssetCacheDirectoryPath;
+extern uint32_t     gResourceMemoryBudgetKB;
 
 // Video settings
 extern bool         gbFullscreen;
@@ -18,10 +21,18 @@ extern int32_t      gOutputResolutionW;
 extern int32_t      gOutputResolutionH;
 extern bool         gbIntegerOutputScaling;
 extern bool         gbAspectCorrectOutputScaling;
+extern uint32_t     gFrameRateCap;
+extern bool         gbAsyncPresentation;
+extern uint32_t     gNumPresentFramebuffers;
+extern bool         gbPresentLatestFrameOnly;
 
 // Graphics settings
 extern bool     gbSimulate16BitFramebuffer;
 extern bool     gbDoFakeContrast;
+extern uint32_t gLightTableDistResolution;
+extern bool     gbMipmapTextures;
+extern bool     gbColumnMajor3dView;
+extern bool     gbIndexedColorTextures;
 
 // Input general settings
 extern float    gInputAnalogToDigitalThreshold;
@@ -33,6 +44,7 @@ extern Controls::GameActionBits gKeyboardGameActions[Input::NUM_KEYBOARD_KEYS];
 
 // Mouse controls and bindings
 extern float                        gMouseTurnSensitivity;
+extern bool                         gbLateLatchMouseTurn;
 extern bool                         gbInvertMouseWheelAxis[Input::NUM_MOUSE_WHEEL_AXES];
 extern Controls::MenuActionBits     gMouseMenuActions[NUM_MOUSE_BUTTONS];
 extern Controls::GameActionBits     gMouseGameActions[NUM_MOUSE_BUTTONS];
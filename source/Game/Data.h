@@ -52,7 +52,8 @@ extern uint32_t                 gValidCount;                    // Increment eve
 enum class PerfCounterMode {
     NONE,
     FPS,
-    USEC
+    USEC,
+    PACING      // Shows how late frames start compared to when they should (frame pacing jitter)
 };
 
 extern PerfCounterMode  gPerfCounterMode;           // What mode the performance counter is in
@@ -1,5 +1,6 @@
 #include "DoomMain.h"
 
+#include "AssetCache.h"
 #include "Audio/Audio.h"
 #include "Config.h"
 #include "Data.h"
@@ -7,6 +8,8 @@
 #include "GameDataFS.h"
 #include "GFX/CelImages.h"
 #include "GFX/Renderer.h"
+#include "GFX/Sprites.h"
+#include "GFX/Textures.h"
 #include "GFX/Video.h"
 #include "Map/Setup.h"
 #include "Prefs.h"
@@ -17,8 +20,8 @@
 #include "UI/OptionsMenu.h"
 #include "UI/TitleScreens.h"
 #include "UI/WipeFx.h"
+#include <cstring>
 #include <SDL.h>
-#include <thread>
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Performance profiling for the FPS count
@@ -57,6 +60,9 @@ static void checkForPerfProfileToggle() noexcept {
         else if (gPerfCounterMode == PerfCounterMode::FPS) {
             gPerfCounterMode = PerfCounterMode::USEC;
         } 
+        else if (gPerfCounterMode == PerfCounterMode::USEC) {
+            gPerfCounterMode = PerfCounterMode::PACING;
+        }
         else {
             gPerfCounterMode = PerfCounterMode::NONE;
         }
@@ -95,11 +101,11 @@ gameaction_e RunGameLoop(
     
     // Run the game loop until instructed to exit
     do {
-        // See how many ticks are to be simulated, if none then sleep for a bit
+        // See how many ticks are to be simulated, if none then sleep until there are
         uint32_t ticksLeftToSimulate = TickCounter::update();
 
         if (ticksLeftToSimulate <= 0) {
-            std::this_thread::yield();
+            TickCounter::waitForNextTick();
             continue;
         }
 
@@ -165,6 +171,7 @@ static void D_DoomInit() noexcept {
     Prefs::load();
     GameDataFS::init();
     Resources::init();
+    AssetCache::init();
     CelImages::init();
     Video::init();
     Input::init();
@@ -190,16 +197,55 @@ static void D_DoomShutdown() noexcept {
     Input::shutdown();
     Video::shutdown();
     CelImages::shutdown();
+    AssetCache::shutdown();
     Resources::shutdown();
     GameDataFS::shutdown();
     Prefs::save();
     Config::shutdown();
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Decodes all graphical game assets and saves them to the on disk asset cache, then exits.
+// Only the subsystems needed to load the assets are initialized: no window or audio device is created.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void D_BuildAssetCache() noexcept {
+    Config::init();
+    Config::gbUseAssetCache = true;     // Always use the cache for this, regardless of settings
+    GameDataFS::init();
+    Resources::init();
+    AssetCache::init();
+
+    if (!AssetCache::isEnabled()) {
+        FATAL_ERROR("Unable to create the asset cache directory! Check the 'AssetCacheDirectoryPath' setting in the config file.");
+    }
+
+    CelImages::init();
+    Textures::init();
+    Sprites::init();
+
+    AssetCache::prebuildAll();
+
+    Sprites::shutdown();
+    Textures::shutdown();
+    CelImages::shutdown();
+    AssetCache::shutdown();
+    Resources::shutdown();
+    GameDataFS::shutdown();
+    Config::shutdown();
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Main entry point for DOOM!!!!
 //------------------------------------------------------------------------------------------------------------------------------------------
-void D_DoomMain() noexcept {
+void D_DoomMain(const int argc, const char* const* const argv) noexcept {
+    // Special mode: populate the asset cache and then exit without running the game
+    for (int argIdx = 1; argIdx < argc; ++argIdx) {
+        if (std::strcmp(argv[argIdx], "--build-asset-cache") == 0) {
+            D_BuildAssetCache();
+            return;
+        }
+    }
+
     D_DoomInit();
     
     IntroLogos::run();
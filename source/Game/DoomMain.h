@@ -20,4 +20,4 @@ gameaction_e RunGameLoop(
     const GameLoopDrawFunc drawer
 ) noexcept;
 
-void D_DoomMain() noexcept;
+void D_DoomMain(const int argc, const char* const* const argv) noexcept;
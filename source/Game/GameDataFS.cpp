@@ -1,10 +1,15 @@
 #include "GameDataFS.h"
 
 #include "Base/FileUtils.h"
+#include "Base/Finally.h"
+#include "Base/Hash.h"
 #include "Config.h"
+#include "DoomDefines.h"
 #include "ThreeDO/CDImageFileInputStream.h"
 #include "ThreeDO/OperaFS.h"
+#include <cinttypes>
 #include <cstring>
+#include <SDL.h>
 
 BEGIN_NAMESPACE(GameDataFS)
 
@@ -12,6 +17,21 @@ static std::string                      gGameDataDir;       // Note: has a path
 static std::string                      gTempFilePath;      // Re-use for string building purposes
 static std::vector<OperaFS::FSEntry>    gOperaFSEntries;
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// An index of all the files in 'gOperaFSEntries' by their full normalized path, implemented as an open addressing hash table.
+// A normalized path has single '/' characters between path components and no leading or trailing separators.
+//------------------------------------------------------------------------------------------------------------------------------------------
+struct OperaFSPathIndexSlot {
+    uint64_t    pathHash;       // Hash of the normalized path of the file
+    uint32_t    entryIdx;       // Index of the file entry or 'UINT32_MAX' if the slot is unused
+};
+
+static std::vector<OperaFSPathIndexSlot>    gOperaFSPathIndex;      // Note: the size is a power of two
+static std::vector<std::string>             gOperaFSEntryPaths;     // Normalized full path for each file entry (empty for directories)
+
+// Max length of a normalized path that can be looked up
+static constexpr uint32_t MAX_NORMALIZED_PATH_LEN = 255;
+
 static bool isPathSeparatorChar(const char c) noexcept {
     return (c == '\\' || c == '/');
 }
@@ -143,20 +163,6 @@ static void makeupTempGameFilePath(const char* pRelativePath) noexcept {
     gTempFilePath.append(pRelativePath);
 }
 
-//------------------------------------------------------------------------------------------------------------------------------------------
-// Builds a list of file system entries that are contained within the CD-ROM image of 3DO Doom being used by the game.
-// Will terminate with a fatal error if this process fails.
-//------------------------------------------------------------------------------------------------------------------------------------------
-static void buildOperaFSEntriesList() noexcept {
-    if (!OperaFS::getFSEntriesFromDiscImage(Config::gGameDataCDImagePath.c_str(), gOperaFSEntries)) {
-        FATAL_ERROR_F(
-            "Failed to open, read or interpret the CD-ROM image for 3DO Doom at the specified path '%s'!\n"
-            "Does the the file at this path exist? If so is it a valid Doom 3DO CD-ROM image in Mode 1 / 2352 format?",
-            Config::gGameDataCDImagePath.c_str()
-        );
-    }
-}
-
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Tokenizer: returns the next component/part of a path string (i.e the bits in between the path separators).
 // Moves along the given pointer until it points to something that isn't a path separator, then figures out the length
@@ -196,62 +202,178 @@ static uint32_t getNextPathToken(const char*& pStr) noexcept {
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Returns an opera FS entry for the given path
+// Normalizes the given path so it can be looked up in the path index, saving the null terminated result to the given buffer.
+// Returns the length of the normalized path or '0' if the path is empty or too long.
 //------------------------------------------------------------------------------------------------------------------------------------------
-static const OperaFS::FSEntry* findOperaFSEntry(const char* const pFilePath) noexcept {
-    // Note: must have initialized the list of files on the CD-ROM!
-    ASSERT(!gOperaFSEntries.empty());
+static uint32_t normalizePath(const char* const pPath, char (&normalizedPathOut)[MAX_NORMALIZED_PATH_LEN + 1]) noexcept {
+    const char* pCurPathPart = pPath;
+    uint32_t pathLen = 0;
 
-    // Get the first part of the path, if there is not at least 1 part then we can't get any file entry
-    const char* pCurPathPart = pFilePath;
-    uint32_t curPathPartLen = getNextPathToken(pCurPathPart);
+    for (uint32_t partLen = getNextPathToken(pCurPathPart); partLen > 0; partLen = getNextPathToken(pCurPathPart)) {
+        const uint32_t separatorLen = (pathLen > 0) ? 1 : 0;
 
-    if (curPathPartLen <= 0)
-        return nullptr;
-    
-    // Continue until we have consumed all of the string, start by searching at the root
-    const OperaFS::FSEntry* pCurEntry = &gOperaFSEntries[0];
+        if (pathLen + separatorLen + partLen > MAX_NORMALIZED_PATH_LEN)
+            return 0;
 
-    do {
-        // We've hit a file or something else, can't search in this for children
-        if (pCurEntry->type != OperaFS::FSEntry::TYPE_DIR)
-            return nullptr;
+        if (separatorLen > 0) {
+            normalizedPathOut[pathLen] = '/';
+        }
 
-        // Iterate through all the children and try to find the path part we are looking for
-        const uint32_t begEntryIdx = pCurEntry->dir.firstChildIdx;
-        const uint32_t endEntryIdx = pCurEntry->dir.firstChildIdx + pCurEntry->dir.numChildren;
+        std::memcpy(normalizedPathOut + pathLen + separatorLen, pCurPathPart, partLen);
+        pathLen += separatorLen + partLen;
+        pCurPathPart += partLen;
+    }
 
-        bool bFoundCorrectChildEntry = false;
+    normalizedPathOut[pathLen] = 0;
+    return pathLen;
+}
 
-        for (uint32_t i = begEntryIdx; i < endEntryIdx; ++i) {
-            const OperaFS::FSEntry& entry = gOperaFSEntries[i];
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Adds all the files in the given directory and its subdirectories to the path index.
+// The given path prefix is the normalized path of the directory with a trailing '/' (or empty for the root).
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void addDirToOperaFSPathIndex(const uint32_t dirEntryIdx, std::string& pathPrefix) noexcept {
+    const OperaFS::FSEntry& dirEntry = gOperaFSEntries[dirEntryIdx];
+    ASSERT(dirEntry.type == OperaFS::FSEntry::TYPE_DIR);
+
+    const uint32_t begEntryIdx = dirEntry.dir.firstChildIdx;
+    const uint32_t endEntryIdx = dirEntry.dir.firstChildIdx + dirEntry.dir.numChildren;
+    const size_t pathPrefixLen = pathPrefix.length();
 
-            // Check that the strings match (up until the path part length) and are the same length
-            if (std::strncmp(pCurPathPart, entry.name, curPathPartLen) == 0) {
-                if (entry.name[curPathPartLen] == 0) {
-                    // Match - found the particular entry we are looking for!
-                    bFoundCorrectChildEntry = true;
-                    pCurEntry = &entry;
+    for (uint32_t entryIdx = begEntryIdx; entryIdx < endEntryIdx; ++entryIdx) {
+        const OperaFS::FSEntry& entry = gOperaFSEntries[entryIdx];
+        pathPrefix.append(entry.name);
+
+        if (entry.type == OperaFS::FSEntry::TYPE_DIR) {
+            pathPrefix.push_back('/');
+            addDirToOperaFSPathIndex(entryIdx, pathPrefix);
+        } else {
+            // Insert the file into the first free slot after where its hash puts it.
+            // Note: if there are duplicate paths (shouldn't happen) the first one added wins, same as the old tree search.
+            const size_t indexMask = gOperaFSPathIndex.size() - 1;
+            const uint64_t pathHash = Hash::fnv1a64(pathPrefix.c_str(), pathPrefix.length());
+
+            for (size_t slotIdx = pathHash & indexMask;; slotIdx = (slotIdx + 1) & indexMask) {
+                OperaFSPathIndexSlot& slot = gOperaFSPathIndex[slotIdx];
+
+                if (slot.entryIdx == UINT32_MAX) {
+                    slot.pathHash = pathHash;
+                    slot.entryIdx = entryIdx;
+                    gOperaFSEntryPaths[entryIdx] = pathPrefix;
                     break;
                 }
+
+                if ((slot.pathHash == pathHash) && (gOperaFSEntryPaths[slot.entryIdx] == pathPrefix))
+                    break;
             }
         }
 
-        // If we did not find what we are looking for then lookup fails
-        if (!bFoundCorrectChildEntry)
-            return nullptr;
-        
-        // Move onto the next path part
-        pCurPathPart = pCurPathPart + curPathPartLen;
-        curPathPartLen = getNextPathToken(pCurPathPart);
+        pathPrefix.resize(pathPrefixLen);
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Builds the index of files by path from the list of file system entries
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void buildOperaFSPathIndex() noexcept {
+    ASSERT(!gOperaFSEntries.empty());
 
-    } while (curPathPartLen > 0);
+    // Size the hash table so that it is at most half full
+    size_t indexSize = 16;
 
-    // The returned entry MUST be a file
-    if (pCurEntry->type != OperaFS::FSEntry::TYPE_FILE)
+    while (indexSize < gOperaFSEntries.size() * 2) {
+        indexSize *= 2;
+    }
+
+    gOperaFSPathIndex.assign(indexSize, OperaFSPathIndexSlot{ 0, UINT32_MAX });
+    gOperaFSEntryPaths.clear();
+    gOperaFSEntryPaths.resize(gOperaFSEntries.size());
+
+    std::string pathPrefix;
+    addDirToOperaFSPathIndex(0, pathPrefix);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Determines the path to the file caching the directory tree of the given disc image, or returns an empty string if there is none.
+// The file lives in the game's preferences directory rather than alongside the disc image, since that might not be writable.
+// The file name is made from a hash of the disc image path, size and modification time, so each disc image gets its own file
+// and a changed disc image never uses the old one.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static std::string determineOperaFSEntriesCacheFilePath(const std::string& discImagePath) noexcept {
+    uint64_t discImageSize = 0;
+    int64_t discImageModTime = 0;
+
+    if (!FileUtils::getFileSizeAndModTime(discImagePath.c_str(), discImageSize, discImageModTime))
+        return {};
+
+    char* const pPrefPath = SDL_GetPrefPath(SAVE_FILE_ORG, SAVE_FILE_PRODUCT);
+    auto cleanupPrefPath = finally([&](){
+        SDL_free(pPrefPath);
+    });
+
+    if (!pPrefPath)
+        return {};
+
+    // Hash everything identifying the disc image
+    uint64_t hash = Hash::fnv1a64(discImagePath.data(), discImagePath.size());
+    hash = Hash::fnv1a64(&discImageSize, sizeof(discImageSize), hash);
+    hash = Hash::fnv1a64(&discImageModTime, sizeof(discImageModTime), hash);
+
+    char fileName[64];
+    std::snprintf(fileName, sizeof(fileName), "DiscImage_%016" PRIx64 ".fsindex", hash);
+
+    std::string path = pPrefPath;
+    path += fileName;   // Note: path is guaranteed to have a separator at the end, as per SDL docs!
+    return path;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Builds a list of file system entries that are contained within the CD-ROM image of 3DO Doom being used by the game.
+// Also builds the index of files by path for fast lookup. Will terminate with a fatal error if this process fails.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void buildOperaFSEntriesList() noexcept {
+    // Note: the directory tree is cached in a file so it doesn't need to be walked on every launch (if the cache file can be made)
+    const std::string cacheFilePath = determineOperaFSEntriesCacheFilePath(Config::gGameDataCDImagePath);
+    const char* const pCacheFilePath = (!cacheFilePath.empty()) ? cacheFilePath.c_str() : nullptr;
+
+    if (!OperaFS::getFSEntriesFromDiscImage(Config::gGameDataCDImagePath.c_str(), gOperaFSEntries, pCacheFilePath)) {
+        FATAL_ERROR_F(
+            "Failed to open, read or interpret the CD-ROM image for 3DO Doom at the specified path '%s'!\n"
+            "Does the the file at this path exist? If so is it a valid Doom 3DO CD-ROM image in Mode 1 / 2352 format?",
+            Config::gGameDataCDImagePath.c_str()
+        );
+    }
+
+    buildOperaFSPathIndex();
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Returns an opera FS entry for the given path
+//------------------------------------------------------------------------------------------------------------------------------------------
+static const OperaFS::FSEntry* findOperaFSEntry(const char* const pFilePath) noexcept {
+    // Note: must have initialized the list of files on the CD-ROM!
+    ASSERT(!gOperaFSPathIndex.empty());
+
+    // Normalize the path, if there is not at least 1 part then we can't get any file entry
+    char normalizedPath[MAX_NORMALIZED_PATH_LEN + 1];
+    const uint32_t pathLen = normalizePath(pFilePath, normalizedPath);
+
+    if (pathLen <= 0)
         return nullptr;
-    
-    return pCurEntry;
+
+    // Probe the index until the file or an unused slot is found
+    const size_t indexMask = gOperaFSPathIndex.size() - 1;
+    const uint64_t pathHash = Hash::fnv1a64(normalizedPath, pathLen);
+
+    for (size_t slotIdx = pathHash & indexMask;; slotIdx = (slotIdx + 1) & indexMask) {
+        const OperaFSPathIndexSlot& slot = gOperaFSPathIndex[slotIdx];
+
+        if (slot.entryIdx == UINT32_MAX)
+            return nullptr;
+
+        if ((slot.pathHash == pathHash) && (gOperaFSEntryPaths[slot.entryIdx] == normalizedPath))
+            return &gOperaFSEntries[slot.entryIdx];
+    }
 }
 
 void init() noexcept {    
@@ -271,6 +393,10 @@ void init() noexcept {
 }
 
 void shutdown() noexcept {
+    gOperaFSPathIndex.clear();
+    gOperaFSPathIndex.shrink_to_fit();
+    gOperaFSEntryPaths.clear();
+    gOperaFSEntryPaths.shrink_to_fit();
     gOperaFSEntries.clear();
     gOperaFSEntries.shrink_to_fit();
     gTempFilePath.clear();
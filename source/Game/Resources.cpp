@@ -2,6 +2,8 @@
 
 #include "Base/Resource.h"
 #include "Base/ResourceMgr.h"
+#include "Config.h"
+#include <algorithm>
 
 BEGIN_NAMESPACE(Resources)
 
@@ -11,6 +13,7 @@ static ResourceMgr gResourceMgr;
 
 void init() noexcept {
     gResourceMgr.init(RESOURCE_FILE_PATH);
+    gResourceMgr.setMemoryBudget(std::min<uint32_t>(Config::gResourceMemoryBudgetKB, UINT32_MAX / 1024) * 1024);
 }
 
 void shutdown() noexcept {
@@ -35,21 +38,51 @@ std::byte* loadData(const uint32_t num) noexcept {
     return (pResource != nullptr) ? pResource->pData : nullptr;
 }
 
+ResourceHandle getHandle(const uint32_t num) noexcept {
+    return gResourceMgr.getResourceHandle(num);
+}
+
+const Resource& get(const ResourceHandle handle) noexcept {
+    return gResourceMgr.getResource(handle);
+}
+
+std::byte* getData(const ResourceHandle handle) noexcept {
+    return gResourceMgr.getResource(handle).pData;
+}
+
+const Resource& load(const ResourceHandle handle) noexcept {
+    return gResourceMgr.loadResource(handle);
+}
+
+std::byte* loadData(const ResourceHandle handle) noexcept {
+    return gResourceMgr.loadResource(handle).pData;
+}
+
 void free(const uint32_t num) noexcept {
     gResourceMgr.freeResource(num);
 }
 
-void release([[maybe_unused]] const uint32_t num) noexcept {
-    // At the moment I'm not implementing any kind of mark and purge memory management system like what
-    // Burgerlib had in the original 3DO source - this call is merely for documentation purposes throughout
-    // the code as a statement of intent. The code can still use this call to say 'Hey, I don't need this
-    // data anymore - get rid of it if you like'.
-    //
-    // Since modern PCs have so much memory and the data size of the 3DO Doom resources file is only ~4MB
-    // a perfectly valid memory management strategy is to simply NOT manage memory and hold onto everything.
-    // Should make level transitions faster - not that they would be slow anyway...
-    //
-    // If you're using this code to do something a little more demanding however then you may want to revisit this.
+void release(const uint32_t num) noexcept {
+    // Note: unlike the original 3DO source there is no mark and purge memory management system here. Released resources
+    // instead simply stay in memory until they need to be evicted to stay within the configured memory budget, least
+    // recently used first. With no budget set (the default) released resources are freed straight away (unless pinned).
+    gResourceMgr.releaseResource(num);
+}
+
+void release(const ResourceHandle handle) noexcept {
+    gResourceMgr.releaseResource(handle);
+}
+
+void pin(const uint32_t num) noexcept {
+    gResourceMgr.pinResource(num);
+}
+
+void unpin(const uint32_t num) noexcept {
+    gResourceMgr.unpinResource(num);
+}
+
+const ResourceMgrStats& getStats() noexcept {
+    return gResourceMgr.getStats();
 }
 
 uint32_t getEndResourceNum() noexcept {
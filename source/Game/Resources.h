@@ -5,6 +5,8 @@
 #include <cstdint>
 
 struct Resource;
+struct ResourceHandle;
+struct ResourceMgrStats;
 
 BEGIN_NAMESPACE(Resources)
 
@@ -17,8 +19,28 @@ std::byte* getData(const uint32_t num) noexcept;
 const Resource* load(const uint32_t num) noexcept;
 std::byte* loadData(const uint32_t num) noexcept;
 
+// Handle based access: the handle for a resource number can be cached and then used to access the resource in constant time.
+// The handle given to these functions MUST be valid!
+ResourceHandle getHandle(const uint32_t num) noexcept;
+const Resource& get(const ResourceHandle handle) noexcept;
+std::byte* getData(const ResourceHandle handle) noexcept;
+const Resource& load(const ResourceHandle handle) noexcept;
+std::byte* loadData(const ResourceHandle handle) noexcept;
+
+// Unload the resource immediately (unless pinned)
 void free(const uint32_t num) noexcept;
+
+// Say the resource is no longer needed: it stays in memory for quick reloads until evicted to stay within the memory budget.
+// With no memory budget set (the default) the resource is freed immediately, unless pinned.
 void release(const uint32_t num) noexcept;
+void release(const ResourceHandle handle) noexcept;
+
+// Pinned resources are never evicted from memory, even when released.
+// Each call to 'pin' must be matched with a call to 'unpin'.
+void pin(const uint32_t num) noexcept;
+void unpin(const uint32_t num) noexcept;
+
+const ResourceMgrStats& getStats() noexcept;
 
 uint32_t getEndResourceNum() noexcept;
 
@@ -12,6 +12,7 @@
 #include "DoomRez.h"
 #include "Game.h"
 #include "GFX/Renderer.h"
+#include "GFX/Sprites.h"
 #include "GFX/Video.h"
 #include "Map/Ceiling.h"
 #include "Map/Platforms.h"
@@ -249,7 +250,7 @@ void P_Drawer(const bool bPresent, const bool bSaveFrameBuffer) noexcept {
         Video::endFrame(bPresent, bSaveFrameBuffer);
     } else if (gPlayer.isOptionsMenuActive()) {
         Video::debugClearScreen();
-        Renderer::drawPlayerView();                     // Render the 3D view
+        Renderer::drawPlayerView(0);                    // Render the 3D view (no late mouse turning while in the menu)
         ST_Drawer();                                    // Draw the status bar
         O_Drawer(bPresent, bSaveFrameBuffer);           // Draw the console handler
         gbRefreshDrawn = false;
@@ -260,12 +261,16 @@ void P_Drawer(const bool bPresent, const bool bSaveFrameBuffer) noexcept {
         Video::endFrame(bPresent, bSaveFrameBuffer);
         gbRefreshDrawn = true;
     } else {
+        const angle_t lateTurnAngle = P_GetLateMouseTurn(gPlayer);     // Sample late latched mouse turning before starting to draw
         Video::debugClearScreen();
-        Renderer::drawPlayerView();                     // Render the 3D view
+        Renderer::drawPlayerView(lateTurnAngle);        // Render the 3D view
         ST_Drawer();                                    // Draw the status bar
         Video::endFrame(bPresent, bSaveFrameBuffer);
         gbRefreshDrawn = true;
     }
+
+    // Now that the frame is done, start loading any sprites that were missing while drawing it (reads the raw sprite data)
+    Sprites::startRequestedLoads();
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
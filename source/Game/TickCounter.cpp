@@ -1,8 +1,11 @@
 #include "TickCounter.h"
 
+#include "Config.h"
 #include "DoomDefines.h"
 #include <algorithm>
 #include <chrono>
+#include <cmath>
+#include <thread>
 
 BEGIN_NAMESPACE(TickCounter)
 
@@ -17,21 +20,94 @@ static constexpr int64_t NS_PER_TICK = 1000000000 / TICKSPERSEC;
 // This anticipates that draw will be very expensive so it's best to simulate the tick ahead of time.
 static constexpr int64_t ADVANCE_SIMULATE_TICK_THRESHOLD = (NS_PER_TICK * 85) / 100;
 
-typedef std::chrono::high_resolution_clock::time_point  TimePoint;
-typedef std::chrono::nanoseconds                        NSDuration;
+// How long to sleep for at a time when waiting for the next tick, and the initial guess at how long such a sleep really takes.
+// Sleeps can overshoot by a lot on some platforms, so the actual duration of sleeps is measured to decide when to stop sleeping.
+static constexpr int64_t SLEEP_STEP_NS = 1000000;
+static constexpr double INITIAL_SLEEP_ESTIMATE_NS = 5000000.0;
+
+// Max number of sleep measurements to consider when estimating how long a sleep takes.
+// After this many measurements older ones are gradually forgotten (exponentially weighted), so that the estimate adapts if the OS
+// timer resolution changes while running and the variance can shrink again after a spike.
+static constexpr uint32_t MAX_SLEEP_SAMPLES = 64;
+
+// How many frames pacing statistics are gathered over before they are updated
+static constexpr uint32_t PACING_STATS_NUM_FRAMES = TICKSPERSEC;
+
+typedef std::chrono::steady_clock::time_point   TimePoint;
+typedef std::chrono::nanoseconds                NSDuration;
 
 static TimePoint    gLastTime;
 static bool         gDidFirstUpdate;
 static int64_t      gUnsimulatedNanoSeconds;
+static TimePoint    gLastFrameTime;             // When 'update' last returned that ticks should be simulated
+static TimePoint    gNextFrameDeadline;         // When 'update' will next return that ticks should be simulated (if valid)
+static bool         gbNextFrameDeadlineValid;
+
+// Running estimate of how long a sleep of 'SLEEP_STEP_NS' actually takes (exponentially weighted mean and variance)
+static double       gSleepEstimateNs;
+static double       gSleepMeanNs;
+static double       gSleepVarianceNs2;
+static uint32_t     gNumSleepSamples;
+
+// Pacing statistics and the totals being gathered for the next update of them
+static PacingStats  gPacingStats;
+static uint64_t     gPacingJitterTotalNs;
+static int64_t      gPacingJitterMaxNs;
+static uint32_t     gPacingNumFrames;
 
 static void clearTimeValues() noexcept {
     gLastTime = {};
     gDidFirstUpdate = false;
     gUnsimulatedNanoSeconds = 0;
+    gLastFrameTime = {};
+    gNextFrameDeadline = {};
+    gbNextFrameDeadlineValid = false;
+    gPacingJitterTotalNs = 0;
+    gPacingJitterMaxNs = 0;
+    gPacingNumFrames = 0;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Gives the minimum time between frames imposed by the frame rate cap, or '0' if there is no cap
+//------------------------------------------------------------------------------------------------------------------------------------------
+static int64_t getFrameRateCapIntervalNs() noexcept {
+    return (Config::gFrameRateCap > 0) ? 1000000000 / (int64_t) Config::gFrameRateCap : 0;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Records a frame starting at the given time, for the purposes of pacing statistics
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void recordFrameStart(const TimePoint now) noexcept {
+    // Note: can only measure jitter if the frame was waited on; if the game is running behind then there was no deadline
+    if (gbNextFrameDeadlineValid) {
+        const int64_t jitterNs = std::max<int64_t>(NSDuration(now - gNextFrameDeadline).count(), 0);
+        gPacingJitterTotalNs += (uint64_t) jitterNs;
+        gPacingJitterMaxNs = std::max(gPacingJitterMaxNs, jitterNs);
+        gPacingNumFrames++;
+    }
+
+    gLastFrameTime = now;
+    gbNextFrameDeadlineValid = false;
+
+    if (gPacingNumFrames >= PACING_STATS_NUM_FRAMES) {
+        gPacingStats.avgJitterUSec = (uint32_t)((gPacingJitterTotalNs / gPacingNumFrames) / 1000);
+        gPacingStats.maxJitterUSec = (uint32_t)(gPacingJitterMaxNs / 1000);
+        gPacingJitterTotalNs = 0;
+        gPacingJitterMaxNs = 0;
+        gPacingNumFrames = 0;
+    }
 }
 
 void init() noexcept {
     clearTimeValues();
+
+    // Note: the sleep estimate is deliberately kept between runs of the game loop, since it's a property of the OS
+    // The initial guess is only used until the first sleep is measured and does not feed into the mean or variance.
+    if (gNumSleepSamples == 0) {
+        gSleepEstimateNs = INITIAL_SLEEP_ESTIMATE_NS;
+        gSleepMeanNs = 0.0;
+        gSleepVarianceNs2 = 0.0;
+    }
 }
 
 void shutdown() noexcept {
@@ -39,7 +115,7 @@ void shutdown() noexcept {
 }
 
 uint32_t update() noexcept {
-    const TimePoint now = std::chrono::high_resolution_clock::now();
+    const TimePoint now = std::chrono::steady_clock::now();
 
     // Note: the first update always requests to simulate 1 tick.
     // Otherwise we see how much time has elapsed between calls.
@@ -48,27 +124,74 @@ uint32_t update() noexcept {
         gLastTime = now;
         gUnsimulatedNanoSeconds += timeElapsed.count();
 
-        if (gUnsimulatedNanoSeconds > 0) {
-            const int64_t ticksToSimulate = gUnsimulatedNanoSeconds / NS_PER_TICK;
+        // If there is a frame rate cap then don't start a frame until enough time has passed since the last one.
+        // Time still accumulates in the meantime, so more ticks are simulated in the next frame to keep the game running at the right speed.
+        const int64_t capIntervalNs = getFrameRateCapIntervalNs();
+        const int64_t nsSinceLastFrame = NSDuration(now - gLastFrameTime).count();
+        const int64_t nsUntilCapAllowsFrame = std::max<int64_t>(capIntervalNs - nsSinceLastFrame, 0);
+
+        if (nsUntilCapAllowsFrame <= 0) {
+            const int64_t ticksToSimulate = std::max<int64_t>(gUnsimulatedNanoSeconds, 0) / NS_PER_TICK;
 
             if (ticksToSimulate > 0) {
                 gUnsimulatedNanoSeconds -= ticksToSimulate * NS_PER_TICK;
+                recordFrameStart(now);
                 return (uint32_t) std::min(ticksToSimulate, MAX_TICKS_TO_SIMULATE);
             } else {
                 if (gUnsimulatedNanoSeconds >= ADVANCE_SIMULATE_TICK_THRESHOLD) {
                     gUnsimulatedNanoSeconds -= NS_PER_TICK;
+                    recordFrameStart(now);
                     return 1;
                 }
             }
         }
 
+        // No ticks to simulate yet: figure out when there will be, so that 'waitForNextTick' knows how long to wait for
+        const int64_t nsUntilTickDue = std::max<int64_t>(ADVANCE_SIMULATE_TICK_THRESHOLD - gUnsimulatedNanoSeconds, 0);
+        gNextFrameDeadline = now + NSDuration(std::max(nsUntilTickDue, nsUntilCapAllowsFrame));
+        gbNextFrameDeadlineValid = true;
         return 0;
     }
     else {
         gLastTime = now;
         gDidFirstUpdate = true;
+        recordFrameStart(now);
         return 1;
     }
 }
 
+void waitForNextTick() noexcept {
+    if (!gbNextFrameDeadlineValid)
+        return;
+
+    // Sleep in small steps for as long as the remaining time comfortably allows it, measuring how long each sleep really takes
+    TimePoint now = std::chrono::steady_clock::now();
+
+    while (NSDuration(gNextFrameDeadline - now).count() > (int64_t) gSleepEstimateNs) {
+        const TimePoint sleepStart = now;
+        std::this_thread::sleep_for(NSDuration(SLEEP_STEP_NS));
+        now = std::chrono::steady_clock::now();
+
+        // Update the estimate of how long a sleep takes: use the mean plus one standard deviation to be on the safe side.
+        // Each new sample is weighted equally with the others until the sample cap is reached, after which the weight stays fixed.
+        const double sleepNs = (double) NSDuration(now - sleepStart).count();
+        gNumSleepSamples = std::min(gNumSleepSamples + 1, MAX_SLEEP_SAMPLES);
+
+        const double weight = 1.0 / (double) gNumSleepSamples;
+        const double delta = sleepNs - gSleepMeanNs;
+        gSleepMeanNs += weight * delta;
+        gSleepVarianceNs2 = (1.0 - weight) * (gSleepVarianceNs2 + weight * delta * delta);
+        gSleepEstimateNs = gSleepMeanNs + std::sqrt(gSleepVarianceNs2);
+    }
+
+    // Spin for the rest of the time for precision
+    while (std::chrono::steady_clock::now() < gNextFrameDeadline) {
+        std::this_thread::yield();
+    }
+}
+
+const PacingStats& getPacingStats() noexcept {
+    return gPacingStats;
+}
+
 END_NAMESPACE(TickCounter)
@@ -5,11 +5,23 @@
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Simple module that keeps track of time for the game and tells how many ticks need to be simulated.
+// Also paces the game loop: rather than spinning until the next tick is due, the loop can sleep until shortly before then.
 //------------------------------------------------------------------------------------------------------------------------------------------
 BEGIN_NAMESPACE(TickCounter)
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Statistics on how accurately frames are being paced, averaged over a number of frames.
+// Jitter is how late a frame started relative to when it was due to start.
+//------------------------------------------------------------------------------------------------------------------------------------------
+struct PacingStats {
+    uint32_t    avgJitterUSec;      // Average amount a frame started late by
+    uint32_t    maxJitterUSec;      // Most a frame started late by
+};
+
 void init() noexcept;
 void shutdown() noexcept;
-uint32_t update() noexcept;     // Update time tracking and return the number of ticks that must be simulated
+uint32_t update() noexcept;             // Update time tracking and return the number of ticks that must be simulated
+void waitForNextTick() noexcept;        // Sleep (and then briefly spin for precision) until 'update' will return at least 1 tick
+const PacingStats& getPacingStats() noexcept;
 
 END_NAMESPACE(TickCounter)
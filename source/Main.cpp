@@ -1,6 +1,8 @@
 #include "Game/DoomMain.h"
 #if WIN32
 #include <Windows.h>
+#include <string>
+#include <vector>
 
 int WINAPI wWinMain(
     [[maybe_unused]] HINSTANCE hInstance,
@@ -8,13 +10,28 @@ int WINAPI wWinMain(
     [[maybe_unused]] LPWSTR lpCmdLine,
     [[maybe_unused]] int nCmdShow
 ) {
+    // Convert the wide char program arguments to UTF-8
+    std::vector<std::string> args;
+    std::vector<const char*> argPtrs;
+
+    for (int i = 0; i < __argc; ++i) {
+        const int numChars = WideCharToMultiByte(CP_UTF8, 0, __wargv[i], -1, nullptr, 0, nullptr, nullptr);
+        std::string& arg = args.emplace_back((numChars > 0) ? numChars - 1 : 0, '\0');
+        WideCharToMultiByte(CP_UTF8, 0, __wargv[i], -1, arg.data(), numChars, nullptr, nullptr);
+    }
+
+    for (const std::string& arg : args) {
+        argPtrs.push_back(arg.c_str());
+    }
+
+    const int argc = (int) argPtrs.size();
+    const char* const* const argv = argPtrs.data();
 #else 
 int main(int argc, char* argv[]) noexcept {
 #endif
 #if APPLE
     @autoreleasepool {
 #endif
-    D_DoomMain();
+    D_DoomMain(argc, argv);
     return 0;
 }
-
@@ -94,7 +94,7 @@ static void loadVertexes(const uint32_t lumpResourceNum) noexcept {
         ++pDstVert;
     }
 
-    Resources::free(lumpResourceNum);
+    Resources::release(lumpResourceNum);
 }
 
 static void loadSectors(const uint32_t lumpResourceNum) noexcept {
@@ -131,7 +131,7 @@ static void loadSectors(const uint32_t lumpResourceNum) noexcept {
     }
 
     // Don't need this anymore
-    Resources::free(lumpResourceNum);
+    Resources::release(lumpResourceNum);
 }
 
 static void loadSides(const uint32_t lumpResourceNum) noexcept {
@@ -170,7 +170,7 @@ static void loadSides(const uint32_t lumpResourceNum) noexcept {
     }
 
     // Don't need this anymore
-    Resources::free(lumpResourceNum);
+    Resources::release(lumpResourceNum);
 }
 
 static void loadLines(const uint32_t lumpResourceNum) noexcept {
@@ -263,7 +263,7 @@ static void loadLines(const uint32_t lumpResourceNum) noexcept {
     }
 
     // Don't need this anymore
-    Resources::free(lumpResourceNum);
+    Resources::release(lumpResourceNum);
 }
 
 static void loadLineSegs(const uint32_t lumpResourceNum) noexcept {
@@ -322,7 +322,7 @@ static void loadLineSegs(const uint32_t lumpResourceNum) noexcept {
     }
 
     // Don't need this anymore
-    Resources::free(lumpResourceNum);
+    Resources::release(lumpResourceNum);
 }
 
 static void loadSubSectors(const uint32_t lumpResourceNum) noexcept {
@@ -357,7 +357,7 @@ static void loadSubSectors(const uint32_t lumpResourceNum) noexcept {
     }
 
     // Don't need this anymore
-    Resources::free(lumpResourceNum);
+    Resources::release(lumpResourceNum);
 }
 
 static void loadNodes(const uint32_t lumpResourceNum) noexcept {
@@ -419,7 +419,7 @@ static void loadNodes(const uint32_t lumpResourceNum) noexcept {
     gpBSPTreeRoot = &gNodes.back();
 
     // Don't need this anymore
-    Resources::free(lumpResourceNum);
+    Resources::release(lumpResourceNum);
 }
 
 static void loadReject(const uint32_t lumpResourceNum) noexcept {
@@ -508,7 +508,7 @@ static void loadBlockMap(const uint32_t lumpResourceNum) noexcept {
     gpBlockMapThingLists = gBlockMapThingLists.data();
 
     // Don't need this anymore
-    Resources::free(lumpResourceNum);
+    Resources::release(lumpResourceNum);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -607,7 +607,7 @@ void mapDataShutdown() {
     gpBSPTreeRoot = nullptr;
 
     if (gLoadedRejectMatrixResourceNum > 0) {
-        Resources::free(gLoadedRejectMatrixResourceNum);
+        Resources::release(gLoadedRejectMatrixResourceNum);
         gLoadedRejectMatrixResourceNum = 0;
     }
 
@@ -90,10 +90,6 @@ struct line_t {
 
     // Intrusive/non-property fields
     uint32_t    validCount;             // Keeps track of whether the line has been visited during certain operations
-    float       v1DrawDepth;            // Depth of v1 and v2 when drawn
-    float       v2DrawDepth;
-    uint8_t     drawnSideIndex;         // Which side of the line is being rendered
-    bool        bIsInFrontOfSprite;     // Used during sprite clipping: stores if the line is considered in front of the sprite
 };
 
 // Flags that can be applied to a line
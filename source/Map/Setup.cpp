@@ -12,6 +12,7 @@
 #include "MapData.h"
 #include "Specials.h"
 #include "Switch.h"
+#include "Things/Info.h"
 #include "Things/MapObj.h"
 #include "UI/UIUtils.h"
 #include <cstring>
@@ -162,7 +163,7 @@ static void LoadThings(const uint32_t lumpResourceNum) {
     }
 
     // Done with this list
-    Resources::free(lumpResourceNum);
+    Resources::release(lumpResourceNum);
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -271,13 +272,13 @@ static void PreloadWalls() noexcept {
         }
     }
 
-    // Preloading other resources that were marked for preloading in the fixed preload table
+    // Preloading the sprites that were marked for preloading in the fixed preload table.
+    // Note: these are decoded rather than just loaded as raw resources, since released raw resources may not stay in memory.
     {
         uint32_t tableIdx = 0;
 
         while (PRELOAD_TABLE[tableIdx] != UINT32_MAX) {
-            Resources::loadData(PRELOAD_TABLE[tableIdx]);
-            Resources::release(PRELOAD_TABLE[tableIdx]);
+            Sprites::loadAsync(PRELOAD_TABLE[tableIdx]);
             ++tableIdx;
         }
     }
@@ -286,6 +287,92 @@ static void PreloadWalls() noexcept {
     MemFree(bLoadTexFlags);
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Marks for loading the sprites used by every state reachable from the given state, following the chain of next states
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void MarkStateChainSprites(const state_t* pState, bool* const bVisitedStates, bool* const bLoadSpriteFlags) noexcept {
+    const uint32_t firstSpriteResourceNum = Sprites::getFirstSpriteResourceNum();
+
+    while (pState && (!bVisitedStates[pState - gStates])) {
+        bVisitedStates[pState - gStates] = true;
+
+        uint32_t spriteResourceNum;
+        uint32_t spriteFrameNum;
+        bool bIsSpriteFullBright;
+        state_t::decomposeSpriteFrameFieldComponents(pState->SpriteFrame, spriteResourceNum, spriteFrameNum, bIsSpriteFullBright);
+
+        if ((spriteResourceNum >= firstSpriteResourceNum) && (spriteResourceNum < Sprites::getEndSpriteResourceNum())) {
+            bLoadSpriteFlags[spriteResourceNum - firstSpriteResourceNum] = true;
+        }
+
+        pState = pState->nextstate;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Predict what sprites the level will need and start decoding them in the background, so they don't have to be decoded the first time
+// they are seen. Uses the types of things in the level and follows all of their state chains (walking, attacking, dying etc.) to find
+// the sprites. Projectiles and common effects like blood and teleport fog are always loaded, since any level might spawn them.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void PreloadSprites() noexcept {
+    // Figure out what types of things to load sprites for
+    bool bLoadTypeFlags[NUMMOBJTYPES] = {};
+
+    for (mobj_t* pMObj = gMObjHead.next; pMObj != &gMObjHead; pMObj = pMObj->next) {
+        bLoadTypeFlags[pMObj->InfoPtr - gMObjInfo] = true;
+    }
+
+    for (uint32_t type = 0; type < NUMMOBJTYPES; ++type) {
+        if (gMObjInfo[type].flags & MF_MISSILE) {
+            bLoadTypeFlags[type] = true;
+        }
+    }
+
+    // Items that enemies drop when killed (see 'KillMobj') might not be in the level to begin with
+    bLoadTypeFlags[MT_CLIP] = true;
+    bLoadTypeFlags[MT_SHOTGUN] = true;
+    bLoadTypeFlags[MT_CHAINGUN] = true;
+
+    bLoadTypeFlags[MT_PUFF] = true;
+    bLoadTypeFlags[MT_BLOOD] = true;
+    bLoadTypeFlags[MT_TFOG] = true;
+    bLoadTypeFlags[MT_IFOG] = true;
+
+    // Follow all the state chains for these types to find the sprites to load
+    const uint32_t numSprites = Sprites::getNumSprites();
+    bool* const bLoadSpriteFlags = reinterpret_cast<bool*>(MemAlloc(numSprites * sizeof(bool)));
+    bool* const bVisitedStates = reinterpret_cast<bool*>(MemAlloc(NUMSTATES * sizeof(bool)));
+    memset(bLoadSpriteFlags, 0, numSprites * sizeof(bool));
+    memset(bVisitedStates, 0, NUMSTATES * sizeof(bool));
+
+    for (uint32_t type = 0; type < NUMMOBJTYPES; ++type) {
+        if (!bLoadTypeFlags[type])
+            continue;
+
+        const mobjinfo_t& info = gMObjInfo[type];
+        MarkStateChainSprites(info.spawnstate, bVisitedStates, bLoadSpriteFlags);
+        MarkStateChainSprites(info.seestate, bVisitedStates, bLoadSpriteFlags);
+        MarkStateChainSprites(info.painstate, bVisitedStates, bLoadSpriteFlags);
+        MarkStateChainSprites(info.meleestate, bVisitedStates, bLoadSpriteFlags);
+        MarkStateChainSprites(info.missilestate, bVisitedStates, bLoadSpriteFlags);
+        MarkStateChainSprites(info.deathstate, bVisitedStates, bLoadSpriteFlags);
+        MarkStateChainSprites(info.xdeathstate, bVisitedStates, bLoadSpriteFlags);
+    }
+
+    // Queue up all the sprites marked for loading to be decoded in the background
+    const uint32_t firstSpriteResourceNum = Sprites::getFirstSpriteResourceNum();
+
+    for (uint32_t spriteIdx = 0; spriteIdx < numSprites; ++spriteIdx) {
+        if (bLoadSpriteFlags[spriteIdx]) {
+            Sprites::loadAsync(firstSpriteResourceNum + spriteIdx);
+        }
+    }
+
+    // Cleanup
+    MemFree(bLoadSpriteFlags);
+    MemFree(bVisitedStates);
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Set the sky texture number for the map
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -322,7 +409,9 @@ void SetupLevel(const uint32_t map) noexcept {
     LoadThings(getMapStartLump(map) + ML_THINGS);   // Spawn all the items
     SpawnSpecials();                                // Spawn all sector specials
     setSkyTextureNum();                             // Figure out which sky to use
+    PreloadSprites();                               // Start decoding the sprites the level is likely to need in the background
     PreloadWalls();                                 // Load all the wall textures and sprites (also does sky texture)
+    Sprites::waitForAllPendingLoads();              // Make sure all the predicted sprites are ready before the level starts
     gbGamePaused = false;                           // Game in progress
 }
 
@@ -5,6 +5,7 @@
 #include "Base/Tables.h"
 #include "Game/Config.h"
 #include "Game/Data.h"
+#include "Game/Tick.h"
 #include "GFX/Renderer.h"
 #include "Info.h"
 #include "Map/Map.h"
@@ -335,6 +336,46 @@ static void P_BuildMove(player_t& player) noexcept {
     }
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Gives the extra turning to apply to the view for mouse movement that has happened since the last tick, if late latching of mouse
+// turning is enabled. This lets the camera respond to the mouse right before a frame is drawn instead of waiting for the next tick.
+// The next tick then applies the same mouse movement for real via 'P_BuildMove', which is why the turn is computed the same way.
+//------------------------------------------------------------------------------------------------------------------------------------------
+angle_t P_GetLateMouseTurn(const player_t& player) noexcept {
+    if (!Config::gbLateLatchMouseTurn)
+        return 0;
+
+    // Only do this if the next tick will actually turn the player
+    const bool bCanTurn = (
+        (!gbGamePaused) &&
+        (player.playerstate == PST_LIVE) &&
+        (!player.isOptionsMenuActive()) &&
+        ((!player.isAutomapActive()) || player.isAutomapFollowModeActive()) &&
+        (player.mo) &&
+        (player.mo->reactiontime <= 0) &&
+        ((player.mo->flags & MF_JUSTATTACKED) == 0)
+    );
+
+    if (!bCanTurn)
+        return 0;
+
+    // Use the same turn speed that the next tick is most likely to use
+    const bool bIsRunning = (gbAlwaysRun || GAME_ACTION(RUN));
+    const uint32_t turnIndex = std::min<uint32_t>(player.turnheld, C_ARRAY_SIZE(ANGLE_TURN) - 1);
+
+    const bool bUseFastTurn = (
+        bIsRunning &&
+        (!GAME_ACTION(MOVE_FORWARD)) &&
+        (!GAME_ACTION(MOVE_BACKWARD)) &&
+        (INPUT_AXIS(MOVE_FORWARD_BACK) == 0.0f) &&
+        (INPUT_AXIS(STRAFE_LEFT_RIGHT) == 0.0f)
+    );
+
+    const float angleTurnFracF = -Input::getLateMouseXMovement() * MOUSE_TURN_SCALE * Config::gMouseTurnSensitivity;
+    const Fixed angleTurnFrac = floatToFixed16(angleTurnFracF);
+    return (angle_t) fixed16Mul(angleTurnFrac, (bUseFastTurn) ? FAST_ANGLE_TURN[turnIndex] : ANGLE_TURN[turnIndex]);
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Moves the given origin along a given angle
 //------------------------------------------------------------------------------------------------------------------------------------------
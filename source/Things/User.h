@@ -1,6 +1,9 @@
 #pragma once
 
+#include "Base/Angle.h"
+
 struct player_t;
 
 void P_PlayerThink(player_t& player) noexcept;
 void PlayerCalcHeight(player_t& player) noexcept;
+angle_t P_GetLateMouseTurn(const player_t& player) noexcept;
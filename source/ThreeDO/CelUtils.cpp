@@ -4,6 +4,9 @@
 #include "Base/ByteInputStream.h"
 #include "Base/Endian.h"
 #include "Base/FourCID.h"
+#include "Base/ParallelFor.h"
+#include <atomic>
+#include <cstring>
 #include <type_traits>
 
 BEGIN_NAMESPACE(CelUtils)
@@ -62,6 +65,9 @@ static constexpr uint32_t CCB_FLAG_LINEAR = 0x00000010;     // The CCB flag set
 // Bitwise OR this with the decoded color to ensure an opaque pixel
 static constexpr uint16_t OPAQUE_PIXEL_BITS = 0x8000;
 
+// Minimum number of images in an image array for each thread used to decode the array: small arrays are not worth starting threads for
+static constexpr uint32_t MIN_IMAGES_PER_DECODE_THREAD = 4;
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Transforms a cel image that uses a special color to represent transparency to a regular ARGB1555 image with alpha.
 // This simplifies & unifies blitting operations elsewhere if the color format for cel images is the same as other
@@ -138,17 +144,31 @@ static uint8_t getCCBBitsPerPixel(const CelControlBlock& ccb) noexcept {
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Decodes unpacked (raw) CEL image data.
+// Reads a single pixel of CEL image data with the given bits per pixel.
+// Images with less than 16 bits per pixel are color indexed and the color is looked up in the PLUT and made opaque.
+// 16-bit images store the color directly, which is returned as is.
+//------------------------------------------------------------------------------------------------------------------------------------------
+template <uint8_t BPP>
+static inline uint16_t readCelPixel(BitInputStream& bitStream, const uint16_t* const pPLUT) THROWS {
+    if constexpr (BPP == 16) {
+        return bitStream.readBitsAsUInt<uint16_t>(16);
+    } else {
+        const uint8_t colorIdx = bitStream.readBitsAsUInt<uint8_t>(BPP);
+        return Endian::bigToHost(pPLUT[colorIdx]) | OPAQUE_PIXEL_BITS;  // Note: making 'always opaque' only works assuming the image is used as a 'masked' image...
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Decodes unpacked (raw) CEL image data with the given bits per pixel.
 // The pointer to the image data must point to the start data for the first row.
 //------------------------------------------------------------------------------------------------------------------------------------------
+template <uint8_t BPP>
 static void decodeUnpackedCelPixelData(
     const std::byte* const pImageData,
     const uint32_t imageDataSize,
     const uint16_t* const pPLUT,
     const uint16_t imageW,
     const uint16_t imageH,
-    const uint8_t imageBPP,
-    const bool bColorIndexed,
     uint16_t* const pImageOut
 ) THROWS {
     // Setup for reading
@@ -163,7 +183,7 @@ static void decodeUnpackedCelPixelData(
     bool bDo64BitAlignment = true;
 
     {
-        const uint32_t rowSizeInBits = imageBPP * imageW;
+        const uint32_t rowSizeInBits = BPP * imageW;
         const uint32_t alignedRowSizeInBits = (rowSizeInBits + 63) & (~63u);
         const uint32_t alignedRowSizeInBytes = alignedRowSizeInBits / 8;
         const uint32_t totalImageSizeWithAlignment = alignedRowSizeInBytes * imageH;
@@ -174,57 +194,31 @@ static void decodeUnpackedCelPixelData(
     }
 
     // Read the entire image
-    if (bColorIndexed) {
-        for (uint16_t y = 0; y < imageH; ++y) {
-            if (bDo64BitAlignment) {
-                bitStream.align64();
-            }
-
-            for (uint16_t x = 0; x < imageW; ++x) {
-                const uint8_t colorIdx = bitStream.readBitsAsUInt<uint8_t>(imageBPP);
-                const uint16_t color = Endian::bigToHost(pPLUT[colorIdx]) | OPAQUE_PIXEL_BITS;  // Note: making 'always opaque' only works assuming the image is used as a 'masked' image...
-                *pCurOutputPixel = color;
-                ++pCurOutputPixel;
-            }
+    for (uint16_t y = 0; y < imageH; ++y) {
+        if (bDo64BitAlignment) {
+            bitStream.align64();
         }
-    } else {
-        ASSERT(imageBPP == 16);
-
-        for (uint16_t y = 0; y < imageH; ++y) {
-            if (bDo64BitAlignment) {
-                bitStream.align64();
-            }
 
-            for (uint16_t x = 0; x < imageW; ++x) {
-                const uint16_t color = bitStream.readBitsAsUInt<uint16_t>(16);
-                *pCurOutputPixel = color;
-                ++pCurOutputPixel;
-            }
+        for (uint16_t x = 0; x < imageW; ++x) {
+            *pCurOutputPixel = readCelPixel<BPP>(bitStream, pPLUT);
+            ++pCurOutputPixel;
         }
     }
 }
 
 //-------------------------------------------------------------------------------------------------
-// Decode packed CEL pixel data.
+// Decode packed CEL pixel data with the given bits per pixel.
 // The pointer to the image data must point to the start data for the first row.
 //-------------------------------------------------------------------------------------------------
+template <uint8_t BPP>
 static void decodePackedCelPixelData(
     const std::byte* const pImageData,
     const uint32_t imageDataSize,
     const uint16_t* const pPLUT,
     const uint16_t imageW,
     const uint16_t imageH,
-    const uint8_t imageBPP,
-    const bool bColorIndexed,
     uint16_t* const pImageOut
 ) THROWS {
-    // Only supporting these image formats!
-    const bool bSupportedImgFormat = (bColorIndexed || imageBPP == 16);
-
-    if (!bSupportedImgFormat) {
-        throw CelDecodeException();
-    }
-
     // Alloc output image and start decoding each row
     const std::byte* pCurRowData = pImageData;
     const std::byte* pNextRowData = nullptr;
@@ -240,7 +234,7 @@ static void decodePackedCelPixelData(
         {
             // For 8 and 16-bit CEL images the offset is encoded in 10-bits of a u16.
             // For other CEL image formats just a single byte is used.
-            if (imageBPP >= 8) {
+            if constexpr (BPP >= 8) {
                 nextRowOffset = bitStream.readBitsAsUInt<uint16_t>(16) & uint16_t(0x3FF);
             } else {
                 nextRowOffset = bitStream.readBitsAsUInt<uint16_t>(8);
@@ -283,16 +277,7 @@ static void decodePackedCelPixelData(
                 const uint16_t endX = x + packCount;
 
                 while (x < endX) {
-                    uint16_t color;
-
-                    if (bColorIndexed) {
-                        const uint16_t colorIdx = bitStream.readBitsAsUInt<uint16_t>(imageBPP);
-                        color = Endian::bigToHost(pPLUT[colorIdx]) | OPAQUE_PIXEL_BITS;
-                    } else {
-                        color = bitStream.readBitsAsUInt<uint16_t>(16) | OPAQUE_PIXEL_BITS;
-                    }
-
-                    pRowPixels[x] = color;
+                    pRowPixels[x] = readCelPixel<BPP>(bitStream, pPLUT) | OPAQUE_PIXEL_BITS;
                     ++x;
                 }
             }
@@ -307,15 +292,7 @@ static void decodePackedCelPixelData(
                     throw CelDecodeException();     // Bad image data!
                 }
 
-                uint16_t color;
-
-                if (bColorIndexed) {
-                    const uint16_t colorIdx = bitStream.readBitsAsUInt<uint16_t>(imageBPP);
-                    color = Endian::bigToHost(pPLUT[colorIdx]) | OPAQUE_PIXEL_BITS;
-                } else {
-                    color = bitStream.readBitsAsUInt<uint16_t>(16) | OPAQUE_PIXEL_BITS;
-                }
-
+                const uint16_t color = readCelPixel<BPP>(bitStream, pPLUT) | OPAQUE_PIXEL_BITS;
                 const uint16_t endX = x + packCount;
 
                 while (x < endX) {
@@ -330,6 +307,26 @@ static void decodePackedCelPixelData(
     }
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Decodes the actual CEL pixel data using the packed or unpacked decoder specialized for the given bits per pixel
+//------------------------------------------------------------------------------------------------------------------------------------------
+template <uint8_t BPP>
+static void decodeCelPixelDataWithBPP(
+    const std::byte* const pImageData,
+    const uint32_t imageDataSize,
+    const uint16_t* const pPLUT,
+    const uint16_t imageW,
+    const uint16_t imageH,
+    const bool bImageIsPacked,
+    uint16_t* const pImageOut
+) THROWS {
+    if (bImageIsPacked) {
+        decodePackedCelPixelData<BPP>(pImageData, imageDataSize, pPLUT, imageW, imageH, pImageOut);
+    } else {
+        decodeUnpackedCelPixelData<BPP>(pImageData, imageDataSize, pPLUT, imageW, imageH, pImageOut);
+    }
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Decodes the actual CEL pixel data.
 // The pointer to the image data must point to the start data for the first row.
@@ -346,7 +343,7 @@ static uint16_t* decodeCelPixelData(
     const bool bColorIndexed
 ) noexcept {
     // Only supporting these image formats!
-    const bool bSupportedImgFormat = (bColorIndexed || imageBPP == 16);
+    const bool bSupportedImgFormat = (bColorIndexed) ? (imageBPP < 16) : (imageBPP == 16);
 
     if (!bSupportedImgFormat) {
         return nullptr;
@@ -357,28 +354,16 @@ static uint16_t* decodeCelPixelData(
 
     // Try and do the decode
     try {
-        if (bImageIsPacked) {
-            decodePackedCelPixelData(
-                pImageData,
-                imageDataSize,
-                pPLUT,
-                imageW,
-                imageH,
-                imageBPP,
-                bColorIndexed,
-                pImageOut
-            );
-        } else {
-            decodeUnpackedCelPixelData(
-                pImageData,
-                imageDataSize,
-                pPLUT,
-                imageW,
-                imageH,
-                imageBPP,
-                bColorIndexed,
-                pImageOut
-            );
+        switch (imageBPP) {
+            case 1:     decodeCelPixelDataWithBPP<1>(pImageData, imageDataSize, pPLUT, imageW, imageH, bImageIsPacked, pImageOut);   break;
+            case 2:     decodeCelPixelDataWithBPP<2>(pImageData, imageDataSize, pPLUT, imageW, imageH, bImageIsPacked, pImageOut);   break;
+            case 4:     decodeCelPixelDataWithBPP<4>(pImageData, imageDataSize, pPLUT, imageW, imageH, bImageIsPacked, pImageOut);   break;
+            case 6:     decodeCelPixelDataWithBPP<6>(pImageData, imageDataSize, pPLUT, imageW, imageH, bImageIsPacked, pImageOut);   break;
+            case 8:     decodeCelPixelDataWithBPP<8>(pImageData, imageDataSize, pPLUT, imageW, imageH, bImageIsPacked, pImageOut);   break;
+            case 16:    decodeCelPixelDataWithBPP<16>(pImageData, imageDataSize, pPLUT, imageW, imageH, bImageIsPacked, pImageOut);  break;
+
+            default:
+                throw CelDecodeException();
         }
     } catch (...) {
         delete[] pImageOut;
@@ -558,37 +543,46 @@ bool loadRezFileCelImages(
     if (dataSize <= numImages * 4)
         return false;
     
-    // Read each image offset and consequently each image
-    bool bAllSucceeded = true;
-
-    imagesOut.numImages = numImages;
-    imagesOut.pImages = new CelImage[numImages];
+    // Read each image offset and make sure there is enough data in the stream for each image before reading any of them
+    const uint32_t* const pImageOffsets = (const uint32_t*) pData;
 
     for (uint32_t imageIdx = 0; imageIdx < numImages; ++imageIdx) {
         // Figure out where this image in the array starts and ends
-        const uint32_t thisImageOffset = Endian::bigToHost(((const uint32_t*) pData)[imageIdx]);
-        const uint32_t nextImageOffset = (imageIdx + 1 < numImages) ? Endian::bigToHost(((const uint32_t*) pData)[imageIdx + 1]) : dataSize;
+        const uint32_t thisImageOffset = Endian::bigToHost(pImageOffsets[imageIdx]);
+        const uint32_t nextImageOffset = (imageIdx + 1 < numImages) ? Endian::bigToHost(pImageOffsets[imageIdx + 1]) : dataSize;
         const uint32_t thisImageDataSize = nextImageOffset - thisImageOffset;
 
-        // Make sure there is enough data left in the stream before we read the image!
-        if (thisImageOffset >= dataSize || thisImageOffset + thisImageDataSize > dataSize) {
-            bAllSucceeded = false;
-            break;
-        }
+        if (thisImageOffset >= dataSize || thisImageOffset + thisImageDataSize > dataSize)
+            return false;
+    }
+
+    // Decode all of the images in parallel: each image is independent and written to its own slot in the array
+    std::atomic<bool> bAnyImageFailed(false);
+
+    imagesOut.numImages = numImages;
+    imagesOut.pImages = new CelImage[numImages];
+
+    parallelFor(numImages, MIN_IMAGES_PER_DECODE_THREAD, [&](const uint32_t imageIdx) noexcept {
+        // If some other image failed then the whole load fails, so don't bother
+        if (bAnyImageFailed.load(std::memory_order_relaxed))
+            return;
+
+        const uint32_t thisImageOffset = Endian::bigToHost(pImageOffsets[imageIdx]);
+        const uint32_t nextImageOffset = (imageIdx + 1 < numImages) ? Endian::bigToHost(pImageOffsets[imageIdx + 1]) : dataSize;
 
-        // Load the image and abort if it failed
         const bool bImageLoadSucceeded = loadRezFileCelImage(
             pData + thisImageOffset,
-            thisImageDataSize,
+            nextImageOffset - thisImageOffset,
             loadFlags,
             imagesOut.pImages[imageIdx]
         );
 
         if (!bImageLoadSucceeded) {
-            bAllSucceeded = false;
-            break;
+            bAnyImageFailed.store(true, std::memory_order_relaxed);
         }
-    }
+    });
+
+    const bool bAllSucceeded = (!bAnyImageFailed.load(std::memory_order_relaxed));
 
     // If the load failed then cleanup, otherwise save the load flags for future reference
     if (bAllSucceeded) {
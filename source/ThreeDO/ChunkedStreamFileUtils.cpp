@@ -1,8 +1,7 @@
 #include "ChunkedStreamFileUtils.h"
 
-#include "Base/ByteInputStream.h"
 #include "Base/Endian.h"
-#include <memory>
+#include <cstring>
 
 BEGIN_NAMESPACE(ChunkedStreamFileUtils)
 
@@ -83,120 +82,38 @@ struct ChunkHeader {
     }
 };
 
-//------------------------------------------------------------------------------------------------------------------------------------------
-// Iterates over all the chunks in a stream file to determine the size of the specified sub stream
-//------------------------------------------------------------------------------------------------------------------------------------------
-static uint32_t determineSubStreamSize(
-    const std::byte* const pStreamFileData,
-    const uint32_t streamFileSize,
-    const FourCID subStreamId
-) noexcept {
-    ASSERT(streamFileSize > sizeof(StreamHeader));
-
-    try {
-        // First skip over the stream header
-        uint32_t subStreamSize = 0;
-        ByteInputStream bytes(pStreamFileData, streamFileSize);
-        bytes.consume(sizeof(StreamHeader));
-
-        // Keep reading more chunk headers until we are done
-        while (bytes.hasBytesLeft()) {
-            // Get the sub chunk header and see if it is the type we are interested in.
-            // If it is the correct type then account for it's size.
-            ChunkHeader header;
-            bytes.read(header);
-            header.convertBigToHostEndian();
-            const uint32_t chunkDataSize = header.chunkSize - sizeof(ChunkHeader);
-
-            if (header.chunkType == subStreamId) {
-                subStreamSize += chunkDataSize;
-            }
-
-            // Skip past this chunk
-            bytes.consume(chunkDataSize);
-        }
+static_assert(sizeof(StreamHeader) == STREAM_HEADER_SIZE);
+static_assert(sizeof(ChunkHeader) == CHUNK_HEADER_SIZE);
 
-        // Return the result
-        return subStreamSize;
-    }
-    catch (...) {
-        return 0;
-    }
-}
+bool checkStreamHeader(const std::byte* const pHeaderData) noexcept {
+    ASSERT(pHeaderData);
 
-bool getSubStreamData(
-    const std::byte* const pStreamFileData,
-    const uint32_t streamFileSize,
-    const FourCID subStreamId,
-    std::byte*& pSubStreamDataOut,
-    uint32_t& subStreamSizeOut
-) noexcept {
-    ASSERT(pStreamFileData || streamFileSize == 0);
-
-    // Give these initial invalid values
-    pSubStreamDataOut = nullptr;
-    subStreamSizeOut = 0;
-
-    // The stream data MUST be at least big enough for the stream header
-    if (streamFileSize <= sizeof(StreamHeader))
-        return false;
-    
     // Read the stream header and endian correct
     StreamHeader streamHdr;
-    std::memcpy(&streamHdr, pStreamFileData, sizeof(StreamHeader));
+    std::memcpy(&streamHdr, pHeaderData, sizeof(StreamHeader));
     streamHdr.convertBigToHostEndian();
 
     // Ensure the header is what we expect
-    if (streamHdr.chunkType != FourCID("SHDR"))
-        return false;
-    
-    if (streamHdr.headerVersion != 2)
-        return false;
+    return (
+        (streamHdr.chunkType == FourCID("SHDR")) &&
+        (streamHdr.headerVersion == 2) &&
+        (streamHdr.chunkSize == sizeof(StreamHeader))
+    );
+}
 
-    if (streamHdr.chunkSize != sizeof(StreamHeader))
-        return false;
-    
-    // Determine the size of the sub stream, if there is no data then we cannot read it
-    const uint32_t subStreamSize = determineSubStreamSize(pStreamFileData, streamFileSize, subStreamId);
+bool readChunkHeader(const std::byte* const pHeaderData, FourCID& chunkTypeOut, uint32_t& chunkDataSizeOut) noexcept {
+    ASSERT(pHeaderData);
 
-    if (subStreamSize <= 0)
-        return false;
-    
-    // Read all of the data for this stream from each chunk in the stream file
-    std::unique_ptr<std::byte[]> streamData(new std::byte[subStreamSize]);
-
-    try {
-        // First skip over the stream header
-        std::byte* pCurData = streamData.get();
-        ByteInputStream bytes(pStreamFileData, streamFileSize);
-        bytes.consume(sizeof(StreamHeader));
-
-        // Keep reading more chunks in the stream until we are done
-        while (bytes.hasBytesLeft()) {
-            // Get this chunk's header and see if it is the type we are interested in.
-            // If it is the correct type then read the chunk, otherwise skip:
-            ChunkHeader chunkHdr;
-            bytes.read(chunkHdr);
-            chunkHdr.convertBigToHostEndian();
-            const uint32_t chunkDataSize = chunkHdr.chunkSize - sizeof(ChunkHeader);
-
-            if (chunkHdr.chunkType == subStreamId) {
-                bytes.readBytes(pCurData, chunkDataSize);
-                pCurData += chunkDataSize;
-            } else {
-                bytes.consume(chunkDataSize);
-            }
-        }
+    ChunkHeader chunkHdr;
+    std::memcpy(&chunkHdr, pHeaderData, sizeof(ChunkHeader));
+    chunkHdr.convertBigToHostEndian();
 
-        // If we read successfully then make the unique ptr relinquish memory ownership and hand over to caller
-        pSubStreamDataOut = streamData.release();
-        subStreamSizeOut = subStreamSize;
+    if (chunkHdr.chunkSize < sizeof(ChunkHeader))
+        return false;
 
-        return true;    // We succeeded to read the stream data!
-    }
-    catch (...) {
-        return false;   // Failed to read the stream data!
-    }
+    chunkTypeOut = chunkHdr.chunkType;
+    chunkDataSizeOut = chunkHdr.chunkSize - (uint32_t) sizeof(ChunkHeader);
+    return true;
 }
 
 END_NAMESPACE(ChunkedStreamFileUtils)
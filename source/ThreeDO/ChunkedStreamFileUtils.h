@@ -13,17 +13,17 @@
 //------------------------------------------------------------------------------------------------------------------------------------------
 BEGIN_NAMESPACE(ChunkedStreamFileUtils)
 
+// Size of the header at the start of a stream file, and the size of the header for each chunk following that
+static constexpr uint32_t STREAM_HEADER_SIZE = 244;
+static constexpr uint32_t CHUNK_HEADER_SIZE = 24;
+
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Extracts the entire data for the specified sub stream in the given stream file.
-// The data and it's size are returned in the given input variables.
-// Returns 'false' on failure to read the stream.
+// Functions for reading a stream file incrementally, one chunk at a time.
+// 'checkStreamHeader' validates the 'STREAM_HEADER_SIZE' bytes at the start of the file.
+// 'readChunkHeader' reads the 'CHUNK_HEADER_SIZE' bytes at the start of a chunk, giving its type and the size of the data
+// which follows the header. Both return 'false' if the data is not valid.
 //------------------------------------------------------------------------------------------------------------------------------------------
-bool getSubStreamData(
-    const std::byte* const pStreamFileData,
-    const uint32_t streamFileSize,
-    const FourCID subStreamId,
-    std::byte*& pSubStreamDataOut,
-    uint32_t& subStreamSizeOut
-) noexcept;
+bool checkStreamHeader(const std::byte* const pHeaderData) noexcept;
+bool readChunkHeader(const std::byte* const pHeaderData, FourCID& chunkTypeOut, uint32_t& chunkDataSizeOut) noexcept;
 
 END_NAMESPACE(ChunkedStreamFileUtils)
@@ -1,11 +1,11 @@
 #include "MovieDecoder.h"
 
-#include "Audio/AudioData.h"
 #include "Base/ByteInputStream.h"
 #include "Base/Endian.h"
-#include "Base/Finally.h"
-#include "ChunkedStreamFileUtils.h"
+#include "Base/FourCID.h"
+#include "Base/Simd.h"
 #include <algorithm>
+#include <cstring>
 
 BEGIN_NAMESPACE(MovieDecoder)
 
@@ -148,6 +148,9 @@ struct AudioStreamHeader {
     }
 };
 
+static_assert(sizeof(VideoStreamHeader) == VIDEO_STREAM_HEADER_SIZE);
+static_assert(sizeof(AudioStreamHeader) == AUDIO_STREAM_HEADER_SIZE);
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Convert a color in YUV format to XRGB8888 as it is done in the Cinepak codec.
 // According to what I read this is not a standard way of converting, but was chosen because of it's simplicity.
@@ -164,9 +167,20 @@ static uint32_t yuvToXRGB8888(const YUVColor color) noexcept {
     return (0xFF000000u | (r << 16) | (g << 8) | (b << 0));
 }
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Convert a codebook vector from YUV to the 4 XRGB8888 pixels it represents
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void convertVidVec(const VidVec vec, uint32_t pixelsOut[4]) noexcept {
+    pixelsOut[0] = yuvToXRGB8888({ vec.y0, vec.u, vec.v });
+    pixelsOut[1] = yuvToXRGB8888({ vec.y1, vec.u, vec.v });
+    pixelsOut[2] = yuvToXRGB8888({ vec.y2, vec.u, vec.v });
+    pixelsOut[3] = yuvToXRGB8888({ vec.y3, vec.u, vec.v });
+}
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Decode a block of 4x4 pixels using the specified codebook (which will be either the 'V1' or 'V4' codebook) and the
 // given set of indexes that reference particular vectors in the codebook.
+// Each vector supplies a 2x2 quadrant of the block, so each row of the block is the top or bottom half of two vectors.
 //------------------------------------------------------------------------------------------------------------------------------------------
 static void decodePixelBlock(
     VideoDecoderState& decoderState,
@@ -185,55 +199,40 @@ static void decodePixelBlock(
 
     // Figure out the top left x and y in terms of pixels
     const uint32_t lx = blockCol * 4;
-    const uint32_t ty = blockRow * 4;    
-
-    // Grab the 4 vectors for this block
-    const VidVec v0 = codebook.vectors[v0Idx];
-    const VidVec v1 = codebook.vectors[v1Idx];
-    const VidVec v2 = codebook.vectors[v2Idx];
-    const VidVec v3 = codebook.vectors[v3Idx];
-
-    // Get the YUV colors for each pixel
-    YUVColor pixelsYUV[16];
-    pixelsYUV[0 ] = { v0.y0, v0.u, v0.v };
-    pixelsYUV[1 ] = { v0.y1, v0.u, v0.v };
-    pixelsYUV[2 ] = { v1.y0, v1.u, v1.v };
-    pixelsYUV[3 ] = { v1.y1, v1.u, v1.v };
-    pixelsYUV[4 ] = { v0.y2, v0.u, v0.v };
-    pixelsYUV[5 ] = { v0.y3, v0.u, v0.v };
-    pixelsYUV[6 ] = { v1.y2, v1.u, v1.v };
-    pixelsYUV[7 ] = { v1.y3, v1.u, v1.v };
-    pixelsYUV[8 ] = { v2.y0, v2.u, v2.v };
-    pixelsYUV[9 ] = { v2.y1, v2.u, v2.v };
-    pixelsYUV[10] = { v3.y0, v3.u, v3.v };
-    pixelsYUV[11] = { v3.y1, v3.u, v3.v };
-    pixelsYUV[12] = { v2.y2, v2.u, v2.v };
-    pixelsYUV[13] = { v2.y3, v2.u, v2.v };
-    pixelsYUV[14] = { v3.y2, v3.u, v3.v };
-    pixelsYUV[15] = { v3.y3, v3.u, v3.v };
-
-    // Now convert each pixel to XRGB and save
+    const uint32_t ty = blockRow * 4;
+
+    // Grab the already converted pixels for the 4 vectors in this block
+    const uint32_t* const pV0 = codebook.vectors[v0Idx];
+    const uint32_t* const pV1 = codebook.vectors[v1Idx];
+    const uint32_t* const pV2 = codebook.vectors[v2Idx];
+    const uint32_t* const pV3 = codebook.vectors[v3Idx];
+
+    // Now write out each row of 4 pixels
     uint32_t* const pRow1 = &decoderState.pPixels[ty * VIDEO_WIDTH + lx];
     uint32_t* const pRow2 = pRow1 + VIDEO_WIDTH;
     uint32_t* const pRow3 = pRow1 + VIDEO_WIDTH * 2;
     uint32_t* const pRow4 = pRow1 + VIDEO_WIDTH * 3;
 
-    pRow1[0] = yuvToXRGB8888(pixelsYUV[0]);
-    pRow1[1] = yuvToXRGB8888(pixelsYUV[1]);
-    pRow1[2] = yuvToXRGB8888(pixelsYUV[2]);
-    pRow1[3] = yuvToXRGB8888(pixelsYUV[3]);
-    pRow2[0] = yuvToXRGB8888(pixelsYUV[4]);
-    pRow2[1] = yuvToXRGB8888(pixelsYUV[5]);
-    pRow2[2] = yuvToXRGB8888(pixelsYUV[6]);
-    pRow2[3] = yuvToXRGB8888(pixelsYUV[7]);
-    pRow3[0] = yuvToXRGB8888(pixelsYUV[8]);
-    pRow3[1] = yuvToXRGB8888(pixelsYUV[9]);
-    pRow3[2] = yuvToXRGB8888(pixelsYUV[10]);
-    pRow3[3] = yuvToXRGB8888(pixelsYUV[11]);
-    pRow4[0] = yuvToXRGB8888(pixelsYUV[12]);
-    pRow4[1] = yuvToXRGB8888(pixelsYUV[13]);
-    pRow4[2] = yuvToXRGB8888(pixelsYUV[14]);
-    pRow4[3] = yuvToXRGB8888(pixelsYUV[15]);
+    #if SIMD_USE_SSE2
+        const __m128i v0 = _mm_load_si128((const __m128i*) pV0);
+        const __m128i v1 = _mm_load_si128((const __m128i*) pV1);
+        const __m128i v2 = _mm_load_si128((const __m128i*) pV2);
+        const __m128i v3 = _mm_load_si128((const __m128i*) pV3);
+
+        _mm_storeu_si128((__m128i*) pRow1, _mm_unpacklo_epi64(v0, v1));
+        _mm_storeu_si128((__m128i*) pRow2, _mm_unpackhi_epi64(v0, v1));
+        _mm_storeu_si128((__m128i*) pRow3, _mm_unpacklo_epi64(v2, v3));
+        _mm_storeu_si128((__m128i*) pRow4, _mm_unpackhi_epi64(v2, v3));
+    #else
+        std::memcpy(pRow1 + 0, pV0 + 0, sizeof(uint32_t) * 2);
+        std::memcpy(pRow1 + 2, pV1 + 0, sizeof(uint32_t) * 2);
+        std::memcpy(pRow2 + 0, pV0 + 2, sizeof(uint32_t) * 2);
+        std::memcpy(pRow2 + 2, pV1 + 2, sizeof(uint32_t) * 2);
+        std::memcpy(pRow3 + 0, pV2 + 0, sizeof(uint32_t) * 2);
+        std::memcpy(pRow3 + 2, pV3 + 0, sizeof(uint32_t) * 2);
+        std::memcpy(pRow4 + 0, pV2 + 2, sizeof(uint32_t) * 2);
+        std::memcpy(pRow4 + 2, pV3 + 2, sizeof(uint32_t) * 2);
+    #endif
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -250,11 +249,8 @@ static void readCVIDChunk_KF_Codebook_12_Bit(
         throw VideoDecodeException();
     }
 
-    VidVec* pCurVec = codebook.vectors;
-
     for (uint32_t i = 0; i < numEntries; ++i) {
-        stream.read(*pCurVec);
-        ++pCurVec;
+        convertVidVec(stream.read<VidVec>(), codebook.vectors[i]);
     }
 }
 
@@ -265,8 +261,6 @@ static void readCVIDChunk_DF_Codebook_12_Bit(ByteInputStream& stream, VidCodeboo
     if (!stream.hasBytesLeft())
         return;
     
-    VidVec* const pVectors = codebook.vectors;
-
     // Note: need to read a flags vector for every 32 vectors in the code book, hence batches of 32:
     for (uint32_t startVecIdx = 0; startVecIdx < 256; startVecIdx += 32) {
         // First read the flags vector telling whether the next 32 vectors are updated or not
@@ -279,7 +273,7 @@ static void readCVIDChunk_DF_Codebook_12_Bit(ByteInputStream& stream, VidCodeboo
         for (uint32_t vecIdx = startVecIdx; vecIdx < endVecIdx; ++vecIdx) {
             // Is this vector to be updated?
             if ((updateFlags & 0x80000000) != 0) {
-                pVectors[vecIdx] = stream.read<VidVec>();
+                convertVidVec(stream.read<VidVec>(), codebook.vectors[vecIdx]);
             }
 
             // Move the next bit up into the top slot for the next loop iteration
@@ -428,42 +422,12 @@ static void readCVIDChunk(VideoDecoderState& decoderState, ByteInputStream& stre
     }
 }
 
-bool initVideoDecoder(
-    const std::byte* const pStreamFileData,
-    const uint32_t streamFileSize,
-    VideoDecoderState& decoderState
-) noexcept {
-    ASSERT(pStreamFileData || streamFileSize <= 0);
-
-    // Default initialize the decoder state initially
-    std::memset(&decoderState, 0, sizeof(VideoDecoderState));
-
-    // Grab the video stream data and abort if that fails
-    bool bInitializedSuccessfully = false;
-    const bool bGotVideoStreamData = ChunkedStreamFileUtils::getSubStreamData(
-        pStreamFileData,
-        streamFileSize,
-        FourCID("FILM"),
-        decoderState.pMovieData,
-        decoderState.movieDataSize
-    );
-
-    auto cleanupOnFailure = finally([&]() noexcept {
-        if (!bInitializedSuccessfully) {
-            shutdownVideoDecoder(decoderState);
-        }
-    });
-
-    if (!bGotVideoStreamData)
-        return false;
-    
-    // There should be at least the header and more data following it.
-    // Grab the header and verify that it looks as we expect:
-    if (decoderState.movieDataSize <= sizeof(VideoStreamHeader))
-        return false;
-
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Reads and validates the header at the start of the video stream data, returning 'false' if it is not a supported video
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool readVideoStreamHeader(const std::byte* const pHeaderData, uint32_t& totalFramesOut) noexcept {
     VideoStreamHeader header;
-    std::memcpy(&header, decoderState.pMovieData, sizeof(VideoStreamHeader));
+    std::memcpy(&header, pHeaderData, sizeof(VideoStreamHeader));
     header.convertBigToHostEndian();
 
     if (header.id != FourCID("cvid") && header.id != FourCID("CVID"))
@@ -478,42 +442,55 @@ bool initVideoDecoder(
     if (header.fps != VIDEO_FPS)
         return false;
     #endif
-    
-    decoderState.curMovieDataOffset += sizeof(VideoStreamHeader);
 
-    // All good if we get to here - alloc a pixel buffer and fill in some other details!
+    totalFramesOut = header.numFrames;
+    return true;
+}
+
+bool initStreamingVideoDecoder(const std::byte* const pVideoStreamHeader, VideoDecoderState& decoderState) noexcept {
+    ASSERT(pVideoStreamHeader);
+
+    // Default initialize the decoder state initially
+    std::memset(&decoderState, 0, sizeof(VideoDecoderState));
+    uint32_t totalFrames = 0;
+
+    if (!readVideoStreamHeader(pVideoStreamHeader, totalFrames))
+        return false;
+
     decoderState.pPixels = new uint32_t[VIDEO_WIDTH * VIDEO_HEIGHT];
-    decoderState.totalFrames = header.numFrames;
-    bInitializedSuccessfully = true;
+    decoderState.totalFrames = totalFrames;
     return true;
 }
 
 void shutdownVideoDecoder(VideoDecoderState& decoderState) noexcept {
     delete[] decoderState.pPixels;
     decoderState.pPixels = nullptr;
-    delete[] decoderState.pMovieData;
-    decoderState.pMovieData = nullptr;
 }
 
-bool decodeNextVideoFrame(VideoDecoderState& decoderState) noexcept {
-    // Sanity checks: decoder must have been initialized
-    ASSERT(decoderState.pMovieData);
-    ASSERT(decoderState.movieDataSize > 0);
+uint32_t getVideoFrameSize(const std::byte* const pFrameData, const uint32_t numBytesAvailable) noexcept {
+    ASSERT(pFrameData || (numBytesAvailable == 0));
 
-    // Can't read if we are at the end of the data
-    const bool bAtMovieEnd = (
-        (decoderState.curMovieDataOffset >= decoderState.movieDataSize) ||
-        (decoderState.frameNum >= decoderState.totalFrames)
-    );
+    if (numBytesAvailable < sizeof(uint32_t))
+        return 0;
 
-    if (bAtMovieEnd)
+    // Note: the frame size field does not include the size of the field itself
+    uint32_t frameSize;
+    std::memcpy(&frameSize, pFrameData, sizeof(uint32_t));
+    Endian::convertBigToHost(frameSize);
+    return (frameSize <= UINT32_MAX - sizeof(uint32_t)) ? frameSize + (uint32_t) sizeof(uint32_t) : 0;
+}
+
+bool decodeVideoFrame(VideoDecoderState& decoderState, const std::byte* const pFrameData, const uint32_t frameDataSize) noexcept {
+    // Sanity checks: decoder must have been initialized
+    ASSERT(decoderState.pPixels);
+    ASSERT(pFrameData || (frameDataSize == 0));
+
+    // Can't decode if we are at the end of the movie
+    if (decoderState.frameNum >= decoderState.totalFrames)
         return false;
     
     // Start reading
-    ByteInputStream movieData(
-        decoderState.pMovieData + decoderState.curMovieDataOffset,
-        decoderState.movieDataSize - decoderState.curMovieDataOffset
-    );
+    ByteInputStream movieData(pFrameData, frameDataSize);
 
     try {
         // Read the frame header and verify it is correct
@@ -567,11 +544,8 @@ bool decodeNextVideoFrame(VideoDecoderState& decoderState) noexcept {
             readCVIDChunk(decoderState, stripData);
         }
 
-        // Update decoder state to point to the next frame
-        ++decoderState.frameNum;
-        decoderState.curMovieDataOffset += frameHeader.frameSize + 4;
-
         // Frame decode succeeded
+        ++decoderState.frameNum;
         return true;
     }
     catch (...) {
@@ -580,46 +554,15 @@ bool decodeNextVideoFrame(VideoDecoderState& decoderState) noexcept {
     }
 }
 
-bool decodeMovieAudio(
-    const std::byte* const pStreamFileData,
-    const uint32_t streamFileSize,
-    AudioData& audioDataOut
-) noexcept {
-    ASSERT(pStreamFileData || streamFileSize <= 0);
-
-    // Default initialize the output until we are successful
-    audioDataOut = {};
-
-    // Firstly try to grab the audio stream data from the header
-    std::byte* pAudioStreamData = nullptr;
-    uint32_t audioStreamDataSize = 0;
-
-    auto cleanupAudioStreamData = finally([&]() noexcept {
-        delete[] pAudioStreamData;
-    });
-
-    const bool bGotAudioStreamData = ChunkedStreamFileUtils::getSubStreamData(
-        pStreamFileData,
-        streamFileSize,
-        FourCID("SNDS"),
-        pAudioStreamData,
-        audioStreamDataSize
-    );
-
-    if (!bGotAudioStreamData)
-        return false;
-
-    // Read the header
-    if (audioStreamDataSize <= sizeof(AudioStreamHeader))
-        return false;
+bool readMovieAudioHeader(const std::byte* const pAudioStreamHeader, MovieAudioFormat& formatOut) noexcept {
+    ASSERT(pAudioStreamHeader);
 
     AudioStreamHeader header;
-    std::memcpy(&header, pAudioStreamData, sizeof(AudioStreamHeader));
+    std::memcpy(&header, pAudioStreamHeader, sizeof(AudioStreamHeader));
     header.convertBigToHostEndian();
 
     // Sanity check the header and make sure it has a supported format
     const bool bInvalidHeader = (
-        (header.audioDataSize + sizeof(AudioStreamHeader) > audioStreamDataSize) ||
         (header.numChannels != 1 && header.numChannels != 2) ||
         (header.bitDepth != 8 && header.bitDepth != 16) ||
         (header.sampleRate <= 0)
@@ -627,18 +570,11 @@ bool decodeMovieAudio(
 
     if (bInvalidHeader)
         return false;
-    
-    // The rest is easy, just fill in the audio data struct, copy the audio data and return 'true' for success
-    const uint32_t bytesPerSample = header.bitDepth / 8;
-
-    audioDataOut.allocBuffer(header.audioDataSize);
-    audioDataOut.bufferSize = header.audioDataSize;
-    audioDataOut.numSamples = (header.audioDataSize / bytesPerSample) / header.numChannels;
-    audioDataOut.sampleRate = header.sampleRate;
-    audioDataOut.numChannels = (uint16_t) header.numChannels;
-    audioDataOut.bitDepth = (uint16_t) header.bitDepth;
 
-    std::memcpy(audioDataOut.pBuffer, pAudioStreamData + sizeof(AudioStreamHeader), header.audioDataSize);
+    formatOut.sampleRate = header.sampleRate;
+    formatOut.numChannels = (uint16_t) header.numChannels;
+    formatOut.bitDepth = (uint16_t) header.bitDepth;
+    formatOut.audioDataSize = header.audioDataSize;
     return true;
 }
 
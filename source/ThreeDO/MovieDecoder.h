@@ -4,8 +4,6 @@
 #include <cstddef>
 #include <cstdint>
 
-struct AudioData;
-
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Functionality for decoding the two movies that come with 3DO Doom.
 // Contains separate functions to decode both the audio and video data streams.
@@ -15,9 +13,9 @@ struct AudioData;
 //  (1) Constants/assumptions: for simplicity and speed I am hardcoding the video width and height to 280x200.
 //      I am also assuming just 1 strip per frame at all times for both movies.
 //      Much of this code is probably not of much use elsewhere anyway outside of this project, so that's okay...
-//  (2) For simplicity the entireity of audio data is decompressed up front, and the entire of the movie data is 
-//      de-chunked up front (but not decompressed). This simplifies the decoding and since the movies are only small
-//      this is okay too. Would have to consider more streaming type approaches for larger files however...
+//  (2) The caller de-chunks the stream file incrementally and hands over the video stream header and then each frame's data
+//      as it arrives, so the movies can be streamed. The audio samples are read directly from the audio stream by the caller,
+//      after the audio stream header has been read with 'readMovieAudioHeader'.
 //  (3) I don't know the exact details of all of the data structures stored in the movies, hence lots of 'unknown' fields.
 //      Some stuff was figured and/or guessed out from reverse engineering and examining the raw data.
 //      Enough is known however to decode the movie successfully.
@@ -35,6 +33,10 @@ static constexpr uint32_t VIDEO_HEIGHT = 200;
 static constexpr uint32_t VIDEO_FPS = 12;
 static constexpr uint32_t NUM_BLOCKS_PER_FRAME = (VIDEO_WIDTH * VIDEO_HEIGHT) / 16;     // Each block is 4x4 pixels
 
+// Size of the headers at the start of the video ('FILM') and audio ('SNDS') sub streams
+static constexpr uint32_t VIDEO_STREAM_HEADER_SIZE = 20;
+static constexpr uint32_t AUDIO_STREAM_HEADER_SIZE = 40;
+
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Represents one vector in the Cinepak 'V1' or 'V4' codebook.
 //------------------------------------------------------------------------------------------------------------------------------------------
@@ -50,18 +52,17 @@ struct alignas(1) VidVec {
 //------------------------------------------------------------------------------------------------------------------------------------------
 // A series of vectors that is looked up to decode a frame.
 // The list of vectors is indexed using a single byte value, so there are at most 256 values.
+// Vectors are converted from YUV to XRGB8888 once when the codebook is read, so decoding blocks is just a matter of copying pixels.
+// The 4 pixels for each vector are stored in this order: top left, top right, bottom left, bottom right.
 //------------------------------------------------------------------------------------------------------------------------------------------
 struct VidCodebook {
-    VidVec vectors[256];
+    alignas(16) uint32_t vectors[256][4];
 };
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Holds the current state/context for decoding video
 //------------------------------------------------------------------------------------------------------------------------------------------
 struct VideoDecoderState {
-    std::byte*      pMovieData;             // The de-chunked movie data for the movie
-    uint32_t        movieDataSize;          // Size of the movie data
-    uint32_t        curMovieDataOffset;     // Offset to the next movie data to use
     uint32_t        frameNum;               // What frame we are on, '1' for the first frame and '0' before the first frame has been decoded.
     uint32_t        totalFrames;            // Total number of frames in the movie.
     VidCodebook     codebooks[2];           // V1 and V4 codebooks of vectors (in that order)
@@ -69,15 +70,11 @@ struct VideoDecoderState {
 };
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Initialize the video decoder state before decoding; this must be done before decoding the first frame.
+// Initialize the video decoder state for streaming, from the header at the start of the video stream.
+// The header must be 'VIDEO_STREAM_HEADER_SIZE' bytes. Frames are then decoded using 'decodeVideoFrame'.
 // Returns 'false' on failure to init the video decoder state successfully.
-// N.B: 'shutdownMovieDecoder' should also be called after you are done with the movie.
 //------------------------------------------------------------------------------------------------------------------------------------------
-bool initVideoDecoder(
-    const std::byte* const pStreamFileData,
-    const uint32_t streamFileSize,
-    VideoDecoderState& decoderState
-) noexcept;
+bool initStreamingVideoDecoder(const std::byte* const pVideoStreamHeader, VideoDecoderState& decoderState) noexcept;
 
 //------------------------------------------------------------------------------------------------------------------------------------------
 // Release resources used by the video decoder state
@@ -85,20 +82,33 @@ bool initVideoDecoder(
 void shutdownVideoDecoder(VideoDecoderState& decoderState) noexcept;
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Decode the next frame of the video into the given decoder state.
-// This advances the frame number by '1' and calling continously will advance the movie.
-// If this has been done successfully ('true' returned) then the frame is stored in the decoder pixel buffer.
+// Gives the total size of the video frame starting at the given data, including the frame size field.
+// Returns '0' if not enough data is available to tell yet.
+//------------------------------------------------------------------------------------------------------------------------------------------
+uint32_t getVideoFrameSize(const std::byte* const pFrameData, const uint32_t numBytesAvailable) noexcept;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Decode a single video frame from the given frame data, which must be the entire frame as given by 'getVideoFrameSize'.
+// This advances the frame number by '1'. If this has been done successfully ('true' returned) then the frame is stored in the
+// decoder pixel buffer.
 //------------------------------------------------------------------------------------------------------------------------------------------
-bool decodeNextVideoFrame(VideoDecoderState& decoderState) noexcept;
+bool decodeVideoFrame(VideoDecoderState& decoderState, const std::byte* const pFrameData, const uint32_t frameDataSize) noexcept;
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// The format of the audio in a movie, as given by the header at the start of the audio stream.
+// The raw audio samples follow the header in the audio stream.
+//------------------------------------------------------------------------------------------------------------------------------------------
+struct MovieAudioFormat {
+    uint32_t    sampleRate;
+    uint16_t    numChannels;
+    uint16_t    bitDepth;
+    uint32_t    audioDataSize;      // Total size of the audio samples
+};
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Decode the entire audio for a movie stored in the given 3DO stream file and save to the given audio data object.
-// Returns 'false' on failure.
+// Read the header at the start of the audio stream, which must be 'AUDIO_STREAM_HEADER_SIZE' bytes.
+// Returns 'false' if the audio format is not supported.
 //------------------------------------------------------------------------------------------------------------------------------------------
-bool decodeMovieAudio(
-    const std::byte* const pStreamFileData,
-    const uint32_t streamFileSize,
-    AudioData& audioDataOut
-) noexcept;
+bool readMovieAudioHeader(const std::byte* const pAudioStreamHeader, MovieAudioFormat& formatOut) noexcept;
 
 END_NAMESPACE(MovieDecoder)
@@ -1,9 +1,13 @@
 #include "OperaFS.h"
 
 #include "Base/Endian.h"
+#include "Base/FileUtils.h"
+#include "Base/FourCID.h"
 #include "CDImageFileInputStream.h"
 #include <cstring>
+#include <memory>
 #include <queue>
+#include <string>
 
 BEGIN_NAMESPACE(OperaFS)
 
@@ -135,6 +139,26 @@ struct DirToRead {
     uint32_t    firstBlockIdx;      // Index of the first block of the directory on the disk (from the disk beginning)
 };
 
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Header for a file caching the list of filesystem entries for a disc image: the entries follow directly after it.
+// The disc image size and a few fields from the disc header identify the disc image the entries were read from.
+// Note: the entries are stored in the native endian and layout of the host machine, the file is not portable.
+//------------------------------------------------------------------------------------------------------------------------------------------
+struct FSEntriesCacheHeader {
+    static constexpr uint32_t FORMAT_VERSION = 1;
+
+    FourCID     magic;              // Should read 'OPFS'
+    uint32_t    formatVersion;      // Should match 'FORMAT_VERSION'
+    uint32_t    fsEntrySize;        // Should match 'sizeof(FSEntry)'
+    uint32_t    discImageSize;      // Size of the disc image (user data only) the entries were read from
+    uint32_t    discId;             // Disc header fields for the disc image the entries were read from
+    uint32_t    discNumBlocks;
+    uint32_t    rootDirBlockIdx;
+    uint32_t    numEntries;         // Number of filesystem entries following the header
+};
+
+static const FourCID FS_ENTRIES_CACHE_MAGIC = FourCID("OPFS");
+
 static bool areAllFlagsSet(const uint32_t flags, const uint32_t bitsToBeSet) noexcept {
     return ((flags & bitsToBeSet) == bitsToBeSet);
 }
@@ -330,7 +354,139 @@ static void readDirEntries(
     }
 }
 
-bool getFSEntriesFromDiscImage(const char* const pDiscImagePath, std::vector<FSEntry>& fsEntriesOut) noexcept {
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Makes up the header for the cache file of filesystem entries for the given disc image
+//------------------------------------------------------------------------------------------------------------------------------------------
+static FSEntriesCacheHeader makeFSEntriesCacheHeader(CDImageFileInputStream& cd, const DiscHeader& discHeader) THROWS {
+    FSEntriesCacheHeader header = {};
+    header.magic = FS_ENTRIES_CACHE_MAGIC;
+    header.formatVersion = FSEntriesCacheHeader::FORMAT_VERSION;
+    header.fsEntrySize = sizeof(FSEntry);
+    header.discImageSize = cd.size();
+    header.discId = discHeader.discId;
+    header.discNumBlocks = discHeader.discNumBlocks;
+    header.rootDirBlockIdx = discHeader.rootDirCopyOffsets[0];
+    return header;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Checks that a list of filesystem entries loaded from a cache file is sane, so bad cache data can't cause out of bounds accesses.
+// Children are always stored after their parent directory, and files must lie within the disc image.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool validateCachedFSEntries(const std::vector<FSEntry>& fsEntries, const uint32_t discImageSize) noexcept {
+    const uint32_t numEntries = (uint32_t) fsEntries.size();
+
+    if ((numEntries == 0) || (fsEntries[0].type != FSEntry::TYPE_DIR))
+        return false;
+
+    for (uint32_t entryIdx = 0; entryIdx < numEntries; ++entryIdx) {
+        const FSEntry& entry = fsEntries[entryIdx];
+
+        if (entry.name[MAX_NAME_LEN] != 0)
+            return false;
+
+        if (entry.type == FSEntry::TYPE_DIR) {
+            const bool bValidChildren = (
+                (entry.dir.numChildren == 0) || (
+                    (entry.dir.firstChildIdx > entryIdx) &&
+                    (entry.dir.firstChildIdx <= numEntries) &&
+                    (entry.dir.numChildren <= numEntries - entry.dir.firstChildIdx)
+                )
+            );
+
+            if (!bValidChildren)
+                return false;
+        }
+        else if (entry.type == FSEntry::TYPE_FILE) {
+            if ((entry.file.offset > discImageSize) || (entry.file.size > discImageSize - entry.file.offset))
+                return false;
+        }
+        else {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Try to load the list of filesystem entries from the given cache file, which must have the expected header.
+// Returns 'false' if the cache file does not exist or was not made from the same disc image.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static bool readFSEntriesCache(
+    const char* const pCacheFilePath,
+    const FSEntriesCacheHeader& expectedHeader,
+    std::vector<FSEntry>& fsEntriesOut
+) noexcept {
+    std::byte* pFileData = nullptr;
+    size_t fileSize = 0;
+
+    if (!FileUtils::getContentsOfFile(pCacheFilePath, pFileData, fileSize))
+        return false;
+
+    std::unique_ptr<std::byte[]> fileData(pFileData);
+
+    if (fileSize < sizeof(FSEntriesCacheHeader))
+        return false;
+
+    // Verify the header matches what is expected (apart from the number of entries) and that the entries are all there
+    FSEntriesCacheHeader header;
+    std::memcpy(&header, pFileData, sizeof(FSEntriesCacheHeader));
+
+    const bool bValidHeader = (
+        (header.magic == expectedHeader.magic) &&
+        (header.formatVersion == expectedHeader.formatVersion) &&
+        (header.fsEntrySize == expectedHeader.fsEntrySize) &&
+        (header.discImageSize == expectedHeader.discImageSize) &&
+        (header.discId == expectedHeader.discId) &&
+        (header.discNumBlocks == expectedHeader.discNumBlocks) &&
+        (header.rootDirBlockIdx == expectedHeader.rootDirBlockIdx) &&
+        (header.numEntries == (fileSize - sizeof(FSEntriesCacheHeader)) / sizeof(FSEntry)) &&
+        ((fileSize - sizeof(FSEntriesCacheHeader)) % sizeof(FSEntry) == 0)
+    );
+
+    if (!bValidHeader)
+        return false;
+
+    fsEntriesOut.resize(header.numEntries);
+    std::memcpy(fsEntriesOut.data(), pFileData + sizeof(FSEntriesCacheHeader), header.numEntries * sizeof(FSEntry));
+
+    if (!validateCachedFSEntries(fsEntriesOut, header.discImageSize)) {
+        fsEntriesOut.clear();
+        return false;
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Saves the list of filesystem entries to the given cache file.
+// Writes to a temporary file first and then renames it, so an interrupted write never leaves a partial cache file behind.
+//------------------------------------------------------------------------------------------------------------------------------------------
+static void writeFSEntriesCache(
+    const char* const pCacheFilePath,
+    const FSEntriesCacheHeader& headerIn,
+    const std::vector<FSEntry>& fsEntries
+) noexcept {
+    FSEntriesCacheHeader header = headerIn;
+    header.numEntries = (uint32_t) fsEntries.size();
+
+    const std::string tmpFilePath = std::string(pCacheFilePath) + ".tmp";
+    const bool bWroteFile = (
+        FileUtils::writeDataToFile(tmpFilePath.c_str(), (const std::byte*) &header, sizeof(FSEntriesCacheHeader)) &&
+        FileUtils::writeDataToFile(tmpFilePath.c_str(), (const std::byte*) fsEntries.data(), fsEntries.size() * sizeof(FSEntry), true)
+    );
+
+    if (bWroteFile) {
+        FileUtils::renameFile(tmpFilePath.c_str(), pCacheFilePath);
+    }
+}
+
+bool getFSEntriesFromDiscImage(
+    const char* const pDiscImagePath,
+    std::vector<FSEntry>& fsEntriesOut,
+    const char* const pCacheFilePath
+) noexcept {
     fsEntriesOut.clear();
 
     try {
@@ -342,6 +498,12 @@ bool getFSEntriesFromDiscImage(const char* const pDiscImagePath, std::vector<FSE
         DiscHeader discHeader;
         readAndVerifyDiscHeader(cd, discHeader);
 
+        // If the directory tree for this disc image has been cached then use that instead of reading it from the disc
+        const FSEntriesCacheHeader cacheHeader = makeFSEntriesCacheHeader(cd, discHeader);
+
+        if (pCacheFilePath && readFSEntriesCache(pCacheFilePath, cacheHeader, fsEntriesOut))
+            return true;
+
         // Makeup the root filesystem entry
         FSEntry& rootFSEntry = fsEntriesOut.emplace_back();
         rootFSEntry.type = FSEntry::TYPE_DIR;
@@ -356,6 +518,11 @@ bool getFSEntriesFromDiscImage(const char* const pDiscImagePath, std::vector<FSE
         
         readDirEntries(cd, dirsToRead, fsEntriesOut);
 
+        // Save the directory tree for next time
+        if (pCacheFilePath) {
+            writeFSEntriesCache(pCacheFilePath, cacheHeader, fsEntriesOut);
+        }
+
         // All good if we got to here!
         return true;
     }
@@ -44,6 +44,14 @@ struct FSEntry {
 
 // Builds a complete list of filesystem entries for the given 3DO disc image path.
 // The root entry is always first in the list; returns false on failure.
-bool getFSEntriesFromDiscImage(const char* const pDiscImagePath, std::vector<FSEntry>& fsEntriesOut) noexcept;
+//
+// If a cache file path is given then the list is loaded from that file instead of walking the directory tree on the disc, provided
+// the cache was made from the same disc image. Otherwise the list is built from the disc and then saved to the cache file for next time.
+// Failing to read or write the cache file is not an error.
+bool getFSEntriesFromDiscImage(
+    const char* const pDiscImagePath,
+    std::vector<FSEntry>& fsEntriesOut,
+    const char* const pCacheFilePath = nullptr
+) noexcept;
 
 END_NAMESPACE(OperaFS)
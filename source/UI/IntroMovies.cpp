@@ -1,50 +1,28 @@
 #include "IntroMovies.h"
 
 #include "Audio/Audio.h"
-#include "Audio/AudioDataMgr.h"
-#include "Audio/AudioSystem.h"
-#include "Base/Finally.h"
 #include "Base/Input.h"
 #include "Base/Tables.h"
 #include "Game/Controls.h"
 #include "Game/Data.h"
 #include "Game/DoomMain.h"
-#include "Game/GameDataFS.h"
 #include "GFX/Blit.h"
 #include "GFX/Video.h"
+#include "MoviePlayer.h"
 #include "ThreeDO/MovieDecoder.h"
 #include "UIUtils.h"
 
 BEGIN_NAMESPACE(IntroMovies)
 
-static AudioDataMgr::Handle                 gMovieAudioDataHandle   = AudioDataMgr::INVALID_HANDLE;
-static uint32_t                             gMovieAudioSampleRate   = 0;
-static AudioSystem::VoiceIdx                gMovieAudioVoice        = AudioSystem::INVALID_VOICE_IDX;
-static MovieDecoder::VideoDecoderState*     gpVidDecoderState       = nullptr;
+static MoviePlayer gMoviePlayer;
 
 static void shutdownMovie() noexcept {
-    if (gMovieAudioVoice != AudioSystem::INVALID_VOICE_IDX) {
-        Audio::getSoundAudioSystem().stopVoice(gMovieAudioVoice);
-        gMovieAudioVoice = AudioSystem::INVALID_VOICE_IDX;
-    }
-
-    if (gMovieAudioDataHandle != AudioDataMgr::INVALID_HANDLE) {
-        Audio::getAudioDataMgr().unloadHandle(gMovieAudioDataHandle);
-        gMovieAudioDataHandle = AudioDataMgr::INVALID_HANDLE;
-    }
-
-    gMovieAudioSampleRate = 0;
-    
-    if (gpVidDecoderState) {
-        MovieDecoder::shutdownVideoDecoder(*gpVidDecoderState);
-        delete gpVidDecoderState;
-        gpVidDecoderState = nullptr;
-    }
+    gMoviePlayer.close();
 }
 
 //------------------------------------------------------------------------------------------------------------------------------------------
-// Loads the given movie and it's audio.
-// Starts playing the audio.
+// Opens the given movie and starts playing it.
+// The movie is streamed from disk and decoded ahead in the background, so it is never fully loaded into memory.
 //------------------------------------------------------------------------------------------------------------------------------------------
 static void startupMovie(const char* path) noexcept {
     // Ensure the screen is clear before we display the movie
@@ -53,53 +31,8 @@ static void startupMovie(const char* path) noexcept {
     // Don't do any screen wipes for movies
     gbDoWipe = false;
 
-    // Try to load the movie file into memory
-    std::byte* pMovieFileData = nullptr;
-    size_t movieFileSize = 0;
-
-    auto cleanupMovieFileData = finally([&]() {
-        delete[] pMovieFileData;
-    });
-
-    if (!GameDataFS::getContentsOfFile(path, pMovieFileData, movieFileSize))
-        return;
-
-    // Initialize the decoder: destroy if failed
-    gpVidDecoderState = new MovieDecoder::VideoDecoderState();
-
-    if (!MovieDecoder::initVideoDecoder(pMovieFileData, (uint32_t) movieFileSize, *gpVidDecoderState)) {
-        shutdownMovie();
-        return;
-    }
-
-    // Decode the first frame of the video
-    if (!MovieDecoder::decodeNextVideoFrame(*gpVidDecoderState)) {
-        shutdownMovie();
-        return;
-    }
-
-    // Load the audio for the movie and start playing it
-    AudioData audioData;
-
-    if (!MovieDecoder::decodeMovieAudio(pMovieFileData, (uint32_t) movieFileSize, audioData)) {
-        shutdownMovie();
-        return;
-    }
-
-    gMovieAudioDataHandle = Audio::getAudioDataMgr().addAudioDataWithOwnership(audioData);
-
-    if (gMovieAudioDataHandle == AudioDataMgr::INVALID_HANDLE) {
-        shutdownMovie();
-        return;
-    }
-
-    gMovieAudioSampleRate = audioData.sampleRate;
-    gMovieAudioVoice = Audio::getSoundAudioSystem().play(gMovieAudioDataHandle);
-
-    if (gMovieAudioVoice == AudioSystem::INVALID_VOICE_IDX) {
-        shutdownMovie();
-        return;
-    }
+    // Start playing the movie: if this fails then it is just skipped
+    gMoviePlayer.open(path, Audio::getMovieAudioStream());
 }
 
 static void onAdiMovieStarting() noexcept {
@@ -115,36 +48,21 @@ static void onMovieStopping() noexcept {
 }
 
 static gameaction_e updateMovie() noexcept {
-    // If there is no movie playing then we are done!
-    if (!gpVidDecoderState)
-        return ga_completed;
-    
-    // If the sound is done playing then we are done
-    const AudioVoice voice = Audio::getSoundAudioSystem().getVoiceState(gMovieAudioVoice);
-    
-    if (voice.state == AudioVoice::State::STOPPED)
+    // If there is no movie playing or the movie is done playing then we are done!
+    if ((!gMoviePlayer.isOpen()) || (!gMoviePlayer.update()))
         return ga_completed;
     
     // Skip pressed?
     if (MENU_ACTION_ENDED(OK) || MENU_ACTION_ENDED(BACK))
         return ga_exitdemo;
-    
-    // Figure out what frame in the video the audio data is at
-    const double audioTimeInSeconds = (double) voice.curSample / (double) gMovieAudioSampleRate;
-    const double tgtVidFrameNumFrac = audioTimeInSeconds * (double) MovieDecoder::VIDEO_FPS;
-    const uint32_t tgtVidFrameNum = (uint32_t) tgtVidFrameNumFrac;
-
-    // If the video is behind then decode to catch up
-    while (gpVidDecoderState->frameNum < tgtVidFrameNum) {
-        if (!MovieDecoder::decodeNextVideoFrame(*gpVidDecoderState))
-            break;
-    }
 
     return ga_nothing;
 }
 
 static void drawMovie(const bool bPresent, const bool bSaveFrameBuffer) noexcept {
-    if (!gpVidDecoderState)
+    const uint32_t* const pMoviePixels = gMoviePlayer.getCurFramePixels();
+
+    if (!pMoviePixels)
         return;
     
     // Figure out the unscaled x and y position of the movie
@@ -162,7 +80,7 @@ static void drawMovie(const bool bPresent, const bool bSaveFrameBuffer) noexcept
         Blit::BCF_H_CLIP |
         Blit::BCF_V_CLIP
     >(
-        gpVidDecoderState->pPixels,
+        pMoviePixels,
         MovieDecoder::VIDEO_WIDTH,
         MovieDecoder::VIDEO_HEIGHT,
         0.0f,
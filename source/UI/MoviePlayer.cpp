@@ -0,0 +1,348 @@
+#include "MoviePlayer.h"
+
+#include "Audio/AudioStream.h"
+#include "Game/GameDataFS.h"
+#include "ThreeDO/ChunkedStreamFileUtils.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+static constexpr uint32_t FRAME_NUM_PIXELS = MovieDecoder::VIDEO_WIDTH * MovieDecoder::VIDEO_HEIGHT;
+
+// Ids of the sub streams in the movie file for video and audio
+static const FourCID VIDEO_SUB_STREAM_ID = FourCID("FILM");
+static const FourCID AUDIO_SUB_STREAM_ID = FourCID("SNDS");
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Reads the given number of bytes from the input onto the end of the buffer.
+// Bytes that have been consumed already are discarded first, so the buffer only ever holds unused data.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void MoviePlayer::SubStreamBuffer::append(const uint32_t numBytes, GameDataFS::InputStream& input) THROWS {
+    if (readOffset > 0) {
+        bytes.erase(bytes.begin(), bytes.begin() + readOffset);
+        readOffset = 0;
+    }
+
+    const size_t oldSize = bytes.size();
+    bytes.resize(oldSize + numBytes);
+    input.readBytes(bytes.data() + oldSize, numBytes);
+}
+
+void MoviePlayer::SubStreamBuffer::clear() noexcept {
+    bytes.clear();
+    bytes.shrink_to_fit();
+    readOffset = 0;
+}
+
+MoviePlayer::MoviePlayer() noexcept
+    : mbIsOpen(false)
+    , mpAudioStream(nullptr)
+    , mpInput()
+    , mbInputEnded(false)
+    , mbVideoEnded(false)
+    , mbAudioEnded(false)
+    , mVideoData()
+    , mAudioData()
+    , mNumAudioBytesLeft(0)
+    , mAudioBytesPerSample(0)
+    , mDecoderState()
+    , mpFramePixels()
+    , mNumFramesDecoded(0)
+    , mCurFrameIdx(0)
+    , mWorkerThread()
+    , mWorkerMutex()
+    , mWorkerCondVar()
+    , mbStopWorker(false)
+{
+    mVideoData.readOffset = 0;
+    mAudioData.readOffset = 0;
+}
+
+MoviePlayer::~MoviePlayer() noexcept {
+    close();
+}
+
+bool MoviePlayer::open(const char* const filePath, AudioStream& audioStream) noexcept {
+    ASSERT(filePath);
+    close();
+
+    // Open the file and validate the stream file header
+    mpInput = GameDataFS::openFile(filePath);
+
+    if (!mpInput)
+        return false;
+
+    try {
+        std::byte streamHeader[ChunkedStreamFileUtils::STREAM_HEADER_SIZE];
+        mpInput->readBytes(streamHeader, sizeof(streamHeader));
+
+        if (!ChunkedStreamFileUtils::checkStreamHeader(streamHeader)) {
+            close();
+            return false;
+        }
+    }
+    catch (...) {
+        close();
+        return false;
+    }
+
+    // Read chunks until the headers for both the video and audio streams have arrived.
+    // These are right at the start of the movie so this only needs to read a little of the file.
+    mbIsOpen = true;
+
+    while ((mVideoData.getSize() < MovieDecoder::VIDEO_STREAM_HEADER_SIZE) || (mAudioData.getSize() < MovieDecoder::AUDIO_STREAM_HEADER_SIZE)) {
+        if (!readNextChunk()) {
+            close();
+            return false;
+        }
+    }
+
+    if (!MovieDecoder::initStreamingVideoDecoder(mVideoData.getData(), mDecoderState)) {
+        close();
+        return false;
+    }
+
+    mVideoData.consume(MovieDecoder::VIDEO_STREAM_HEADER_SIZE);
+
+    MovieDecoder::MovieAudioFormat audioFormat;
+
+    if (!MovieDecoder::readMovieAudioHeader(mAudioData.getData(), audioFormat)) {
+        close();
+        return false;
+    }
+
+    mAudioData.consume(MovieDecoder::AUDIO_STREAM_HEADER_SIZE);
+    mNumAudioBytesLeft = audioFormat.audioDataSize;
+    mAudioBytesPerSample = audioFormat.numChannels * (audioFormat.bitDepth / 8u);
+
+    // Start the audio playing (initially silent until audio is queued) and kick off the worker thread to do the rest
+    if (!audioStream.playQueued(audioFormat.sampleRate, audioFormat.numChannels, audioFormat.bitDepth)) {
+        close();
+        return false;
+    }
+
+    mpAudioStream = &audioStream;
+    mpFramePixels = std::make_unique<uint32_t[]>(FRAME_NUM_PIXELS * NUM_FRAME_BUFFERS);
+    mNumFramesDecoded = 0;
+    mCurFrameIdx = 0;
+    mbStopWorker = false;
+    mWorkerThread = std::thread([this]() noexcept { workerThreadMain(); });
+    return true;
+}
+
+void MoviePlayer::close() noexcept {
+    // Stop the worker thread first since it uses everything else
+    if (mWorkerThread.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(mWorkerMutex);
+            mbStopWorker = true;
+        }
+
+        mWorkerCondVar.notify_one();
+        mWorkerThread.join();
+        mbStopWorker = false;
+    }
+
+    if (mpAudioStream) {
+        mpAudioStream->stop();
+        mpAudioStream = nullptr;
+    }
+
+    if (mDecoderState.pPixels) {
+        MovieDecoder::shutdownVideoDecoder(mDecoderState);
+    }
+
+    mpInput.reset();
+    mbInputEnded = false;
+    mbVideoEnded = false;
+    mbAudioEnded = false;
+    mVideoData.clear();
+    mAudioData.clear();
+    mNumAudioBytesLeft = 0;
+    mAudioBytesPerSample = 0;
+    mpFramePixels.reset();
+    mNumFramesDecoded = 0;
+    mCurFrameIdx = 0;
+    mbIsOpen = false;
+}
+
+bool MoviePlayer::update() noexcept {
+    if (!mbIsOpen)
+        return false;
+
+    // If the audio is done playing then the movie is done
+    if (!mpAudioStream->isPlaying())
+        return false;
+
+    // Figure out what frame in the video the audio is at: frame number '1' is the first frame.
+    // Move onto that frame if it has been decoded, otherwise show the latest frame that has been decoded.
+    const double audioTimeInSeconds = mpAudioStream->getPlaybackTime();
+    const uint32_t tgtFrameNum = (uint32_t)(audioTimeInSeconds * (double) MovieDecoder::VIDEO_FPS);
+    const uint32_t tgtFrameIdx = (tgtFrameNum > 0) ? tgtFrameNum - 1 : 0;
+    const uint32_t numFramesDecoded = mNumFramesDecoded.load(std::memory_order_acquire);
+    const uint32_t oldFrameIdx = mCurFrameIdx.load(std::memory_order_relaxed);
+    uint32_t curFrameIdx = oldFrameIdx;
+
+    while ((curFrameIdx < tgtFrameIdx) && (curFrameIdx + 1 < numFramesDecoded)) {
+        ++curFrameIdx;
+    }
+
+    // If frame buffers were freed up then let the worker know it can decode more
+    if (curFrameIdx != oldFrameIdx) {
+        mCurFrameIdx.store(curFrameIdx, std::memory_order_release);
+        mWorkerCondVar.notify_one();
+    }
+
+    return true;
+}
+
+const uint32_t* MoviePlayer::getCurFramePixels() const noexcept {
+    if ((!mbIsOpen) || (mNumFramesDecoded.load(std::memory_order_acquire) == 0))
+        return nullptr;
+
+    const uint32_t frameBufferIdx = mCurFrameIdx.load(std::memory_order_relaxed) % NUM_FRAME_BUFFERS;
+    return mpFramePixels.get() + (size_t) frameBufferIdx * FRAME_NUM_PIXELS;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Worker thread: reads the next chunk of the movie file and adds its data to the buffer for the sub stream it belongs to.
+// Returns 'false' if there are no more chunks to read, either because the end of the file was reached or an error.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool MoviePlayer::readNextChunk() noexcept {
+    if (mbInputEnded)
+        return false;
+
+    try {
+        if (mpInput->size() - mpInput->tell() < ChunkedStreamFileUtils::CHUNK_HEADER_SIZE) {
+            mbInputEnded = true;
+            return false;
+        }
+
+        std::byte chunkHeader[ChunkedStreamFileUtils::CHUNK_HEADER_SIZE];
+        mpInput->readBytes(chunkHeader, sizeof(chunkHeader));
+
+        FourCID chunkType;
+        uint32_t chunkDataSize = 0;
+
+        if (!ChunkedStreamFileUtils::readChunkHeader(chunkHeader, chunkType, chunkDataSize)) {
+            mbInputEnded = true;
+            return false;
+        }
+
+        if (chunkType == VIDEO_SUB_STREAM_ID) {
+            mVideoData.append(chunkDataSize, *mpInput);
+        } else if (chunkType == AUDIO_SUB_STREAM_ID) {
+            mAudioData.append(chunkDataSize, *mpInput);
+        } else {
+            mpInput->skip(chunkDataSize);
+        }
+
+        return true;
+    }
+    catch (...) {
+        mbInputEnded = true;
+        return false;
+    }
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Worker thread: decodes the next video frame into the next free frame buffer, reading more of the file as needed.
+// Returns 'false' if no frame was decoded, in which case the video has ended.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool MoviePlayer::decodeNextFrame() noexcept {
+    // Read until there is a complete frame of video data
+    uint32_t frameSize = MovieDecoder::getVideoFrameSize(mVideoData.getData(), mVideoData.getSize());
+
+    while ((frameSize == 0) || (frameSize > mVideoData.getSize())) {
+        if (!readNextChunk()) {
+            mbVideoEnded = true;
+            return false;
+        }
+
+        frameSize = MovieDecoder::getVideoFrameSize(mVideoData.getData(), mVideoData.getSize());
+    }
+
+    // Decode the frame and copy it to the ring of frame buffers.
+    // Note: the decoder must decode into its own pixels since delta frames only update part of the previous frame.
+    if (!MovieDecoder::decodeVideoFrame(mDecoderState, mVideoData.getData(), frameSize)) {
+        mbVideoEnded = true;
+        return false;
+    }
+
+    mVideoData.consume(frameSize);
+
+    const uint32_t frameIdx = mNumFramesDecoded.load(std::memory_order_relaxed);
+    uint32_t* const pFramePixels = mpFramePixels.get() + (size_t)(frameIdx % NUM_FRAME_BUFFERS) * FRAME_NUM_PIXELS;
+    std::memcpy(pFramePixels, mDecoderState.pPixels, FRAME_NUM_PIXELS * sizeof(uint32_t));
+    mNumFramesDecoded.store(frameIdx + 1, std::memory_order_release);
+
+    if (mDecoderState.frameNum >= mDecoderState.totalFrames) {
+        mbVideoEnded = true;
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Worker thread: queues as much audio as the audio stream will take, reading more of the file as needed.
+// Returns 'true' if any audio was queued.
+//------------------------------------------------------------------------------------------------------------------------------------------
+bool MoviePlayer::queueAudio() noexcept {
+    // Make sure there is at least one sample of audio available, if there is more audio to come
+    while ((mAudioData.getSize() < mAudioBytesPerSample) && (mNumAudioBytesLeft >= mAudioBytesPerSample)) {
+        if (!readNextChunk())
+            break;
+    }
+
+    const uint32_t numSamplesAvailable = std::min(mAudioData.getSize(), mNumAudioBytesLeft) / mAudioBytesPerSample;
+
+    // If there is no more audio then let the audio stream know it has everything
+    if (numSamplesAvailable == 0) {
+        mpAudioStream->endQueue();
+        mbAudioEnded = true;
+        return false;
+    }
+
+    const uint32_t numSamplesQueued = mpAudioStream->queueSamples(mAudioData.getData(), numSamplesAvailable);
+    const uint32_t numBytesQueued = numSamplesQueued * mAudioBytesPerSample;
+    mAudioData.consume(numBytesQueued);
+    mNumAudioBytesLeft -= numBytesQueued;
+    return (numSamplesQueued > 0);
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Worker thread: keeps the ring of frames and the audio stream topped up until the movie ends or the thread is told to stop.
+// When there is nothing to do the thread sleeps for a little while, or until the game thread frees up a frame buffer.
+//------------------------------------------------------------------------------------------------------------------------------------------
+void MoviePlayer::workerThreadMain() noexcept {
+    std::unique_lock<std::mutex> lock(mWorkerMutex);
+
+    while (!mbStopWorker) {
+        lock.unlock();
+        bool bDidWork = false;
+
+        // Decode the next frame if there is a free frame buffer.
+        // Note: the buffer for the frame being displayed must not be touched, hence the '- 1'.
+        const uint32_t numFramesDecoded = mNumFramesDecoded.load(std::memory_order_relaxed);
+        const uint32_t curFrameIdx = mCurFrameIdx.load(std::memory_order_acquire);
+        const bool bHaveFreeFrameBuffer = (numFramesDecoded - curFrameIdx < NUM_FRAME_BUFFERS);
+
+        if ((!mbVideoEnded) && bHaveFreeFrameBuffer) {
+            bDidWork |= decodeNextFrame();
+        }
+
+        // Feed the audio stream
+        if (!mbAudioEnded) {
+            bDidWork |= queueAudio();
+        }
+
+        lock.lock();
+
+        if (mbVideoEnded && mbAudioEnded)
+            break;
+
+        if (!bDidWork) {
+            mWorkerCondVar.wait_for(lock, std::chrono::milliseconds(2));
+        }
+    }
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "ThreeDO/MovieDecoder.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class AudioStream;
+
+namespace GameDataFS {
+    class InputStream;
+}
+
+//------------------------------------------------------------------------------------------------------------------------------------------
+// Streams one of the 3DO movies from disk and plays it.
+// A worker thread reads the stream file a chunk at a time, decodes video frames ahead into a small ring of frame buffers and feeds
+// the movie audio incrementally to an audio stream. The game thread just picks the decoded frame that matches the audio clock.
+// Only the frame ring and a small amount of undecoded data are held in memory at any time.
+//
+// Threading notes:
+//  (1) All public functions must be called from the same thread (the game thread).
+//  (2) The worker thread owns the input file, the decoder and the audio stream's queue while the movie is open.
+//  (3) The worker only writes frame buffers that are not being displayed: it stays at most 'NUM_FRAME_BUFFERS - 1' frames
+//      ahead of the frame currently displayed by the game thread.
+//------------------------------------------------------------------------------------------------------------------------------------------
+class MoviePlayer {
+public:
+    // How many decoded frames are kept: the displayed frame plus the frames decoded ahead of it
+    static constexpr uint32_t NUM_FRAME_BUFFERS = 4;
+
+    MoviePlayer() noexcept;
+    ~MoviePlayer() noexcept;
+
+    //------------------------------------------------------------------------------------------------------------------
+    // Open the given movie and start playing it, with the audio played through the given stream.
+    // Returns 'false' on failure. Note: the audio stream MUST remain valid until the movie is closed.
+    //------------------------------------------------------------------------------------------------------------------
+    bool open(const char* const filePath, AudioStream& audioStream) noexcept;
+    void close() noexcept;
+    inline bool isOpen() const noexcept { return mbIsOpen; }
+
+    //------------------------------------------------------------------------------------------------------------------
+    // Advances the displayed frame to match the audio clock. Returns 'false' once the movie has finished playing.
+    //------------------------------------------------------------------------------------------------------------------
+    bool update() noexcept;
+
+    //------------------------------------------------------------------------------------------------------------------
+    // Gives the pixels for the frame currently being displayed, or 'nullptr' if no frame has been decoded yet.
+    // The frame is 'MovieDecoder::VIDEO_WIDTH' x 'MovieDecoder::VIDEO_HEIGHT' pixels in XRGB8888 format.
+    //------------------------------------------------------------------------------------------------------------------
+    const uint32_t* getCurFramePixels() const noexcept;
+
+private:
+    // Data for one of the sub streams (video or audio) in the movie file which has been read but not yet used
+    struct SubStreamBuffer {
+        std::vector<std::byte>  bytes;
+        uint32_t                readOffset;
+
+        inline const std::byte* getData() const noexcept { return bytes.data() + readOffset; }
+        inline uint32_t getSize() const noexcept { return (uint32_t) bytes.size() - readOffset; }
+        inline void consume(const uint32_t numBytes) noexcept { readOffset += numBytes; }
+        void append(const uint32_t numBytes, GameDataFS::InputStream& input) THROWS;
+        void clear() noexcept;
+    };
+
+    bool readNextChunk() noexcept;
+    bool decodeNextFrame() noexcept;
+    bool queueAudio() noexcept;
+    void workerThreadMain() noexcept;
+
+    bool                                        mbIsOpen;
+    AudioStream*                                mpAudioStream;
+
+    // State owned by the worker thread while the movie is open
+    std::unique_ptr<GameDataFS::InputStream>    mpInput;
+    bool                                        mbInputEnded;
+    bool                                        mbVideoEnded;
+    bool                                        mbAudioEnded;
+    SubStreamBuffer                             mVideoData;
+    SubStreamBuffer                             mAudioData;
+    uint32_t                                    mNumAudioBytesLeft;     // How many bytes of audio samples are left to queue
+    uint32_t                                    mAudioBytesPerSample;
+    MovieDecoder::VideoDecoderState             mDecoderState;
+
+    // The ring of decoded frames
+    std::unique_ptr<uint32_t[]>                 mpFramePixels;
+    std::atomic<uint32_t>                       mNumFramesDecoded;      // Written only by the worker thread
+    std::atomic<uint32_t>                       mCurFrameIdx;           // Index of the frame being displayed, written only by the game thread
+
+    // Worker thread and its stop signal
+    std::thread                                 mWorkerThread;
+    std::mutex                                  mWorkerMutex;
+    std::condition_variable                     mWorkerCondVar;
+    bool                                        mbStopWorker;           // Protected by 'mWorkerMutex'
+};
@@ -3,6 +3,7 @@
 #include "Base/Tables.h"
 #include "Game/Data.h"
 #include "Game/DoomRez.h"
+#include "Game/TickCounter.h"
 #include "GFX/Blit.h"
 #include "GFX/CelImages.h"
 #include "GFX/Video.h"
@@ -234,6 +235,11 @@ void drawPerformanceCounter(const int32_t x, const int32_t y) noexcept {
         std::string usecString = std::to_string(gPerfCounterAverageUSec) + std::string(" USEC");
         printBigFont(x, y, usecString.c_str());
     }
+    else if (gPerfCounterMode == PerfCounterMode::PACING) {
+        const TickCounter::PacingStats& stats = TickCounter::getPacingStats();
+        std::string pacingString = std::string("JITTER ") + std::to_string(stats.avgJitterUSec) + std::string(" MAX ") + std::to_string(stats.maxJitterUSec);
+        printBigFont(x, y, pacingString.c_str());
+    }
 }
 
 END_NAMESPACE(UIUtils)
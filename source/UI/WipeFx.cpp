@@ -8,7 +8,7 @@
 #include "UIUtils.h"
 #include <algorithm>
 #include <cstring>
-#include <thread>
+#include <memory>
 
 BEGIN_NAMESPACE(WipeFx)
 
@@ -192,7 +192,7 @@ void doWipe(const GameLoopDrawFunc drawFunc) noexcept {
         uint32_t ticksLeftToSimulate = TickCounter::update();
 
         if (ticksLeftToSimulate <= 0) {
-            std::this_thread::yield();
+            TickCounter::waitForNextTick();
             continue;
         }
 